@@ -0,0 +1,761 @@
+// AutoPowerDaemon.cpp
+// Headless governor for build servers and lab machines: the tray app's sampling / decision /
+// actuation loop with no window, tray icon, dialog resource or registry. It is configured by a
+// key=value file using the tray's registry value names and controlled over a local channel
+// (ControlChannel.h), one JSON line per reply:
+//
+//   state                                 applied and governor profile, tier, reasons, load, pin
+//   pin boost|balanced|saver [SECONDS]    hold a profile; without SECONDS until unpin
+//   unpin
+//   watch / unwatch                       stream one JSON line per profile or tier transition
+//   stats                                 startup time, resident memory, ticks, power writes, input latency
+//   energy [reset]                        Wh per profile and per app, the always-Boost estimate
+//   target [off|DURATION|until HH:MM]     battery runtime target (e.g. 3h, until 18:00) and its estimate
+//
+// There is no foreground window here: tiers come from load, background processes, battery and
+// temperature. On Linux, InputBoost = 1 adds keyboard and pointer input from evdev (root or the
+// input group): it sets the idle time, and a key press, click or deliberate move ticks at once.
+// With PMU access (root or CAP_PERFMON) the hardware counters tell compute-bound load from load
+// waiting on memory: the latter doesn't make the tier Active and is capped at MemoryBoundMaxPct
+// with boost off (PerfClassify = 0 turns this off).
+//
+// Usage:
+//   AutoPowerDaemon [--config FILE] [--endpoint PATH] [--telemetry FILE] [--energy FILE] [--dry-run]
+//   AutoPowerDaemon --send "COMMAND" [--endpoint PATH]
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o autopowerd AutoPowerDaemon/AutoPowerDaemon.cpp AutoPowerManager/ControlChannel.cpp
+//       AutoPowerManager/Footprint.cpp AutoPowerManager/GovernorLoop.cpp AutoPowerManager/Governor.cpp
+//       AutoPowerManager/CpuSampler.cpp AutoPowerManager/CpuTopology.cpp AutoPowerManager/ProcessScanner.cpp
+//       AutoPowerManager/ForegroundTracker.cpp AutoPowerManager/ProcessQos.cpp AutoPowerManager/ProfileLadder.cpp
+//       AutoPowerManager/Thermal.cpp AutoPowerManager/TickScheduler.cpp AutoPowerManager/Telemetry.cpp
+//       AutoPowerManager/PowerWriter.cpp AutoPowerManager/LatencyHistogram.cpp AutoPowerManager/SysfsPower.cpp
+//       AutoPowerManager/SignalFilter.cpp AutoPowerManager/AppRules.cpp AutoPowerManager/Energy.cpp
+//       AutoPowerManager/BatteryRuntime.cpp AutoPowerManager/InputBoost.cpp AutoPowerManager/PerfCounters.cpp
+//       AutoPowerManager/Predictor.cpp
+
+#include "../AutoPowerManager/ControlChannel.h"
+#include "../AutoPowerManager/Footprint.h"
+#include "../AutoPowerManager/GovernorLoop.h"
+#include "../AutoPowerManager/InputBoost.h"
+#include "../AutoPowerManager/LatencyHistogram.h"
+#ifndef _WIN32
+#include "../AutoPowerManager/SysfsPower.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// ---------- Configuration (the tray's registry value names) ----------
+struct DaemonConfig {
+    GovernorLoopConfig loop;                   // processQos off: with no foreground, every busy process is "background"
+    uint32_t telemetryRecords = 65'536;        // with --telemetry
+    std::wstring appRules;                     // AppRules.h lines, from HeavyApps and AppRule
+    ProfileLadder ladder;
+    bool     inputBoost = false;               // evdev input (Linux): idle time and input-triggered ticks
+    InputBoostConfig input;
+};
+
+static uint32_t ClampU32(unsigned long v, uint32_t lo, uint32_t hi) { return v < lo ? lo : v > hi ? hi : (uint32_t)v; }
+
+static std::string Trim(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n"), b = s.find_last_not_of(" \t\r\n");
+    return a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+}
+
+static std::wstring Widen(const std::string& s) { return std::wstring(s.begin(), s.end()); }   // image names, ladder lines: ASCII
+
+// One "Key = Value" per line, '#' comments. HeavyApps is comma-separated; AppRule and ProfileLevel may
+// repeat.
+// The *Filter keys take a filter spec (see SignalFilter.h), e.g. CpuFilter = median:3+ewma:800/4500.
+// RuntimeTarget takes a battery runtime target (see BatteryRuntime.h), e.g. 3h or until 18:00.
+// Clamps match the tray's LoadConfig.
+static bool LoadConfigFile(const char* path, DaemonConfig& c) {
+    FILE* f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "%s: can't open\n", path); return false; }
+    char buf[512];
+    for (int lineNo = 1; fgets(buf, sizeof(buf), f); ++lineNo) {
+        std::string line = Trim(buf);
+        if (line.empty() || line[0] == '#') continue;
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) { fprintf(stderr, "%s:%d: expected Key = Value\n", path, lineNo); continue; }
+        const std::string key = Trim(line.substr(0, eq)), val = Trim(line.substr(eq + 1));
+        const unsigned long v = strtoul(val.c_str(), nullptr, 10);
+        if (key == "BattThreshold")             c.loop.gov.battThreshold = (int)ClampU32(v, 0, 100);
+        else if (key == "LockDownshift")        c.loop.gov.lockDownshift = v != 0;
+        else if (key == "StickyBoostMs")        c.loop.gov.stickyBoostMs = ClampU32(v, 5'000, 300'000);
+        else if (key == "ResidencyBalancedMs")  c.loop.gov.residencyBalancedMs = ClampU32(v, 10'000, 600'000);
+        else if (key == "ResidencySaverMs")     c.loop.gov.residencySaverMs = ClampU32(v, 10'000, 600'000);
+        else if (key == "ActiveCpuPct")         c.loop.gov.activeCpuPct = ClampU32(v, 1, 100);
+        else if (key == "EngagedCpuPct")        c.loop.gov.engagedCpuPct = ClampU32(v, 1, 100);
+        else if (key == "ActiveMaxCorePct")     c.loop.gov.activeMaxCorePct = ClampU32(v, 0, 100);
+        else if (key == "ActiveTopKPct")        c.loop.gov.activeTopKPct = ClampU32(v, 0, 100);
+        else if (key == "EngagedMaxCorePct")    c.loop.gov.engagedMaxCorePct = ClampU32(v, 0, 100);
+        else if (key == "CpuTopK")              c.loop.cpuTopK = ClampU32(v, 1, 64);
+        else if (key == "BgScanMs")             c.loop.bgScanMs = v ? ClampU32(v, 1'000, 60'000) : 0;
+        else if (key == "BgHeavyMinCorePct")    c.loop.bgHeavyMinCorePct = ClampU32(v, 1, 100);
+        else if (key == "BgBusyCorePct")        c.loop.bgBusyCorePct = ClampU32(v, 0, 6400);
+        else if (key == "ProcessQos")           c.loop.processQos = v != 0;
+        else if (key == "QosThrottleCorePct")   c.loop.qosThrottleCorePct = ClampU32(v, 5, 6400);
+        else if (key == "LadderTargetUtilPct")  c.loop.ladderTargetUtilPct = ClampU32(v, 10, 95);
+        else if (key == "LadderDownMsPerLevel") c.loop.ladderDownMsPerLevel = ClampU32(v, 0, 60'000);
+        else if (key == "ThermalCap")           c.loop.thermalCap = v != 0;
+        else if (key == "ThermalSoftC")         c.loop.thermalSoftC = ClampU32(v, 50, 105);
+        else if (key == "PackageLimitW")        c.loop.packageLimitW = ClampU32(v, 0, 500);
+        else if (key == "TelemetryRecords")     c.telemetryRecords = ClampU32(v, 0, 1u << 24);
+        else if (key == "CpuHysteresisPct")     c.loop.gov.cpuHysteresisPct = ClampU32(v, 0, 50);
+        else if (key == "BattHysteresisPct")    c.loop.gov.battHysteresisPct = (int)ClampU32(v, 0, 20);
+        else if (key == "RuntimeReservePct")    c.loop.runtimeReservePct = ClampU32(v, 0, 50);
+        else if (key == "InputBoost")           c.inputBoost = v != 0;
+        else if (key == "InputDebounceMs")      c.input.debounceMs = ClampU32(v, 0, 5'000);
+        else if (key == "PerfClassify")         c.loop.perfClassify = v != 0;
+        else if (key == "MemoryBoundMaxPct")    c.loop.memoryBoundMaxPct = ClampU32(v, 50, 100);
+        else if (key == "RuntimeTarget") {
+            if (!ParseRuntimeTarget(val.c_str(), c.loop.runtimeTarget)) fprintf(stderr, "%s:%d: bad RuntimeTarget\n", path, lineNo);
+        }
+        else if (key == "CpuFilter" || key == "IdleFilter" || key == "BattFilter") {
+            FilterSpec& spec = key == "CpuFilter" ? c.loop.gov.cpuFilter : key == "IdleFilter" ? c.loop.gov.idleFilter : c.loop.gov.battFilter;
+            if (!ParseFilterSpec(val.c_str(), spec)) fprintf(stderr, "%s:%d: bad %s\n", path, lineNo, key.c_str());
+        }
+        else if (key == "HeavyApps") {            // plain names: one Boost rule each
+            std::string lines = val;
+            std::replace(lines.begin(), lines.end(), ',', '\n');
+            c.appRules += Widen(lines) + L"\n";
+        }
+        else if (key == "AppRule") {
+            AppRule r;
+            if (ParseAppRule(Widen(val), r)) c.appRules += Widen(val) + L"\n";
+            else fprintf(stderr, "%s:%d: bad AppRule\n", path, lineNo);
+        }
+        else if (key == "ProfileLevel") {
+            ProfileLevel l;
+            if (ParseProfileLevel(Widen(val), l)) c.ladder.Merge(l);
+            else fprintf(stderr, "%s:%d: bad ProfileLevel\n", path, lineNo);
+        }
+        else fprintf(stderr, "%s:%d: unknown key %s\n", path, lineNo, key.c_str());
+    }
+    fclose(f);
+    return true;
+}
+
+// ---------- Control replies ----------
+// Flat JSON objects. Values are numbers, booleans and the engine's fixed names, so nothing needs escaping.
+class JsonLine {
+public:
+    JsonLine& Str(const char* k, const char* v) { Key(k); s += '"'; s += v; s += '"'; return *this; }
+    JsonLine& Bool(const char* k, bool v) { Key(k); s += v ? "true" : "false"; return *this; }
+    JsonLine& Null(const char* k) { Key(k); s += "null"; return *this; }
+    JsonLine& Int(const char* k, long long v) { Key(k); s += std::to_string(v); return *this; }
+    JsonLine& Num(const char* k, double v, int decimals = 1) {
+        char b[32]; snprintf(b, sizeof(b), "%.*f", decimals, v);
+        Key(k); s += b; return *this;
+    }
+    JsonLine& Raw(const char* k, const std::string& json) { Key(k); s += json; return *this; }
+    std::string Done() const { return s + "}"; }
+private:
+    void Key(const char* k) { if (s.size() > 1) s += ','; s += '"'; s += k; s += "\":"; }
+    std::string s = "{";
+};
+
+static std::string ErrorReply(const char* what) { return JsonLine().Bool("ok", false).Str("error", what).Done(); }
+
+static bool ParseProfile(const std::string& s, ProcProfile& p) {
+    std::string l = s;
+    std::transform(l.begin(), l.end(), l.begin(), [](char ch) { return (char)tolower((unsigned char)ch); });
+    if (l == "boost") p = ProcProfile::Boost;
+    else if (l == "balanced") p = ProcProfile::Balanced;
+    else if (l == "saver") p = ProcProfile::Saver;
+    else return false;
+    return true;
+}
+
+static uint64_t MonoMs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t MonoUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t WallClockMs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static int LocalMinuteOfDay() {
+    const time_t t = time(nullptr);
+    struct tm lt;
+#ifdef _WIN32
+    if (localtime_s(&lt, &t)) return -1;
+#else
+    if (!localtime_r(&t, &lt)) return -1;
+#endif
+    return lt.tm_hour * 60 + lt.tm_min;
+}
+
+// ---------- Platform ----------
+struct Platform {
+#ifdef _WIN32
+    NtCoreTimesSource      coreTimes;
+    NtProcessTableSource   procTable;
+    Win32PowerBackend      power;
+    PdhThermalSource       thermal;
+    BatteryEnergySource    energy;
+    Win32ProcessQosControl qosControl;
+    const char*            backendName = "powrprof";
+#else
+    ProcStatCoreTimesSource coreTimes;
+    ProcfsProcessTableSource procTable;
+    SysfsPowerBackend      power;
+    SysfsThermalSource     thermal;
+    RaplEnergySource       energy;
+    PerfEventSource        perf;
+    LinuxProcessQosControl qosControl;
+    const char*            backendName = "sysfs";
+#endif
+
+    void ReadPowerSource(bool& onAC, int& battPct) {
+#ifdef _WIN32
+        SYSTEM_POWER_STATUS sps{};
+        if (!GetSystemPowerStatus(&sps)) return;
+        onAC = sps.ACLineStatus != 0;   // 255 (unknown): desktops, servers
+        battPct = sps.BatteryLifePercent == 255 ? -1 : (int)sps.BatteryLifePercent;
+#else
+        onAC = power.DetectOnAC();
+        battPct = power.DetectBatteryPct();
+#endif
+    }
+};
+
+#ifndef _WIN32
+// ---------- Input (evdev) ----------
+// A thread blocks on the input devices; each event goes through the gate, and a trigger wakes the
+// main loop (ControlServer::Interrupt) to tick at once. Event timestamps are CLOCK_MONOTONIC, the
+// steady_clock the loop runs on, so Daemon::Tick can time a step up from the event itself.
+class InputWatcher {
+public:
+    ~InputWatcher() { Stop(); }
+
+    bool Start(const InputBoostConfig& c, ControlServer& server) {
+        gate.SetConfig(c);
+        wake = &server;
+        if (!src.Open()) return false;
+        thread = std::thread([this] { Run(); });
+        return true;
+    }
+    void Stop() {
+        { std::lock_guard<std::mutex> g(lock); stop = true; }
+        retry.notify_all();
+        src.Interrupt();
+        if (thread.joinable()) thread.join();
+    }
+
+    void     SetActive(bool a) { active = a; }                        // tier already Active: no trigger
+    uint64_t LastInputMs() const { return lastInputMs; }
+    bool     Pending() const { return triggerUs != 0; }
+    uint64_t TakeTrigger() { return triggerUs.exchange(0); }          // event time (us) of a pending trigger; 0 none
+    size_t   Devices() const { std::lock_guard<std::mutex> g(lock); return devices; }
+    bool     KernelStamps() const { std::lock_guard<std::mutex> g(lock); return kernelStamps; }
+    InputBoostGate::Stats GateStats() const { std::lock_guard<std::mutex> g(lock); return gate.GetStats(); }
+
+private:
+    void Run() {
+        std::vector<EvdevInputSource::Event> events;
+        std::unique_lock<std::mutex> g(lock);
+        while (!stop) {
+            devices = src.Devices();
+            kernelStamps = src.KernelStamps();
+            if (!devices) {                                           // all unplugged: look again later
+                retry.wait_for(g, std::chrono::seconds(30), [this] { return stop; });
+                if (!stop) src.Open();
+                continue;
+            }
+            g.unlock();
+            events.clear();
+            const bool woken = !src.Wait(30'000, events);
+            g.lock();
+            if (woken) continue;
+            if (events.empty()) { src.Open(); continue; }             // quiet: pick up hotplugged devices
+            for (const EvdevInputSource::Event& e : events) {
+                lastInputMs = e.us / 1000;
+                if (gate.OnInput(e.us / 1000, e.kind, active)) {
+                    uint64_t none = 0;
+                    triggerUs.compare_exchange_strong(none, e.us);   // the earliest pending one counts
+                    wake->Interrupt();
+                }
+            }
+        }
+    }
+
+    EvdevInputSource        src;
+    InputBoostGate          gate;                                     // guarded by lock
+    ControlServer*          wake = nullptr;
+    std::thread             thread;
+    mutable std::mutex      lock;
+    std::condition_variable retry;
+    bool                    stop = false;
+    size_t                  devices = 0;
+    bool                    kernelStamps = false;
+    std::atomic<bool>       active{ false };
+    std::atomic<uint64_t>   lastInputMs{ 0 };
+    std::atomic<uint64_t>   triggerUs{ 0 };
+};
+#endif
+
+// ---------- Daemon ----------
+class Daemon {
+public:
+    Daemon(const DaemonConfig& cfg, Platform& plat, IPowerBackend& backend)
+        : cfg(cfg), plat(plat), loop(plat.coreTimes, plat.procTable, plat.qosControl, plat.thermal, backend) {}
+
+    void Init(const std::string& telemetryPath, const std::string& energyPath);
+    uint32_t Tick();                                   // returns the delay until the next tick
+    void Handle(ControlServer& server, const ControlRequest& r, bool& kick);
+    void Shutdown();
+    bool InputTriggered() const;                       // an input event asked for a tick now
+
+    uint64_t startedMs = 0;                            // main() entry, MonoMs
+    double   readyMs = -1.0;                           // main() -> first tick done and channel open
+    double   processReadyMs = -1.0;                    // process creation -> the same point
+    ControlServer* events = nullptr;
+
+private:
+    std::string State(uint64_t nowMs) const;
+    std::string Stats() const;
+    std::string Energy() const;
+    std::string Runtime() const;
+    void SaveEnergy() const;
+    void Transition();
+
+    const DaemonConfig& cfg;
+    Platform&           plat;
+    GovernorLoop        loop;
+    GovernorLoopInputs  inputs;
+    uint32_t            delay = 0;
+    std::string         energyPath;                    // ledger kept across runs, if set
+#ifndef _WIN32
+    std::unique_ptr<InputWatcher> input;               // with InputBoost = 1 and a readable device
+#endif
+    LatencyHistogram    inputLatency;                  // input event -> end of the step up it triggered
+};
+
+void Daemon::Init(const std::string& telemetryPath, const std::string& energyFile) {
+    loop.SetConfig(cfg.loop);
+    loop.SetLadder(cfg.ladder);
+    AppRules rules;
+    rules.Parse(cfg.appRules);
+    loop.SetAppRules(rules);
+    CpuTopology topo;
+#ifdef _WIN32
+    const bool haveTopo = ReadCpuTopology(topo);
+    loop.SetSelfPid(GetCurrentProcessId());
+#else
+    const bool haveTopo = ReadSysfsCpuTopology("/sys", topo);
+    if (haveTopo) plat.power.SetTopology(topo);
+    loop.SetSelfPid((uint32_t)getpid());
+#endif
+    if (haveTopo) loop.SetTopology(topo);
+    if (!telemetryPath.empty() && cfg.telemetryRecords) {
+#ifdef _WIN32
+        std::wstring w(telemetryPath.size() + 1, L'\0');
+        w.resize(MultiByteToWideChar(CP_ACP, 0, telemetryPath.c_str(), -1, &w[0], (int)w.size()));
+        const bool ok = !w.empty() && loop.Telemetry().Open(w.c_str(), cfg.telemetryRecords);
+#else
+        const bool ok = loop.Telemetry().Open(telemetryPath.c_str(), cfg.telemetryRecords);
+#endif
+        if (!ok) fprintf(stderr, "%s: can't map the telemetry ring\n", telemetryPath.c_str());
+    }
+    loop.SetEnergySource(&plat.energy);
+    energyPath = energyFile;
+    if (!energyPath.empty()) if (FILE* f = fopen(energyPath.c_str(), "rb")) {
+        if (!loop.Energy().Load(f)) fprintf(stderr, "%s: not an energy ledger, starting empty\n", energyPath.c_str());
+        fclose(f);
+    }
+    fprintf(stderr, "topology: %s, %d class(es)\n", topo.source, topo.classes);
+#ifndef _WIN32
+    if (cfg.loop.perfClassify) {   // set even when the open fails: the source retries once a minute
+        if (plat.perf.Open())
+            fprintf(stderr, "perf: %zu cpu(s), %s\n", plat.perf.Cpus(), plat.perf.HaveMisses() ? "LLC misses"
+                    : plat.perf.HaveStalls() ? "backend stalls" : "no memory event (never memory-bound)");
+        else fprintf(stderr, "perf: no hardware counters (%s); memory-bound load boosts like any other\n", strerror(plat.perf.Error()));
+        loop.SetPerfSource(&plat.perf);
+    }
+#endif
+    if (cfg.inputBoost && events) {
+#ifndef _WIN32
+        input.reset(new InputWatcher);
+        if (input->Start(cfg.input, *events)) fprintf(stderr, "input: %zu device(s)\n", input->Devices());
+        else {
+            fprintf(stderr, "input: no readable keyboard or pointer under /dev/input (root or the input group)\n");
+            input.reset();
+        }
+#else
+        fprintf(stderr, "input: InputBoost is Linux only here; the tray app uses Raw Input\n");
+#endif
+    }
+}
+
+void Daemon::Shutdown() {
+#ifndef _WIN32
+    input.reset();
+#endif
+    loop.RestoreAll();
+    loop.Telemetry().Close();
+    SaveEnergy();
+}
+
+bool Daemon::InputTriggered() const {
+#ifndef _WIN32
+    return input && input->Pending();
+#else
+    return false;
+#endif
+}
+
+uint32_t Daemon::Tick() {
+    plat.ReadPowerSource(inputs.onAC, inputs.battPct);
+    inputs.minuteOfDay = LocalMinuteOfDay();
+    const uint64_t now = MonoMs();
+    uint64_t triggerUs = 0;
+#ifndef _WIN32
+    if (input) {
+        const uint64_t last = input->LastInputMs();
+        inputs.idleSec = last ? (uint32_t)std::min<uint64_t>(UINT32_MAX - 1, (now > last ? now - last : 0) / 1000) : UINT32_MAX;
+        triggerUs = input->TakeTrigger();
+    }
+#endif
+    const uint64_t failures = loop.GetStats().commitFailures;
+    delay = loop.Tick(now, inputs, WallClockMs());
+    if (!failures && loop.GetStats().commitFailures)
+        fprintf(stderr, "power settings not applied (permissions?); retrying each tick\n");
+    // The write is synchronous: the tick's end is when the step up is applied.
+    if (triggerUs && loop.Transitioned() && (int)loop.Applied() < (int)loop.PrevApplied()) {
+        const uint64_t doneUs = MonoUs();
+        inputLatency.Record(doneUs > triggerUs ? doneUs - triggerUs : 0);
+    }
+#ifndef _WIN32
+    if (input) input->SetActive(loop.Gov().Tier() == ActivityTier::Active);
+#endif
+    if (loop.Transitioned()) Transition();
+    return delay;
+}
+
+void Daemon::Transition() {
+    if (!events || !events->Watchers()) return;
+    const Governor& gov = loop.Gov();
+    JsonLine j;
+    j.Str("event", "transition").Int("wallMs", (long long)WallClockMs())
+     .Str("from", ProfileNameA(loop.PrevApplied())).Str("to", ProfileNameA(loop.Applied()))
+     .Str("fromTier", TierNameA(loop.PrevTier())).Str("tier", TierNameA(gov.Tier()))
+     .Str("tierReason", TierReasonNameA(gov.LastTierReason())).Str("profileReason", ProfileReasonNameA(gov.LastProfileReason()))
+     .Bool("pinned", loop.Pinned()).Num("cpu", gov.CpuEWMA()).Num("topK", gov.TopKEWMA());
+    events->Broadcast(j.Done());
+}
+
+std::string Daemon::State(uint64_t nowMs) const {
+    const Governor& gov = loop.Gov();
+    const LadderSetpoint& sp = loop.Setpoint();
+    JsonLine j;
+    j.Bool("ok", true).Str("profile", ProfileNameA(loop.Applied())).Str("governor", ProfileNameA(gov.Profile()))
+     .Str("tier", TierNameA(gov.Tier())).Str("tierReason", TierReasonNameA(gov.LastTierReason()))
+     .Str("profileReason", ProfileReasonNameA(gov.LastProfileReason()));
+    if (loop.Pinned()) {
+        const uint64_t until = loop.PinUntilMs();
+        j.Str("pinned", ProfileNameA(loop.PinProfile()));
+        if (until) j.Int("pinRemainingSec", (long long)((until > nowMs ? until - nowMs : 0) + 999) / 1000);
+        else j.Null("pinRemainingSec");
+    }
+    else j.Null("pinned");
+    j.Num("cpu", gov.CpuEWMA()).Num("maxCore", gov.MaxCoreEWMA()).Num("topK", gov.TopKEWMA())
+     .Num("ladderPos", loop.Ladder().Size() ? loop.LadderCtl().Position() : 0.0)
+     .Int("maxProcAC", sp.maxAC).Int("boostAC", sp.boostAC)
+     .Int("thermalLevel", loop.Thermal().Level()).Num("tempC", loop.ThermalReading().tempC)
+     .Str("workload", WorkloadPhaseNameA(loop.Workload().Phase())).Bool("memoryCapped", gov.MemoryCapped())
+     .Bool("onAC", inputs.onAC).Int("battPct", inputs.battPct).Int("nextTickMs", delay);
+    if (loop.Runtime().Active()) j.Str("runtimeCeiling", ProfileNameA(loop.Runtime().Ceiling()));
+    else j.Null("runtimeCeiling");
+    const WorkloadMetrics& wm = loop.Workload().Metrics();
+    if (wm.gCyclesPerSec > 0) j.Num("ipc", wm.ipc, 2); else j.Null("ipc");
+    if (wm.mpki >= 0) j.Num("mpki", wm.mpki, 1); else j.Null("mpki");
+    const CpuTopology& topo = loop.Topology();
+    if (topo.Hybrid()) j.Num("pCoresPct", loop.Load().classAggregate[topo.classes - 1]).Num("eCoresPct", loop.Load().classAggregate[0]);
+    return j.Done();
+}
+
+std::string Daemon::Stats() const {
+    ProcessFootprint fp;
+    ReadProcessFootprint(fp);
+    const ProcessQosEngine::Stats& q = loop.Qos().GetStats();
+    const GovernorLoop::Stats& st = loop.GetStats();
+    const double hours = (MonoMs() - startedMs) / 3'600'000.0;
+    JsonLine j;
+    j.Bool("ok", true).Int("uptimeSec", (long long)((MonoMs() - startedMs) / 1000))
+     .Num("startupMs", readyMs).Num("processStartupMs", processReadyMs)
+     .Int("rssKB", (long long)fp.rssKB).Int("peakRssKB", (long long)fp.peakRssKB).Int("privateKB", (long long)fp.privateKB)
+     .Num("cpuMs", fp.cpuMs).Num("cpuMsPerHour", hours > 0 ? fp.cpuMs / hours : 0.0)
+     .Int("ticks", (long long)st.ticks).Int("wakeups", (long long)loop.Scheduler().Wakeups())
+     .Num("wakeupsPerHour", hours > 0 ? loop.Scheduler().Wakeups() / hours : 0.0).Int("transitions", (long long)st.transitions)
+     .Int("commits", (long long)st.commits).Int("commitFailures", (long long)st.commitFailures)
+     .Int("qosEco", q.eco).Int("qosHigh", q.high).Int("telemetry", (long long)loop.Telemetry().Appended())
+     .Str("backend", plat.backendName)
+     .Int("clients", events ? (long long)events->Clients() : 0);
+#ifndef _WIN32
+    if (input) {
+        const InputBoostGate::Stats in = input->GateStats();
+        const LatencyHistogram& h = inputLatency;
+        JsonLine lat;
+        lat.Int("n", (long long)h.Count()).Num("p50Ms", h.Percentile(0.50) / 1000.0, 2).Num("p90Ms", h.Percentile(0.90) / 1000.0, 2)
+           .Num("p99Ms", h.Percentile(0.99) / 1000.0, 2).Num("maxMs", h.Max() / 1000.0, 2);
+        j.Raw("input", JsonLine().Int("devices", (long long)input->Devices()).Bool("kernelStamps", input->KernelStamps())
+            .Int("events", (long long)in.events).Int("triggers", (long long)in.triggers).Int("debounced", (long long)in.debounced)
+            .Int("absorbed", (long long)in.absorbed).Raw("latency", lat.Done()).Done());
+        return j.Done();
+    }
+#endif
+    j.Null("input");
+    return j.Done();
+}
+
+// App names become JSON strings: keep the characters image names use, nothing that needs escaping.
+static std::string JsonSafe(const wchar_t* w) {
+    std::string s;
+    for (; *w; ++w) s += (*w < 0x80 && (isalnum((int)*w) || strchr("._-+() ", (int)*w))) ? (char)*w : '_';
+    return s.empty() ? "(none)" : s;
+}
+
+std::string Daemon::Energy() const {
+    const EnergyLedger& l = loop.Energy();
+    JsonLine j;
+    j.Bool("ok", true).Str("meter", loop.EnergySourceName()).Num("totalWh", l.MeteredWh(), 3);
+    uint64_t meteredMs = 0, unmeteredMs = 0;
+    for (ProcProfile p : { ProcProfile::Boost, ProcProfile::Balanced, ProcProfile::Saver }) {
+        const EnergyLedger::Counter c = l.Profile(p);
+        std::string key = ProfileNameA(p);
+        key[0] = (char)tolower((unsigned char)key[0]);   // "boostWh"
+        j.Num((key + "Wh").c_str(), c.Wh(), 3);
+        meteredMs += c.ms;
+        unmeteredMs += l.UnmeteredMs(p);
+    }
+    j.Num("meteredHours", meteredMs / 3'600'000.0, 2).Num("unmeteredHours", unmeteredMs / 3'600'000.0, 2);
+    double boostWh;
+    if (l.AlwaysBoostWh(boostWh)) j.Num("alwaysBoostWh", boostWh, 3).Num("savedWh", boostWh - l.MeteredWh(), 3);
+    else j.Null("alwaysBoostWh").Null("savedWh");
+
+    // The ten apps that cost the most.
+    std::vector<size_t> order;
+    for (size_t i = 0; i < l.Apps(); ++i) if (l.AppAt(i).Total().ms) order.push_back(i);
+    std::sort(order.begin(), order.end(), [&l](size_t a, size_t b) { return l.AppAt(a).Total().mJ > l.AppAt(b).Total().mJ; });
+    if (order.size() > 10) order.resize(10);
+    std::string apps = "[";
+    for (size_t i : order) {
+        const EnergyLedger::App& a = l.AppAt(i);
+        const EnergyLedger::Counter c = a.Total();
+        if (apps.size() > 1) apps += ',';
+        apps += JsonLine().Str("app", JsonSafe(a.name).c_str()).Num("wh", c.Wh(), 3).Num("hours", c.ms / 3'600'000.0, 2)
+            .Num("boostPct", c.mJ ? 100.0 * a.byProfile[(int)ProcProfile::Boost].mJ / c.mJ : 0.0).Done();
+    }
+    return j.Raw("apps", apps + "]").Done();
+}
+
+std::string Daemon::Runtime() const {
+    const RuntimeGovernor& rt = loop.Runtime();
+    char target[32];
+    FormatRuntimeTarget(loop.Config().runtimeTarget, target, sizeof(target));
+    JsonLine j;
+    j.Bool("ok", true).Str("target", target).Int("reservePct", (long long)loop.Config().runtimeReservePct)
+     .Bool("active", rt.Active());
+    if (rt.Active()) j.Str("ceiling", ProfileNameA(rt.Ceiling())).Num("hoursToTarget", rt.HoursToTarget(), 2);
+    else j.Null("ceiling").Null("hoursToTarget");
+    double left;
+    if (rt.Active() && rt.HoursLeft(left)) j.Num("hoursLeft", left, 2);
+    else j.Null("hoursLeft");
+    const DischargeEstimator& est = rt.Estimator();
+    if (est.Valid()) {
+        const uint64_t now = MonoMs();
+        j.Num("boostPctPerHour", est.RatePctPerHour(ProcProfile::Boost, now))
+         .Num("balancedPctPerHour", est.RatePctPerHour(ProcProfile::Balanced, now))
+         .Num("saverPctPerHour", est.RatePctPerHour(ProcProfile::Saver, now));
+    }
+    else j.Null("boostPctPerHour").Null("balancedPctPerHour").Null("saverPctPerHour");
+    return j.Int("samples", (long long)est.Samples()).Done();
+}
+
+void Daemon::SaveEnergy() const {
+    if (energyPath.empty()) return;
+    FILE* f = fopen(energyPath.c_str(), "wb");
+    if (!f || !loop.Energy().Save(f)) fprintf(stderr, "%s: can't write the energy ledger\n", energyPath.c_str());
+    if (f) fclose(f);
+}
+
+void Daemon::Handle(ControlServer& server, const ControlRequest& r, bool& kick) {
+    std::vector<std::string> args;
+    for (size_t i = 0; i < r.line.size();) {
+        size_t j = r.line.find_first_of(" \t", i);
+        if (j == std::string::npos) j = r.line.size();
+        if (j > i) args.push_back(r.line.substr(i, j - i));
+        i = j + 1;
+    }
+    if (args.empty()) return;
+    const std::string& cmd = args[0];
+    const uint64_t now = MonoMs();
+    if (cmd == "state") server.Reply(r.client, State(now));
+    else if (cmd == "stats") server.Reply(r.client, Stats());
+    else if (cmd == "energy") {
+        if (args.size() == 2 && args[1] == "reset") loop.Energy().Clear();
+        else if (args.size() != 1) { server.Reply(r.client, ErrorReply("usage: energy [reset]")); return; }
+        server.Reply(r.client, Energy());
+    }
+    else if (cmd == "target") {
+        if (args.size() > 1) {
+            std::string text = args[1];
+            for (size_t i = 2; i < args.size(); ++i) text += " " + args[i];
+            GovernorLoopConfig c = loop.Config();
+            if (!ParseRuntimeTarget(text.c_str(), c.runtimeTarget)) { server.Reply(r.client, ErrorReply("usage: target [off|DURATION|until HH:MM]")); return; }
+            loop.SetConfig(c);
+            kick = true;
+        }
+        server.Reply(r.client, Runtime());
+    }
+    else if (cmd == "pin") {
+        ProcProfile p;
+        if (args.size() < 2 || args.size() > 3 || !ParseProfile(args[1], p)) { server.Reply(r.client, ErrorReply("usage: pin boost|balanced|saver [SECONDS]")); return; }
+        const unsigned long sec = std::min(args.size() == 3 ? strtoul(args[2].c_str(), nullptr, 10) : 0ul, 7ul * 24 * 3600);
+        loop.Pin(p, sec ? now + (uint64_t)sec * 1000 : 0);
+        kick = true;   // apply now, not at the next scheduled tick
+        JsonLine j;
+        j.Bool("ok", true).Str("pinned", ProfileNameA(p));
+        if (sec) j.Int("seconds", (long long)sec); else j.Null("seconds");
+        server.Reply(r.client, j.Done());
+    }
+    else if (cmd == "unpin") {
+        kick = loop.Pinned();
+        loop.Unpin();
+        server.Reply(r.client, JsonLine().Bool("ok", true).Null("pinned").Done());
+    }
+    else if (cmd == "watch" || cmd == "unwatch") {
+        server.SetWatching(r.client, cmd == "watch");
+        server.Reply(r.client, JsonLine().Bool("ok", true).Bool("watching", cmd == "watch").Done());
+    }
+    else server.Reply(r.client, ErrorReply("commands: state, stats, energy, target, pin, unpin, watch, unwatch"));
+}
+
+// ---------- Process ----------
+static std::atomic<bool> g_stop{ false };
+static ControlServer*    g_server = nullptr;
+
+#ifdef _WIN32
+static HANDLE g_exited = nullptr;
+
+static BOOL WINAPI ConsoleCtrl(DWORD) {
+    g_stop = true;
+    if (g_server) g_server->Interrupt();
+    // Close / logoff / shutdown end the process when this returns: let the loop restore QoS first.
+    if (g_exited) WaitForSingleObject(g_exited, 5000);
+    return TRUE;
+}
+#else
+static void OnSignal(int) {
+    g_stop = true;
+    if (g_server) g_server->Interrupt();
+}
+#endif
+
+static int Send(const std::string& endpoint, const std::string& command) {
+    const bool watch = command.compare(0, 5, "watch") == 0;
+    bool failed = false;
+    const bool reached = ControlRequestLines(endpoint, command, [&](const std::string& line) {
+        printf("%s\n", line.c_str());
+        fflush(stdout);
+        failed = failed || line.find("\"ok\":false") != std::string::npos;
+        return watch;
+    });
+    if (!reached) { fprintf(stderr, "%s: no daemon listening\n", endpoint.c_str()); return 1; }
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    const uint64_t startedMs = MonoMs();
+    std::string configPath, endpoint = DefaultControlEndpoint(), telemetryPath, energyPath, send;
+    bool dryRun = false, haveSend = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--config") && i + 1 < argc) configPath = argv[++i];
+        else if (!strcmp(argv[i], "--endpoint") && i + 1 < argc) endpoint = argv[++i];
+        else if (!strcmp(argv[i], "--telemetry") && i + 1 < argc) telemetryPath = argv[++i];
+        else if (!strcmp(argv[i], "--energy") && i + 1 < argc) energyPath = argv[++i];
+        else if (!strcmp(argv[i], "--send") && i + 1 < argc) { send = argv[++i]; haveSend = true; }
+        else if (!strcmp(argv[i], "--dry-run")) dryRun = true;
+        else {
+            fprintf(stderr, "usage: AutoPowerDaemon [--config FILE] [--endpoint PATH] [--telemetry FILE] [--energy FILE] [--dry-run]\n"
+                            "       AutoPowerDaemon --send \"state|stats|energy [reset]|target [SPEC]|pin PROFILE [SECONDS]|unpin|watch\" [--endpoint PATH]\n");
+            return 2;
+        }
+    }
+    if (haveSend) return Send(endpoint, send);
+
+    DaemonConfig cfg;
+    if (!configPath.empty() && !LoadConfigFile(configPath.c_str(), cfg)) return 1;
+
+    ControlServer server;
+    if (!server.Open(endpoint)) { fprintf(stderr, "%s: can't listen (another daemon running?)\n", endpoint.c_str()); return 1; }
+    g_server = &server;
+#ifdef _WIN32
+    g_exited = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    SetConsoleCtrlHandler(ConsoleCtrl, TRUE);
+#else
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction sa {};
+    sa.sa_handler = OnSignal;   // no SA_RESTART: poll() returns EINTR
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+#endif
+
+    std::unique_ptr<Platform> plat(new Platform);
+    CountingPowerBackend dry;
+    std::unique_ptr<Daemon> d(new Daemon(cfg, *plat, dryRun ? (IPowerBackend&)dry : (IPowerBackend&)plat->power));
+    if (dryRun) plat->backendName = "dry-run";
+    d->events = &server;
+    d->startedMs = startedMs;
+    d->Init(telemetryPath, energyPath);
+
+    uint64_t nextTickMs = MonoMs() + d->Tick();
+    ProcessFootprint fp;
+    ReadProcessFootprint(fp);
+    d->readyMs = (double)(MonoMs() - startedMs);
+    d->processReadyMs = fp.sinceStartMs;
+    fprintf(stderr, "listening on %s (%s); ready %.0f ms after main, %.0f ms after process start; rss %llu KB\n",
+        server.Endpoint().c_str(), plat->backendName, d->readyMs, fp.sinceStartMs, (unsigned long long)fp.rssKB);
+
+    std::vector<ControlRequest> requests;
+    while (!g_stop) {
+        uint64_t now = MonoMs();
+        if (now >= nextTickMs) { nextTickMs = now + d->Tick(); now = MonoMs(); }
+        requests.clear();
+        if (!server.Wait((uint32_t)(nextTickMs > now ? nextTickMs - now : 0), requests)) break;
+        bool kick = false;
+        for (const ControlRequest& r : requests) d->Handle(server, r, kick);
+        if (kick || d->InputTriggered()) nextTickMs = MonoMs();
+    }
+
+    d->Shutdown();
+    g_server = nullptr;
+    server.Close();
+#ifdef _WIN32
+    SetEvent(g_exited);
+#endif
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Actuator.h
+// Latest-wins actuation off the message thread. The UI thread posts the desired state into a
+// lock-free single-slot mailbox (a triple buffer) and returns at once; a worker thread applies
+// whatever is newest. A request superseded before the worker got to it is dropped, never queued.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Single producer, single consumer. Post never blocks or fails; Take returns the newest unread value.
+template <typename T>
+class LatestMailbox {
+public:
+    // Returns true if it replaced a value the consumer had not taken yet.
+    bool Post(const T& v) {
+        slots[back] = v;
+        uint8_t prev = middle.exchange((uint8_t)(back | kFresh), std::memory_order_acq_rel);
+        back = prev & kIndex;
+        return (prev & kFresh) != 0;
+    }
+
+    bool Take(T& out) {
+        if (!(middle.load(std::memory_order_acquire) & kFresh)) return false;
+        uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & kIndex;
+        out = slots[front];
+        return true;
+    }
+
+    bool Pending() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+
+private:
+    static constexpr uint8_t kIndex = 3;
+    static constexpr uint8_t kFresh = 4;
+
+    T                    slots[3]{};
+    uint8_t              back = 0;      // producer-owned
+    uint8_t              front = 1;     // consumer-owned
+    std::atomic<uint8_t> middle{ 2 };   // shared: index | kFresh
+};
+
+// Worker that applies the newest posted value. handler runs on the worker thread only.
+template <typename T>
+class LatestWinsWorker {
+public:
+    struct Stats {
+        uint64_t posted = 0;
+        uint64_t applied = 0;
+        uint64_t superseded = 0;   // posted, then replaced before the worker took it
+    };
+
+    explicit LatestWinsWorker(std::function<void(const T&)> handler) : handler(std::move(handler)) {}
+    ~LatestWinsWorker() { Stop(); }
+    LatestWinsWorker(const LatestWinsWorker&) = delete;
+    LatestWinsWorker& operator=(const LatestWinsWorker&) = delete;
+
+    void Start() {
+        if (thread.joinable()) return;
+        stop = false;
+        thread = std::thread([this] { Run(); });
+    }
+
+    // Finishes the value being applied; a pending one is dropped.
+    void Stop() {
+        if (!thread.joinable()) return;
+        { std::lock_guard<std::mutex> g(wakeLock); stop = true; }
+        wake.notify_one();
+        thread.join();
+    }
+
+    // Producer side. The lock only covers the sleep/wake handshake, never the handler.
+    void Post(const T& v) {
+        posted.fetch_add(1, std::memory_order_relaxed);
+        if (box.Post(v)) superseded.fetch_add(1, std::memory_order_relaxed);
+        { std::lock_guard<std::mutex> g(wakeLock); signaled = true; }
+        wake.notify_one();
+    }
+
+    // A value is waiting or being applied.
+    bool Busy() const { return box.Pending() || applying.load(std::memory_order_acquire); }
+
+    Stats GetStats() const {
+        Stats s;
+        s.posted = posted.load(std::memory_order_relaxed);
+        s.applied = applied.load(std::memory_order_relaxed);
+        s.superseded = superseded.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    void Run() {
+        T v;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> g(wakeLock);
+                wake.wait(g, [this] { return stop || signaled; });
+                if (stop) return;
+                signaled = false;
+            }
+            applying.store(true, std::memory_order_release);
+            while (box.Take(v)) {
+                handler(v);
+                applied.fetch_add(1, std::memory_order_relaxed);
+            }
+            applying.store(false, std::memory_order_release);
+        }
+    }
+
+    std::function<void(const T&)> handler;
+    LatestMailbox<T>               box;
+    std::thread                    thread;
+    std::mutex                     wakeLock;
+    std::condition_variable        wake;
+    bool                           signaled = false;
+    bool                           stop = false;
+    std::atomic<bool>              applying{ false };
+    std::atomic<uint64_t>          posted{ 0 };
+    std::atomic<uint64_t>          applied{ 0 };
+    std::atomic<uint64_t>          superseded{ 0 };
+};
@@ -0,0 +1,283 @@
+// AppRules.cpp
+
+#include "AppRules.h"
+#include "ProfileLadder.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <cwctype>
+
+static wchar_t Fold(wchar_t c) { return c == L'/' ? L'\\' : (wchar_t)towlower(c); }
+
+static bool HasWildcard(const std::wstring& s) { return s.find_first_of(L"*?") != std::wstring::npos; }
+
+// ---------- Parsing ----------
+static bool ParsePct(const std::wstring& v, int lo, int hi, int& out) {
+    if (v.empty() || v.size() > 3) return false;
+    int n = 0;
+    for (wchar_t c : v) { if (c < L'0' || c > L'9') return false; n = n * 10 + (c - L'0'); }
+    if (n < lo || n > hi) return false;
+    out = n;
+    return true;
+}
+
+bool ParseAppRule(const std::wstring& line, AppRule& out) {
+    AppRule r;
+    size_t i = 0;
+    auto skipSpace = [&]() { while (i < line.size() && iswspace(line[i])) ++i; };
+    auto token = [&]() {
+        const size_t start = i;
+        while (i < line.size() && !iswspace(line[i])) ++i;
+        return line.substr(start, i - start);
+    };
+
+    // Pattern: quoted (may hold spaces) or up to the first blank.
+    skipSpace();
+    std::wstring pat;
+    if (i < line.size() && line[i] == L'"') {
+        const size_t close = line.find(L'"', i + 1);
+        if (close == std::wstring::npos) return false;
+        pat = line.substr(i + 1, close - i - 1);
+        i = close + 1;
+    }
+    else pat = token();
+    for (wchar_t& c : pat) c = Fold(c);
+    if (pat.empty()) return false;
+    if (pat.find(L'\\') != std::wstring::npos) {
+        if (pat.back() == L'\\') pat += L'*';                // a folder: everything below it
+    }
+    else if (pat.size() > 4 && pat.compare(pat.size() - 4, 4, L".exe") == 0) pat.resize(pat.size() - 4);
+    r.pattern = pat;
+
+    // Actions and conditions, in any order.
+    for (skipSpace(); i < line.size(); skipSpace()) {
+        std::wstring t = token();
+        std::transform(t.begin(), t.end(), t.begin(), ::towlower);
+        int v = 0;
+        if (t == L"->" || t == L"\u2192") continue;
+        if (t == L"boost")                                               r.profile = ProcProfile::Boost;
+        else if (t == L"balanced")                                       r.profile = ProcProfile::Balanced;
+        else if (t == L"saver")                                          r.profile = ProcProfile::Saver;
+        else if (t == L"ac")                                             r.when = kRuleOnAC;
+        else if (t == L"dc")                                             r.when = kRuleOnDC;
+        else if (t == L"park=off")                                       r.parkPct = 100;   // no parking
+        else if (!t.compare(0, 4, L"max=") && ParsePct(t.substr(4), 1, 100, v))  r.maxProcPct = (uint8_t)v;
+        else if (!t.compare(0, 5, L"park=") && ParsePct(t.substr(5), 0, 100, v)) r.parkPct = (int16_t)v;
+        else return false;
+    }
+    out = r;
+    return true;
+}
+
+// ---------- Glob automaton ----------
+static bool TestBit(const uint64_t* set, size_t i) { return (set[i >> 6] >> (i & 63)) & 1; }
+static void SetBit(uint64_t* set, size_t i) { set[i >> 6] |= 1ull << (i & 63); }
+
+void GlobAutomaton::Clear() {
+    nfa.clear();
+    starts.clear();
+    patterns = 0;
+    classes = 1;
+    std::fill(std::begin(ascii), std::end(ascii), (uint16_t)0);
+    wide.clear();
+    words = 0;
+    dfa.clear();
+}
+
+uint16_t GlobAutomaton::ClassOf(wchar_t c) const {
+    if ((uint32_t)c < 128) return ascii[c];
+    auto it = std::lower_bound(wide.begin(), wide.end(), std::make_pair(c, (uint16_t)0));
+    return it != wide.end() && it->first == c ? it->second : 0;
+}
+
+void GlobAutomaton::Add(const std::wstring& pattern, int16_t rule, uint8_t when) {
+    starts.push_back((uint32_t)nfa.size());
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const wchar_t c = Fold(pattern[i]);
+        if (c == L'*') {
+            if (nfa.size() > starts.back() && nfa.back().kind == Star) continue;   // "**" == "*"
+            nfa.push_back({ Star, 0, -1, 0 });
+        }
+        else if (c == L'?') nfa.push_back({ AnyChar, 0, -1, 0 });
+        else {
+            uint16_t cls = ClassOf(c);
+            if (!cls) {
+                cls = classes++;
+                if ((uint32_t)c < 128) ascii[c] = cls;
+                else wide.insert(std::lower_bound(wide.begin(), wide.end(), std::make_pair(c, (uint16_t)0)), std::make_pair(c, cls));
+            }
+            nfa.push_back({ Literal, cls, -1, 0 });
+        }
+    }
+    nfa.push_back({ End, 0, rule, when });
+    ++patterns;
+    words = (nfa.size() + 63) / 64;
+    dfa.clear();                                      // rebuilt by the next Match
+}
+
+// A '*' may also match nothing: whoever reaches it reaches the next position too.
+void GlobAutomaton::Close(uint64_t* set) const {
+    for (size_t i = 0; i < nfa.size(); ++i)
+        if (nfa[i].kind == Star && TestBit(set, i)) SetBit(set, i + 1);
+}
+
+int32_t GlobAutomaton::Intern(const uint64_t* set) const {
+    std::string key((const char*)set, words * sizeof(uint64_t));
+    auto it = index.find(key);
+    if (it != index.end()) return it->second;
+
+    DfaState d;
+    d.bits = setBits.size();
+    d.best[0] = d.best[1] = -1;
+    for (size_t i = 0; i < nfa.size(); ++i) {
+        if (nfa[i].kind != End || !TestBit(set, i)) continue;
+        for (int ac = 0; ac < 2; ++ac)
+            if ((nfa[i].when & (ac ? kRuleOnAC : kRuleOnDC)) && (d.best[ac] < 0 || nfa[i].rule < d.best[ac])) d.best[ac] = nfa[i].rule;
+    }
+    const int32_t id = (int32_t)dfa.size();
+    dfa.push_back(d);
+    setBits.insert(setBits.end(), set, set + words);
+    trans.resize(trans.size() + classes, -1);
+    index.emplace(std::move(key), id);
+    return id;
+}
+
+void GlobAutomaton::Restart() const {
+    dfa.clear();
+    setBits.clear();
+    trans.clear();
+    index.clear();
+    scratch.assign(words, 0);
+    Intern(scratch.data());                           // 0: dead
+    for (uint32_t s : starts) SetBit(scratch.data(), s);
+    Close(scratch.data());
+    Intern(scratch.data());                           // 1: start
+}
+
+int32_t GlobAutomaton::Step(int32_t from, uint16_t cls) const {
+    scratch.assign(words, 0);
+    const uint64_t* cur = &setBits[dfa[(size_t)from].bits];
+    for (size_t i = 0; i < nfa.size(); ++i) {
+        if (!TestBit(cur, i)) continue;
+        const Pos& p = nfa[i];
+        if (p.kind == Star) SetBit(scratch.data(), i);
+        else if (p.kind == AnyChar || (p.kind == Literal && p.cls == cls)) SetBit(scratch.data(), i + 1);
+    }
+    Close(scratch.data());
+    if (dfa.size() >= kMaxDfaStates) {                // pathological pattern mix: start over
+        std::vector<uint64_t> next = scratch;
+        Restart();
+        return Intern(next.data());
+    }
+    const int32_t to = Intern(scratch.data());
+    trans[(size_t)from * classes + cls] = to;
+    return to;
+}
+
+void GlobAutomaton::Match(const wchar_t* text, size_t len, int16_t best[2]) const {
+    if (!patterns) return;
+    if (dfa.empty()) Restart();
+    int32_t s = 1;
+    for (size_t i = 0; i < len && s; ++i) {
+        const uint16_t cls = ClassOf(Fold(text[i]));
+        const int32_t t = trans[(size_t)s * classes + cls];
+        s = t >= 0 ? t : Step(s, cls);
+    }
+    for (int ac = 0; ac < 2; ++ac)
+        if (dfa[(size_t)s].best[ac] >= 0 && (best[ac] < 0 || dfa[(size_t)s].best[ac] < best[ac])) best[ac] = dfa[(size_t)s].best[ac];
+}
+
+// ---------- Rule set ----------
+void AppRules::Clear() {
+    rules.clear();
+    exactNames.clear();
+    exactPaths.clear();
+    nameGlobs.Clear();
+    pathGlobs.Clear();
+}
+
+void AppRules::Add(const AppRule& r) {
+    const int16_t i = (int16_t)rules.size();
+    rules.push_back(r);
+    const bool path = r.pattern.find(L'\\') != std::wstring::npos;
+    if (HasWildcard(r.pattern)) { (path ? pathGlobs : nameGlobs).Add(r.pattern, i, r.when); return; }
+    AppMatch& m = (path ? exactPaths : exactNames)[r.pattern];
+    for (int ac = 0; ac < 2; ++ac)
+        if ((r.when & (ac ? kRuleOnAC : kRuleOnDC)) && m.rule[ac] < 0) m.rule[ac] = i;   // first rule wins
+}
+
+// A '#' at the start of the line or after a blank, outside the quoted pattern ("C:\My #Tools\").
+static size_t CommentStart(const std::wstring& line) {
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == L'"') quoted = !quoted;
+        else if (line[i] == L'#' && !quoted && (i == 0 || iswspace(line[i - 1]))) return i;
+    }
+    return std::wstring::npos;
+}
+
+int AppRules::Parse(const std::wstring& text) {
+    Clear();
+    int bad = 0;
+    for (size_t start = 0; start < text.size();) {
+        size_t end = text.find_first_of(L"\r\n", start);
+        if (end == std::wstring::npos) end = text.size();
+        std::wstring line = text.substr(start, end - start);
+        const size_t hash = CommentStart(line);
+        if (hash != std::wstring::npos) line.resize(hash);
+        if (line.find_first_not_of(L" \t") != std::wstring::npos) {
+            AppRule r;
+            if (ParseAppRule(line, r) && rules.size() < INT16_MAX) Add(r);
+            else ++bad;
+        }
+        start = end + 1;
+    }
+    return bad;
+}
+
+AppMatch AppRules::Match(const std::wstring& name, const std::wstring& path) const {
+    int16_t best[2] = { -1, -1 };
+    auto merge = [&best](const AppMatch& m) {
+        for (int ac = 0; ac < 2; ++ac)
+            if (m.rule[ac] >= 0 && (best[ac] < 0 || m.rule[ac] < best[ac])) best[ac] = m.rule[ac];
+    };
+    if (!name.empty()) {
+        auto it = exactNames.find(name);
+        if (it != exactNames.end()) merge(it->second);
+        nameGlobs.Match(name.data(), name.size(), best);
+    }
+    if (!path.empty()) {
+        std::wstring folded = path;
+        for (wchar_t& c : folded) c = Fold(c);
+        auto it = exactPaths.find(folded);
+        if (it != exactPaths.end()) merge(it->second);
+        pathGlobs.Match(folded.data(), folded.size(), best);
+    }
+    AppMatch m;
+    for (int ac = 0; ac < 2; ++ac) {
+        m.rule[ac] = best[ac];
+        m.heavy[ac] = best[ac] >= 0 && rules[(size_t)best[ac]].Heavy();
+    }
+    return m;
+}
+
+// ---------- Governor & ladder ----------
+void SetForegroundRule(GovernorSignals& s, const AppRule* rule) {
+    s.fgHeavy = rule && rule->Heavy();
+    s.fgPinned = rule && !rule->Heavy();
+    if (s.fgPinned) s.fgProfile = rule->profile;
+}
+
+LadderSetpoint ApplyAppRule(const LadderSetpoint& sp, const AppRule& rule) {
+    LadderSetpoint r = sp;
+    if (rule.maxProcPct < 100) {
+        uint8_t* pairs[][2] = { { &r.minAC, &r.maxAC }, { &r.minDC, &r.maxDC }, { &r.pMinAC, &r.pMaxAC },
+                                { &r.pMinDC, &r.pMaxDC }, { &r.eMinAC, &r.eMaxAC }, { &r.eMinDC, &r.eMaxDC } };
+        for (auto& mm : pairs) {
+            *mm[1] = std::min(*mm[1], rule.maxProcPct);
+            *mm[0] = std::min(*mm[0], *mm[1]);
+        }
+    }
+    if (rule.parkPct >= 0) r.parkAC = r.parkDC = (uint8_t)rule.parkPct;
+    return r;
+}
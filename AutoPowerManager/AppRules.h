@@ -0,0 +1,133 @@
+// AppRules.h
+// Per-application rules: which apps hold Boost (the old heavy list), which pin another profile while
+// they own the foreground, and which caps they bring. One rule per line; a '#' at the start or after
+// a blank starts a comment, except inside a quoted pattern:
+//
+//   pattern [->] [boost|balanced|saver] [max=PCT] [park=PCT|off] [ac|dc]
+//
+//   vivado*                      boost park=off
+//   teams                        balanced max=70
+//   "C:\Games\"                  boost ac
+//
+// A pattern without a path separator matches the normalized image name ("vivado*" matches
+// vivado.exe and vivado_lab.exe). A pattern with one matches the full image path, and a trailing
+// separator means everything below that folder. '*' and '?' are wildcards ('*' also crosses folders),
+// case is ignored, and '/' equals '\'. Quote a pattern that contains spaces. A bare pattern is a
+// Boost rule, so the old one-name-per-line HeavyApps value parses unchanged. The first matching
+// rule that applies to the power source wins.
+//
+// Every pattern compiles into one matcher. Exact names and paths go to hash tables, and wildcard
+// patterns go to a single automaton whose DFA states are built as inputs first reach them. A lookup
+// costs a hash probe plus one table step per character, however many rules there are. Lookups happen
+// when a process is first seen, never per tick.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct LadderSetpoint;
+
+enum : uint8_t { kRuleOnDC = 1, kRuleOnAC = 2 };
+
+struct AppRule {
+    std::wstring pattern;                          // as matched: lowercased, '/' -> '\'
+    ProcProfile  profile = ProcProfile::Boost;     // Boost: hold Active, as a heavy app always did
+    uint8_t      maxProcPct = 100;                 // caps SET_MAX_PROC_STATE (every core class)
+    int16_t      parkPct = -1;                     // SET_CORE_PARK_MIN_CORES override; <0: the ladder's
+    uint8_t      when = kRuleOnDC | kRuleOnAC;
+
+    bool Heavy() const { return profile == ProcProfile::Boost; }
+    bool HasCaps() const { return maxProcPct < 100 || parkPct >= 0; }
+};
+
+// One rule line without its comment, e.g. "teams balanced max=70". False if malformed.
+bool ParseAppRule(const std::wstring& line, AppRule& out);
+
+// Result of matching one process: the winning rule for each power source (index into AppRules,
+// -1 for none), resolved once so the scan and the tick only read it.
+struct AppMatch {
+    int16_t rule[2] = { -1, -1 };                  // [onAC]
+    bool    heavy[2] = { false, false };
+
+    int  Rule(bool onAC) const { return rule[onAC ? 1 : 0]; }
+    bool Heavy(bool onAC) const { return heavy[onAC ? 1 : 0]; }
+};
+
+// Glob patterns ('*', '?') over one alphabet, run as a lazily built DFA. Each DFA state is a set of
+// pattern positions, so one pass over the input advances every pattern at once. Not thread-safe:
+// matching fills the transition cache.
+class GlobAutomaton {
+public:
+    static constexpr size_t kMaxDfaStates = 4'096;   // the cache restarts past this
+
+    void   Clear();
+    void   Add(const std::wstring& pattern, int16_t rule, uint8_t when);
+    size_t Patterns() const { return patterns; }
+    size_t DfaStates() const { return dfa.size(); }
+
+    // Lowest rule index per power source among the patterns that match all of text.
+    void Match(const wchar_t* text, size_t len, int16_t best[2]) const;
+
+private:
+    enum Kind : uint8_t { Literal, AnyChar, Star, End };
+    struct Pos { Kind kind; uint16_t cls; int16_t rule; uint8_t when; };   // one NFA state
+    struct DfaState { size_t bits; int16_t best[2]; };                     // offset into setBits
+
+    uint16_t ClassOf(wchar_t c) const;
+    void     Close(uint64_t* set) const;
+    int32_t  Intern(const uint64_t* set) const;
+    int32_t  Step(int32_t from, uint16_t cls) const;
+    void     Restart() const;
+
+    std::vector<Pos>                            nfa;
+    std::vector<uint32_t>                       starts;     // first position of each pattern
+    size_t                                      patterns = 0;
+    uint16_t                                    classes = 1;   // 0: any character no pattern names
+    uint16_t                                    ascii[128] = {};
+    std::vector<std::pair<wchar_t, uint16_t>>   wide;       // sorted, for the rest
+    size_t                                      words = 0;  // per state set
+
+    mutable std::vector<uint64_t>                        setBits;
+    mutable std::vector<DfaState>                        dfa;       // 0: dead, 1: start
+    mutable std::vector<int32_t>                         trans;     // dfa.size() * classes, -1: not built
+    mutable std::unordered_map<std::string, int32_t>     index;     // state set bytes -> dfa state
+    mutable std::vector<uint64_t>                        scratch;
+};
+
+class AppRules {
+public:
+    // Replaces the rules with the lines of text ("\n" or "\r\n"). Returns the number of malformed
+    // lines, which are skipped.
+    int  Parse(const std::wstring& text);
+    void Clear();
+    void Add(const AppRule& r);   // appended: lowest priority
+
+    size_t         Size() const { return rules.size(); }
+    const AppRule& operator[](size_t i) const { return rules[i]; }
+
+    // name: normalized image name (NormalizeImageName); path: full image path, or empty if unknown.
+    AppMatch       Match(const std::wstring& name, const std::wstring& path) const;
+    const AppRule* Rule(const AppMatch& m, bool onAC) const {
+        const int i = m.Rule(onAC);
+        return i >= 0 ? &rules[(size_t)i] : nullptr;
+    }
+
+    const GlobAutomaton& NameGlobs() const { return nameGlobs; }
+    const GlobAutomaton& PathGlobs() const { return pathGlobs; }
+
+private:
+    std::vector<AppRule>                           rules;
+    std::unordered_map<std::wstring, AppMatch>     exactNames, exactPaths;
+    GlobAutomaton                                  nameGlobs, pathGlobs;
+};
+
+// The foreground app's rule (or none) as governor signals: Boost -> fgHeavy, otherwise fgPinned.
+void SetForegroundRule(GovernorSignals& s, const AppRule* rule);
+
+// A foreground rule's caps on top of the ladder (after the thermal cap: both only lower).
+LadderSetpoint ApplyAppRule(const LadderSetpoint& sp, const AppRule& rule);
@@ -1,6 +1,7 @@
 ﻿// AutoPowerManager_UI.cpp
 // Win32 tray utility: adaptive processor tuning with polished slider-based Settings UI.
 
+#define NOMINMAX
 #include <windows.h>
 #include <powrprof.h>
 #include <wtsapi32.h>
@@ -12,8 +13,31 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <mutex>
 
 #include "resource.h"
+#include "PowerWriter.h"
+#include "Governor.h"
+#include "GovernorLoop.h"
+#include "CpuSampler.h"
+#include "CpuTopology.h"
+#include "AppRules.h"
+#include "BatteryRuntime.h"
+#include "ForegroundTracker.h"
+#include "TickScheduler.h"
+#include "ProcessScanner.h"
+#include "ProcessQos.h"
+#include "ProfileLadder.h"
+#include "Predictor.h"
+#include "Energy.h"
+#include "Telemetry.h"
+#include "Actuator.h"
+#include "Thermal.h"
+#include "Footprint.h"
+#include "InputBoost.h"
+#include "StatusText.h"
 
 #pragma comment(lib, "PowrProf.lib")
 #pragma comment(lib, "Wtsapi32.lib")
@@ -28,7 +52,7 @@ struct Config {
     bool lockDownshift = true;         // saver when locked/display off
     GUID planAC = { 0x8c5e7fda,0xe8bf,0x4a96,{0x9a,0x85,0xa6,0xe2,0x3a,0x8c,0x63,0x5c} }; // High performance
     GUID planDC = { 0xa1841308,0x3541,0x4fab,{0xbc,0x81,0xf7,0x15,0x56,0xf2,0x0b,0x4a} }; // Power saver
-    std::vector<std::wstring> heavyApps = { L"comsol", L"matlab", L"vivado", L"ansys" };
+    std::wstring appRules = L"comsol\r\nmatlab\r\nvivado\r\nansys";   // AppRules.h syntax, as typed
 } g_cfg;
 
 // Legacy governor knobs (kept for compatibility with existing GUI fields; not used for plan switching)
@@ -42,6 +66,57 @@ static DWORD  g_stickyBoostMs = 45'000; // hold boost after user input
 static DWORD  g_residencyBalancedMs = 60'000; // time in Engaged before Balanced
 static DWORD  g_residencySaverMs = 90'000; // time in Idle before Saver
 
+// Aggregate CPU thresholds (registry only; Tools/Tuner sweeps them with the timings above)
+static DWORD  g_activeCpuPct = 40;          // smoothed CPU -> Active
+static DWORD  g_engagedCpuPct = 15;         // smoothed CPU -> Engaged
+
+// Per-core thresholds (registry only; 0 disables)
+static DWORD  g_activeMaxCorePct = 90;      // busiest core -> Active
+static DWORD  g_activeTopKPct = 75;         // mean of k busiest cores -> Active
+static DWORD  g_engagedMaxCorePct = 50;     // busiest core -> Engaged
+static DWORD  g_cpuTopK = 2;
+
+// Input filters (registry only; specs as in SignalFilter.h, e.g. "median:3+ewma:800/4500")
+static FilterSpec g_cpuFilter = FilterSpec::LegacyCpu();
+static FilterSpec g_idleFilter, g_battFilter;     // passthrough
+static DWORD  g_cpuHysteresisPct = 0;       // CPU thresholds release this far below where they trip
+static DWORD  g_battHysteresisPct = 0;      // low-battery latch clears this far above BattThreshold
+
+// Battery runtime target (settings dialog): replaces the BattThreshold cutoff while one is set
+static RuntimeTarget   g_runtimeTarget;     // off
+static DWORD           g_runtimeReservePct = 5;
+
+// Background process scan (registry only)
+static DWORD  g_bgScanMs = 5'000;           // 0 disables
+static DWORD  g_bgHeavyMinCorePct = 10;     // Boost-rule process using this much of a core -> Active
+static DWORD  g_bgBusyCorePct = 80;         // any process using this much of a core -> Engaged (0 disables)
+
+// Per-process QoS (registry only)
+static bool   g_processQos = true;          // EcoQoS for busy background processes, High for Boost-rule apps
+static DWORD  g_qosThrottleCorePct = 25;    // background process using this much of a core -> EcoQoS
+
+// Profile ladder (registry only): the controller's loop knobs; extra/overriding levels are in ProfileLevels
+static DWORD  g_ladderTargetUtilPct = 60;
+static DWORD  g_ladderDownMsPerLevel = 4'000;   // 0 = jump like the old three-profile switch
+
+// Learned pre-boost (registry only)
+static bool   g_predictBoost = true;
+
+// Telemetry ring (registry only)
+static DWORD  g_telemetryRecords = 65'536;  // ~18 h at 1 s ticks, 2.5 MB; 0 disables
+
+// Thermal / package-power Boost cap (registry only)
+static bool   g_thermalCap = true;
+static DWORD  g_thermalSoftC = 85;          // step down when the projected temperature reaches this
+static DWORD  g_packageLimitW = 0;          // 0: none (Windows rarely exposes the firmware limit)
+
+// Actuation latency (registry only)
+static DWORD  g_actuationWarnMs = 250;      // tray warning when a p99 exceeds this; 0 disables
+
+// Input-triggered ticks (registry only; InputBoost.h)
+static bool   g_inputBoost = true;          // Raw Input ticks the governor on a key press, click or deliberate move
+static DWORD  g_inputDebounceMs = 250;      // at most one input-triggered tick per this
+
 // ---------- Power & state ----------
 static const GUID GUID_BALANCED = { 0x381b4222,0xf694,0x41f0,{0x96,0x85,0xff,0x5b,0xb2,0x60,0xdf,0x2e} };
 static const GUID GUID_HIGH_PERF = { 0x8c5e7fda,0xe8bf,0x4a96,{0x9a,0x85,0xa6,0xe2,0x3a,0x8c,0x63,0x5c} };
@@ -51,8 +126,6 @@ static const GUID GUID_ACDC_POWER_SOURCE = { 0x5d3e9a59,0xe9d5,0x4b00,{0xa6,0xbd
 static const GUID GUID_BATTERY_PERCENTAGE_REMAINING = { 0xa7ad8041,0xb45a,0x4cae,{0x87,0xa3,0xee,0xcb,0xb4,0x68,0xa9,0xe1} };
 static const GUID GUID_CONSOLE_DISPLAY_STATE = { 0x6fe69556,0x704a,0x47a0,{0x8f,0x24,0xc2,0x8d,0x93,0x6f,0xda,0x47} };
 
-enum class DisplayState { Off = 0, On = 1, Dimmed = 2 };
-
 static bool  g_isOnAC = true;
 static int   g_battPct = 100;
 static DisplayState g_display = DisplayState::On;
@@ -63,28 +136,29 @@ static HWND  g_hDlg = nullptr;      // settings dialog
 static UINT  WM_TRAYICON;            // custom tray msg
 static NOTIFYICONDATA nid{};
 
-// ---------- CPU smoothing ----------
-static ULONGLONG g_prevIdle = 0, g_prevKernel = 0, g_prevUser = 0;
-static bool   g_cpuInit = false;
-static double g_cpuEWMA = 0.0; // 0..100%
-static double g_cpuBuf[5] = { 0,0,0,0,0 };
-static int    g_cpuIdx = 0;
-
-// ---------- Sticky & residency ----------
-static DWORD  g_boostHoldUntil = 0;
-static DWORD  g_enterBalancedAt = 0;
-static DWORD  g_enterSaverAt = 0;
-
-enum class ActivityTier { Idle, Engaged, Active };
-enum class ProcProfile { Boost, Balanced, Saver };
-static ProcProfile g_currentProcProfile = ProcProfile::Balanced;
-
-// ---------- Processor tuning GUIDs ----------
-static const GUID SUB_PROCESSOR = { 0x54533251,0x82be,0x4824,{0x96,0xc1,0x47,0xb6,0x0b,0x74,0x0d,0x00} }; // GUID_PROCESSOR_SETTINGS_SUBGROUP
-static const GUID SET_MIN_PROC_STATE = { 0x893dee8e,0x2bef,0x41e0,{0x89,0xc6,0xb5,0x7f,0xc8,0x77,0x79,0x99} }; // GUID_PROCESSOR_THROTTLE_MINIMUM
-static const GUID SET_MAX_PROC_STATE = { 0xbc5038f7,0x23e0,0x4960,{0x96,0xda,0x33,0xab,0xaf,0x59,0x35,0xec} }; // GUID_PROCESSOR_THROTTLE_MAXIMUM
-static const GUID SET_BOOST_MODE = { 0xbe337238,0x0d82,0x4146,{0xa2,0x41,0x23,0x20,0x33,0x1f,0xf1,0xa6} }; // GUID_PROCESSOR_PERF_BOOST_MODE
-static const GUID SET_CORE_PARK_MIN_CORES = { 0x0cc5b647,0xc1df,0x4637,{0x89,0x2e,0x31,0x69,0x1b,0x1d,0x2d,0x5b} }; // % cores unparked min
+// ---------- Governor loop (sample, scan, governor, ladder, thermal cap; see GovernorLoop.cpp) ----------
+// The same tick as the headless daemon. The tray feeds it the session signals and the foreground app
+// and takes its setpoints onto the actuator thread instead of letting it write them inline.
+static NtCoreTimesSource      g_coreTimes;        // per logical processor
+static NtProcessTableSource   g_procTable;        // background scan: minimized solves never own the foreground
+static Win32ProcessQosControl g_qosControl;       // EcoQoS for busy background processes; restored on exit
+static PdhThermalSource       g_thermalSource;
+static Win32PowerBackend      g_powerBackend;     // actuator thread only (the loop's inline writer is unused)
+static GovernorLoop           g_loop(g_coreTimes, g_procTable, g_qosControl, g_thermalSource, g_powerBackend);
+
+// ---------- Tick scheduling (adaptive; see TickScheduler.cpp) ----------
+static const UINT_PTR kTickTimerId = 1001;
+
+static void ArmTickTimer(UINT delayMs) {
+    // Coalescable: let the kernel batch our wake-up with others; tighter around transitions.
+    ULONG tolerance = delayMs <= g_loop.Scheduler().Config().fastMs ? delayMs / 8 : delayMs / 4;
+    SetCoalescableTimer(g_hMain, kTickTimerId, delayMs, nullptr, tolerance);
+}
+
+static void KickGovernorTick() { ArmTickTimer(g_loop.Kick(GetTickCount64())); }
+
+// Input that ticks the governor at once instead of waiting for the timer (see OnRawInput).
+static InputBoostGate g_inputGate;
 
 // ---------- Small utils ----------
 static UINT ClampUInt(UINT v, UINT lo, UINT hi) { if (v < lo) return lo; if (v > hi) return hi; return v; }
@@ -116,10 +190,8 @@ static void SaveConfig() {
     DWORD dcCode = IsEqualGUID(g_cfg.planDC, GUID_POWER_SAVER) ? 1 : (IsEqualGUID(g_cfg.planDC, GUID_BALANCED) ? 2 : 0);
     RegWriteDWORD(hKey, L"PlanAC", acCode);
     RegWriteDWORD(hKey, L"PlanDC", dcCode);
-    // heavy apps
-    std::wstring joined;
-    for (size_t i = 0; i < g_cfg.heavyApps.size(); ++i) { joined += g_cfg.heavyApps[i]; if (i + 1 < g_cfg.heavyApps.size()) joined += L"\r\n"; }
-    RegWriteString(hKey, L"HeavyApps", joined);
+    // app rules (the value name predates rules; plain names are Boost rules)
+    RegWriteString(hKey, L"HeavyApps", g_cfg.appRules);
     // legacy knobs (kept)
     RegWriteDWORD(hKey, L"GovConfirm", g_confirmSamples);
     RegWriteDWORD(hKey, L"GovCooldown", g_minSwitchIntervalMs);
@@ -129,6 +201,38 @@ static void SaveConfig() {
     RegWriteDWORD(hKey, L"StickyBoostMs", g_stickyBoostMs);
     RegWriteDWORD(hKey, L"ResidencyBalancedMs", g_residencyBalancedMs);
     RegWriteDWORD(hKey, L"ResidencySaverMs", g_residencySaverMs);
+    RegWriteDWORD(hKey, L"ActiveCpuPct", g_activeCpuPct);
+    RegWriteDWORD(hKey, L"EngagedCpuPct", g_engagedCpuPct);
+    // per-core thresholds
+    RegWriteDWORD(hKey, L"ActiveMaxCorePct", g_activeMaxCorePct);
+    RegWriteDWORD(hKey, L"ActiveTopKPct", g_activeTopKPct);
+    RegWriteDWORD(hKey, L"EngagedMaxCorePct", g_engagedMaxCorePct);
+    RegWriteDWORD(hKey, L"CpuTopK", g_cpuTopK);
+    // background scan
+    RegWriteDWORD(hKey, L"BgScanMs", g_bgScanMs);
+    RegWriteDWORD(hKey, L"BgHeavyMinCorePct", g_bgHeavyMinCorePct);
+    RegWriteDWORD(hKey, L"BgBusyCorePct", g_bgBusyCorePct);
+    RegWriteDWORD(hKey, L"ProcessQos", g_processQos ? 1u : 0u);
+    RegWriteDWORD(hKey, L"QosThrottleCorePct", g_qosThrottleCorePct);
+    // input filters (the *Filter specs are user-edited and left alone)
+    RegWriteDWORD(hKey, L"CpuHysteresisPct", g_cpuHysteresisPct);
+    RegWriteDWORD(hKey, L"BattHysteresisPct", g_battHysteresisPct);
+    // battery runtime target
+    char target[32];
+    FormatRuntimeTarget(g_runtimeTarget, target, sizeof(target));
+    RegWriteString(hKey, L"RuntimeTarget", std::wstring(target, target + strlen(target)));
+    RegWriteDWORD(hKey, L"RuntimeReservePct", g_runtimeReservePct);
+    // profile ladder (ProfileLevels is user-edited and left alone)
+    RegWriteDWORD(hKey, L"LadderTargetUtilPct", g_ladderTargetUtilPct);
+    RegWriteDWORD(hKey, L"LadderDownMsPerLevel", g_ladderDownMsPerLevel);
+    RegWriteDWORD(hKey, L"PredictBoost", g_predictBoost ? 1u : 0u);
+    RegWriteDWORD(hKey, L"TelemetryRecords", g_telemetryRecords);
+    RegWriteDWORD(hKey, L"ActuationWarnMs", g_actuationWarnMs);
+    RegWriteDWORD(hKey, L"InputBoost", g_inputBoost ? 1u : 0u);
+    RegWriteDWORD(hKey, L"InputDebounceMs", g_inputDebounceMs);
+    RegWriteDWORD(hKey, L"ThermalCap", g_thermalCap ? 1u : 0u);
+    RegWriteDWORD(hKey, L"ThermalSoftC", g_thermalSoftC);
+    RegWriteDWORD(hKey, L"PackageLimitW", g_packageLimitW);
     RegCloseKey(hKey);
 }
 
@@ -140,22 +244,8 @@ static void LoadConfig() {
     if (RegReadDWORD(hKey, L"PlanAC", v)) g_cfg.planAC = (v == 1 ? GUID_HIGH_PERF : (v == 2 ? GUID_BALANCED : g_cfg.planAC));
     if (RegReadDWORD(hKey, L"PlanDC", v)) g_cfg.planDC = (v == 1 ? GUID_POWER_SAVER : (v == 2 ? GUID_BALANCED : g_cfg.planDC));
 
-    std::wstring hv = RegReadString(hKey, L"HeavyApps");
-    if (!hv.empty()) {
-        g_cfg.heavyApps.clear();
-        size_t start = 0;
-        while (start < hv.size()) {
-            size_t pos = hv.find_first_of(L"\r\n", start);
-            std::wstring tok = hv.substr(start, (pos == std::wstring::npos ? hv.size() : pos) - start);
-            tok.erase(tok.begin(), std::find_if(tok.begin(), tok.end(), [](wchar_t c) {return !iswspace(c);}));
-            tok.erase(std::find_if(tok.rbegin(), tok.rend(), [](wchar_t c) {return !iswspace(c);}).base(), tok.end());
-            std::transform(tok.begin(), tok.end(), tok.begin(), ::towlower);
-            if (!tok.empty()) g_cfg.heavyApps.push_back(tok);
-            if (pos == std::wstring::npos) break;
-            start = hv.find_first_not_of(L"\r\n", pos);
-            if (start == std::wstring::npos) break;
-        }
-    }
+    std::wstring rules = RegReadString(hKey, L"HeavyApps");   // compiled by ApplyAppRules
+    if (!rules.empty()) g_cfg.appRules = rules;
 
     // legacy knobs
     if (RegReadDWORD(hKey, L"GovConfirm", v))   g_confirmSamples = (int)ClampUInt(v, 1, 10);
@@ -167,164 +257,436 @@ static void LoadConfig() {
     if (RegReadDWORD(hKey, L"StickyBoostMs", v))        g_stickyBoostMs = ClampUInt(v, 5'000, 300'000);
     if (RegReadDWORD(hKey, L"ResidencyBalancedMs", v))  g_residencyBalancedMs = ClampUInt(v, 10'000, 600'000);
     if (RegReadDWORD(hKey, L"ResidencySaverMs", v))     g_residencySaverMs = ClampUInt(v, 10'000, 600'000);
+    if (RegReadDWORD(hKey, L"ActiveCpuPct", v))         g_activeCpuPct = ClampUInt(v, 1, 100);
+    if (RegReadDWORD(hKey, L"EngagedCpuPct", v))        g_engagedCpuPct = ClampUInt(v, 1, 100);
+
+    // per-core thresholds
+    if (RegReadDWORD(hKey, L"ActiveMaxCorePct", v))     g_activeMaxCorePct = ClampUInt(v, 0, 100);
+    if (RegReadDWORD(hKey, L"ActiveTopKPct", v))        g_activeTopKPct = ClampUInt(v, 0, 100);
+    if (RegReadDWORD(hKey, L"EngagedMaxCorePct", v))    g_engagedMaxCorePct = ClampUInt(v, 0, 100);
+    if (RegReadDWORD(hKey, L"CpuTopK", v))              g_cpuTopK = ClampUInt(v, 1, 64);
+
+    // input filters: a malformed spec keeps the previous one
+    if (RegReadDWORD(hKey, L"CpuHysteresisPct", v))     g_cpuHysteresisPct = ClampUInt(v, 0, 50);
+    if (RegReadDWORD(hKey, L"BattHysteresisPct", v))    g_battHysteresisPct = ClampUInt(v, 0, 20);
+    std::wstring spec = RegReadString(hKey, L"CpuFilter");
+    if (!spec.empty()) ParseFilterSpec(spec.c_str(), g_cpuFilter);
+    spec = RegReadString(hKey, L"IdleFilter");
+    if (!spec.empty()) ParseFilterSpec(spec.c_str(), g_idleFilter);
+    spec = RegReadString(hKey, L"BattFilter");
+    if (!spec.empty()) ParseFilterSpec(spec.c_str(), g_battFilter);
+
+    // battery runtime target ("3h", "until 18:00"; BatteryRuntime.h)
+    spec = RegReadString(hKey, L"RuntimeTarget");
+    if (!spec.empty()) ParseRuntimeTarget(spec.c_str(), g_runtimeTarget);
+    if (RegReadDWORD(hKey, L"RuntimeReservePct", v))    g_runtimeReservePct = ClampUInt(v, 0, 50);
+
+    // background scan
+    if (RegReadDWORD(hKey, L"BgScanMs", v))             g_bgScanMs = v ? ClampUInt(v, 1'000, 60'000) : 0;
+    if (RegReadDWORD(hKey, L"BgHeavyMinCorePct", v))    g_bgHeavyMinCorePct = ClampUInt(v, 1, 100);
+    if (RegReadDWORD(hKey, L"BgBusyCorePct", v))        g_bgBusyCorePct = ClampUInt(v, 0, 6400);
+    if (RegReadDWORD(hKey, L"ProcessQos", v))           g_processQos = (v != 0);
+    if (RegReadDWORD(hKey, L"QosThrottleCorePct", v))   g_qosThrottleCorePct = ClampUInt(v, 5, 6400);
+
+    // profile ladder: one "name,rank,minAC,minDC,maxAC,maxDC,boostAC,boostDC,parkAC,parkDC" per line,
+    // optionally followed by ",pMinAC,pMinDC,pMaxAC,pMaxDC,eMinAC,eMinDC,eMaxAC,eMaxDC" for hybrid CPUs
+    if (RegReadDWORD(hKey, L"LadderTargetUtilPct", v))  g_ladderTargetUtilPct = ClampUInt(v, 10, 95);
+    if (RegReadDWORD(hKey, L"LadderDownMsPerLevel", v)) g_ladderDownMsPerLevel = ClampUInt(v, 0, 60'000);
+    if (RegReadDWORD(hKey, L"PredictBoost", v))         g_predictBoost = (v != 0);
+    if (RegReadDWORD(hKey, L"TelemetryRecords", v))     g_telemetryRecords = ClampUInt(v, 0, 1u << 24);
+    if (RegReadDWORD(hKey, L"ActuationWarnMs", v))      g_actuationWarnMs = ClampUInt(v, 0, 60'000);
+    if (RegReadDWORD(hKey, L"InputBoost", v))           g_inputBoost = (v != 0);
+    if (RegReadDWORD(hKey, L"InputDebounceMs", v))      g_inputDebounceMs = ClampUInt(v, 0, 5'000);
+    if (RegReadDWORD(hKey, L"ThermalCap", v))           g_thermalCap = (v != 0);
+    if (RegReadDWORD(hKey, L"ThermalSoftC", v))         g_thermalSoftC = ClampUInt(v, 50, 105);
+    if (RegReadDWORD(hKey, L"PackageLimitW", v))        g_packageLimitW = ClampUInt(v, 0, 500);
+    ProfileLadder ladder;
+    std::wstring levels = RegReadString(hKey, L"ProfileLevels");
+    for (size_t start = 0; start < levels.size();) {
+        size_t pos = levels.find_first_of(L"\r\n", start);
+        ProfileLevel l;
+        if (ParseProfileLevel(levels.substr(start, (pos == std::wstring::npos ? levels.size() : pos) - start), l)) ladder.Merge(l);
+        if (pos == std::wstring::npos) break;
+        start = pos + 1;
+    }
+    g_loop.SetLadder(ladder);
 
     RegCloseKey(hKey);
 }
 
-// ---------- CPU & activity ----------
-static double SampleCpuPercent() {
-    FILETIME idle, kernel, user;
-    if (!GetSystemTimes(&idle, &kernel, &user)) return 0.0;
-    ULARGE_INTEGER i{ idle.dwLowDateTime, idle.dwHighDateTime };
-    ULARGE_INTEGER k{ kernel.dwLowDateTime, kernel.dwHighDateTime };
-    ULARGE_INTEGER u{ user.dwLowDateTime, user.dwHighDateTime };
-    ULONGLONG ci = i.QuadPart, ck = k.QuadPart, cu = u.QuadPart;
+// ---------- Activity ----------
+static DWORD IdleSeconds() {
+    LASTINPUTINFO li{ sizeof(li) };
+    if (!GetLastInputInfo(&li)) return 0;
+    return (GetTickCount() - li.dwTime) / 1000;
+}
 
-    if (!g_cpuInit) { g_prevIdle = ci; g_prevKernel = ck; g_prevUser = cu; g_cpuInit = true; return 0.0; }
-    ULONGLONG idleDiff = ci - g_prevIdle;
-    ULONGLONG kernDiff = ck - g_prevKernel;
-    ULONGLONG userDiff = cu - g_prevUser;
-    g_prevIdle = ci; g_prevKernel = ck; g_prevUser = cu;
+// ---------- Foreground app (event-driven) ----------
+// EVENT_SYSTEM_FOREGROUND pushes changes; ticks only read the cached classification.
+static Win32ProcessInspector g_procInspector;
+static ForegroundTracker     g_fgTracker(g_procInspector);
+static HWINEVENTHOOK         g_fgHook = nullptr;
+
+static void ForegroundWindowChanged(HWND fg) {
+    DWORD pid = 0;
+    if (fg) GetWindowThreadProcessId(fg, &pid);
+    const AppRule* was = g_fgTracker.ForegroundRule(g_isOnAC);
+    g_fgTracker.OnForegroundChanged(pid);
+    g_loop.OnForeground(pid);
+    if (g_hMain && g_fgTracker.ForegroundRule(g_isOnAC) != was) KickGovernorTick();
+}
 
-    ULONGLONG total = kernDiff + userDiff;
-    if (total == 0) return 0.0;
-    double busy = (double)(total - idleDiff) * 100.0 / (double)total;
-    if (busy < 0) busy = 0; if (busy > 100) busy = 100;
-    return busy;
+static void CALLBACK ForegroundEventProc(HWINEVENTHOOK, DWORD event, HWND hwnd, LONG idObject, LONG, DWORD, DWORD) {
+    if (event == EVENT_SYSTEM_FOREGROUND && idObject == OBJID_WINDOW) ForegroundWindowChanged(hwnd);
 }
 
-static double Median5(const double a[5]) {
-    double v[5] = { a[0],a[1],a[2],a[3],a[4] };
-    for (int i = 1; i < 5; ++i) { double key = v[i]; int j = i - 1; while (j >= 0 && v[j] > key) { v[j + 1] = v[j]; --j; } v[j + 1] = key; }
-    return v[2];
+static void ForegroundHookInstall() {
+    // Out-of-context: callbacks arrive on this thread's message loop, same as WM_TIMER.
+    g_fgHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, ForegroundEventProc, 0, 0,
+        WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    ForegroundWindowChanged(GetForegroundWindow());
 }
 
-static DWORD IdleSeconds() {
-    LASTINPUTINFO li{ sizeof(li) };
-    if (!GetLastInputInfo(&li)) return 0;
-    return (GetTickCount() - li.dwTime) / 1000;
+static void ForegroundHookRemove() {
+    if (g_fgHook) { UnhookWinEvent(g_fgHook); g_fgHook = nullptr; }
 }
 
-static void CpuUpdateEWMA() {
-    double sample = SampleCpuPercent();
-    g_cpuBuf[g_cpuIdx] = sample;
-    g_cpuIdx = (g_cpuIdx + 1) % 5;
-    double med = Median5(g_cpuBuf);
-    const double alpha = 0.20;
-    g_cpuEWMA = (1.0 - alpha) * g_cpuEWMA + alpha * med;
-}
-
-static void UpdateBoostHold() {
-    if (IdleSeconds() < 2) g_boostHoldUntil = GetTickCount() + g_stickyBoostMs;
-}
-
-static ActivityTier DecideTier() {
-    DWORD now = GetTickCount();
-    bool sticky = now < g_boostHoldUntil;
-
-    // Foreground heavy app?
-    bool fgHeavy = false;
-    HWND fg = GetForegroundWindow();
-    if (fg) {
-        DWORD pid = 0; GetWindowThreadProcessId(fg, &pid);
-        HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-        if (h) {
-            wchar_t path[MAX_PATH]; DWORD sz = MAX_PATH;
-            if (QueryFullProcessImageNameW(h, 0, path, &sz)) {
-                std::wstring s(path);
-                size_t p = s.find_last_of(L"\\/");
-                if (p != std::wstring::npos) s = s.substr(p + 1);
-                std::transform(s.begin(), s.end(), s.begin(), ::towlower);
-                if (s.size() > 4 && s.substr(s.size() - 4) == L".exe") s.resize(s.size() - 4);
-                for (auto& n : g_cfg.heavyApps) if (s == n) { fgHeavy = true; break; }
-            }
-            CloseHandle(h);
-        }
-    }
+// ---------- App rules ----------
+// Compiled once per edit; the foreground tracker and the loop's scanner classify each process when
+// they first see it, so ticks only read the result. Returns the number of lines that didn't parse.
+static int ApplyAppRules() {
+    AppRules rules;
+    const int bad = rules.Parse(g_cfg.appRules);
+    g_fgTracker.SetRules(rules);
+    g_loop.SetAppRules(rules);
+    return bad;
+}
+
+// ---------- Per-user data files ----------
+// %LOCALAPPDATA%\AutoPowerManager\<file>; empty when the folder can't be resolved.
+static std::wstring AppDataPath(const wchar_t* file) {
+    wchar_t base[MAX_PATH];
+    DWORD n = GetEnvironmentVariableW(L"LOCALAPPDATA", base, MAX_PATH);
+    if (!n || n >= MAX_PATH) return L"";
+    std::wstring dir = std::wstring(base) + L"\\AutoPowerManager";
+    CreateDirectoryW(dir.c_str(), nullptr);
+    return dir + L"\\" + file;
+}
+
+// ---------- Learned pre-boost ----------
+// Model lives in predictor.bin (fixed size, ~100 KB).
+static TierPredictor g_predictor;
+
+static void PredictorLoad() {
+    std::wstring path = AppDataPath(L"predictor.bin");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"rb");
+    if (!f) return;
+    g_predictor.Load(f);   // a foreign/truncated file leaves the model empty
+    fclose(f);
+}
+
+static void PredictorSave() {
+    std::wstring path = AppDataPath(L"predictor.bin");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"wb");
+    if (!f) return;
+    g_predictor.Save(f);
+    fclose(f);
+}
+
+// ---------- Energy accounting ----------
+// Battery discharge charged per profile and per app (Energy.h); the ledger lives in energy.bin
+// (fixed size, ~3 KB). On AC there is no meter, and that time is counted as unmetered.
+static BatteryEnergySource g_energySource;
+
+static void EnergyLoad() {
+    std::wstring path = AppDataPath(L"energy.bin");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"rb");
+    if (!f) return;
+    g_loop.Energy().Load(f);   // a foreign/truncated file leaves the ledger empty
+    fclose(f);
+}
+
+static void EnergySave() {
+    std::wstring path = AppDataPath(L"energy.bin");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"wb");
+    if (!f) return;
+    g_loop.Energy().Save(f);
+    fclose(f);
+}
+
+// Written to %LOCALAPPDATA%\AutoPowerManager\energy.txt and opened.
+static void DumpEnergyReport() {
+    std::wstring path = AppDataPath(L"energy.txt");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"w");
+    if (!f) return;
+    fputs(FormatEnergyReport(g_loop.Energy(), g_loop.EnergySourceName()).c_str(), f);
+    fclose(f);
+    ShellExecuteW(nullptr, L"open", path.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
+}
+
+static int LocalMinuteOfDay() {
+    SYSTEMTIME lt; GetLocalTime(&lt);
+    return lt.wHour * 60 + lt.wMinute;
+}
+
+// ---------- Telemetry ----------
+// Every tick is recorded to telemetry.bin, a mapped ring that outlives a crash; export it with
+// Tools/TelemetryExport. Falls back to an in-memory ring when the file can't be mapped.
+static void TelemetryOpen() {
+    TelemetryRing& ring = g_loop.Telemetry();
+    ring.Close();
+    if (!g_telemetryRecords) return;
+    std::wstring path = AppDataPath(L"telemetry.bin");
+    if (path.empty() || !ring.Open(path.c_str(), g_telemetryRecords))
+        ring.OpenInMemory(g_telemetryRecords);
+}
 
-    if (sticky || fgHeavy || g_cpuEWMA > 40.0 || IdleSeconds() < 2)
-        return ActivityTier::Active;
-    if (IdleSeconds() < 90 || g_cpuEWMA > 15.0)
-        return ActivityTier::Engaged;
-    return ActivityTier::Idle;
+static uint64_t WallClockMs() {
+    FILETIME ft; GetSystemTimeAsFileTime(&ft);
+    ULARGE_INTEGER u; u.LowPart = ft.dwLowDateTime; u.HighPart = ft.dwHighDateTime;
+    return (u.QuadPart - 116'444'736'000'000'000ull) / 10'000;   // 1601 -> 1970, 100 ns -> ms
+}
+
+// Registry/slider knobs -> loop config (copied each tick so slider edits apply live).
+static GovernorLoopConfig CurrentLoopConfig() {
+    GovernorLoopConfig l;
+    GovernorConfig& c = l.gov;
+    c.battThreshold = g_cfg.battThreshold;
+    c.lockDownshift = g_cfg.lockDownshift;
+    c.stickyBoostMs = g_stickyBoostMs;
+    c.residencyBalancedMs = g_residencyBalancedMs;
+    c.residencySaverMs = g_residencySaverMs;
+    c.activeCpuPct = g_activeCpuPct;
+    c.engagedCpuPct = g_engagedCpuPct;
+    c.activeMaxCorePct = g_activeMaxCorePct;
+    c.activeTopKPct = g_activeTopKPct;
+    c.engagedMaxCorePct = g_engagedMaxCorePct;
+    c.cpuFilter = g_cpuFilter;
+    c.idleFilter = g_idleFilter;
+    c.battFilter = g_battFilter;
+    c.cpuHysteresisPct = g_cpuHysteresisPct;
+    c.battHysteresisPct = (int)g_battHysteresisPct;
+    l.cpuTopK = g_cpuTopK;
+    l.bgScanMs = g_bgScanMs;
+    l.bgHeavyMinCorePct = g_bgHeavyMinCorePct;
+    l.bgBusyCorePct = g_bgBusyCorePct;
+    l.processQos = g_processQos;
+    l.qosThrottleCorePct = g_qosThrottleCorePct;
+    l.ladderTargetUtilPct = g_ladderTargetUtilPct;
+    l.ladderDownMsPerLevel = g_ladderDownMsPerLevel;
+    l.thermalCap = g_thermalCap;
+    l.thermalSoftC = g_thermalSoftC;
+    l.packageLimitW = g_packageLimitW;
+    l.runtimeTarget = g_runtimeTarget;
+    l.runtimeReservePct = g_runtimeReservePct;
+    l.predictBoost = g_predictBoost;
+    return l;
 }
 
 // ---------- Processor tuning (in-plan nudges) ----------
-static void WriteACDCIndex(const GUID& subgroup, const GUID& setting, DWORD ac, DWORD dc) {
-    GUID* active = nullptr;
-    if (PowerGetActiveScheme(nullptr, &active) != ERROR_SUCCESS || !active) return;
-    PowerWriteACValueIndex(nullptr, active, &subgroup, &setting, ac);
-    PowerWriteDCValueIndex(nullptr, active, &subgroup, &setting, dc);
-    PowerSetActiveScheme(nullptr, active); // commit
-    LocalFree(active);
-}
-
-static void ProcProfile_Boost() {       // snappy
-    if (g_currentProcProfile == ProcProfile::Boost) return;
-    WriteACDCIndex(SUB_PROCESSOR, SET_MIN_PROC_STATE, 80, 50);
-    WriteACDCIndex(SUB_PROCESSOR, SET_MAX_PROC_STATE, 100, 90);
-    WriteACDCIndex(SUB_PROCESSOR, SET_BOOST_MODE, 3, 2); // 0:Off 1:Efficient 2:Aggressive 3:AggressiveAtGuarantee
-    WriteACDCIndex(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, 100, 60);
-    g_currentProcProfile = ProcProfile::Boost;
-}
-
-static void ProcProfile_Balanced() {    // normal
-    if (g_currentProcProfile == ProcProfile::Balanced) return;
-    WriteACDCIndex(SUB_PROCESSOR, SET_MIN_PROC_STATE, 20, 10);
-    WriteACDCIndex(SUB_PROCESSOR, SET_MAX_PROC_STATE, 100, 80);
-    WriteACDCIndex(SUB_PROCESSOR, SET_BOOST_MODE, 2, 1);
-    WriteACDCIndex(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, 60, 40);
-    g_currentProcProfile = ProcProfile::Balanced;
-}
-
-static void ProcProfile_Saver() {       // glide down
-    if (g_currentProcProfile == ProcProfile::Saver) return;
-    WriteACDCIndex(SUB_PROCESSOR, SET_MIN_PROC_STATE, 5, 5);
-    WriteACDCIndex(SUB_PROCESSOR, SET_MAX_PROC_STATE, 60, 50);
-    WriteACDCIndex(SUB_PROCESSOR, SET_BOOST_MODE, 1, 0);
-    WriteACDCIndex(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, 30, 30);
-    g_currentProcProfile = ProcProfile::Saver;
-}
-
-static void DecideAndApplyProcProfile(bool onAC, ActivityTier tier) {
-    DWORD now = GetTickCount();
-
-    // Hard overrides first
-    if (!onAC && g_battPct >= 0 && g_battPct < g_cfg.battThreshold) {
-        ProcProfile_Saver(); g_enterBalancedAt = g_enterSaverAt = 0; return;
-    }
-    if (g_sessionLocked || g_display != DisplayState::On) {
-        if (g_cfg.lockDownshift) { ProcProfile_Saver(); g_enterBalancedAt = g_enterSaverAt = 0; return; }
-    }
+// The governor picks Boost/Balanced/Saver; the ladder controller turns that into a position on the
+// profile ladder and slews down through the intermediate levels. One diffed transaction per change,
+// applied on the actuator thread: the message loop posts the newest setpoint and never waits on
+// the power API. A setpoint superseded before the actuator got to it is never written.
+static const UINT WM_APP_ACTUATED = WM_APP + 1;   // actuator -> message thread: latency snapshot updated
+static const UINT WM_APP_REFRESH = WM_APP + 2;    // settings dialog shown: refresh its status line
+
+struct ActuationRequest {
+    LadderSetpoint sp;
+    ProcProfile    from = ProcProfile::Balanced;
+    ProcProfile    to = ProcProfile::Balanced;
+    uint64_t       inputUs = 0;             // QPC time of the input that triggered it; 0 none
+};
+
+static TimedPowerBackend   g_timedBackend(g_powerBackend);  // actuator thread only
+static PowerSettingsWriter g_powerWriter(g_timedBackend);   // ...
+static LadderSetpoint      g_postedSetpoint;                // message thread
+static std::atomic<bool>   g_setpointValid{ false };        // cleared by the actuator when a commit fails
+
+// ---------- Actuation latency ----------
+// Every power API call is timed per setting (TimedPowerBackend); whole transactions are binned
+// by governor profile transition, from x to (X -> X is a ladder slew step). The actuator owns the
+// live histograms and publishes a copy after each transaction for the UI. An input-triggered step
+// up is also timed from the input event to the end of its transaction.
+struct ActuationLatency {
+    LatencyHistogram                       transitions[3][3];
+    LatencyHistogram                       input;
+    std::vector<TimedPowerBackend::Series> writes;
+    LatencyHistogram                       reads;
+    LatencyHistogram                       commits;
+};
+static LatencyHistogram g_transitionLatency[3][3];   // actuator thread only
+static LatencyHistogram g_inputLatency;              // ...
+static std::mutex       g_latencyLock;               // guards g_latency; held for copies only
+static ActuationLatency g_latency;
+static bool             g_latencyWarned = false;
+static const uint64_t   kLatencyWarnMinSamples = 20;
+static ProcessFootprint g_startupFootprint;          // at the end of WM_CREATE, for the report
+
+static uint64_t QpcMicros() {
+    static LARGE_INTEGER freq{};
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER c; QueryPerformanceCounter(&c);
+    return (uint64_t)(c.QuadPart / freq.QuadPart * 1'000'000 + c.QuadPart % freq.QuadPart * 1'000'000 / freq.QuadPart);
+}
+
+static void ActuationNamesInit() {
+    g_timedBackend.SetName(SET_MIN_PROC_STATE, "min-proc-state");
+    g_timedBackend.SetName(SET_MAX_PROC_STATE, "max-proc-state");
+    g_timedBackend.SetName(SET_MIN_PROC_STATE1, "min-proc-state-1");
+    g_timedBackend.SetName(SET_MAX_PROC_STATE1, "max-proc-state-1");
+    g_timedBackend.SetName(SET_BOOST_MODE, "boost-mode");
+    g_timedBackend.SetName(SET_CORE_PARK_MIN_CORES, "core-park-min");
+}
 
-    // Upward is immediate
-    if (tier == ActivityTier::Active) {
-        ProcProfile_Boost();
-        g_enterBalancedAt = g_enterSaverAt = 0;
-        return;
+static LatencyHistogram AllTransitions() {
+    std::lock_guard<std::mutex> g(g_latencyLock);
+    LatencyHistogram all;
+    for (auto& row : g_latency.transitions) for (auto& h : row) all.Merge(h);
+    return all;
+}
+
+static void PublishActuationLatency() {
+    {
+        std::lock_guard<std::mutex> g(g_latencyLock);
+        std::copy(&g_transitionLatency[0][0], &g_transitionLatency[0][0] + 9, &g_latency.transitions[0][0]);
+        g_latency.input = g_inputLatency;
+        g_latency.writes = g_timedBackend.Writes();
+        g_latency.reads = g_timedBackend.SchemeReads();
+        g_latency.commits = g_timedBackend.Commits();
     }
+    PostMessage(g_hMain, WM_APP_ACTUATED, 0, 0);
+}
+
+static void TrayBalloon(const wchar_t* title, const wchar_t* text);
+
+// Warn once when any series' p99 crosses the limit; re-arm when it is back under.
+static void CheckActuationLatency() {
+    if (!g_actuationWarnMs) return;
+    const uint64_t limitUs = g_actuationWarnMs * 1000ull;
+    std::unique_lock<std::mutex> g(g_latencyLock);
+    uint64_t worst = 0;
+    std::string what;
+    auto consider = [&](const LatencyHistogram& h, const std::string& name) {
+        if (h.Count() < kLatencyWarnMinSamples) return;
+        uint64_t p99 = h.Percentile(0.99);
+        if (p99 > worst) { worst = p99; what = name; }
+    };
+    for (int f = 0; f < 3; ++f)
+        for (int t = 0; t < 3; ++t)
+            consider(g_latency.transitions[f][t], std::string(ProfileNameA((ProcProfile)f)) + " -> " + ProfileNameA((ProcProfile)t));
+    for (auto& w : g_latency.writes)
+        consider(w.hist, std::string(w.name ? w.name : "setting") + (w.src == PowerSource::AC ? " (AC)" : " (DC)"));
+    consider(g_latency.commits, "PowerSetActiveScheme");
+    g.unlock();
+
+    if (worst <= limitUs) { g_latencyWarned = false; return; }
+    if (g_latencyWarned) return;
+    g_latencyWarned = true;
+    wchar_t text[200];
+    StringCchPrintf(text, 200, L"%hs p99 is %llu ms (limit %u ms). Use \"Actuation Latency Report\" for details.",
+        what.c_str(), (unsigned long long)((worst + 500) / 1000), (unsigned)g_actuationWarnMs);
+    TrayBalloon(L"Slow power setting changes", text);
+}
 
-    // Engaged -> Balanced after residency
-    if (tier == ActivityTier::Engaged) {
-        if (!g_enterBalancedAt) g_enterBalancedAt = now + g_residencyBalancedMs;
-        if (now >= g_enterBalancedAt) ProcProfile_Balanced();
-        g_enterSaverAt = 0; // reset Saver timer
-        return;
+// Written to %LOCALAPPDATA%\AutoPowerManager\actuation.txt and opened.
+static void DumpActuationLatency() {
+    std::wstring path = AppDataPath(L"actuation.txt");
+    FILE* f = path.empty() ? nullptr : _wfopen(path.c_str(), L"w");
+    if (!f) return;
+    ActuationLatency lat;
+    { std::lock_guard<std::mutex> g(g_latencyLock); lat = g_latency; }
+    char line[160];
+    fprintf(f, "Actuation latency (since start)\n\nProfile transitions (whole transaction):\n");
+    for (int from = 0; from < 3; ++from)
+        for (int to = 0; to < 3; ++to) {
+            const LatencyHistogram& h = lat.transitions[from][to];
+            if (!h.Count()) continue;
+            h.Summary(line, sizeof(line));
+            fprintf(f, "  %-8s -> %-8s  %s\n", ProfileNameA((ProcProfile)from), ProfileNameA((ProcProfile)to), line);
+        }
+    fprintf(f, "\nPower API calls:\n");
+    for (auto& w : lat.writes) {
+        w.hist.Summary(line, sizeof(line));
+        fprintf(f, "  %-16s %s  %s\n", w.name ? w.name : "?", w.src == PowerSource::AC ? "AC" : "DC", line);
+    }
+    lat.reads.Summary(line, sizeof(line));
+    fprintf(f, "  %-19s  %s\n", "PowerGetActiveScheme", line);
+    lat.commits.Summary(line, sizeof(line));
+    fprintf(f, "  %-19s  %s\n", "PowerSetActiveScheme", line);
+    if (g_inputBoost) {
+        const InputBoostGate::Stats& in = g_inputGate.GetStats();
+        lat.input.Summary(line, sizeof(line));
+        fprintf(f, "\nInput to actuation (Raw Input event to the end of the step up):\n  %s\n", line);
+        fprintf(f, "  %llu events, %llu ticks triggered, %llu debounced, %llu while already Active\n",
+            (unsigned long long)in.events, (unsigned long long)in.triggers, (unsigned long long)in.debounced,
+            (unsigned long long)in.absorbed);
     }
+    // Same figures as AutoPowerDaemon's "stats", for comparing the tray and headless builds.
+    ProcessFootprint now;
+    ReadProcessFootprint(now);
+    fprintf(f, "\nProcess footprint:\n  ready %.0f ms after process start\n  working set %llu KB (peak %llu KB), private %llu KB\n",
+        g_startupFootprint.sinceStartMs, (unsigned long long)now.rssKB, (unsigned long long)now.peakRssKB, (unsigned long long)now.privateKB);
+    if (now.sinceStartMs > 0)
+        fprintf(f, "  CPU time %.0f ms (%.0f ms per hour), %llu governor wake-ups (%.0f per hour)\n", now.cpuMs,
+            now.cpuMs * 3'600'000.0 / now.sinceStartMs, (unsigned long long)g_loop.Scheduler().Wakeups(),
+            g_loop.Scheduler().Wakeups() * 3'600'000.0 / now.sinceStartMs);
+    fclose(f);
+    ShellExecuteW(nullptr, L"open", path.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
+}
 
-    // Idle -> Saver after longer residency; otherwise hold Balanced
-    if (tier == ActivityTier::Idle) {
-        if (!g_enterSaverAt) g_enterSaverAt = now + g_residencySaverMs;
-        if (now >= g_enterSaverAt) ProcProfile_Saver();
-        else ProcProfile_Balanced();
+// Actuator thread.
+static void ActuateLadderSetpoint(const ActuationRequest& r) {
+    const uint64_t calls = g_timedBackend.Calls();
+    const uint64_t t0 = QpcMicros();
+    g_powerWriter.Begin();
+    StageLadderSetpoint(g_powerWriter, r.sp, g_loop.Topology().Hybrid());
+    const uint64_t failures = g_powerWriter.Failures();
+    g_powerWriter.Commit();
+    if (g_powerWriter.Failures() != failures) g_setpointValid = false;   // re-post on the next tick; an empty diff is fine
+    if (g_timedBackend.Calls() != calls) {                  // the diff may have left nothing to write
+        const uint64_t done = QpcMicros();
+        g_transitionLatency[(int)r.from][(int)r.to].Record(done - t0);
+        if (r.inputUs) g_inputLatency.Record(done > r.inputUs ? done - r.inputUs : 0);
+        PublishActuationLatency();
     }
 }
 
-// ---------- Tray & UI ----------
-static const wchar_t* ProfileName(ProcProfile p) {
-    return p == ProcProfile::Boost ? L"Boost" : p == ProcProfile::Balanced ? L"Balanced" : L"Saver";
+static LatestWinsWorker<ActuationRequest> g_actuator(ActuateLadderSetpoint);
+static uint64_t g_triggerInputUs = 0;   // message thread: set for the length of an input-triggered tick
+
+// Message thread: the loop hands over every tick's setpoint; never blocks.
+struct TrayActuator : ISetpointActuator {
+    void Apply(const LadderSetpoint& sp, ProcProfile from, ProcProfile to) override {
+        if (g_setpointValid && sp == g_postedSetpoint) return;
+        g_postedSetpoint = sp;
+        g_setpointValid = true;
+        ActuationRequest r;
+        r.sp = sp; r.from = from; r.to = to;
+        if ((int)to < (int)from) r.inputUs = g_triggerInputUs;   // a step up the input asked for
+        g_actuator.Post(r);
+    }
+    bool Busy() const override { return g_actuator.Busy(); }
+};
+static TrayActuator g_trayActuator;
+
+// ---------- Governor tick ----------
+static void DecideAndApplyProcProfile() {
+    g_loop.SetConfig(CurrentLoopConfig());
+    GovernorLoopInputs in;
+    in.idleSec = IdleSeconds();
+    in.onAC = g_isOnAC;
+    in.battPct = g_battPct;
+    in.display = g_display;
+    in.sessionLocked = g_sessionLocked;
+    in.fgPid = g_fgTracker.ForegroundPid();
+    in.fgRule = g_fgTracker.ForegroundRule(g_isOnAC);
+    in.fgName = &g_fgTracker.ForegroundName();
+    in.minuteOfDay = LocalMinuteOfDay();
+    ArmTickTimer(g_loop.Tick(GetTickCount64(), in, WallClockMs()));
 }
 
+// ---------- Tray & UI ----------
 static void TrayAdd(HWND hWnd) {
     WM_TRAYICON = RegisterWindowMessage(L"APM_TRAYICON_MSG");
     nid = {}; nid.cbSize = sizeof(nid); nid.hWnd = hWnd; nid.uID = 1;
@@ -337,29 +699,114 @@ static void TrayAdd(HWND hWnd) {
 }
 static void TrayRemove() { if (nid.cbSize) Shell_NotifyIcon(NIM_DELETE, &nid); }
 
-static void RefreshTrayAndDialog() {
-    std::wstring tip = L"Auto Power Manager\n";
-    tip += L"Profile: "; tip += ProfileName(g_currentProcProfile);
-    tip += L" • CPU~"; tip += std::to_wstring((int)g_cpuEWMA); tip += L"%";
-    tip += L" • Idle "; tip += std::to_wstring((int)IdleSeconds()); tip += L"s";
-    tip += L"\nAC:"; tip += g_isOnAC ? L"Online" : L"Battery";
-    tip += L" • Batt:"; tip += std::to_wstring(g_battPct); tip += L"%";
-    nid.uFlags = NIF_TIP; StringCchCopy(nid.szTip, ARRAYSIZE(nid.szTip), tip.c_str());
+static void TrayBalloon(const wchar_t* title, const wchar_t* text) {
+    if (!nid.cbSize) return;
+    nid.uFlags = NIF_INFO; nid.dwInfoFlags = NIIF_WARNING;
+    StringCchCopy(nid.szInfoTitle, ARRAYSIZE(nid.szInfoTitle), title);
+    StringCchCopy(nid.szInfo, ARRAYSIZE(nid.szInfo), text);
     Shell_NotifyIcon(NIM_MODIFY, &nid);
+}
 
-    if (g_hDlg) {
-        wchar_t line[256];
-        StringCchPrintf(line, 256, L"Profile:%s  CPU~%d%%  Idle:%us  AC:%s  Batt:%d%%",
-            ProfileName(g_currentProcProfile), (int)g_cpuEWMA, (unsigned)IdleSeconds(),
-            g_isOnAC ? L"Online" : L"Battery", g_battPct);
-        SetDlgItemText(g_hDlg, IDC_STATUS_LINE, line);
+static StatusFields CurrentStatus() {
+    StatusFields f;
+    f.profile = g_loop.Applied();
+    const ProfileLadder& ladder = g_loop.Ladder();
+    size_t level = ladder.Size() ? std::min(ladder.Size() - 1, (size_t)std::lround(std::max(0.0, g_loop.LadderCtl().Position()))) : 0;
+    f.level = ladder.Size() ? ladder[level].name : "";
+    f.cpuPct = g_loop.Gov().CpuEWMA();
+    f.maxCorePct = g_loop.Gov().MaxCoreEWMA();
+    f.idleSec = IdleSeconds();
+    f.onAC = g_isOnAC;
+    f.battPct = g_battPct;
+    f.tickMs = g_loop.Scheduler().Delay();
+    f.tempC = g_loop.ThermalReading().tempC;
+    f.thermalLevel = g_loop.Thermal().Level();
+    f.eco = g_loop.Qos().GetStats().eco;
+    const CpuTopology& topo = g_loop.Topology();
+    f.hybrid = topo.Hybrid();
+    if (f.hybrid) {
+        f.pCoresPct = g_loop.Load().classAggregate[topo.classes - 1];
+        f.eCoresPct = g_loop.Load().classAggregate[0];
     }
+    return f;
+}
+
+// Formatted in place and sent only when the text changed; the dialog line only while it is on
+// screen (showing or restoring it posts WM_APP_REFRESH).
+static wchar_t g_sentTip[ARRAYSIZE(nid.szTip)];
+static wchar_t g_sentLine[320];
+
+static void RefreshTrayAndDialog() {
+    StatusFields f = CurrentStatus();
+    wchar_t tip[ARRAYSIZE(nid.szTip)];
+    FormatTrayTip(f, tip, ARRAYSIZE(tip));
+    if (wcscmp(tip, g_sentTip) != 0) {
+        StringCchCopy(g_sentTip, ARRAYSIZE(g_sentTip), tip);
+        nid.uFlags = NIF_TIP; StringCchCopy(nid.szTip, ARRAYSIZE(nid.szTip), tip);
+        Shell_NotifyIcon(NIM_MODIFY, &nid);
+    }
+
+    if (g_hDlg && IsWindowVisible(g_hDlg) && !IsIconic(g_hDlg)) {
+        wchar_t line[ARRAYSIZE(g_sentLine)];
+        LatencyHistogram sw = AllTransitions();
+        f.switchP50Ms = sw.Percentile(0.50) / 1000.0;
+        f.switchP99Ms = sw.Percentile(0.99) / 1000.0;
+        FormatStatusLine(f, line, ARRAYSIZE(line));
+        if (wcscmp(line, g_sentLine) != 0) {
+            StringCchCopy(g_sentLine, ARRAYSIZE(g_sentLine), line);
+            SetDlgItemText(g_hDlg, IDC_STATUS_LINE, line);
+        }
+    }
+}
+
+// ---------- Input-triggered ticks ----------
+// Raw Input with RIDEV_INPUTSINK reaches the message window whichever app has the focus. Only the
+// kind of event is looked at, never key codes or pointer positions.
+static void InputBoostRegister(HWND hWnd, bool on) {
+    RAWINPUTDEVICE rid[2] = {};
+    rid[0].usUsagePage = 0x01; rid[0].usUsage = 0x06;   // keyboard
+    rid[1].usUsagePage = 0x01; rid[1].usUsage = 0x02;   // mouse (precision touchpads report as one too)
+    for (RAWINPUTDEVICE& d : rid) { d.dwFlags = on ? RIDEV_INPUTSINK : RIDEV_REMOVE; d.hwndTarget = on ? hWnd : nullptr; }
+    RegisterRawInputDevices(rid, 2, sizeof(RAWINPUTDEVICE));
+}
+
+static void OnRawInput(HRAWINPUT h) {
+    RAWINPUT ri;
+    UINT size = sizeof(ri);
+    if (GetRawInputData(h, RID_INPUT, &ri, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) return;
+    InputKind kind;
+    if (ri.header.dwType == RIM_TYPEKEYBOARD) {
+        if (ri.data.keyboard.Flags & RI_KEY_BREAK) return;   // release
+        kind = InputKind::Key;
+    }
+    else if (ri.header.dwType == RIM_TYPEMOUSE) {
+        const USHORT b = ri.data.mouse.usButtonFlags;
+        const USHORT downs = RI_MOUSE_LEFT_BUTTON_DOWN | RI_MOUSE_RIGHT_BUTTON_DOWN | RI_MOUSE_MIDDLE_BUTTON_DOWN
+                           | RI_MOUSE_BUTTON_4_DOWN | RI_MOUSE_BUTTON_5_DOWN;
+        kind = (b & downs) ? InputKind::Button : (b & (RI_MOUSE_WHEEL | RI_MOUSE_HWHEEL)) ? InputKind::Wheel : InputKind::Motion;
+        if (kind == InputKind::Motion && !ri.data.mouse.lLastX && !ri.data.mouse.lLastY) return;   // a button release
+    }
+    else return;
+
+    InputBoostConfig c = g_inputGate.Config();
+    c.debounceMs = g_inputDebounceMs;
+    g_inputGate.SetConfig(c);
+    if (!g_inputGate.OnInput(GetTickCount64(), kind, g_loop.Gov().Tier() == ActivityTier::Active)) return;
+    // Timed from when the event was queued (GetMessageTime), so the wait in the queue counts too.
+    const uint64_t queuedUs = (uint64_t)(GetTickCount() - (DWORD)GetMessageTime()) * 1000;
+    const uint64_t now = QpcMicros();
+    g_triggerInputUs = now > queuedUs ? now - queuedUs : 1;
+    DecideAndApplyProcProfile();
+    g_triggerInputUs = 0;
+    RefreshTrayAndDialog();
 }
 
 static void ShowContextMenu(HWND hWnd, POINT pt) {
     HMENU menu = CreatePopupMenu();
     AppendMenu(menu, MF_STRING, IDM_TRAY_OPEN, L"Open Settings");
     AppendMenu(menu, MF_STRING, IDM_TRAY_APPLY, L"Apply Now");
+    AppendMenu(menu, MF_STRING, IDM_TRAY_LATENCY, L"Actuation Latency Report");
+    AppendMenu(menu, MF_STRING, IDM_TRAY_ENERGY, L"Energy Report");
     AppendMenu(menu, MF_SEPARATOR, 0, nullptr);
     AppendMenu(menu, MF_STRING, IDM_TRAY_EXIT, L"Exit");
     SetForegroundWindow(hWnd);
@@ -407,6 +854,24 @@ static void ApplyPreset(HWND hDlg, int presetId) {
     RefreshTrayAndDialog();
 }
 
+// ---- Battery runtime target ----
+// The target's state next to its edit box: the cap in force and the estimate behind it.
+static void ShowRuntimeEstimate(HWND hDlg) {
+    const RuntimeGovernor& runtime = g_loop.Runtime();
+    wchar_t text[96];
+    double left = 0.0;
+    if (g_runtimeTarget.kind == RuntimeTarget::Off)
+        StringCchCopy(text, ARRAYSIZE(text), L"off (e.g. 3h or until 18:00)");
+    else if (!runtime.Active())
+        StringCchCopy(text, ARRAYSIZE(text), g_isOnAC ? L"applies on battery" : L"target reached");
+    else if (!runtime.HoursLeft(left))
+        StringCchPrintf(text, ARRAYSIZE(text), L"%.1f h to go, measuring drain", runtime.HoursToTarget());
+    else
+        StringCchPrintf(text, ARRAYSIZE(text), L"%.1f h to go; %ls cap lasts %.1f h",
+            runtime.HoursToTarget(), ProfileNameW(runtime.Ceiling()), left);
+    SetDlgItemText(hDlg, IDC_TX_RUNTIME, text);
+}
+
 // ---- Dialog load/save of legacy (radios, checkbox, heavy list) ----
 static void DlgLoadFromConfig(HWND hDlg) {
     // Radios for AC/DC plan preference (still shown; engine mainly tunes in-plan)
@@ -416,10 +881,14 @@ static void DlgLoadFromConfig(HWND hDlg) {
         IsEqualGUID(g_cfg.planDC, GUID_BALANCED) ? IDC_DC_PLAN_BALANCED : IDC_DC_PLAN_SAVER);
     CheckDlgButton(hDlg, IDC_LOCK_DOWNSHIFT, g_cfg.lockDownshift ? BST_CHECKED : BST_UNCHECKED);
 
-    // Heavy apps
-    std::wstring joined;
-    for (size_t i = 0; i < g_cfg.heavyApps.size(); ++i) { joined += g_cfg.heavyApps[i]; if (i + 1 < g_cfg.heavyApps.size()) joined += L"\r\n"; }
-    SetDlgItemText(hDlg, IDC_HEAVY_LIST, joined.c_str());
+    // App rules
+    SetDlgItemText(hDlg, IDC_HEAVY_LIST, g_cfg.appRules.c_str());
+
+    // Battery runtime target
+    char target[32];
+    FormatRuntimeTarget(g_runtimeTarget, target, sizeof(target));
+    SetDlgItemTextA(hDlg, IDC_ED_RUNTIME, target);
+    ShowRuntimeEstimate(hDlg);
 }
 
 static void DlgSaveToConfig(HWND hDlg) {
@@ -428,23 +897,21 @@ static void DlgSaveToConfig(HWND hDlg) {
     g_cfg.planDC = (IsDlgButtonChecked(hDlg, IDC_DC_PLAN_BALANCED) == BST_CHECKED) ? GUID_BALANCED : GUID_POWER_SAVER;
     g_cfg.lockDownshift = (IsDlgButtonChecked(hDlg, IDC_LOCK_DOWNSHIFT) == BST_CHECKED);
 
-    // Heavy list
+    // App rules: kept as typed; malformed lines are skipped and reported
     wchar_t buf[4096]; GetDlgItemText(hDlg, IDC_HEAVY_LIST, buf, 4096);
-    std::wstring hv = buf;
-    g_cfg.heavyApps.clear();
-    size_t start = 0;
-    while (start < hv.size()) {
-        size_t pos = hv.find_first_of(L"\r\n", start);
-        std::wstring tok = hv.substr(start, (pos == std::wstring::npos ? hv.size() : pos) - start);
-        tok.erase(tok.begin(), std::find_if(tok.begin(), tok.end(), [](wchar_t c) {return !iswspace(c);}));
-        tok.erase(std::find_if(tok.rbegin(), tok.rend(), [](wchar_t c) {return !iswspace(c);}).base(), tok.end());
-        std::transform(tok.begin(), tok.end(), tok.begin(), ::towlower);
-        if (!tok.empty()) g_cfg.heavyApps.push_back(tok);
-        if (pos == std::wstring::npos) break;
-        start = hv.find_first_not_of(L"\r\n", pos);
-        if (start == std::wstring::npos) break;
+    g_cfg.appRules = buf;
+    if (int bad = ApplyAppRules()) {
+        wchar_t msg[96];
+        StringCchPrintf(msg, ARRAYSIZE(msg), L"%d app rule line(s) could not be read and are ignored.", bad);
+        TrayBalloon(L"App rules", msg);
     }
 
+    // Battery runtime target: a malformed one keeps the previous target
+    wchar_t target[48]; GetDlgItemText(hDlg, IDC_ED_RUNTIME, target, ARRAYSIZE(target));
+    if (!ParseRuntimeTarget(target, g_runtimeTarget))
+        TrayBalloon(L"Battery target", L"Use a duration such as 3h or 2h30m, a time such as until 18:00, or off.");
+    ShowRuntimeEstimate(hDlg);
+
     // Sliders (live updated already, but enforce bounds from UI at save)
     int batt = Slider_Get(hDlg, IDC_SL_BATTPCT);
     int sticky = Slider_Get(hDlg, IDC_SL_STICKY);
@@ -482,6 +949,7 @@ static INT_PTR CALLBACK DlgProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lPara
     case WM_INITDIALOG:
     {
         g_hDlg = hDlg;
+        g_sentLine[0] = 0;   // a new dialog has no status line yet
         DialogStyleModern(hDlg);
 
         // Initialize sliders from persisted values (ms→sec), set labels
@@ -546,6 +1014,12 @@ static INT_PTR CALLBACK DlgProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lPara
             DestroyWindow(hDlg); g_hDlg = nullptr; return TRUE;
         }
         break;
+    case WM_SHOWWINDOW:
+        if (wParam) PostMessage(g_hMain, WM_APP_REFRESH, 0, 0);
+        break;
+    case WM_SIZE:
+        if (wParam == SIZE_RESTORED) PostMessage(g_hMain, WM_APP_REFRESH, 0, 0);
+        break;
     case WM_CLOSE:
         DestroyWindow(hDlg); g_hDlg = nullptr; return TRUE;
     }
@@ -575,7 +1049,7 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
 {
     if (msg == WM_CREATE) {
         g_hMain = hWnd;
-        SetTimer(hWnd, 1001, 1000, nullptr); // 1s sampling
+        ArmTickTimer(g_loop.Scheduler().Config().baseMs); // adaptive from the first tick on
 
         // power/session notifications
         RegisterPowerSettingNotification(hWnd, &GUID_ACDC_POWER_SOURCE, DEVICE_NOTIFY_WINDOW_HANDLE);
@@ -584,6 +1058,21 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
         WTSRegisterSessionNotification(hWnd, NOTIFY_FOR_THIS_SESSION);
 
         LoadConfig();
+        g_loop.SetConfig(CurrentLoopConfig());   // focus changes before the first tick read ProcessQos
+        if (g_inputBoost) InputBoostRegister(hWnd, true);
+        PredictorLoad();
+        EnergyLoad();
+        TelemetryOpen();
+        ActuationNamesInit();
+        CpuTopology topo;
+        if (ReadCpuTopology(topo)) g_loop.SetTopology(topo);
+        g_loop.SetActuator(&g_trayActuator);
+        g_loop.SetPredictor(&g_predictor);
+        g_loop.SetEnergySource(&g_energySource);
+        g_actuator.Start();   // after the topology: the actuator reads it
+        ApplyAppRules();
+        g_loop.SetSelfPid(GetCurrentProcessId());
+        ForegroundHookInstall();
         TrayAdd(hWnd);
 
         SYSTEM_POWER_STATUS sps{}; if (GetSystemPowerStatus(&sps)) {
@@ -592,14 +1081,26 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
         }
         g_display = DisplayState::On; g_sessionLocked = false;
         RefreshTrayAndDialog();
+        ReadProcessFootprint(g_startupFootprint);
         return 0;
     }
     else if (msg == WM_DESTROY) {
         TrayRemove();
+        ForegroundHookRemove();
+        if (g_inputBoost) InputBoostRegister(hWnd, false);
+        g_loop.RestoreAll();
+        g_actuator.Stop();   // lets an in-flight transaction finish
+        PredictorSave();
+        EnergySave();
+        g_loop.Telemetry().Close();
         WTSUnRegisterSessionNotification(hWnd);
         PostQuitMessage(0);
         return 0;
     }
+    else if (msg == WM_ENDSESSION) {
+        if (wParam) { PredictorSave(); EnergySave(); g_loop.RestoreAll(); }   // logoff/shutdown may not get as far as WM_DESTROY
+        return 0;
+    }
     else if (msg == WM_POWERBROADCAST && wParam == PBT_POWERSETTINGCHANGE) {
         auto pbs = reinterpret_cast<const POWERBROADCAST_SETTING*>(lParam);
         if (pbs) {
@@ -614,26 +1115,39 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
                 DWORD st = ReadSettingDWORD(pbs); // 0=Off,1=On,2=Dimmed
                 g_display = (st == 0 ? DisplayState::Off : (st == 1 ? DisplayState::On : DisplayState::Dimmed));
             }
+            KickGovernorTick();
         }
         return TRUE;
     }
+    else if (msg == WM_APP_ACTUATED) {
+        CheckActuationLatency();
+        return 0;
+    }
+    else if (msg == WM_APP_REFRESH) {
+        RefreshTrayAndDialog();
+        return 0;
+    }
     else if (msg == WM_WTSSESSION_CHANGE) {
         if (wParam == WTS_SESSION_LOCK)   g_sessionLocked = true;
         if (wParam == WTS_SESSION_UNLOCK) g_sessionLocked = false;
+        KickGovernorTick();
         return 0;
     }
     else if (msg == WM_COMMAND) {
         switch (LOWORD(wParam)) {
         case IDM_TRAY_OPEN:  TrayOrOpenSettings(hWnd); return 0;
-        case IDM_TRAY_APPLY: RefreshTrayAndDialog();   return 0;
+        case IDM_TRAY_APPLY: KickGovernorTick(); RefreshTrayAndDialog(); return 0;
+        case IDM_TRAY_LATENCY: DumpActuationLatency(); return 0;
+        case IDM_TRAY_ENERGY: DumpEnergyReport(); return 0;
         case IDM_TRAY_EXIT:  DestroyWindow(hWnd);      return 0;
         }
     }
-    else if (msg == WM_TIMER && wParam == 1001) {
-        CpuUpdateEWMA();
-        UpdateBoostHold();
-        ActivityTier tier = DecideTier();
-        DecideAndApplyProcProfile(g_isOnAC, tier);
+    else if (msg == WM_INPUT) {
+        OnRawInput((HRAWINPUT)lParam);
+        return DefWindowProc(hWnd, msg, wParam, lParam);   // frees the input
+    }
+    else if (msg == WM_TIMER && wParam == kTickTimerId) {
+        DecideAndApplyProcProfile();
         RefreshTrayAndDialog();
         return 0;
     }
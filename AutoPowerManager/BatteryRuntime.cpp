@@ -0,0 +1,218 @@
+// BatteryRuntime.cpp
+
+#include "BatteryRuntime.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ---------- Target text ----------
+static const char* SkipSpace(const char* p) { while (*p == ' ' || *p == '\t') ++p; return p; }
+
+static bool ParseClock(const char* p, uint32_t& minuteOfDay) {
+    char* e = nullptr;
+    const long h = strtol(p, &e, 10);
+    if (e == p || *e != ':' || h < 0 || h > 23) return false;
+    const char* q = e + 1;
+    const long m = strtol(q, &e, 10);
+    if (e - q != 2 || m < 0 || m > 59 || *SkipSpace(e)) return false;
+    minuteOfDay = (uint32_t)(h * 60 + m);
+    return true;
+}
+
+bool ParseRuntimeTarget(const char* text, RuntimeTarget& out) {
+    char buf[48];
+    const char* p = SkipSpace(text);
+    size_t n = 0;
+    for (; p[n] && n + 1 < sizeof(buf); ++n) buf[n] = (char)tolower((unsigned char)p[n]);
+    if (p[n]) return false;
+    while (n && (buf[n - 1] == ' ' || buf[n - 1] == '\t' || buf[n - 1] == '\r' || buf[n - 1] == '\n')) --n;
+    buf[n] = 0;
+
+    RuntimeTarget t;
+    if (!n || !strcmp(buf, "off") || !strcmp(buf, "none")) { out = t; return true; }
+    const bool until = !strncmp(buf, "until", 5);
+    const char* q = until ? SkipSpace(buf + 5) : buf;
+    if (until || strchr(q, ':')) {
+        if (!ParseClock(q, t.minutes)) return false;
+        t.kind = RuntimeTarget::Until;
+        out = t;
+        return true;
+    }
+
+    // Duration: one or more "<number> h|m" terms; hours may be fractional.
+    double minutes = 0.0;
+    while (*q) {
+        char* e = nullptr;
+        const double v = strtod(q, &e);
+        if (e == q || v < 0.0) return false;
+        e = (char*)SkipSpace(e);
+        if (*e == 'h')      minutes += v * 60.0;
+        else if (*e == 'm') minutes += v;
+        else return false;
+        ++e;
+        if (!strncmp(e, "in", 2)) e += 2;                  // "min"
+        else if (!strncmp(e, "r", 1)) e += 1;              // "hr"
+        if (*e == 's') ++e;                                // "hrs", "mins"
+        q = SkipSpace(e);
+    }
+    if (minutes < 1.0 || minutes > 48.0 * 60.0) return false;
+    t.kind = RuntimeTarget::Duration;
+    t.minutes = (uint32_t)std::lround(minutes);
+    out = t;
+    return true;
+}
+
+bool ParseRuntimeTarget(const wchar_t* text, RuntimeTarget& out) {
+    char narrow[48];
+    size_t n = 0;
+    for (; text[n]; ++n) {
+        if (n + 1 >= sizeof(narrow) || text[n] > 0x7f) return false;   // targets are ASCII
+        narrow[n] = (char)text[n];
+    }
+    narrow[n] = 0;
+    return ParseRuntimeTarget(narrow, out);
+}
+
+void FormatRuntimeTarget(const RuntimeTarget& t, char* out, size_t cap) {
+    if (!cap) return;
+    const unsigned h = t.minutes / 60, m = t.minutes % 60;
+    if (t.kind == RuntimeTarget::Until)        snprintf(out, cap, "until %02u:%02u", h, m);
+    else if (t.kind == RuntimeTarget::Off)     snprintf(out, cap, "off");
+    else if (!m)                               snprintf(out, cap, "%uh", h);
+    else if (!h)                               snprintf(out, cap, "%um", m);
+    else                                       snprintf(out, cap, "%uh%02um", h, m);
+}
+
+// ---------- Discharge estimator ----------
+void DischargeEstimator::Reset() { *this = DischargeEstimator(); }
+
+void DischargeEstimator::Interrupt() {
+    lastPct = -1;
+    lastDropMs = lastMs = 0;
+    std::fill(std::begin(msIn), std::end(msIn), 0);
+}
+
+void DischargeEstimator::Update(uint64_t nowMs, int battPct, ProcProfile applied, ProcProfile wanted) {
+    if (battPct < 0) { Interrupt(); return; }
+    if (lastMs && nowMs > lastMs) {
+        msIn[(int)applied] += nowMs - lastMs;
+        const double a = 1.0 - std::exp(-(double)(nowMs - lastMs) / kDemandTauMs);
+        for (int p = 0; p < 3; ++p) demand[p] += a * ((p == (int)wanted ? 1.0 : 0.0) - demand[p]);
+    }
+    lastMs = nowMs;
+    if (lastPct < 0 || battPct > lastPct) {            // start, or the gauge recalibrated upward
+        lastPct = battPct;
+        lastDropMs = 0;
+        std::fill(std::begin(msIn), std::end(msIn), 0);
+        return;
+    }
+    if (battPct == lastPct) return;
+
+    const int drop = lastPct - battPct;
+    lastPct = battPct;
+    // The first drop only starts the clock: the percentage at unplugging was part-used.
+    const uint64_t started = lastDropMs;
+    const uint64_t total = msIn[0] + msIn[1] + msIn[2];
+    lastDropMs = nowMs;
+    uint64_t in[3];
+    std::copy(std::begin(msIn), std::end(msIn), in);
+    std::fill(std::begin(msIn), std::end(msIn), 0);
+    if (!started || !total || nowMs <= started) return;
+
+    const double dtMs = (double)(nowMs - started);
+    const double rate = drop * 3.6e6 / dtMs;           // %/h over the interval
+    if (samples) {
+        for (int p : { (int)ProcProfile::Boost, (int)ProcProfile::Saver }) {
+            if (in[p] < total * 9 / 10) continue;
+            const double a = 1.0 - std::exp(-dtMs / kFactorTauMs);
+            factor[p] += a * (std::min(3.0, std::max(0.3, rate / base)) - factor[p]);
+        }
+    }
+    double mix = 0.0;
+    for (int p = 0; p < 3; ++p) mix += (double)in[p] * factor[p];
+    mix /= (double)total;
+    const double sample = rate / mix;
+    base = samples ? base + (1.0 - std::exp(-dtMs / kTauMs)) * (sample - base) : sample;
+    ++samples;
+}
+
+double DischargeEstimator::RatePctPerHour(ProcProfile p, uint64_t nowMs) const {
+    double b = base;
+    const uint64_t total = msIn[0] + msIn[1] + msIn[2];
+    if (lastDropMs && nowMs > lastDropMs && total) {
+        double mix = 0.0;
+        for (int q = 0; q < 3; ++q) mix += (double)msIn[q] * factor[q];
+        mix /= (double)total;
+        const double elapsedH = (double)(nowMs - lastDropMs) / 3.6e6;
+        if (b * mix * elapsedH > 1.0) b = 1.0 / (elapsedH * mix);   // the next percent is overdue
+    }
+    return b * factor[(int)p];
+}
+
+double DischargeEstimator::PlannedRatePctPerHour(ProcProfile ceiling, uint64_t nowMs) const {
+    double rate = 0.0;
+    for (int p = 0; p < 3; ++p) rate += demand[p] * RatePctPerHour((ProcProfile)std::max(p, (int)ceiling), nowMs);
+    return rate;
+}
+
+// ---------- Runtime governor ----------
+void RuntimeGovernor::SetConfig(const RuntimeGovernorConfig& c) {
+    if (c.target.kind != cfg.target.kind || c.target.minutes != cfg.target.minutes) deadlineMs = 0;   // re-plan
+    cfg = c;
+}
+
+bool RuntimeGovernor::HoursLeft(double& h) const {
+    if (!est.Valid() || battPct < 0) return false;
+    const double rate = est.PlannedRatePctPerHour(ceiling, nowMs);
+    if (rate <= 0.0) return false;
+    h = std::max(0, battPct - cfg.reservePct) / rate;
+    return true;
+}
+
+void RuntimeGovernor::Update(uint64_t now, bool onAC, int pct, ProcProfile applied, ProcProfile wanted, int minuteOfDay) {
+    nowMs = now;
+    battPct = pct;
+    if (onAC || pct < 0) {
+        est.Interrupt();
+        onBattery = false;
+        active = false;
+        ceiling = ProcProfile::Boost;
+        headroomSinceMs = 0;
+        return;
+    }
+    if (!onBattery) { onBattery = true; unplugMs = now; deadlineMs = 0; }
+    est.Update(now, pct, applied, wanted);
+
+    // The deadline is fixed on the monotonic clock when the discharge starts or the target changes.
+    if (!deadlineMs && cfg.target.kind != RuntimeTarget::Off) {
+        if (cfg.target.kind == RuntimeTarget::Duration) deadlineMs = unplugMs + cfg.target.minutes * 60'000ull;
+        else if (minuteOfDay >= 0) deadlineMs = now + (uint64_t)((cfg.target.minutes + 1440 - (uint32_t)minuteOfDay) % 1440) * 60'000ull;
+    }
+    if (cfg.target.kind == RuntimeTarget::Off || !deadlineMs || now >= deadlineMs) {
+        active = false;                               // no target, or reached: the battThreshold cutoff again
+        ceiling = ProcProfile::Boost;
+        hoursToTarget = 0.0;
+        headroomSinceMs = 0;
+        return;
+    }
+    active = true;
+    hoursToTarget = (double)(deadlineMs - now) / 3.6e6;
+
+    ProcProfile best = ProcProfile::Saver;
+    const int usable = pct - cfg.reservePct;
+    if (usable > 0 && !est.Valid()) best = ProcProfile::Boost;   // nothing measured yet
+    else if (usable > 0) {
+        const double budget = usable / hoursToTarget;                 // %/h that still reaches the target
+        for (ProcProfile p : { ProcProfile::Boost, ProcProfile::Balanced }) {
+            if (est.PlannedRatePctPerHour(p, now) * (1.0 + cfg.marginPct / 100.0) <= budget) { best = p; break; }
+        }
+    }
+    // Down at once; up only after the headroom has lasted.
+    if ((int)best >= (int)ceiling) { ceiling = best; headroomSinceMs = 0; return; }
+    if (!headroomSinceMs) headroomSinceMs = now;
+    if (now - headroomSinceMs >= cfg.raiseHoldMs) { ceiling = best; headroomSinceMs = 0; }
+}
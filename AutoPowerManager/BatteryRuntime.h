@@ -0,0 +1,108 @@
+// BatteryRuntime.h
+// Battery runtime target: "last 3 h" or "last until 18:00" instead of a fixed low-battery cutoff.
+// A discharge estimator turns the battery percentage history into a smoothed drain rate per
+// profile, and the runtime governor caps the profile at the highest one whose drain still reaches
+// the target with a reserve left. The cap follows the estimate: it drops at once when the battery
+// falls behind and lifts only after the estimate has had headroom for a while.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Text forms: "off", a duration from unplugging ("3h", "2h30m", "90m", "1.5h"), or a time of day
+// ("until 18:00", "18:00"; the next one, so "until 08:00" at 22:00 is tomorrow morning).
+struct RuntimeTarget {
+    enum Kind : uint8_t { Off, Duration, Until };
+    Kind     kind = Off;
+    uint32_t minutes = 0;            // Duration: runtime after unplugging; Until: minute of the day
+};
+
+bool ParseRuntimeTarget(const char* text, RuntimeTarget& out);
+bool ParseRuntimeTarget(const wchar_t* text, RuntimeTarget& out);
+void FormatRuntimeTarget(const RuntimeTarget& t, char* out, size_t cap);
+
+// Drain rate from battery-percentage drops. The gauge reports whole percent, so each drop closes an
+// interval whose rate is known exactly (drop / time since the previous drop); intervals are blended
+// with a time-constant EWMA. Profiles are modelled as a Balanced-equivalent base rate times a
+// per-profile factor: an interval spent in a mix of profiles updates the base through the mix's
+// factor, and one spent almost entirely in Boost or Saver updates that profile's factor. While a
+// drop is overdue, the time since the last one bounds the rate from above, so a lighter load shows
+// up before the next drop. Learned rates survive AC periods; the interval clock does not.
+// The estimator also keeps the long-run mix of profiles the governor asked for (before any cap), so
+// a plan under a ceiling charges only the time the ceiling would actually take away.
+class DischargeEstimator {
+public:
+    void Reset();
+    // On battery, once per tick: the raw percentage, the profile in force since the last call and
+    // the one the governor wanted for it.
+    void Update(uint64_t nowMs, int battPct, ProcProfile applied, ProcProfile wanted);
+    // The charger was connected (or the reading is unknown): the current interval is void.
+    void Interrupt();
+
+    bool   Valid() const { return samples >= kMinSamples; }   // one interval is too noisy to plan on
+    // Percent per hour at profile p (its factor times the base), bounded by an overdue drop.
+    double RatePctPerHour(ProcProfile p, uint64_t nowMs) const;
+    // Percent per hour with every profile above the ceiling held down to it, over the wanted mix.
+    double PlannedRatePctPerHour(ProcProfile ceiling, uint64_t nowMs) const;
+    double Factor(ProcProfile p) const { return factor[(int)p]; }
+    double Demand(ProcProfile p) const { return demand[(int)p]; }
+    uint32_t Samples() const { return samples; }
+
+    static constexpr uint32_t kMinSamples = 3;
+    static constexpr double kTauMs = 15.0 * 60'000.0;   // blend time constant
+    static constexpr double kFactorTauMs = 45.0 * 60'000.0;
+    static constexpr double kDemandTauMs = 90.0 * 60'000.0;   // long enough to span a work cycle
+
+private:
+    double   base = 0.0;                 // %/h at Balanced
+    double   factor[3] = { 1.35, 1.0, 0.75 };   // Boost, Balanced, Saver (priors until measured)
+    double   demand[3] = { 0.0, 1.0, 0.0 };     // share of time the governor wanted each profile
+    uint32_t samples = 0;
+    int      lastPct = -1;
+    uint64_t lastDropMs = 0;             // 0: waiting for the first drop of this discharge
+    uint64_t lastMs = 0;
+    uint64_t msIn[3] = {};               // time per profile since lastDropMs
+};
+
+struct RuntimeGovernorConfig {
+    RuntimeTarget target;
+    int      reservePct = 5;             // arrive at the target with this much left; Saver below it
+    double   marginPct = 10.0;           // plan for this much more drain than estimated
+    uint32_t raiseHoldMs = 5 * 60'000;   // a higher cap must have headroom this long before it lifts
+};
+
+class RuntimeGovernor {
+public:
+    void SetConfig(const RuntimeGovernorConfig& c);
+    const RuntimeGovernorConfig& Config() const { return cfg; }
+
+    // Once per tick with the raw battery reading (<0 unknown), the profile applied since the last
+    // call and the one the governor wanted (Governor::Wanted()), and the local minute of the day
+    // (for "until"; <0 unknown).
+    void Update(uint64_t nowMs, bool onAC, int battPct, ProcProfile applied, ProcProfile wanted, int minuteOfDay);
+    // Active: the governor should use the ceiling instead of its battThreshold cutoff.
+    void ApplyTo(GovernorSignals& s) const { s.runtimeTarget = active; s.runtimeCeiling = ceiling; }
+
+    bool        Active() const { return active; }   // a target is set, on battery, not reached yet
+    ProcProfile Ceiling() const { return ceiling; }
+    double      HoursToTarget() const { return hoursToTarget; }
+    // Hours until the reserve at the current ceiling; false without an estimate.
+    bool        HoursLeft(double& h) const;
+    const DischargeEstimator& Estimator() const { return est; }
+
+private:
+    RuntimeGovernorConfig cfg;
+    DischargeEstimator    est;
+    bool        active = false;
+    ProcProfile ceiling = ProcProfile::Boost;
+    bool        onBattery = false;
+    uint64_t    unplugMs = 0;
+    uint64_t    deadlineMs = 0;          // 0: not planned yet
+    uint64_t    headroomSinceMs = 0;     // since when a higher ceiling would have met the target
+    double      hoursToTarget = 0.0;
+    int         battPct = -1;
+    uint64_t    nowMs = 0;
+};
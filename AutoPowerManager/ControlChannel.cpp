@@ -0,0 +1,411 @@
+// ControlChannel.cpp
+// Overlapped named-pipe server (Win32) / poll()-driven Unix socket server, and the blocking client.
+
+#include "ControlChannel.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // the daemon ignores SIGPIPE
+#endif
+#endif
+
+struct ControlServer::Client {
+    uint32_t    id = 0;
+    bool        watch = false;
+    std::string in;                 // partial request line
+#ifdef _WIN32
+    HANDLE      pipe = INVALID_HANDLE_VALUE;
+    OVERLAPPED  ov{};               // the read in flight
+    char        buf[512];
+#else
+    int         fd = -1;
+#endif
+};
+
+ControlServer::ControlServer() {}
+ControlServer::~ControlServer() { Close(); }
+
+ControlServer::Client* ControlServer::Find(uint32_t id) {
+    for (Client* c : clients) if (c->id == id) return c;
+    return nullptr;
+}
+
+size_t ControlServer::Watchers() const {
+    return (size_t)std::count_if(clients.begin(), clients.end(), [](const Client* c) { return c->watch; });
+}
+
+void ControlServer::SetWatching(uint32_t client, bool on) {
+    if (Client* c = Find(client)) c->watch = on;
+}
+
+void ControlServer::Reply(uint32_t client, const std::string& line) {
+    for (size_t i = 0; i < clients.size(); ++i)
+        if (clients[i]->id == client) { if (!Send(*clients[i], line)) Drop(i); return; }
+}
+
+void ControlServer::Broadcast(const std::string& line) {
+    for (size_t i = clients.size(); i-- > 0;)
+        if (clients[i]->watch && !Send(*clients[i], line)) Drop(i);
+}
+
+bool ControlServer::Split(Client& c, const char* data, size_t n, std::vector<ControlRequest>& out) {
+    c.in.append(data, n);
+    size_t start = 0;
+    for (size_t nl; (nl = c.in.find('\n', start)) != std::string::npos; start = nl + 1) {
+        size_t end = nl;
+        if (end > start && c.in[end - 1] == '\r') --end;
+        ControlRequest r;
+        r.client = c.id;
+        r.line.assign(c.in, start, end - start);
+        out.push_back(std::move(r));
+    }
+    c.in.erase(0, start);
+    return c.in.size() <= kMaxLine;
+}
+
+#ifdef _WIN32
+// ---------- Win32: named pipe ----------
+std::string DefaultControlEndpoint() { return "\\\\.\\pipe\\AutoPowerManager"; }
+
+static bool StartRead(HANDLE pipe, OVERLAPPED& ov, char* buf, DWORD size) {
+    // Completion (synchronous or not) signals ov.hEvent; the bytes are collected in ReadFrom.
+    if (ReadFile(pipe, buf, size, nullptr, &ov)) return true;
+    return GetLastError() == ERROR_IO_PENDING;
+}
+
+bool ControlServer::StartListening(bool first) {
+    HANDLE h = CreateNamedPipeA(endpoint.c_str(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    OVERLAPPED* ov = (OVERLAPPED*)listenOv;
+    ZeroMemory(ov, sizeof(*ov));
+    ov->hEvent = (HANDLE)listenEvent;
+    ResetEvent(ov->hEvent);
+    listener = h;
+    listenPending = false;
+    if (!ConnectNamedPipe(h, ov)) {
+        DWORD err = GetLastError();
+        if (err == ERROR_IO_PENDING) listenPending = true;
+        else if (err == ERROR_PIPE_CONNECTED) SetEvent(ov->hEvent);   // a client raced the connect
+        else { CloseHandle(h); listener = nullptr; return false; }
+    }
+    return true;
+}
+
+bool ControlServer::Open(const std::string& name) {
+    Close();
+    endpoint = name;
+    listenEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    writeEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    listenOv = new OVERLAPPED{};
+    if (!listenEvent || !wakeEvent || !writeEvent || !StartListening(true)) { Close(); return false; }
+    return true;
+}
+
+bool ControlServer::IsOpen() const { return listener != nullptr; }
+
+void ControlServer::Drop(size_t i) {
+    Client* c = clients[i];
+    DWORD n = 0;
+    CancelIoEx(c->pipe, nullptr);
+    GetOverlappedResult(c->pipe, &c->ov, &n, TRUE);   // the read must finish before buf goes away
+    DisconnectNamedPipe(c->pipe);
+    CloseHandle(c->pipe);
+    CloseHandle(c->ov.hEvent);
+    delete c;
+    clients.erase(clients.begin() + i);
+}
+
+void ControlServer::Close() {
+    while (!clients.empty()) Drop(clients.size() - 1);
+    if (listener) {
+        DWORD n = 0;
+        if (listenPending) { CancelIoEx((HANDLE)listener, (OVERLAPPED*)listenOv); GetOverlappedResult((HANDLE)listener, (OVERLAPPED*)listenOv, &n, TRUE); }
+        CloseHandle((HANDLE)listener);
+        listener = nullptr;
+    }
+    if (listenEvent) { CloseHandle((HANDLE)listenEvent); listenEvent = nullptr; }
+    if (wakeEvent) { CloseHandle((HANDLE)wakeEvent); wakeEvent = nullptr; }
+    if (writeEvent) { CloseHandle((HANDLE)writeEvent); writeEvent = nullptr; }
+    delete (OVERLAPPED*)listenOv;
+    listenOv = nullptr;
+}
+
+void ControlServer::Interrupt() { if (wakeEvent) SetEvent((HANDLE)wakeEvent); }
+
+void ControlServer::Accept() {
+    HANDLE h = (HANDLE)listener;
+    DWORD n = 0;
+    const bool ok = !listenPending || GetOverlappedResult(h, (OVERLAPPED*)listenOv, &n, FALSE);
+    listener = nullptr;
+    if (ok) {
+        Client* c = new Client;
+        c->id = nextId++;
+        c->pipe = h;
+        c->ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (c->ov.hEvent && StartRead(h, c->ov, c->buf, sizeof(c->buf))) clients.push_back(c);
+        else { if (c->ov.hEvent) CloseHandle(c->ov.hEvent); DisconnectNamedPipe(h); CloseHandle(h); delete c; }
+        if (clients.size() > kMaxClients) { Send(*clients.back(), "{\"ok\":false,\"error\":\"too many clients\"}"); Drop(clients.size() - 1); }
+    }
+    else CloseHandle(h);
+    StartListening(false);   // on failure IsOpen turns false and the daemon exits
+}
+
+bool ControlServer::ReadFrom(Client& c, std::vector<ControlRequest>& out) {
+    DWORD n = 0;
+    if (!GetOverlappedResult(c.pipe, &c.ov, &n, FALSE)) return false;   // broken pipe: client gone
+    if (!Split(c, c.buf, n, out)) return false;
+    return StartRead(c.pipe, c.ov, c.buf, sizeof(c.buf));
+}
+
+bool ControlServer::Send(Client& c, const std::string& line) {
+    const std::string msg = line + "\n";
+    OVERLAPPED ov{};
+    ov.hEvent = (HANDLE)writeEvent;
+    ResetEvent(ov.hEvent);
+    DWORD n = 0;
+    if (!WriteFile(c.pipe, msg.data(), (DWORD)msg.size(), nullptr, &ov)) {
+        if (GetLastError() != ERROR_IO_PENDING) return false;
+        if (WaitForSingleObject(ov.hEvent, 50) == WAIT_TIMEOUT) {
+            // Pipe buffer full: the client stopped reading. Don't let it stall the governor.
+            CancelIoEx(c.pipe, &ov);
+            GetOverlappedResult(c.pipe, &ov, &n, TRUE);
+            return false;
+        }
+    }
+    return GetOverlappedResult(c.pipe, &ov, &n, TRUE) && n == msg.size();
+}
+
+bool ControlServer::Wait(uint32_t timeoutMs, std::vector<ControlRequest>& out) {
+    const ULONGLONG deadline = GetTickCount64() + timeoutMs;
+    for (;;) {
+        if (!listener) return false;
+        HANDLE hs[2 + kMaxClients];
+        DWORD n = 0;
+        hs[n++] = (HANDLE)wakeEvent;
+        hs[n++] = (HANDLE)listenEvent;
+        for (Client* c : clients) hs[n++] = c->ov.hEvent;
+        const ULONGLONG now = GetTickCount64();
+        const DWORD r = WaitForMultipleObjects(n, hs, FALSE, now >= deadline ? 0 : (DWORD)(deadline - now));
+        if (r == WAIT_TIMEOUT || r == WAIT_OBJECT_0) return true;
+        if (r == WAIT_OBJECT_0 + 1) Accept();
+        else if (r >= WAIT_OBJECT_0 + 2 && r < WAIT_OBJECT_0 + n) {
+            const size_t i = r - WAIT_OBJECT_0 - 2;
+            if (!ReadFrom(*clients[i], out)) Drop(i);
+        }
+        else return true;   // WAIT_FAILED: let the caller tick; the next Wait retries
+        if (!out.empty()) return true;
+    }
+}
+
+bool ControlClient::Connect(const std::string& endpoint) {
+    Close();
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        HANDLE h = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (h != INVALID_HANDLE_VALUE) { handle = h; return true; }
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(endpoint.c_str(), 2000)) return false;
+    }
+    return false;
+}
+
+bool ControlClient::Send(const std::string& line) {
+    const std::string msg = line + "\n";
+    DWORD n = 0;
+    return handle && WriteFile((HANDLE)handle, msg.data(), (DWORD)msg.size(), &n, nullptr) && n == msg.size();
+}
+
+bool ControlClient::ReadLine(std::string& line) {
+    for (;;) {
+        size_t nl = buf.find('\n');
+        if (nl != std::string::npos) { line.assign(buf, 0, nl); buf.erase(0, nl + 1); return true; }
+        char tmp[512];
+        DWORD n = 0;
+        if (!handle || !ReadFile((HANDLE)handle, tmp, sizeof(tmp), &n, nullptr) || !n) return false;
+        buf.append(tmp, n);
+    }
+}
+
+void ControlClient::Close() {
+    if (handle) { CloseHandle((HANDLE)handle); handle = nullptr; }
+    buf.clear();
+}
+
+#else
+// ---------- POSIX: Unix domain socket ----------
+std::string DefaultControlEndpoint() {
+    const char* dir = getenv("XDG_RUNTIME_DIR");
+    if (dir && *dir) return std::string(dir) + "/autopower.sock";
+    return "/tmp/autopower-" + std::to_string((unsigned)getuid()) + ".sock";
+}
+
+static bool SetNonBlocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    return fl >= 0 && fcntl(fd, F_SETFL, fl | O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+static bool SocketAddress(const std::string& path, sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+bool ControlServer::Open(const std::string& name) {
+    Close();
+    sockaddr_un addr;
+    if (!SocketAddress(name, addr)) return false;
+
+    // A socket file nobody answers on is left over from a crash; a live one belongs to another daemon.
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0) {
+        const bool live = connect(probe, (const sockaddr*)&addr, sizeof(addr)) == 0;
+        close(probe);
+        if (live) return false;
+    }
+    unlink(name.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    const mode_t old = umask(0177);
+    const bool bound = bind(fd, (const sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(old);
+    if (!bound || listen(fd, 8) != 0 || !SetNonBlocking(fd) || pipe(wakeFds) != 0) {
+        close(fd);
+        if (bound) unlink(name.c_str());
+        return false;
+    }
+    SetNonBlocking(wakeFds[0]);
+    SetNonBlocking(wakeFds[1]);
+    listenFd = fd;
+    endpoint = name;
+    return true;
+}
+
+bool ControlServer::IsOpen() const { return listenFd >= 0; }
+
+void ControlServer::Drop(size_t i) {
+    close(clients[i]->fd);
+    delete clients[i];
+    clients.erase(clients.begin() + i);
+}
+
+void ControlServer::Close() {
+    while (!clients.empty()) Drop(clients.size() - 1);
+    if (listenFd >= 0) { close(listenFd); listenFd = -1; unlink(endpoint.c_str()); }
+    for (int& fd : wakeFds) if (fd >= 0) { close(fd); fd = -1; }
+}
+
+void ControlServer::Interrupt() {
+    // Async-signal-safe; a full pipe already holds a wake-up.
+    if (wakeFds[1] >= 0) { char b = 1; ssize_t r = write(wakeFds[1], &b, 1); (void)r; }
+}
+
+void ControlServer::Accept() {
+    for (;;) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        if (!SetNonBlocking(fd)) { close(fd); continue; }
+        Client* c = new Client;
+        c->id = nextId++;
+        c->fd = fd;
+        clients.push_back(c);
+        if (clients.size() > kMaxClients) { Send(*c, "{\"ok\":false,\"error\":\"too many clients\"}"); Drop(clients.size() - 1); }
+    }
+}
+
+bool ControlServer::ReadFrom(Client& c, std::vector<ControlRequest>& out) {
+    char buf[512];
+    for (;;) {
+        ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n > 0) { if (!Split(c, buf, (size_t)n, out)) return false; continue; }
+        if (n == 0) return false;                                   // closed
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+}
+
+bool ControlServer::Send(Client& c, const std::string& line) {
+    const std::string msg = line + "\n";
+    // Replies are short; a socket buffer that can't take one means the client stopped reading.
+    ssize_t n = send(c.fd, msg.data(), msg.size(), MSG_NOSIGNAL);
+    return n == (ssize_t)msg.size();
+}
+
+bool ControlServer::Wait(uint32_t timeoutMs, std::vector<ControlRequest>& out) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::vector<pollfd> fds;
+    for (;;) {
+        if (listenFd < 0) return false;
+        fds.clear();
+        fds.push_back(pollfd{ wakeFds[0], POLLIN, 0 });
+        fds.push_back(pollfd{ listenFd, POLLIN, 0 });
+        for (Client* c : clients) fds.push_back(pollfd{ c->fd, POLLIN, 0 });
+        const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        const int r = poll(fds.data(), (nfds_t)fds.size(), left > 0 ? (int)left : 0);
+        if (r <= 0) return true;                                    // timeout, or EINTR: a signal to look at
+        if (fds[0].revents) {
+            char b[64];
+            while (read(wakeFds[0], b, sizeof(b)) > 0) {}
+            return true;
+        }
+        // Clients first, by index, before Accept or Drop change the list.
+        for (size_t i = fds.size() - 1; i >= 2; --i)
+            if (fds[i].revents && !ReadFrom(*clients[i - 2], out)) Drop(i - 2);
+        if (fds[1].revents) Accept();
+        if (!out.empty()) return true;
+    }
+}
+
+bool ControlClient::Connect(const std::string& endpoint) {
+    Close();
+    sockaddr_un addr;
+    if (!SocketAddress(endpoint, addr)) return false;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (connect(fd, (const sockaddr*)&addr, sizeof(addr)) != 0) { Close(); return false; }
+    return true;
+}
+
+bool ControlClient::Send(const std::string& line) {
+    const std::string msg = line + "\n";
+    for (size_t off = 0; off < msg.size();) {
+        ssize_t n = send(fd, msg.data() + off, msg.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+bool ControlClient::ReadLine(std::string& line) {
+    for (;;) {
+        size_t nl = buf.find('\n');
+        if (nl != std::string::npos) { line.assign(buf, 0, nl); buf.erase(0, nl + 1); return true; }
+        char tmp[512];
+        ssize_t n = fd >= 0 ? recv(fd, tmp, sizeof(tmp), 0) : -1;
+        if (n <= 0) return false;
+        buf.append(tmp, (size_t)n);
+    }
+}
+
+void ControlClient::Close() {
+    if (fd >= 0) { close(fd); fd = -1; }
+    buf.clear();
+}
+#endif
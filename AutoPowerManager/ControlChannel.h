@@ -0,0 +1,114 @@
+// ControlChannel.h
+// Local control channel for the headless daemon: newline-delimited text requests and replies over
+// a named pipe (Win32) or a Unix domain socket. Single-threaded and non-blocking; the daemon's loop
+// sleeps in Wait until the next tick or the next request.
+//
+// Access is the endpoint's: the pipe keeps its default DACL (writable by the owner, SYSTEM and
+// administrators only) and rejects remote clients; the socket is created mode 0600.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// \\.\pipe\AutoPowerManager on Win32; $XDG_RUNTIME_DIR/autopower.sock, else /tmp/autopower-<uid>.sock.
+std::string DefaultControlEndpoint();
+
+struct ControlRequest {
+    uint32_t    client = 0;
+    std::string line;             // without the newline
+};
+
+class ControlServer {
+public:
+    static constexpr size_t kMaxClients = 32;
+    static constexpr size_t kMaxLine = 1024;    // longer requests drop the client
+
+    ControlServer();
+    ~ControlServer();
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    // False if the endpoint can't be created or another server already owns it.
+    bool Open(const std::string& endpoint);
+    void Close();
+    bool IsOpen() const;
+    const std::string& Endpoint() const { return endpoint; }
+
+    // Accepts connections and reads until at least one complete request line is in out, timeoutMs
+    // passes, or Interrupt is called. Returns false only when the channel is closed.
+    bool Wait(uint32_t timeoutMs, std::vector<ControlRequest>& out);
+
+    // Sends line + '\n'. A client that can't take it at once (full buffer, gone) is dropped.
+    void Reply(uint32_t client, const std::string& line);
+    // Watching clients also receive every Broadcast line.
+    void SetWatching(uint32_t client, bool on);
+    void Broadcast(const std::string& line);
+
+    size_t Clients() const { return clients.size(); }
+    size_t Watchers() const;
+
+    // Wakes Wait from another thread or a signal handler.
+    void Interrupt();
+
+private:
+    struct Client;
+
+    Client* Find(uint32_t id);
+    void    Drop(size_t i);
+    bool    Send(Client& c, const std::string& line);
+    void    Accept();
+    bool    ReadFrom(Client& c, std::vector<ControlRequest>& out);
+    bool    Split(Client& c, const char* data, size_t n, std::vector<ControlRequest>& out);
+#ifdef _WIN32
+    bool    StartListening(bool first);
+#endif
+
+    std::string          endpoint;
+    std::vector<Client*> clients;
+    uint32_t             nextId = 1;
+#ifdef _WIN32
+    void*                listener = nullptr;    // pipe instance waiting for a client (HANDLE)
+    void*                listenEvent = nullptr;
+    void*                wakeEvent = nullptr;
+    void*                writeEvent = nullptr;
+    void*                listenOv = nullptr;    // OVERLAPPED
+    bool                 listenPending = false; // ConnectNamedPipe in flight (else already connected)
+#else
+    int                  listenFd = -1;
+    int                  wakeFds[2] = { -1, -1 };
+#endif
+};
+
+// Client side, for scripts and the daemon's --send: a blocking connection.
+class ControlClient {
+public:
+    ControlClient() = default;
+    ~ControlClient() { Close(); }
+    ControlClient(const ControlClient&) = delete;
+    ControlClient& operator=(const ControlClient&) = delete;
+
+    bool Connect(const std::string& endpoint);
+    bool Send(const std::string& line);
+    bool ReadLine(std::string& line);     // false at end of stream
+    void Close();
+
+private:
+#ifdef _WIN32
+    void*       handle = nullptr;
+#else
+    int         fd = -1;
+#endif
+    std::string buf;
+};
+
+// One request, then reply lines until the server closes or onLine returns false. False if the
+// endpoint couldn't be reached.
+template <typename F> bool ControlRequestLines(const std::string& endpoint, const std::string& request, F onLine) {
+    ControlClient c;
+    if (!c.Connect(endpoint) || !c.Send(request)) return false;
+    std::string line;
+    while (c.ReadLine(line)) if (!onLine(line)) break;
+    return true;
+}
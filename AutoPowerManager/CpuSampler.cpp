@@ -0,0 +1,144 @@
+// CpuSampler.cpp
+// Per-core CPU sampler and its Win32 / procfs counter sources.
+
+#include "CpuSampler.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#ifdef _WIN32
+// ---------- Win32 source ----------
+namespace {
+typedef LONG(NTAPI* NtQuerySystemInformationEx_t)(ULONG, PVOID, ULONG, PVOID, ULONG, PULONG);
+const ULONG kSystemProcessorPerformanceInformation = 8;
+
+struct ProcessorPerformanceInfo {   // SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION
+    LARGE_INTEGER IdleTime;
+    LARGE_INTEGER KernelTime;       // includes idle
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER DpcTime;
+    LARGE_INTEGER InterruptTime;
+    ULONG         InterruptCount;
+};
+}
+
+NtCoreTimesSource::NtCoreTimesSource() {
+    if (HMODULE nt = GetModuleHandleW(L"ntdll.dll"))
+        query = reinterpret_cast<void*>(GetProcAddress(nt, "NtQuerySystemInformationEx"));
+}
+
+// Fallback: the whole machine as one core, so every CPU signal sees the aggregate.
+static bool ReadSystemTimes(CoreTimes& out) {
+    out.busy.clear(); out.total.clear(); out.ids.clear();
+    FILETIME idle, kernel, user;
+    if (!GetSystemTimes(&idle, &kernel, &user)) return false;
+    auto ticks = [](const FILETIME& ft) { return ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime; };
+    const uint64_t total = ticks(kernel) + ticks(user);   // kernel includes idle
+    const uint64_t i = ticks(idle);
+    out.busy.push_back(total > i ? total - i : 0);
+    out.total.push_back(total);
+    return true;
+}
+
+bool NtCoreTimesSource::Read(CoreTimes& out) {
+    if (!query) return ReadSystemTimes(out);
+    auto fn = reinterpret_cast<NtQuerySystemInformationEx_t>(query);
+    out.busy.clear(); out.total.clear(); out.ids.clear();
+
+    WORD groups = GetActiveProcessorGroupCount();
+    for (WORD g = 0; g < groups; ++g) {
+        DWORD n = GetActiveProcessorCount(g);
+        buf.resize(n * sizeof(ProcessorPerformanceInfo));
+        ULONG ret = 0; USHORT group = g;
+        if (fn(kSystemProcessorPerformanceInformation, &group, sizeof(group), buf.data(), (ULONG)buf.size(), &ret) < 0)
+            return ReadSystemTimes(out);
+        auto* info = reinterpret_cast<const ProcessorPerformanceInfo*>(buf.data());
+        for (ULONG i = 0; i < ret / sizeof(ProcessorPerformanceInfo); ++i) {
+            uint64_t total = (uint64_t)info[i].KernelTime.QuadPart + (uint64_t)info[i].UserTime.QuadPart;
+            uint64_t idle = (uint64_t)info[i].IdleTime.QuadPart;
+            out.busy.push_back(total > idle ? total - idle : 0);
+            out.total.push_back(total);
+            out.ids.push_back((uint32_t)g * 64 + i);
+        }
+    }
+    return !out.total.empty();
+}
+#endif
+
+// ---------- procfs source ----------
+bool ProcStatCoreTimesSource::Read(CoreTimes& out) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    out.busy.clear(); out.total.clear(); out.ids.clear();
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "cpu", 3) != 0) { if (!out.total.empty()) break; continue; }
+        if (line[3] < '0' || line[3] > '9') continue;   // aggregate "cpu " line
+        unsigned long long v[8] = { 0 };                 // user nice system idle iowait irq softirq steal
+        const char* p = strchr(line, ' ');
+        if (!p || sscanf(p, "%llu %llu %llu %llu %llu %llu %llu %llu", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) < 4) continue;
+        uint64_t total = 0;
+        for (auto x : v) total += x;
+        uint64_t idle = v[3] + v[4];
+        out.busy.push_back(total - idle);
+        out.total.push_back(total);
+        out.ids.push_back((uint32_t)strtoul(line + 3, nullptr, 10));
+    }
+    fclose(f);
+    return !out.total.empty();
+}
+
+// ---------- Sampler ----------
+bool PerCoreCpuSampler::Sample(CpuLoad& out) {
+    if (!src.Read(cur)) return false;
+    const size_t n = cur.total.size();
+    out = CpuLoad{};
+    out.cores = (int)n;
+    out.classes = topo.classes;
+
+    if (prevTotal.size() != n) {    // first sample or hotplug: re-prime
+        prevBusy = cur.busy; prevTotal = cur.total;
+        util.assign(n, 0.0f); scratch.resize(n);
+        return true;
+    }
+
+    uint64_t sumBusy = 0, sumTotal = 0;
+    uint64_t classBusy[kMaxCoreClasses] = {}, classTotal[kMaxCoreClasses] = {};
+    float mx = 0.0f;
+    const bool perClass = topo.Hybrid() && cur.ids.size() == n;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t db = cur.busy[i] >= prevBusy[i] ? cur.busy[i] - prevBusy[i] : 0;
+        uint64_t dt = cur.total[i] >= prevTotal[i] ? cur.total[i] - prevTotal[i] : 0;
+        if (db > dt) db = dt;
+        float u = dt ? 100.0f * (float)db / (float)dt : 0.0f;
+        util[i] = u;
+        mx = std::max(mx, u);
+        sumBusy += db; sumTotal += dt;
+        if (perClass) {
+            uint8_t c = topo.ClassOf(cur.ids[i]);
+            classBusy[c] += db; classTotal[c] += dt;
+            out.classMaxCore[c] = std::max(out.classMaxCore[c], (double)u);
+        }
+    }
+    prevBusy.swap(cur.busy); prevTotal.swap(cur.total);
+
+    size_t k = std::min<size_t>((size_t)topK, n);
+    std::copy(util.begin(), util.end(), scratch.begin());
+    std::nth_element(scratch.begin(), scratch.begin() + (k - 1), scratch.end(), std::greater<float>());
+    double top = 0.0;
+    for (size_t i = 0; i < k; ++i) top += scratch[i];
+
+    out.aggregate = sumTotal ? 100.0 * (double)sumBusy / (double)sumTotal : 0.0;
+    out.maxCore = mx;
+    if (perClass) {
+        for (int c = 0; c < topo.classes; ++c)
+            out.classAggregate[c] = classTotal[c] ? 100.0 * (double)classBusy[c] / (double)classTotal[c] : 0.0;
+    }
+    else { out.classAggregate[0] = out.aggregate; out.classMaxCore[0] = mx; }
+    out.topKMean = k ? top / (double)k : 0.0;
+    return true;
+}
@@ -0,0 +1,75 @@
+// CpuSampler.h
+// Per-logical-processor CPU sampling. Cumulative counters and per-core deltas are kept as
+// struct-of-arrays so one pass over contiguous arrays yields aggregate, max-core and top-k load.
+
+#pragma once
+
+#include "CpuTopology.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One sample's summary, all 0..100%.
+struct CpuLoad {
+    double aggregate = 0.0;   // whole machine (what GetSystemTimes reports)
+    double maxCore = 0.0;     // busiest logical processor
+    double topKMean = 0.0;    // mean of the k busiest logical processors
+    int    cores = 0;
+    int    classes = 1;                                 // per-class figures below, with SetTopology
+    double classAggregate[kMaxCoreClasses] = {};        // 0 = most efficient class
+    double classMaxCore[kMaxCoreClasses] = {};
+};
+
+// Cumulative busy/total ticks per logical processor (units are backend-defined).
+struct CoreTimes {
+    std::vector<uint64_t> busy;
+    std::vector<uint64_t> total;
+    std::vector<uint32_t> ids;    // logical processor id per entry (offline CPUs leave gaps)
+};
+
+struct ICoreTimesSource {
+    virtual ~ICoreTimesSource() = default;
+    virtual bool Read(CoreTimes& out) = 0;
+};
+
+#ifdef _WIN32
+// NtQuerySystemInformation(SystemProcessorPerformanceInformation), every processor group; the whole
+// machine as one core from GetSystemTimes where that query is unavailable or fails.
+class NtCoreTimesSource : public ICoreTimesSource {
+public:
+    NtCoreTimesSource();
+    bool Read(CoreTimes& out) override;
+private:
+    void* query = nullptr;    // NtQuerySystemInformationEx
+    std::vector<uint8_t> buf;
+};
+#endif
+
+// /proc/stat "cpuN" lines; the path is injectable for fixtures.
+class ProcStatCoreTimesSource : public ICoreTimesSource {
+public:
+    explicit ProcStatCoreTimesSource(std::string path = "/proc/stat") : path(std::move(path)) {}
+    bool Read(CoreTimes& out) override;
+private:
+    std::string path;
+};
+
+class PerCoreCpuSampler {
+public:
+    explicit PerCoreCpuSampler(ICoreTimesSource& src, int topK = 2) : src(src), topK(topK < 1 ? 1 : topK) {}
+
+    // First call primes the counters and reports zero load.
+    bool Sample(CpuLoad& out);
+    const std::vector<float>& CoreUtil() const { return util; }   // last per-core %, by index
+    void SetTopK(int k) { topK = k < 1 ? 1 : k; }
+    void SetTopology(const CpuTopology& t) { topo = t; }
+
+private:
+    ICoreTimesSource& src;
+    int topK;
+    CpuTopology topo;
+    CoreTimes cur;
+    std::vector<uint64_t> prevBusy, prevTotal;
+    std::vector<float> util, scratch;
+};
@@ -0,0 +1,134 @@
+// CpuTopology.cpp
+// Efficiency-class detection: Win32 CPU sets and sysfs capacity / hybrid PMU lists.
+
+#include "CpuTopology.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+bool ParseCpuList(const char* text, std::vector<uint32_t>& out) {
+    out.clear();
+    const char* p = text;
+    while (*p && *p != '\n') {
+        char* end = nullptr;
+        unsigned long lo = strtoul(p, &end, 10), hi = lo;
+        if (end == p) return false;
+        p = end;
+        if (*p == '-') {
+            ++p;
+            hi = strtoul(p, &end, 10);
+            if (end == p || hi < lo || hi - lo > 65535) return false;
+            p = end;
+        }
+        for (unsigned long c = lo; c <= hi; ++c) out.push_back((uint32_t)c);
+        if (*p == ',') ++p;
+        else if (*p && *p != '\n') return false;
+    }
+    return true;
+}
+
+void RankCoreClasses(const std::vector<uint32_t>& raw, const std::vector<bool>& present, CpuTopology& out) {
+    std::vector<uint32_t> levels;
+    for (size_t i = 0; i < raw.size(); ++i) if (present[i]) levels.push_back(raw[i]);
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+    out.classes = std::max(1, std::min((int)levels.size(), kMaxCoreClasses));
+    out.classOf.assign(raw.size(), 0);
+    std::fill(std::begin(out.count), std::end(out.count), 0u);
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (!present[i]) continue;
+        int c = (int)(std::lower_bound(levels.begin(), levels.end(), raw[i]) - levels.begin());
+        out.classOf[i] = (uint8_t)std::min(c, kMaxCoreClasses - 1);
+        ++out.count[out.classOf[i]];
+    }
+    // Absent ids (offline, gaps) take the fastest class: mis-capping a P-core costs more than
+    // leaving an E-core uncapped.
+    for (size_t i = 0; i < raw.size(); ++i) if (!present[i]) out.classOf[i] = (uint8_t)(out.classes - 1);
+}
+
+#ifdef _WIN32
+bool ReadCpuTopology(CpuTopology& out) {
+    out = CpuTopology{};
+    ULONG len = 0;
+    GetSystemCpuSetInformation(nullptr, 0, &len, GetCurrentProcess(), 0);
+    if (!len) return false;
+    std::vector<uint8_t> buf(len);
+    auto* first = reinterpret_cast<SYSTEM_CPU_SET_INFORMATION*>(buf.data());
+    if (!GetSystemCpuSetInformation(first, len, &len, GetCurrentProcess(), 0)) return false;
+
+    std::vector<uint32_t> raw;
+    std::vector<bool> present;
+    for (size_t off = 0; off < len;) {
+        auto* p = reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION*>(buf.data() + off);
+        if (!p->Size) break;
+        if (p->Type == CpuSetInformation) {
+            uint32_t id = (uint32_t)p->CpuSet.Group * 64 + p->CpuSet.LogicalProcessorIndex;
+            if (raw.size() <= id) { raw.resize(id + 1, 0); present.resize(id + 1, false); }
+            raw[id] = p->CpuSet.EfficiencyClass;
+            present[id] = true;
+        }
+        off += p->Size;
+    }
+    if (raw.empty()) return false;
+    RankCoreClasses(raw, present, out);
+    out.source = "cpu-sets";
+    return true;
+}
+#endif
+
+static bool ReadFileText(const std::string& path, std::string& text) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool ReadSysfsCpuTopology(const std::string& root, CpuTopology& out) {
+    out = CpuTopology{};
+    const std::string base = root + "/devices/system/cpu";
+    std::string text;
+    std::vector<uint32_t> ids;
+    if (!ReadFileText(base + "/present", text) || !ParseCpuList(text.c_str(), ids) || ids.empty()) return false;
+    const uint32_t n = *std::max_element(ids.begin(), ids.end()) + 1;
+
+    std::vector<uint32_t> raw(n, 0);
+    std::vector<bool> present(n, false);
+
+    // Capacity first: it is what the scheduler itself uses (1024 = the fastest core).
+    bool capacity = true;
+    for (uint32_t id : ids) {
+        if (!ReadFileText(base + "/cpu" + std::to_string(id) + "/cpu_capacity", text)) { capacity = false; break; }
+        raw[id] = (uint32_t)strtoul(text.c_str(), nullptr, 10);
+        present[id] = true;
+    }
+    if (capacity) {
+        RankCoreClasses(raw, present, out);
+        out.source = "cpu_capacity";
+        return true;
+    }
+
+    // Intel hybrid: one PMU per core type, each listing its CPUs.
+    std::vector<uint32_t> atom, core;
+    if (ReadFileText(root + "/devices/cpu_atom/cpus", text) && ParseCpuList(text.c_str(), atom) &&
+        ReadFileText(root + "/devices/cpu_core/cpus", text) && ParseCpuList(text.c_str(), core)) {
+        std::fill(present.begin(), present.end(), false);
+        for (uint32_t id : atom) if (id < n) { raw[id] = 0; present[id] = true; }
+        for (uint32_t id : core) if (id < n) { raw[id] = 1; present[id] = true; }
+        RankCoreClasses(raw, present, out);
+        out.source = "cpu_atom/cpu_core";
+        return true;
+    }
+
+    // Homogeneous.
+    std::fill(present.begin(), present.end(), false);
+    for (uint32_t id : ids) present[id] = true;
+    RankCoreClasses(std::vector<uint32_t>(n, 0), present, out);
+    out.source = "homogeneous";
+    return true;
+}
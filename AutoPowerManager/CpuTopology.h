@@ -0,0 +1,42 @@
+// CpuTopology.h
+// Core efficiency classes on hybrid CPUs (P-cores / E-cores, big.LITTLE). Class 0 is the most
+// efficient; the highest class is the fastest. Windows exposes two classes of processor settings
+// (the base setting for class 0, the "Class 1" variants for the rest), so profiles carry separate
+// limits per class and the sampler reports utilization per class.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr int kMaxCoreClasses = 4;
+
+struct CpuTopology {
+    std::vector<uint8_t> classOf;                 // by logical processor id (group * 64 + index on Win32)
+    uint32_t             count[kMaxCoreClasses] = {};
+    int                  classes = 1;
+    const char*          source = "none";          // where the classes came from (static string)
+
+    bool    Hybrid() const { return classes > 1; }
+    uint8_t ClassOf(uint32_t id) const { return id < classOf.size() ? classOf[id] : (uint8_t)(classes - 1); }
+    // The two classes the power settings can address: 0 = efficiency, 1 = everything faster.
+    bool    Performance(uint32_t id) const { return ClassOf(id) > 0; }
+};
+
+// "0-3,8,10-11\n" -> {0,1,2,3,8,10,11}. False on malformed input.
+bool ParseCpuList(const char* text, std::vector<uint32_t>& out);
+
+// Ranks raw per-CPU values (EfficiencyClass, cpu_capacity) into dense classes, lowest = 0.
+// Values past kMaxCoreClasses distinct levels share the top class.
+void RankCoreClasses(const std::vector<uint32_t>& raw, const std::vector<bool>& present, CpuTopology& out);
+
+#ifdef _WIN32
+// GetSystemCpuSetInformation: EfficiencyClass per logical processor.
+bool ReadCpuTopology(CpuTopology& out);
+#endif
+
+// root/devices/system/cpu/cpuN/cpu_capacity (arm64, and x86 hybrid on newer kernels), else the
+// hybrid PMU lists root/devices/cpu_atom/cpus and root/devices/cpu_core/cpus (Intel). Plain file
+// parsing, so it builds everywhere and runs against captured sysfs fixtures.
+bool ReadSysfsCpuTopology(const std::string& root, CpuTopology& out);
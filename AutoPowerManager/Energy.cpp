@@ -0,0 +1,313 @@
+// Energy.cpp
+// Energy meters (battery discharge / RAPL) and the per-profile, per-app ledger.
+
+#include "Energy.h"
+#include "PlatformTypes.h"
+#include "ProcessScanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+
+#ifdef _WIN32
+#include <powrprof.h>
+#pragma comment(lib, "PowrProf.lib")
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// ---------- Battery meter ----------
+#ifndef BATTERY_UNKNOWN_RATE
+#define BATTERY_UNKNOWN_RATE 0x80000000
+#endif
+
+bool BatteryEnergySource::Read(uint64_t nowMs, double& joules) {
+    SYSTEM_BATTERY_STATE st{};
+    const bool valid = CallNtPowerInformation(SystemBatteryState, nullptr, 0, &st, sizeof(st)) == 0 &&
+        st.BatteryPresent && st.Discharging && !st.AcOnLine && st.Rate != BATTERY_UNKNOWN_RATE && (LONG)st.Rate < 0;
+    const double mw = valid ? -(double)(LONG)st.Rate : 0.0;
+    bool ok = false;
+    if (valid && primed && nowMs > lastMs) {
+        joules = 0.5 * (mw + lastMw) * (double)(nowMs - lastMs) / 1e6;   // mW * ms = uJ; trapezoid
+        ok = true;
+    }
+    primed = valid; lastMs = nowMs; lastMw = mw;
+    return ok;
+}
+#endif
+
+#ifndef _WIN32
+// ---------- RAPL meter ----------
+static bool ReadU64(const std::string& path, uint64_t& v) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    char text[32];
+    ssize_t k = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (k <= 0) return false;
+    text[k] = 0;
+    char* end = nullptr;
+    v = strtoull(text, &end, 10);
+    return end != text;
+}
+
+RaplEnergySource::RaplEnergySource(std::string root) : root(std::move(root)) {}
+
+void RaplEnergySource::Discover() {
+    discovered = true;
+    primed = false;
+    domains.clear();
+    const std::string dir = root + "/class/powercap";
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* de = readdir(d)) {
+            // Packages only: "intel-rapl:0", not "intel-rapl:0:0" (core, uncore, dram are inside it).
+            const char* n = de->d_name;
+            if (strncmp(n, "intel-rapl:", 11) || strchr(n + 11, ':')) continue;
+            Domain dom;
+            dom.energy = dir + "/" + n + "/energy_uj";
+            uint64_t e;
+            if (!ReadU64(dom.energy, e)) continue;
+            if (!ReadU64(dir + "/" + n + "/max_energy_range_uj", dom.rangeUj)) dom.rangeUj = 0;
+            domains.push_back(std::move(dom));
+        }
+        closedir(d);
+    }
+}
+
+bool RaplEnergySource::Read(uint64_t nowMs, double& joules) {
+    if (!discovered) Discover();
+    if (domains.empty()) {   // driver loaded later, or permissions changed: rescan once a minute at most
+        if (nowMs >= retryMs) { discovered = false; retryMs = nowMs + 60'000; }
+        return false;
+    }
+    uint64_t total = 0;
+    bool ok = primed;
+    for (Domain& d : domains) {
+        uint64_t e;
+        if (!ReadU64(d.energy, e)) { discovered = false; return false; }
+        if (e >= d.lastUj) total += e - d.lastUj;
+        else if (d.rangeUj && d.lastUj <= d.rangeUj) total += d.rangeUj - d.lastUj + e;   // wrapped once
+        else ok = false;                                                                   // reset: can't tell
+        d.lastUj = e;
+    }
+    primed = true;
+    if (ok) joules = total / 1e6;
+    return ok;
+}
+#endif
+
+// ---------- Ledger ----------
+EnergyLedger::Counter EnergyLedger::App::Total() const {
+    Counter c;
+    for (const Counter& p : byProfile) { c.mJ += p.mJ; c.ms += p.ms; }
+    return c;
+}
+
+int EnergyLedger::BandOf(double cpuPct) {
+    return cpuPct < 10.0 ? 0 : cpuPct < 30.0 ? 1 : cpuPct < 60.0 ? 2 : 3;
+}
+
+void EnergyLedger::Clear() {
+    const ProcProfile p = profile;
+    const bool a = attributed;
+    const uint64_t last = lastMs;
+    *this = EnergyLedger();
+    profile = p; attributed = a; lastMs = last;   // keep charging the running interval
+}
+
+static bool SameName(const wchar_t* slot, const std::wstring& app) {
+    const size_t n = std::min(app.size(), EnergyLedger::kNameLen);
+    return wcsncmp(slot, app.c_str(), n) == 0 && slot[n] == 0;
+}
+
+size_t EnergyLedger::Slot(const std::wstring& app) {
+    if (current < used && SameName(apps[current].name, app)) return current;
+    for (size_t i = 0; i < used; ++i) if (SameName(apps[i].name, app)) return i;
+    size_t i = used;
+    if (used < kApps) ++used;
+    else {
+        // Full: the app that has cost the least so far makes room; its totals go to "other".
+        i = 0;
+        for (size_t j = 1; j < kApps; ++j) if (apps[j].Total().mJ < apps[i].Total().mJ) i = j;
+        App& o = apps[kApps];
+        if (!otherUsed) { otherUsed = true; wmemcpy(o.name, L"(other)", 8); }
+        for (int p = 0; p < 3; ++p) { o.byProfile[p].mJ += apps[i].byProfile[p].mJ; o.byProfile[p].ms += apps[i].byProfile[p].ms; }
+        apps[i] = App();
+    }
+    const size_t n = std::min(app.size(), kNameLen);
+    wmemcpy(apps[i].name, app.c_str(), n);
+    apps[i].name[n] = 0;
+    return i;
+}
+
+void EnergyLedger::Charge(uint64_t nowMs, double joules, bool metered, double cpuPct) {
+    const uint64_t dt = attributed && nowMs > lastMs ? nowMs - lastMs : 0;
+    lastMs = nowMs;
+    if (!dt) return;
+    const int p = (int)profile;
+    if (!metered) { unmeteredMs[p] += dt; return; }
+    const uint64_t mJ = (uint64_t)std::llround(std::max(0.0, joules) * 1000.0);
+    Counter& b = bands[p][BandOf(cpuPct)];
+    b.mJ += mJ; b.ms += dt;
+    Counter& a = apps[current].byProfile[p];
+    a.mJ += mJ; a.ms += dt;
+}
+
+void EnergyLedger::Attribute(ProcProfile p, const std::wstring& app) {
+    profile = p;
+    current = Slot(app);
+    attributed = true;
+}
+
+EnergyLedger::Counter EnergyLedger::Profile(ProcProfile p) const {
+    Counter c;
+    for (const Counter& b : bands[(int)p]) { c.mJ += b.mJ; c.ms += b.ms; }
+    return c;
+}
+
+double EnergyLedger::MeteredWh() const {
+    double wh = 0.0;
+    for (int p = 0; p < 3; ++p) wh += Profile((ProcProfile)p).Wh();
+    return wh;
+}
+
+bool EnergyLedger::AlwaysBoostWh(double& wh) const {
+    const uint64_t kMinMs = 60'000;
+    const Counter boost = Profile(ProcProfile::Boost);
+    if (boost.ms < kMinMs) return false;
+    double mJ = 0.0;
+    for (int b = 0; b < kBands; ++b) {
+        const Counter& bb = bands[(int)ProcProfile::Boost][b];
+        const double w = bb.ms >= kMinMs ? bb.MeanW() : boost.MeanW();
+        uint64_t ms = 0;
+        for (int p = 0; p < 3; ++p) ms += bands[p][b].ms;
+        mJ += w * (double)ms;
+    }
+    wh = mJ / 3.6e6;
+    return true;
+}
+
+// Fixed layout: names as UTF-16 code units, so a file is the same size on every platform.
+namespace {
+const uint32_t kMagic = 0x45504D41;   // "AMPE"
+const uint32_t kVersion = 1;
+}
+
+bool EnergyLedger::Save(FILE* f) const {
+    uint32_t hdr[5] = { kMagic, kVersion, (uint32_t)kBands, (uint32_t)kApps, (uint32_t)kNameLen };
+    if (fwrite(hdr, sizeof(hdr), 1, f) != 1) return false;
+    uint64_t head[3 * kBands * 2 + 3 + 2];
+    size_t k = 0;
+    for (int p = 0; p < 3; ++p)
+        for (int b = 0; b < kBands; ++b) { head[k++] = bands[p][b].mJ; head[k++] = bands[p][b].ms; }
+    for (int p = 0; p < 3; ++p) head[k++] = unmeteredMs[p];
+    head[k++] = used;
+    head[k++] = otherUsed ? 1 : 0;
+    if (fwrite(head, sizeof(head), 1, f) != 1) return false;
+    for (const App& a : apps) {
+        uint16_t name[kNameLen + 1];
+        for (size_t i = 0; i <= kNameLen; ++i) name[i] = (uint16_t)a.name[i];
+        uint64_t c[6];
+        for (int p = 0; p < 3; ++p) { c[2 * p] = a.byProfile[p].mJ; c[2 * p + 1] = a.byProfile[p].ms; }
+        if (fwrite(name, sizeof(name), 1, f) != 1 || fwrite(c, sizeof(c), 1, f) != 1) return false;
+    }
+    return true;
+}
+
+bool EnergyLedger::Load(FILE* f) {
+    uint32_t hdr[5];
+    if (fread(hdr, sizeof(hdr), 1, f) != 1) return false;
+    if (hdr[0] != kMagic || hdr[1] != kVersion || hdr[2] != kBands || hdr[3] != kApps || hdr[4] != kNameLen) return false;
+    uint64_t head[3 * kBands * 2 + 3 + 2];
+    if (fread(head, sizeof(head), 1, f) != 1) return false;
+    App loaded[kApps + 1];
+    for (App& a : loaded) {
+        uint16_t name[kNameLen + 1];
+        uint64_t c[6];
+        if (fread(name, sizeof(name), 1, f) != 1 || fread(c, sizeof(c), 1, f) != 1) return false;
+        for (size_t i = 0; i <= kNameLen; ++i) a.name[i] = (wchar_t)name[i];
+        a.name[kNameLen] = 0;
+        for (int p = 0; p < 3; ++p) { a.byProfile[p].mJ = c[2 * p]; a.byProfile[p].ms = c[2 * p + 1]; }
+    }
+    if (head[3 * kBands * 2 + 3] > kApps) return false;
+    size_t k = 0;
+    for (int p = 0; p < 3; ++p)
+        for (int b = 0; b < kBands; ++b) { bands[p][b].mJ = head[k++]; bands[p][b].ms = head[k++]; }
+    for (int p = 0; p < 3; ++p) unmeteredMs[p] = head[k++];
+    used = (size_t)head[k++];
+    otherUsed = head[k++] != 0;
+    std::copy(std::begin(loaded), std::end(loaded), apps);
+    current = 0;
+    attributed = false;   // the next Attribute starts a fresh interval
+    return true;
+}
+
+// ---------- Attribution & report ----------
+const std::wstring& ChargedApp(const GovernorSignals& s, const ProcessScanner& scanner, const std::wstring& fgName) {
+    static const std::wstring none;
+    const BackgroundLoad& bg = scanner.Result();
+    if (s.bgHeavy && !s.fgHeavy && bg.heavyPid)
+        if (const ProcessScanner::Entry* e = scanner.Find(bg.heavyPid)) return e->name;
+    if (!fgName.empty()) return fgName;
+    if (s.bgBusy && bg.topPid)
+        if (const ProcessScanner::Entry* e = scanner.Find(bg.topPid)) return e->name;
+    return none;
+}
+
+static void Appendf(std::string& out, const char* fmt, ...) {
+    char line[200];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    out += line;
+}
+
+static std::string Narrow(const wchar_t* w) {
+    std::string s;
+    for (; *w; ++w) s += *w < 0x80 ? (char)*w : '?';   // image names are nearly always ASCII
+    return s;
+}
+
+std::string FormatEnergyReport(const EnergyLedger& l, const char* source) {
+    std::string out;
+    const double total = l.MeteredWh();
+    uint64_t meteredMs = 0, unmeteredMs = 0;
+    for (int p = 0; p < 3; ++p) { meteredMs += l.Profile((ProcProfile)p).ms; unmeteredMs += l.UnmeteredMs((ProcProfile)p); }
+    Appendf(out, "Energy (%s): %.2f Wh over %.1f h metered, %.1f h unmetered\n\n", source, total,
+            meteredMs / 3'600'000.0, unmeteredMs / 3'600'000.0);
+
+    Appendf(out, "By profile:\n");
+    for (int p = 0; p < 3; ++p) {
+        const EnergyLedger::Counter c = l.Profile((ProcProfile)p);
+        Appendf(out, "  %-9s %8.2f Wh %5.1f%%  %7.1f h  %6.2f W mean\n", ProfileNameA((ProcProfile)p), c.Wh(),
+                total > 0 ? 100.0 * c.Wh() / total : 0.0, c.ms / 3'600'000.0, c.MeanW());
+    }
+
+    Appendf(out, "\nBy app (Boost share of its energy):\n");
+    std::vector<size_t> order;
+    for (size_t i = 0; i < l.Apps(); ++i) if (l.AppAt(i).Total().ms) order.push_back(i);
+    std::sort(order.begin(), order.end(), [&l](size_t a, size_t b) { return l.AppAt(a).Total().mJ > l.AppAt(b).Total().mJ; });
+    for (size_t i : order) {
+        const EnergyLedger::App& a = l.AppAt(i);
+        const EnergyLedger::Counter c = a.Total();
+        const std::string name = a.name[0] ? Narrow(a.name) : "(none)";
+        Appendf(out, "  %-24s %8.2f Wh %5.1f%%  %7.1f h  boost %3.0f%%\n", name.c_str(), c.Wh(),
+                total > 0 ? 100.0 * c.Wh() / total : 0.0, c.ms / 3'600'000.0,
+                c.mJ ? 100.0 * a.byProfile[(int)ProcProfile::Boost].mJ / c.mJ : 0.0);
+    }
+
+    double boostWh = 0.0;
+    if (l.AlwaysBoostWh(boostWh))
+        Appendf(out, "\nAlways-Boost estimate: %.2f Wh; saved %.2f Wh (%.1f%%)\n", boostWh, boostWh - total,
+                boostWh > 0 ? 100.0 * (boostWh - total) / boostWh : 0.0);
+    else
+        Appendf(out, "\nAlways-Boost estimate: needs at least a minute of metered Boost\n");
+    return out;
+}
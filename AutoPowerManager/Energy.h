@@ -0,0 +1,135 @@
+// Energy.h
+// Energy accounting: what each profile and each app costs. A meter reports the energy used since
+// its previous reading. On Linux that is the RAPL package counters, and on Windows the battery
+// discharge rate (battery only). The ledger charges each interval to the profile that was applied
+// and to the app responsible for the load, in fixed-size counters, so accounting never allocates
+// and the saved file has a fixed size.
+//
+// The savings estimate compares against always-Boost. Boost's measured mean power in each CPU-load
+// band, times all the time spent in that band, is what Boost would have used; the difference from
+// what was measured is the saving. It is an estimate: Boost's power at a given load is measured
+// only while the governor chose Boost.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class ProcessScanner;
+
+struct IEnergySource {
+    virtual ~IEnergySource() = default;
+    // Joules used since the previous call. False when unknown: the first call, no readable meter,
+    // or (battery meter) while on AC.
+    virtual bool Read(uint64_t nowMs, double& joules) = 0;
+    virtual const char* Name() const = 0;
+};
+
+#ifdef _WIN32
+// CallNtPowerInformation(SystemBatteryState): the discharge rate (mW) while on battery, integrated
+// between readings. Whole-system power, not just the package.
+class BatteryEnergySource : public IEnergySource {
+public:
+    bool Read(uint64_t nowMs, double& joules) override;
+    const char* Name() const override { return "battery"; }
+private:
+    bool     primed = false;
+    uint64_t lastMs = 0;
+    double   lastMw = 0.0;
+};
+#endif
+
+#ifndef _WIN32
+// RAPL package domains under /sys/class/powercap (intel-rapl:N, summed over packages; the
+// intel-rapl:N:M subdomains are inside them). energy_uj wraps at max_energy_range_uj; an interval
+// whose wrap can't be unwrapped is dropped rather than guessed. energy_uj is root-only on current
+// kernels. root is injectable for fixture trees.
+class RaplEnergySource : public IEnergySource {
+public:
+    explicit RaplEnergySource(std::string root = "/sys");
+    bool Read(uint64_t nowMs, double& joules) override;
+    const char* Name() const override { return "rapl"; }
+    size_t Domains() const { return domains.size(); }
+
+private:
+    struct Domain {
+        std::string energy;        // .../intel-rapl:N/energy_uj
+        uint64_t    rangeUj = 0;   // max_energy_range_uj; 0 unknown
+        uint64_t    lastUj = 0;
+    };
+    void Discover();
+
+    std::string         root;
+    std::vector<Domain> domains;
+    bool                discovered = false;
+    bool                primed = false;
+    uint64_t            retryMs = 0;   // nothing readable: rescan no sooner than this
+};
+#endif
+
+class EnergyLedger {
+public:
+    static constexpr int    kBands = 4;        // interval CPU load: <10%, <30%, <60%, >=60%
+    static constexpr size_t kApps = 32;        // then the least-charged app is folded into "other"
+    static constexpr size_t kNameLen = 23;
+
+    struct Counter {
+        uint64_t mJ = 0;                       // metered energy
+        uint64_t ms = 0;                       // the time it covers
+        double Wh() const { return mJ / 3.6e6; }
+        double MeanW() const { return ms ? (double)mJ / (double)ms : 0.0; }
+    };
+    struct App {
+        wchar_t name[kNameLen + 1] = {};       // normalized image name; empty: no app
+        Counter byProfile[3];
+        Counter Total() const;
+    };
+
+    // Charges the interval since the previous call to the profile and app set by Attribute, at the
+    // interval's mean CPU load. Call once per tick, before Attribute.
+    void Charge(uint64_t nowMs, double joules, bool metered, double cpuPct);
+    // The profile and app responsible from now on.
+    void Attribute(ProcProfile p, const std::wstring& app);
+    void Clear();
+
+    Counter        Profile(ProcProfile p) const;
+    const Counter& Band(ProcProfile p, int band) const { return bands[(int)p][band]; }
+    uint64_t       UnmeteredMs(ProcProfile p) const { return unmeteredMs[(int)p]; }
+    size_t         Apps() const { return used + (otherUsed ? 1 : 0); }   // "other" last, once used
+    const App&     AppAt(size_t i) const { return i < used ? apps[i] : apps[kApps]; }
+    static int     BandOf(double cpuPct);
+
+    double MeteredWh() const;
+    // What always-Boost would have used over the metered time; false without enough Boost samples
+    // (a minute in a band, else a minute overall) to estimate it.
+    bool   AlwaysBoostWh(double& wh) const;
+
+    bool Save(FILE* f) const;
+    bool Load(FILE* f);                        // false (and unchanged) on a foreign or truncated file
+
+private:
+    size_t Slot(const std::wstring& app);
+
+    Counter          bands[3][kBands];
+    uint64_t         unmeteredMs[3] = {};
+    App              apps[kApps + 1];          // [kApps]: "other"
+    size_t           used = 0;
+    bool             otherUsed = false;
+    size_t           current = 0;              // app slot being charged
+    ProcProfile      profile = ProcProfile::Balanced;
+    bool             attributed = false;
+    uint64_t         lastMs = 0;
+};
+
+// The app charged for the next interval: a heavy app computing in the background while the
+// foreground app isn't heavy (it is what holds Boost), else the foreground app, else (no foreground,
+// as in the daemon) the busiest process when one is busy.
+const std::wstring& ChargedApp(const GovernorSignals& s, const ProcessScanner& scanner, const std::wstring& fgName);
+
+// Multi-line text report: Wh per profile and per app (most first), unmetered time and the savings
+// estimate. source names the meter (or the file it was read from).
+std::string FormatEnergyReport(const EnergyLedger& l, const char* source);
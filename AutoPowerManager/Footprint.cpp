@@ -0,0 +1,66 @@
+// Footprint.cpp
+// GetProcessTimes / GetProcessMemoryInfo, or /proc/self/{stat,status} and getrusage.
+
+#include "Footprint.h"
+#include "PlatformTypes.h"
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool ReadProcessFootprint(ProcessFootprint& out) {
+    out = ProcessFootprint{};
+    FILETIME created, exited, kernel, user, now;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        GetSystemTimePreciseAsFileTime(&now);
+        ULARGE_INTEGER c{ created.dwLowDateTime, created.dwHighDateTime }, n{ now.dwLowDateTime, now.dwHighDateTime };
+        out.sinceStartMs = (double)(n.QuadPart - c.QuadPart) / 10'000.0;
+        ULARGE_INTEGER k{ kernel.dwLowDateTime, kernel.dwHighDateTime }, u{ user.dwLowDateTime, user.dwHighDateTime };
+        out.cpuMs = (double)(k.QuadPart + u.QuadPart) / 10'000.0;
+    }
+    PROCESS_MEMORY_COUNTERS_EX pmc{};
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc))) return out.sinceStartMs >= 0;
+    out.rssKB = pmc.WorkingSetSize / 1024;
+    out.peakRssKB = pmc.PeakWorkingSetSize / 1024;
+    out.privateKB = pmc.PrivateUsage / 1024;
+    return true;
+}
+#else
+bool ReadProcessFootprint(ProcessFootprint& out) {
+    out = ProcessFootprint{};
+    char text[1024];
+    // starttime (field 22) is in clock ticks since boot, the same base as CLOCK_BOOTTIME.
+    if (FILE* f = fopen("/proc/self/stat", "r")) {
+        size_t n = fread(text, 1, sizeof(text) - 1, f);
+        fclose(f);
+        text[n] = 0;
+        const char* p = strrchr(text, ')');   // comm may contain spaces
+        for (int field = 2; p && field < 22; ++field) p = strchr(p + 1, ' ');
+        timespec ts;
+        const long hz = sysconf(_SC_CLK_TCK);
+        if (p && hz > 0 && clock_gettime(CLOCK_BOOTTIME, &ts) == 0)
+            out.sinceStartMs = (ts.tv_sec + ts.tv_nsec / 1e9 - strtod(p + 1, nullptr) / hz) * 1000.0;
+    }
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        out.cpuMs = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) return out.sinceStartMs >= 0;
+    while (fgets(text, sizeof(text), f)) {
+        unsigned long long kb = 0;
+        if (sscanf(text, "VmRSS: %llu", &kb) == 1) out.rssKB = kb;
+        else if (sscanf(text, "VmHWM: %llu", &kb) == 1) out.peakRssKB = kb;
+        else if (sscanf(text, "RssAnon: %llu", &kb) == 1) out.privateKB = kb;
+    }
+    fclose(f);
+    return true;
+}
+#endif
@@ -0,0 +1,18 @@
+// Footprint.h
+// Startup time, resident memory and CPU time of the running process, so the tray app and the
+// headless daemon can be compared on the same machine (the tray's latency report, the daemon's
+// "stats"), and the governor's own CPU cost can be read off a running instance.
+
+#pragma once
+
+#include <cstdint>
+
+struct ProcessFootprint {
+    double   sinceStartMs = -1.0;   // process creation -> the call (loader included); <0 unknown
+    uint64_t rssKB = 0;             // working set / VmRSS
+    uint64_t peakRssKB = 0;         // peak working set / VmHWM
+    uint64_t privateKB = 0;         // private commit (Win32) / anonymous resident (Linux)
+    double   cpuMs = 0.0;           // user + kernel CPU time so far, all threads
+};
+
+bool ReadProcessFootprint(ProcessFootprint& out);
@@ -0,0 +1,98 @@
+// ForegroundTracker.cpp
+// Foreground identity cache and the Win32 process inspector.
+
+#include "ForegroundTracker.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cwctype>
+
+#ifdef _WIN32
+// ---------- Win32 inspector ----------
+bool Win32ProcessInspector::CreationTime(uint32_t pid, uint64_t& t) {
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return false;
+    FILETIME c, e, k, u;
+    bool ok = GetProcessTimes(h, &c, &e, &k, &u) != 0;
+    if (ok) t = ((uint64_t)c.dwHighDateTime << 32) | c.dwLowDateTime;
+    CloseHandle(h);
+    return ok;
+}
+
+bool Win32ProcessInspector::ImagePath(uint32_t pid, std::wstring& path) {
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return false;
+    wchar_t buf[MAX_PATH]; DWORD sz = MAX_PATH;
+    bool ok = QueryFullProcessImageNameW(h, 0, buf, &sz) != 0;
+    if (ok) path.assign(buf, sz);
+    CloseHandle(h);
+    return ok;
+}
+#endif
+
+std::wstring NormalizeImageName(const std::wstring& path) {
+    size_t p = path.find_last_of(L"\\/");
+    std::wstring s = (p == std::wstring::npos) ? path : path.substr(p + 1);
+    std::transform(s.begin(), s.end(), s.begin(), ::towlower);
+    if (s.size() > 4 && s.compare(s.size() - 4, 4, L".exe") == 0) s.resize(s.size() - 4);
+    return s;
+}
+
+// ---------- Tracker ----------
+ForegroundTracker::ForegroundTracker(IProcessInspector& inspector, size_t capacity)
+    : inspector(inspector), capacity(capacity ? capacity : 1) {
+    entries.reserve(this->capacity);
+}
+
+const std::wstring& ForegroundTracker::ForegroundName() const {
+    static const std::wstring empty;
+    return current >= 0 ? entries[current].name : empty;
+}
+
+int ForegroundTracker::Find(uint32_t pid, uint64_t created) const {
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].pid == pid && entries[i].created == created) return (int)i;
+    return -1;
+}
+
+int ForegroundTracker::Victim() const {
+    int v = 0;
+    for (size_t i = 1; i < entries.size(); ++i)
+        if (entries[i].lastUsed < entries[v].lastUsed) v = (int)i;
+    return v;
+}
+
+void ForegroundTracker::OnForegroundChanged(uint32_t pid) {
+    ++stats.events;
+    if (!pid) { current = -1; return; }
+
+    uint64_t created = 0;
+    if (!inspector.CreationTime(pid, created)) {   // protected / already gone
+        ++stats.lookupFailures; current = -1; return;
+    }
+    int i = Find(pid, created);
+    if (i >= 0) {
+        ++stats.hits;
+        entries[i].lastUsed = ++clock;
+        current = i;
+        return;
+    }
+
+    ++stats.misses;
+    std::wstring path;
+    if (!inspector.ImagePath(pid, path)) { ++stats.lookupFailures; current = -1; return; }
+
+    Entry e;
+    e.pid = pid; e.created = created; e.lastUsed = ++clock;
+    e.name = NormalizeImageName(path);
+    e.path = std::move(path);
+    e.match = rules.Match(e.name, e.path);
+    if (entries.size() < capacity) { entries.push_back(std::move(e)); i = (int)entries.size() - 1; }
+    else { i = Victim(); entries[i] = std::move(e); }
+    current = i;
+}
+
+void ForegroundTracker::SetRules(const AppRules& r) {
+    rules = r;
+    for (auto& e : entries) e.match = rules.Match(e.name, e.path);
+}
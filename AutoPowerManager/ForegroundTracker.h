@@ -0,0 +1,70 @@
+// ForegroundTracker.h
+// Foreground-app classification driven by change events rather than per-tick polling.
+// Results are cached by (PID, process creation time) so PID reuse can't return a stale answer,
+// and the steady-state tick only reads a bool.
+
+#pragma once
+
+#include "AppRules.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// OS lookups, only performed on a foreground change that misses the cache.
+struct IProcessInspector {
+    virtual ~IProcessInspector() = default;
+    virtual bool CreationTime(uint32_t pid, uint64_t& t) = 0;    // any unit, unique per process
+    virtual bool ImagePath(uint32_t pid, std::wstring& path) = 0;
+};
+
+#ifdef _WIN32
+// OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION) + GetProcessTimes / QueryFullProcessImageNameW.
+struct Win32ProcessInspector : IProcessInspector {
+    bool CreationTime(uint32_t pid, uint64_t& t) override;
+    bool ImagePath(uint32_t pid, std::wstring& path) override;
+};
+#endif
+
+// "C:\\Program Files\\MATLAB\\bin\\MATLAB.exe" -> "matlab"
+std::wstring NormalizeImageName(const std::wstring& path);
+
+class ForegroundTracker {
+public:
+    struct Stats { uint64_t events = 0, hits = 0, misses = 0, lookupFailures = 0; };
+
+    explicit ForegroundTracker(IProcessInspector& inspector, size_t capacity = 64);
+
+    // Event source (EVENT_SYSTEM_FOREGROUND hook, or a fake in tests) reports the new owner PID.
+    void OnForegroundChanged(uint32_t pid);
+
+    // Reclassifies cached entries from their stored names and paths; no process lookups.
+    void SetRules(const AppRules& r);
+
+    // The foreground app's rule for the power source, if any.
+    const AppRule*      ForegroundRule(bool onAC) const { return current >= 0 ? rules.Rule(entries[current].match, onAC) : nullptr; }
+    uint32_t            ForegroundPid() const { return current >= 0 ? entries[current].pid : 0; }
+    const std::wstring& ForegroundName() const;
+    const Stats&        GetStats() const { return stats; }
+
+private:
+    struct Entry {
+        uint32_t     pid = 0;
+        uint64_t     created = 0;
+        uint64_t     lastUsed = 0;
+        std::wstring name;      // normalized
+        std::wstring path;      // full image path, for path rules
+        AppMatch     match;
+    };
+
+    int  Find(uint32_t pid, uint64_t created) const;
+    int  Victim() const;
+
+    IProcessInspector&        inspector;
+    size_t                    capacity;
+    std::vector<Entry>        entries;
+    AppRules                  rules;
+    int                       current = -1;
+    uint64_t                  clock = 0;
+    Stats                     stats;
+};
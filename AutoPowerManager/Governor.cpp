@@ -0,0 +1,159 @@
+// Governor.cpp
+// Tier decision and profile selection, lifted out of the Win32 message loop.
+
+#include "Governor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+const char* ProfileNameA(ProcProfile p) {
+    return p == ProcProfile::Boost ? "Boost" : p == ProcProfile::Balanced ? "Balanced" : "Saver";
+}
+
+const char* TierNameA(ActivityTier t) {
+    return t == ActivityTier::Active ? "Active" : t == ActivityTier::Engaged ? "Engaged" : "Idle";
+}
+
+const char* TierReasonNameA(TierReason r) {
+    static const char* const names[] = { "input", "sticky", "fg-heavy", "bg-heavy", "cpu-active", "predicted",
+                                         "recent-input", "cpu-engaged", "bg-busy", "idle", "memory-bound" };
+    return (size_t)r < sizeof(names) / sizeof(names[0]) ? names[(size_t)r] : "?";
+}
+
+const char* ProfileReasonNameA(ProfileReason r) {
+    static const char* const names[] = { "low-battery", "locked", "active", "engaged-waiting", "engaged-residency",
+                                         "idle-waiting", "idle-residency", "app-rule", "runtime-target" };
+    return (size_t)r < sizeof(names) / sizeof(names[0]) ? names[(size_t)r] : "?";
+}
+
+// ---------- Input filtering ----------
+void Governor::SetConfig(const GovernorConfig& c) {
+    cfg = c;
+    cpuAgg.Configure(c.cpuFilter);
+    cpuMaxCore.Configure(c.cpuFilter);
+    cpuTopK.Configure(c.cpuFilter);
+    idle.Configure(c.idleFilter);
+    batt.Configure(c.battFilter);
+}
+
+// Filters s in place and updates the CPU comparators. Time-based stages see the real tick spacing
+// (clamped to a minute), so adaptive ticks keep the configured response.
+void Governor::FilterSignals(const GovernorSignals& raw, GovernorSignals& s) {
+    const double dtMs = lastTickMs && raw.nowMs > lastTickMs ? std::min<double>(60'000.0, (double)(raw.nowMs - lastTickMs)) : 1000.0;
+    lastTickMs = raw.nowMs;
+    s = raw;
+    cpuAgg.Update(raw.cpuPct, dtMs);
+    cpuMaxCore.Update(raw.cpuMaxCorePct, dtMs);
+    cpuTopK.Update(raw.cpuTopKPct, dtMs);
+    s.idleSec = (uint32_t)std::lround(std::max(0.0, idle.Update((double)raw.idleSec, dtMs)));
+    if (raw.battPct >= 0) s.battPct = (int)std::lround(batt.Update((double)raw.battPct, dtMs));
+
+    // Every comparator sees every tick (no short-circuit), or a skipped one would hold a stale state.
+    // The per-core thresholds are disabled at 0.
+    const double band = std::max(0.0, cfg.cpuHysteresisPct);
+    auto trip = [band](Hysteresis& h, double v, double threshold) { return h.Update(v, threshold, threshold - band); };
+    auto tripIf = [&trip](Hysteresis& h, double v, double threshold) { const bool on = trip(h, v, threshold); return threshold > 0.0 && on; };
+    const bool a0 = trip(activeCpu, cpuAgg.Value(), cfg.activeCpuPct);
+    const bool a1 = tripIf(activeMaxCore, cpuMaxCore.Value(), cfg.activeMaxCorePct);
+    const bool a2 = tripIf(activeTopK, cpuTopK.Value(), cfg.activeTopKPct);
+    const bool e0 = trip(engagedCpu, cpuAgg.Value(), cfg.engagedCpuPct);
+    const bool e1 = tripIf(engagedMaxCore, cpuMaxCore.Value(), cfg.engagedMaxCorePct);
+    cpuActive = a0 || a1 || a2;
+    cpuEngaged = e0 || e1;
+}
+
+// ---------- Sticky & tier ----------
+void Governor::UpdateBoostHold(const GovernorSignals& s) {
+    if (s.idleSec < cfg.inputIdleSec) boostHoldUntil = s.nowMs + cfg.stickyBoostMs;
+}
+
+ActivityTier Governor::DecideTier(const GovernorSignals& s, TierReason& why) const {
+    bool sticky = s.nowMs < boostHoldUntil;
+    // cpuActive / cpuEngaged come from FilterSignals. A single pinned thread barely moves the
+    // aggregate on a wide machine; per-core load catches it. Load that is waiting on memory doesn't
+    // run faster at a higher clock, so on its own it only counts as Engaged.
+    const bool loadActive = cpuActive && !s.memoryBound;
+    if (sticky || s.fgHeavy || s.bgHeavy || loadActive || s.idleSec < cfg.inputIdleSec) {
+        why = s.idleSec < cfg.inputIdleSec ? TierReason::Input : s.fgHeavy ? TierReason::ForegroundHeavy
+            : s.bgHeavy ? TierReason::BackgroundHeavy : loadActive ? TierReason::CpuActive : TierReason::StickyHold;
+        return ActivityTier::Active;
+    }
+    if (s.idleSec < cfg.engagedIdleSec || cpuActive || cpuEngaged || s.bgBusy) {
+        why = s.idleSec < cfg.engagedIdleSec ? TierReason::RecentInput : cpuActive ? TierReason::MemoryBound
+            : cpuEngaged ? TierReason::CpuEngaged : TierReason::BackgroundBusy;
+        return ActivityTier::Engaged;
+    }
+    why = TierReason::Idle;
+    return ActivityTier::Idle;
+}
+
+// ---------- Profile ----------
+ProcProfile Governor::DecideProfile(const GovernorSignals& s, ActivityTier t) {
+    const uint64_t now = s.nowMs;
+
+    // Hard overrides first; low battery holds until the charge is battHysteresisPct above the threshold.
+    // A runtime target replaces the threshold (its ceiling is applied in Tick).
+    lowBattery = !s.onAC && s.battPct >= 0 && !s.runtimeTarget
+        && (s.battPct < cfg.battThreshold || (lowBattery && s.battPct < cfg.battThreshold + cfg.battHysteresisPct));
+    if (lowBattery) {
+        profileReason = ProfileReason::LowBattery;
+        enterBalancedAt = enterSaverAt = 0; return ProcProfile::Saver;
+    }
+    if (s.sessionLocked || s.display != DisplayState::On) {
+        if (cfg.lockDownshift) { profileReason = ProfileReason::LockedOrDisplayOff; enterBalancedAt = enterSaverAt = 0; return ProcProfile::Saver; }
+    }
+
+    // An app rule holds its profile while the app owns the foreground, whatever the load
+    if (s.fgPinned) {
+        profileReason = ProfileReason::AppRule;
+        enterBalancedAt = enterSaverAt = 0;
+        return s.fgProfile;
+    }
+
+    // Upward is immediate
+    if (t == ActivityTier::Active) {
+        profileReason = ProfileReason::ActiveTier;
+        enterBalancedAt = enterSaverAt = 0;
+        return ProcProfile::Boost;
+    }
+
+    // Engaged -> Balanced after residency
+    if (t == ActivityTier::Engaged) {
+        if (!enterBalancedAt) enterBalancedAt = now + cfg.residencyBalancedMs;
+        enterSaverAt = 0; // reset Saver timer
+        bool due = now >= enterBalancedAt;
+        profileReason = due ? ProfileReason::EngagedResidency : ProfileReason::EngagedWaiting;
+        return due ? ProcProfile::Balanced : profile;
+    }
+
+    // Idle -> Saver after longer residency; otherwise hold Balanced
+    if (!enterSaverAt) enterSaverAt = now + cfg.residencySaverMs;
+    bool due = now >= enterSaverAt;
+    profileReason = due ? ProfileReason::IdleResidency : ProfileReason::IdleWaiting;
+    return due ? ProcProfile::Saver : ProcProfile::Balanced;
+}
+
+uint64_t Governor::NextDeadlineMs(uint64_t nowMs) const {
+    uint64_t next = 0;
+    for (uint64_t d : { boostHoldUntil, enterBalancedAt, enterSaverAt })
+        if (d > nowMs && (!next || d < next)) next = d;
+    return next;
+}
+
+ProcProfile Governor::Tick(const GovernorSignals& raw) {
+    GovernorSignals s;
+    FilterSignals(raw, s);
+    UpdateBoostHold(s);
+    organicTier = DecideTier(s, tierReason);
+    // The prediction only lifts; the predictor must learn from organicTier or it would feed itself.
+    tier = s.predictActive ? ActivityTier::Active : organicTier;
+    if (tier != organicTier) tierReason = TierReason::Predicted;
+    profile = wanted = DecideProfile(s, tier);
+    memoryCapped = s.memoryBound && !BoostHeld(s.nowMs);
+    if (s.runtimeTarget && (int)profile < (int)s.runtimeCeiling) {
+        profile = s.runtimeCeiling;
+        profileReason = ProfileReason::RuntimeTarget;
+    }
+    return profile;
+}
@@ -0,0 +1,127 @@
+// Governor.h
+// Platform-independent tier/profile policy. All OS inputs arrive through GovernorSignals,
+// time through an injected monotonic millisecond clock, so the policy can be replayed offline.
+
+#pragma once
+
+#include "SignalFilter.h"
+
+#include <cstdint>
+
+enum class DisplayState { Off = 0, On = 1, Dimmed = 2 };
+enum class ActivityTier { Idle, Engaged, Active };
+enum class ProcProfile { Boost, Balanced, Saver };
+
+// Why the last tick chose its tier / profile (telemetry, diagnostics).
+enum class TierReason : uint8_t { Input, StickyHold, ForegroundHeavy, BackgroundHeavy, CpuActive, Predicted,
+                                  RecentInput, CpuEngaged, BackgroundBusy, Idle, MemoryBound };
+enum class ProfileReason : uint8_t { LowBattery, LockedOrDisplayOff, ActiveTier, EngagedWaiting, EngagedResidency,
+                                     IdleWaiting, IdleResidency, AppRule, RuntimeTarget };
+
+const char* ProfileNameA(ProcProfile p);
+const char* TierNameA(ActivityTier t);
+const char* TierReasonNameA(TierReason r);
+const char* ProfileReasonNameA(ProfileReason r);
+
+// Tunables; the app fills this from the registry/sliders, the tools from the command line.
+struct GovernorConfig {
+    int      battThreshold = 25;            // % (Saver below this on battery)
+    bool     lockDownshift = true;          // Saver when locked / display off
+    uint32_t stickyBoostMs = 45'000;        // hold boost after user input
+    uint32_t residencyBalancedMs = 60'000;  // time in Engaged before Balanced
+    uint32_t residencySaverMs = 90'000;     // time in Idle before Saver
+    double   activeCpuPct = 40.0;           // smoothed CPU above this -> Active
+    double   engagedCpuPct = 15.0;          // smoothed CPU above this -> Engaged
+    double   activeMaxCorePct = 90.0;       // busiest core above this -> Active (<= 0 disables)
+    double   activeTopKPct = 75.0;          // mean of the k busiest cores above this -> Active
+    double   engagedMaxCorePct = 50.0;      // busiest core above this -> Engaged
+    uint32_t inputIdleSec = 2;              // idle below this counts as fresh input
+    uint32_t engagedIdleSec = 90;           // idle below this keeps Engaged
+
+    // Input filters (SignalFilter.h) and threshold hysteresis; the defaults keep the original policy.
+    FilterSpec cpuFilter = FilterSpec::LegacyCpu();   // aggregate, busiest core and top-k alike
+    FilterSpec idleFilter;                  // seconds since input
+    FilterSpec battFilter;                  // battery %
+    double   cpuHysteresisPct = 0.0;        // CPU thresholds release this far below where they trip
+    int      battHysteresisPct = 0;         // low-battery Saver holds until battThreshold + this
+};
+
+// One tick worth of observations.
+struct GovernorSignals {
+    uint64_t     nowMs = 0;                 // monotonic clock
+    double       cpuPct = 0.0;              // raw aggregate sample, 0..100
+    double       cpuMaxCorePct = 0.0;       // raw busiest-core sample
+    double       cpuTopKPct = 0.0;          // raw mean of the k busiest cores
+    uint32_t     idleSec = 0;               // seconds since last user input
+    bool         onAC = true;
+    int          battPct = 100;             // <0 when unknown
+    bool         runtimeTarget = false;     // a battery runtime target is in force (BatteryRuntime.h)...
+    ProcProfile  runtimeCeiling = ProcProfile::Boost;  // ...capping the profile here, instead of battThreshold
+    DisplayState display = DisplayState::On;
+    bool         sessionLocked = false;
+    bool         fgHeavy = false;           // foreground process has a Boost app rule (a "heavy app")
+    bool         fgPinned = false;          // foreground process has a Balanced/Saver app rule...
+    ProcProfile  fgProfile = ProcProfile::Balanced;   // ...for this profile
+    bool         bgHeavy = false;           // a heavy app is computing, foreground or not
+    bool         bgBusy = false;            // some process is over the scanner's CPU share
+    bool         predictActive = false;     // learned pre-boost for this epoch (Predictor)
+    bool         memoryBound = false;       // the busy cores are waiting on memory (PerfCounters.h)
+};
+
+class Governor {
+public:
+    explicit Governor(const GovernorConfig& cfg = GovernorConfig()) { SetConfig(cfg); }
+
+    // Filters restart only when their spec changes, so the config can be copied in every tick.
+    void SetConfig(const GovernorConfig& c);
+    const GovernorConfig& Config() const { return cfg; }
+
+    // Sample -> smooth -> tier -> profile. Returns the profile that should be applied.
+    ProcProfile Tick(const GovernorSignals& s);
+
+    // Filtered inputs (the names predate configurable filters).
+    double       CpuEWMA() const { return cpuAgg.Value(); }
+    double       MaxCoreEWMA() const { return cpuMaxCore.Value(); }
+    double       TopKEWMA() const { return cpuTopK.Value(); }
+    double       IdleFiltered() const { return idle.Value(); }
+    double       BattFiltered() const { return batt.Value(); }
+    ActivityTier Tier() const { return tier; }
+    ActivityTier OrganicTier() const { return organicTier; }   // tier without the prediction's lift
+    TierReason    LastTierReason() const { return tierReason; }
+    ProfileReason LastProfileReason() const { return profileReason; }
+    ProcProfile  Profile() const { return profile; }
+    ProcProfile  Wanted() const { return wanted; }      // profile before the runtime ceiling
+    bool         BoostHeld(uint64_t nowMs) const { return nowMs < boostHoldUntil; }
+    // Memory-bound with no input boost hold: the caller caps the setpoint (WorkloadClassifierConfig::cap).
+    bool         MemoryCapped() const { return memoryCapped; }
+    uint64_t     NextDeadlineMs(uint64_t nowMs) const;   // earliest armed timer after nowMs; 0 = none
+
+private:
+    void         FilterSignals(const GovernorSignals& raw, GovernorSignals& s);
+    void         UpdateBoostHold(const GovernorSignals& s);
+    ActivityTier DecideTier(const GovernorSignals& s, TierReason& why) const;
+    ProcProfile  DecideProfile(const GovernorSignals& s, ActivityTier t);
+
+    GovernorConfig cfg;
+
+    // Input filtering and the CPU threshold comparators
+    SignalFilter cpuAgg, cpuMaxCore, cpuTopK, idle, batt;
+    Hysteresis   activeCpu, activeMaxCore, activeTopK, engagedCpu, engagedMaxCore;
+    bool         cpuActive = false, cpuEngaged = false;
+    bool         lowBattery = false;
+    bool         memoryCapped = false;
+
+    uint64_t lastTickMs = 0;
+
+    // Sticky & residency (0 = not armed)
+    uint64_t boostHoldUntil = 0;
+    uint64_t enterBalancedAt = 0;
+    uint64_t enterSaverAt = 0;
+
+    ActivityTier tier = ActivityTier::Engaged;
+    ActivityTier organicTier = ActivityTier::Engaged;
+    TierReason    tierReason = TierReason::RecentInput;
+    ProfileReason profileReason = ProfileReason::EngagedWaiting;
+    ProcProfile  profile = ProcProfile::Balanced;
+    ProcProfile  wanted = ProcProfile::Balanced;
+};
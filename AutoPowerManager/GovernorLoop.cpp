@@ -0,0 +1,145 @@
+// GovernorLoop.cpp
+
+#include "GovernorLoop.h"
+
+#include <algorithm>
+
+GovernorLoop::GovernorLoop(ICoreTimesSource& coreTimes, IProcessTableSource& procTable, IProcessQosControl& qosControl,
+                           IThermalSource& thermalSource, IPowerBackend& power)
+    : thermalSource(thermalSource), sampler(coreTimes), scanner(procTable), qos(qosControl), writer(power) {}
+
+GovernorSignals GovernorLoop::SampleSignals(uint64_t nowMs, const GovernorLoopInputs& in) {
+    GovernorSignals s;
+    s.nowMs = nowMs;
+    sampler.SetTopK((int)cfg.cpuTopK);
+    CpuLoad l;
+    if (sampler.Sample(l)) {
+        load = l;
+        s.cpuPct = l.aggregate; s.cpuMaxCorePct = l.maxCore; s.cpuTopKPct = l.topKMean;
+    }
+    s.idleSec = in.idleSec;
+    s.onAC = in.onAC;
+    s.battPct = in.battPct;
+    s.display = in.display;
+    s.sessionLocked = in.sessionLocked;
+    SetForegroundRule(s, in.fgRule);
+    if (cfg.bgScanMs && (!lastScanMs || nowMs - lastScanMs >= cfg.bgScanMs)) {
+        ProcessScannerConfig c;
+        c.heavyMinCorePct = cfg.bgHeavyMinCorePct;
+        c.busyCorePct = cfg.bgBusyCorePct;
+        c.onAC = in.onAC;
+        scanner.SetConfig(c);
+        if (scanner.Scan(nowMs) && cfg.processQos) {
+            ProcessQosConfig q;
+            q.throttleCorePct = cfg.qosThrottleCorePct;
+            qos.SetConfig(q);
+            qos.Update(scanner, in.fgPid, nowMs);
+        }
+        lastScanMs = nowMs;
+    }
+    if (cfg.bgScanMs) {
+        s.bgHeavy = scanner.Result().heavyBusy;
+        s.bgBusy = scanner.Result().busy;
+    }
+    s.memoryBound = UpdateWorkload(nowMs);
+    return s;
+}
+
+// True in a memory-bound phase. The counters are read every tick, so each sample spans one interval.
+bool GovernorLoop::UpdateWorkload(uint64_t nowMs) {
+    if (!perfSource || !cfg.perfClassify) { workload.Reset(); return false; }
+    WorkloadClassifierConfig c = workload.Config();
+    c.cap.maxProcPct = (uint8_t)cfg.memoryBoundMaxPct;
+    workload.SetConfig(c);
+    PerfSample ps;
+    const bool ok = perfSource->Read(nowMs, ps);
+    return workload.Update(nowMs, ps, ok) == WorkloadPhase::Memory;
+}
+
+const ThermalCap& GovernorLoop::UpdateThermalCap(uint64_t nowMs) {
+    if (!cfg.thermalCap) { thermal.Reset(); thermalSample = ThermalSample{}; return thermal.Cap(); }
+    ThermalCapConfig c = thermal.Config();
+    c.softC = cfg.thermalSoftC;
+    c.powerLimitW = cfg.packageLimitW;
+    thermal.SetConfig(c);
+    thermalSource.Sample(nowMs, thermalSample);
+    return thermal.Update(nowMs, thermalSample);
+}
+
+// The interval that just ended goes to the profile and app of the previous tick.
+void GovernorLoop::ChargeEnergy(uint64_t nowMs, const GovernorSignals& sig, const std::wstring& fgName) {
+    if (!energySource) return;
+    double joules = 0.0;
+    const bool metered = energySource->Read(nowMs, joules);
+    energy.Charge(nowMs, joules, metered, sig.cpuPct);
+    energy.Attribute(applied, ChargedApp(sig, scanner, fgName));
+}
+
+const std::wstring& GovernorLoop::ForegroundName(const GovernorLoopInputs& in) const {
+    static const std::wstring noApp;
+    if (in.fgName) return *in.fgName;
+    const ProcessScanner::Entry* fg = in.fgPid ? scanner.Find(in.fgPid) : nullptr;
+    return fg ? fg->name : noApp;
+}
+
+uint32_t GovernorLoop::Tick(uint64_t nowMs, const GovernorLoopInputs& in, uint64_t wallMs) {
+    gov.SetConfig(cfg.gov);
+    GovernorSignals sig = SampleSignals(nowMs, in);
+    const std::wstring& fgName = ForegroundName(in);
+    const bool predicting = predictor && in.minuteOfDay >= 0;
+    const uint32_t app = predicting ? TierPredictor::AppKey(fgName) : 0;
+    sig.predictActive = predicting && cfg.predictBoost && in.onAC && predictor->PredictActive(app, in.minuteOfDay);
+    prevApplied = applied;
+    prevTier = gov.Tier();
+    const ThermalCap& cap = UpdateThermalCap(nowMs);
+    RuntimeGovernorConfig rc = runtime.Config();
+    rc.target = cfg.runtimeTarget;
+    rc.reservePct = (int)cfg.runtimeReservePct;
+    runtime.SetConfig(rc);
+    runtime.Update(nowMs, in.onAC, in.battPct, applied, gov.Wanted(), in.minuteOfDay);
+    runtime.ApplyTo(sig);
+    const ProcProfile decided = gov.Tick(sig);
+    if (pinned && pinUntilMs && nowMs >= pinUntilMs) pinned = false;
+    applied = pinned ? pinProfile : decided;
+
+    LadderControllerConfig lc = ladderCtl.Config();
+    lc.targetUtilPct = cfg.ladderTargetUtilPct;
+    lc.downMsPerLevel = cfg.ladderDownMsPerLevel;
+    ladderCtl.SetConfig(lc);
+    const double util = std::max(gov.CpuEWMA(), gov.TopKEWMA());
+    LadderSetpoint sp = ApplyThermalCap(ladderCtl.Update(ladder, nowMs, applied, util), cap);
+    if (gov.MemoryCapped() && !pinned) sp = ApplyThermalCap(sp, workload.Config().cap);   // a pin is deliberate
+    if (in.fgRule) sp = ApplyAppRule(sp, *in.fgRule);
+    if (actuator) {
+        lastSetpoint = sp;
+        actuator->Apply(sp, prevApplied, applied);
+    }
+    else if (!setpointValid || sp != lastSetpoint) {
+        // Inline: the callers have no UI to keep responsive; a slow power API only delays the next tick.
+        lastSetpoint = sp;
+        writer.Begin();
+        StageLadderSetpoint(writer, sp, topo.Hybrid());
+        const uint64_t failures = writer.Failures();
+        if (writer.Commit()) ++stats.commits;
+        setpointValid = writer.Failures() == failures;   // a diff that left nothing to write is fine
+        stats.commitFailures = writer.Failures();
+    }
+    ChargeEnergy(nowMs, sig, fgName);
+    if (predicting)
+        predictor->Observe(nowMs, in.minuteOfDay, app, gov.OrganicTier(), sig.predictActive,
+            sig.predictActive && gov.OrganicTier() != ActivityTier::Active);
+
+    TickObservation o = ObserveTick(gov, sig);
+    o.actuating = !ladderCtl.Settled() || (actuator && actuator->Busy()) || thermal.Level() > 0;
+    const uint32_t delay = sched.OnTick(o);
+    if (telemetry.IsOpen()) {
+        TelemetryRecord rec = MakeTelemetryRecord(gov, sig, applied, prevApplied, pinned, wallMs, delay);
+        rec.thermalLevel = (uint8_t)thermal.Level();
+        rec.tempC = (uint8_t)std::min(255.0, std::max(0.0, thermalSample.tempC + 0.5));
+        telemetry.Append(rec);
+    }
+    ++stats.ticks;
+    transitioned = applied != prevApplied || gov.Tier() != prevTier;
+    if (transitioned) ++stats.transitions;
+    return delay;
+}
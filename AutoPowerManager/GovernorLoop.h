@@ -0,0 +1,176 @@
+// GovernorLoop.h
+// The tick path without a message loop: sample -> background scan -> workload phase -> thermal cap ->
+// battery runtime ceiling -> governor -> ladder -> diffed power write -> energy charge -> next delay. Every OS input
+// arrives through the module interfaces and time through the caller, so the tray and the headless
+// daemon run it against the live system and Tools/GovBench against mocks on a virtual clock.
+
+#pragma once
+
+#include "AppRules.h"
+#include "BatteryRuntime.h"
+#include "CpuSampler.h"
+#include "CpuTopology.h"
+#include "Energy.h"
+#include "Governor.h"
+#include "PerfCounters.h"
+#include "PowerWriter.h"
+#include "Predictor.h"
+#include "ProcessQos.h"
+#include "ProcessScanner.h"
+#include "ProfileLadder.h"
+#include "Telemetry.h"
+#include "Thermal.h"
+#include "TickScheduler.h"
+
+#include <cstdint>
+#include <string>
+
+// The tray's registry knobs that shape the tick (same defaults).
+struct GovernorLoopConfig {
+    GovernorConfig gov;
+    uint32_t cpuTopK = 2;
+    uint32_t bgScanMs = 5'000;                 // 0 disables
+    uint32_t bgHeavyMinCorePct = 10;
+    uint32_t bgBusyCorePct = 80;
+    bool     processQos = false;
+    uint32_t qosThrottleCorePct = 25;
+    uint32_t ladderTargetUtilPct = 60;
+    uint32_t ladderDownMsPerLevel = 4'000;
+    bool     thermalCap = true;
+    uint32_t thermalSoftC = 85;
+    uint32_t packageLimitW = 0;
+    RuntimeTarget runtimeTarget;               // off: the battThreshold cutoff
+    uint32_t runtimeReservePct = 5;
+    bool     perfClassify = true;              // with a counter source: memory-bound load doesn't boost
+    uint32_t memoryBoundMaxPct = 80;           // max processor state in a memory-bound phase (boost off)
+    bool     predictBoost = true;              // with a predictor: pre-boost on AC when it expects Active
+};
+
+// Signals the loop doesn't sample itself (input, power source, session, foreground).
+struct GovernorLoopInputs {
+    uint32_t     idleSec = UINT32_MAX;         // no interactive user
+    bool         onAC = true;
+    int          battPct = -1;
+    DisplayState display = DisplayState::On;
+    bool         sessionLocked = false;
+    uint32_t     fgPid = 0;
+    const AppRule* fgRule = nullptr;           // the foreground app's rule for onAC (its caps apply too)
+    const std::wstring* fgName = nullptr;      // the foreground app's name if the caller tracks it; else from the scan
+    int          minuteOfDay = -1;             // local wall clock, for "until HH:MM" runtime targets
+};
+
+// Applies setpoints somewhere other than the tick's thread (the tray's actuator thread). Apply must
+// not block; it gets every tick's setpoint and skips what it already has.
+struct ISetpointActuator {
+    virtual ~ISetpointActuator() = default;
+    virtual void Apply(const LadderSetpoint& sp, ProcProfile from, ProcProfile to) = 0;
+    virtual bool Busy() const = 0;             // a transaction is queued or in flight
+};
+
+class GovernorLoop {
+public:
+    struct Stats { uint64_t ticks = 0, commits = 0, commitFailures = 0, transitions = 0; };
+
+    GovernorLoop(ICoreTimesSource& coreTimes, IProcessTableSource& procTable, IProcessQosControl& qosControl,
+                 IThermalSource& thermalSource, IPowerBackend& power);
+
+    void SetConfig(const GovernorLoopConfig& c) { cfg = c; }
+    const GovernorLoopConfig& Config() const { return cfg; }
+    void SetLadder(const ProfileLadder& l) { ladder = l; }
+    void SetTopology(const CpuTopology& t) { topo = t; sampler.SetTopology(t); }
+    void SetAppRules(const AppRules& r) { scanner.SetRules(r); }
+    void SetSelfPid(uint32_t pid) { qos.SetSelfPid(pid); }
+    TelemetryRing& Telemetry() { return telemetry; }
+    const TelemetryRing& Telemetry() const { return telemetry; }
+    // Without a source (the default) nothing is charged.
+    void SetEnergySource(IEnergySource* s) { energySource = s; }
+    const char* EnergySourceName() const { return energySource ? energySource->Name() : "none"; }
+    EnergyLedger& Energy() { return energy; }
+    const EnergyLedger& Energy() const { return energy; }
+    // Without a source (the default) the phase stays Unknown and load is taken at face value.
+    void SetPerfSource(IPerfCounterSource* s) { perfSource = s; }
+    const char* PerfSourceName() const { return perfSource ? perfSource->Name() : "none"; }
+    // Without one (the default) setpoints are written inline and counted in Stats.
+    void SetActuator(ISetpointActuator* a) { actuator = a; }
+    // Without one (the default) nothing is pre-boosted. Needs inputs with a minuteOfDay.
+    void SetPredictor(TierPredictor* p) { predictor = p; }
+
+    // A pinned profile replaces the governor's output until untilMs (0: until Unpin).
+    void Pin(ProcProfile p, uint64_t untilMs) { pinned = true; pinProfile = p; pinUntilMs = untilMs; }
+    void Unpin() { pinned = false; }
+
+    // One tick at nowMs (monotonic); wallMs only stamps telemetry. Returns the delay to the next tick.
+    uint32_t Tick(uint64_t nowMs, const GovernorLoopInputs& in, uint64_t wallMs);
+    // Something changed between ticks: returns the shortened delay to the next one.
+    uint32_t Kick(uint64_t nowMs) { return sched.Kick(nowMs); }
+    // Focus moved: the QoS engine lifts the new foreground at once instead of at the next scan.
+    void OnForeground(uint32_t pid) { if (cfg.processQos) qos.OnForeground(scanner, pid); }
+
+    // Whether the last tick changed the applied profile or the tier, and from what.
+    bool         Transitioned() const { return transitioned; }
+    ProcProfile  PrevApplied() const { return prevApplied; }
+    ActivityTier PrevTier() const { return prevTier; }
+
+    void RestoreAll() { qos.RestoreAll(&scanner); }
+
+    const Governor&         Gov() const { return gov; }
+    ProcProfile             Applied() const { return applied; }   // governor output, or the pin
+    bool                    Pinned() const { return pinned; }
+    ProcProfile             PinProfile() const { return pinProfile; }
+    uint64_t                PinUntilMs() const { return pinUntilMs; }
+    const ProfileLadder&    Ladder() const { return ladder; }
+    const LadderController& LadderCtl() const { return ladderCtl; }
+    const LadderSetpoint&   Setpoint() const { return lastSetpoint; }
+    const ThermalLimiter&   Thermal() const { return thermal; }
+    const ThermalSample&    ThermalReading() const { return thermalSample; }
+    const RuntimeGovernor&  Runtime() const { return runtime; }
+    const WorkloadClassifier& Workload() const { return workload; }
+    const CpuLoad&          Load() const { return load; }
+    const CpuTopology&      Topology() const { return topo; }
+    const TickScheduler&    Scheduler() const { return sched; }
+    const ProcessScanner&   Scanner() const { return scanner; }
+    const ProcessQosEngine& Qos() const { return qos; }
+    const Stats&            GetStats() const { return stats; }
+
+private:
+    GovernorSignals   SampleSignals(uint64_t nowMs, const GovernorLoopInputs& in);
+    bool              UpdateWorkload(uint64_t nowMs);
+    const ThermalCap& UpdateThermalCap(uint64_t nowMs);
+    void              ChargeEnergy(uint64_t nowMs, const GovernorSignals& sig, const std::wstring& fgName);
+    const std::wstring& ForegroundName(const GovernorLoopInputs& in) const;
+
+    GovernorLoopConfig  cfg;
+    IThermalSource&     thermalSource;
+    CpuTopology         topo;
+    PerCoreCpuSampler   sampler;
+    CpuLoad             load;
+    ProcessScanner      scanner;
+    uint64_t            lastScanMs = 0;
+    ProcessQosEngine    qos;
+    Governor            gov;
+    ProfileLadder       ladder;
+    LadderController    ladderCtl;
+    ThermalLimiter      thermal;
+    ThermalSample       thermalSample;
+    IPerfCounterSource* perfSource = nullptr;
+    ISetpointActuator*  actuator = nullptr;
+    TierPredictor*      predictor = nullptr;
+    WorkloadClassifier  workload;
+    RuntimeGovernor     runtime;
+    TickScheduler       sched;
+    TelemetryRing       telemetry;
+    IEnergySource*      energySource = nullptr;
+    EnergyLedger        energy;
+    PowerSettingsWriter writer;
+    LadderSetpoint      lastSetpoint;
+    bool                setpointValid = false;
+
+    ProcProfile  applied = ProcProfile::Balanced;
+    bool         pinned = false;
+    ProcProfile  pinProfile = ProcProfile::Balanced;
+    uint64_t     pinUntilMs = 0;
+    bool         transitioned = false;
+    ProcProfile  prevApplied = ProcProfile::Balanced;
+    ActivityTier prevTier = ActivityTier::Engaged;
+    Stats        stats;
+};
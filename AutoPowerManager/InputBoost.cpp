@@ -0,0 +1,144 @@
+// InputBoost.cpp
+
+#include "InputBoost.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// ---------- Gate ----------
+bool InputBoostGate::OnInput(uint64_t nowMs, InputKind kind, bool active) {
+    ++stats.events;
+    lastInputMs = nowMs;
+    if (kind == InputKind::Motion) {
+        if (!motionStartMs || nowMs - motionStartMs > cfg.motionWindowMs) { motionStartMs = nowMs; motionCount = 0; }
+        if (++motionCount < cfg.motionEvents) return false;   // not a deliberate move yet
+    }
+    if (active) { ++stats.absorbed; return false; }
+    if (lastTriggerMs && nowMs - lastTriggerMs < cfg.debounceMs) { ++stats.debounced; return false; }
+    lastTriggerMs = nowMs;
+    ++stats.triggers;
+    return true;
+}
+
+#ifndef _WIN32
+// ---------- evdev ----------
+static bool TestBit(const unsigned long* bits, unsigned bit) {
+    const unsigned w = 8 * sizeof(unsigned long);
+    return (bits[bit / w] >> (bit % w)) & 1ul;
+}
+
+// Keyboards (letter keys), mice (relative axes or the left button) and touch devices; not the
+// power button, lid switch or media-key-only devices.
+static bool IsPointerOrKeyboard(int fd) {
+    unsigned long ev[(EV_MAX + 8 * sizeof(long)) / (8 * sizeof(long))] = {};
+    unsigned long keys[(KEY_MAX + 8 * sizeof(long)) / (8 * sizeof(long))] = {};
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(ev)), ev) < 0) return false;
+    if (TestBit(ev, EV_REL)) return true;
+    if (!TestBit(ev, EV_KEY) || ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) return false;
+    return TestBit(keys, KEY_A) || TestBit(keys, BTN_LEFT) || TestBit(keys, BTN_TOUCH);
+}
+
+static uint64_t MonoUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+EvdevInputSource::EvdevInputSource(std::string root) : root(std::move(root)) {}
+
+EvdevInputSource::~EvdevInputSource() {
+    Close();
+    for (int& fd : wakeFds) if (fd >= 0) { close(fd); fd = -1; }
+}
+
+size_t EvdevInputSource::Open() {
+    if (wakeFds[0] < 0 && pipe(wakeFds) == 0) {
+        for (int fd : wakeFds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+    DIR* d = opendir(root.c_str());
+    if (!d) return devices.size();
+    while (dirent* de = readdir(d)) {
+        if (strncmp(de->d_name, "event", 5) || devices.size() >= kMaxDevices) continue;
+        const std::string name = de->d_name;
+        if (std::any_of(devices.begin(), devices.end(), [&](const Device& x) { return x.name == name; })) continue;
+        const int fd = open((root + "/" + name).c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+        if (!IsPointerOrKeyboard(fd)) { close(fd); continue; }
+        Device dev;
+        dev.name = name;
+        dev.fd = fd;
+        int clock = CLOCK_MONOTONIC;
+        dev.monotonic = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+        devices.push_back(dev);
+    }
+    closedir(d);
+    kernelStamps = std::all_of(devices.begin(), devices.end(), [](const Device& x) { return x.monotonic; });
+    return devices.size();
+}
+
+void EvdevInputSource::Close() {
+    for (Device& dev : devices) close(dev.fd);
+    devices.clear();
+}
+
+void EvdevInputSource::Interrupt() {
+    if (wakeFds[1] >= 0) { const char b = 1; if (write(wakeFds[1], &b, 1) < 0) {} }
+}
+
+bool EvdevInputSource::ReadDevice(Device& dev, std::vector<Event>& out) {
+    input_event ev[32];
+    for (;;) {
+        const ssize_t n = read(dev.fd, ev, sizeof(ev));
+        if (n < 0) return errno == EAGAIN || errno == EINTR;   // ENODEV: unplugged
+        if (n == 0) return false;
+        const uint64_t readUs = MonoUs();
+        for (size_t i = 0; i < (size_t)n / sizeof(input_event); ++i) {
+            const input_event& e = ev[i];
+            const uint64_t us = dev.monotonic ? (uint64_t)e.input_event_sec * 1'000'000ull + (uint64_t)e.input_event_usec : readUs;
+            if (e.type == EV_KEY && e.value == 1)
+                out.push_back(Event{ us, e.code < BTN_MISC || e.code >= KEY_OK ? InputKind::Key : InputKind::Button });
+            else if (e.type == EV_REL && (e.code == REL_WHEEL || e.code == REL_HWHEEL))
+                out.push_back(Event{ us, InputKind::Wheel });
+            else if (e.type == EV_REL || e.type == EV_ABS)
+                dev.motion = true;
+            else if (e.type == EV_SYN && e.code == SYN_REPORT && dev.motion) {
+                dev.motion = false;
+                out.push_back(Event{ us, InputKind::Motion });
+            }
+        }
+    }
+}
+
+bool EvdevInputSource::Wait(int timeoutMs, std::vector<Event>& out) {
+    if (devices.empty()) return false;
+    pollfd fds[1 + kMaxDevices];
+    nfds_t n = 0;
+    fds[n++] = pollfd{ wakeFds[0], POLLIN, 0 };
+    for (const Device& dev : devices) fds[n++] = pollfd{ dev.fd, POLLIN, 0 };
+    if (poll(fds, n, timeoutMs) <= 0) return true;   // timeout, or EINTR
+    if (fds[0].revents) {
+        char b[64];
+        while (read(wakeFds[0], b, sizeof(b)) > 0) {}
+        return false;
+    }
+    // By index from the back, so a dropped device doesn't shift the ones still to read.
+    for (size_t i = devices.size(); i-- > 0;) {
+        if (!fds[i + 1].revents) continue;
+        if (!ReadDevice(devices[i], out)) { close(devices[i].fd); devices.erase(devices.begin() + i); }
+    }
+    return true;
+}
+#endif
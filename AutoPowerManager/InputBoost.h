@@ -0,0 +1,86 @@
+// InputBoost.h
+// Input-triggered governor ticks. The tick timer backs off to seconds while the machine is idle, so
+// a polled idle counter leaves the first keystroke waiting up to a full interval before Boost.
+// Instead, input events arrive as they happen (Raw Input with RIDEV_INPUTSINK in the tray, evdev
+// in the Linux daemon) and the gate decides which of them tick the governor at once. Debouncing
+// keeps a drag or a typing burst from ticking on every report: one tick is enough to start the
+// boost hold, and the regular ticks keep it going while the tier is Active.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class InputKind : uint8_t { Key, Button, Wheel, Motion };
+
+struct InputBoostConfig {
+    uint32_t debounceMs = 250;       // at most one input-triggered tick per this
+    uint32_t motionEvents = 4;       // pointer motion counts once this many reports arrive ...
+    uint32_t motionWindowMs = 100;   // ... within this long (a nudged mouse doesn't boost)
+};
+
+class InputBoostGate {
+public:
+    struct Stats { uint64_t events = 0, triggers = 0, debounced = 0, absorbed = 0; };
+
+    void SetConfig(const InputBoostConfig& c) { cfg = c; }
+    const InputBoostConfig& Config() const { return cfg; }
+
+    // One input event. active: the governor's tier is already Active, so a tick would change
+    // nothing. True: tick the governor now.
+    bool OnInput(uint64_t nowMs, InputKind kind, bool active);
+
+    uint64_t     LastInputMs() const { return lastInputMs; }   // any event, motion included; 0 none
+    const Stats& GetStats() const { return stats; }
+
+private:
+    InputBoostConfig cfg;
+    uint64_t lastInputMs = 0;
+    uint64_t lastTriggerMs = 0;
+    uint64_t motionStartMs = 0;
+    uint32_t motionCount = 0;
+    Stats    stats;
+};
+
+#ifndef _WIN32
+// Keyboards, mice, touchpads and touchscreens under /dev/input (event*). Reading them needs root or
+// the input group. Timestamps are switched to CLOCK_MONOTONIC (steady_clock) where the kernel
+// allows it, so latency can be measured from the event itself; otherwise from when it was read.
+// Motion is reported once per SYN_REPORT, key repeats and releases not at all. root is injectable.
+class EvdevInputSource {
+public:
+    struct Event { uint64_t us; InputKind kind; };
+
+    explicit EvdevInputSource(std::string root = "/dev/input");
+    ~EvdevInputSource();
+
+    // Opens the input devices not open yet (call again to pick up hotplugged ones); the count open.
+    size_t Open();
+    void   Close();
+    size_t Devices() const { return devices.size(); }
+    bool   KernelStamps() const { return kernelStamps; }   // all devices stamp in CLOCK_MONOTONIC
+
+    // Waits up to timeoutMs (-1: no limit) and appends what arrived. False when woken by Interrupt
+    // or with no devices open.
+    bool Wait(int timeoutMs, std::vector<Event>& out);
+    void Interrupt();   // any thread
+
+    static constexpr size_t kMaxDevices = 32;
+
+private:
+    struct Device {
+        std::string name;        // event3
+        int         fd = -1;
+        bool        monotonic = false;
+        bool        motion = false;   // motion since the last SYN_REPORT
+    };
+    bool ReadDevice(Device& d, std::vector<Event>& out);
+
+    std::string         root;
+    std::vector<Device> devices;
+    int                 wakeFds[2] = { -1, -1 };
+    bool                kernelStamps = true;
+};
+#endif
@@ -0,0 +1,81 @@
+// LatencyHistogram.cpp
+// Bucket arithmetic, percentiles and the one-line summary.
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static int HighestBit(uint64_t v) {   // v > 0
+    int b = 0;
+    for (int s = 32; s; s >>= 1)
+        if (v >> s) { v >>= s; b += s; }
+    return b;
+}
+
+// Magnitude 0 holds [0, 2^kSubBits) one value per slot; magnitude m > 0 holds
+// [2^(m+kSubBits-1), 2^(m+kSubBits)) in kHalf slots of width 2^m.
+size_t LatencyHistogram::IndexOf(uint64_t us) {
+    us = std::min(us, MaxTrackable());
+    int m = us ? std::max(0, HighestBit(us) - (kSubBits - 1)) : 0;
+    return (size_t)m * kHalf + (size_t)(us >> m);
+}
+
+uint64_t LatencyHistogram::LowestEquivalent(size_t index) {
+    size_t m = index < 2 * (size_t)kHalf ? 0 : index / kHalf - 1;
+    return (uint64_t)(index - m * kHalf) << m;
+}
+
+uint64_t LatencyHistogram::HighestEquivalent(size_t index) {
+    size_t m = index < 2 * (size_t)kHalf ? 0 : index / kHalf - 1;
+    return (((uint64_t)(index - m * kHalf) + 1) << m) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t us) {
+    uint32_t& c = counts[IndexOf(us)];
+    if (c != UINT32_MAX) ++c;
+    minUs = total ? std::min(minUs, us) : us;
+    maxUs = std::max(maxUs, us);
+    sumUs += us;
+    ++total;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& o) {
+    if (!o.total) return;
+    for (size_t i = 0; i < kCounts; ++i)
+        counts[i] = (uint32_t)std::min<uint64_t>((uint64_t)counts[i] + o.counts[i], UINT32_MAX);
+    minUs = total ? std::min(minUs, o.minUs) : o.minUs;
+    maxUs = std::max(maxUs, o.maxUs);
+    sumUs += o.sumUs;
+    total += o.total;
+}
+
+void LatencyHistogram::Reset() { *this = LatencyHistogram(); }
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+    if (!total) return 0;
+    q = std::min(1.0, std::max(0.0, q));
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(q * (double)total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kCounts; ++i) {
+        seen += counts[i];
+        if (seen >= target) return std::min(std::max(HighestEquivalent(i), minUs), maxUs);
+    }
+    return maxUs;
+}
+
+static int FormatUs(char* buf, size_t n, uint64_t us) {
+    if (us < 1000) return snprintf(buf, n, "%lluus", (unsigned long long)us);
+    if (us < 10'000) return snprintf(buf, n, "%.1fms", us / 1000.0);
+    return snprintf(buf, n, "%llums", (unsigned long long)((us + 500) / 1000));
+}
+
+int LatencyHistogram::Summary(char* buf, size_t n) const {
+    char p50[24], p90[24], p99[24], mx[24];
+    FormatUs(p50, sizeof(p50), Percentile(0.50));
+    FormatUs(p90, sizeof(p90), Percentile(0.90));
+    FormatUs(p99, sizeof(p99), Percentile(0.99));
+    FormatUs(mx, sizeof(mx), Max());
+    return snprintf(buf, n, "n=%llu p50=%s p90=%s p99=%s max=%s", (unsigned long long)total, p50, p90, p99, mx);
+}
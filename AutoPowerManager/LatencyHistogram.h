@@ -0,0 +1,43 @@
+// LatencyHistogram.h
+// HDR-style latency histogram: log-linear buckets (32 per power of two, so any value is reported
+// within ~3 %), fixed 2 KB of counts, O(1) Record. Values are microseconds; anything beyond
+// MaxTrackable() is clamped into the top bucket but still counted exactly in Max().
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class LatencyHistogram {
+public:
+    static constexpr int    kSubBits = 5;                          // sub-buckets per magnitude = 2^kSubBits
+    static constexpr int    kHalf = 1 << (kSubBits - 1);
+    static constexpr int    kMagnitudes = 32;                      // up to 2^36 us (~19 h)
+    static constexpr size_t kCounts = (size_t)(kMagnitudes + 1) * kHalf;
+
+    void Record(uint64_t us);
+    void Merge(const LatencyHistogram& o);
+    void Reset();
+
+    uint64_t Count() const { return total; }
+    uint64_t Min() const { return total ? minUs : 0; }
+    uint64_t Max() const { return maxUs; }
+    double   Mean() const { return total ? (double)sumUs / (double)total : 0.0; }
+    // Smallest recorded-bucket value v such that a fraction q (0..1) of samples are <= v.
+    uint64_t Percentile(double q) const;
+
+    // "n=42 p50=1.2ms p90=3.4ms p99=120ms max=131ms"
+    int Summary(char* buf, size_t n) const;
+
+    static constexpr uint64_t MaxTrackable() { return (1ull << (kMagnitudes - 1 + kSubBits)) - 1; }
+    static size_t   IndexOf(uint64_t us);
+    static uint64_t LowestEquivalent(size_t index);
+    static uint64_t HighestEquivalent(size_t index);
+
+private:
+    uint32_t counts[kCounts] = {};
+    uint64_t total = 0;
+    uint64_t sumUs = 0;
+    uint64_t minUs = 0;
+    uint64_t maxUs = 0;
+};
@@ -0,0 +1,153 @@
+// PerfCounters.cpp
+// perf_event counter groups and the compute / memory-bound classifier.
+
+#include "PerfCounters.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* WorkloadPhaseNameA(WorkloadPhase p) {
+    return p == WorkloadPhase::Compute ? "compute" : p == WorkloadPhase::Memory ? "memory" : "unknown";
+}
+
+#ifndef _WIN32
+// ---------- perf_event ----------
+static int OpenCounter(uint64_t config, int cpu, int groupFd) {
+    perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = PERF_TYPE_HARDWARE;
+    a.config = config;
+    a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    a.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &a, -1, cpu, groupFd, PERF_FLAG_FD_CLOEXEC);
+}
+
+bool PerfEventSource::Open() {
+    Close();
+    static const uint64_t kConfig[kEvents] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                               PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_BACKEND };
+    const long conf = sysconf(_SC_NPROCESSORS_CONF);
+    const size_t n = conf > 0 ? std::min((size_t)conf, kMaxCpus) : 1;
+    bool decided = false;   // which members the PMU has, from the first CPU that opens
+    for (size_t i = 0; i < n; ++i) {
+        Cpu c;
+        c.fd[kCycles] = OpenCounter(kConfig[kCycles], (int)i, -1);
+        if (c.fd[kCycles] < 0) { error = errno; continue; }   // offline, or no access
+        bool ok = true;
+        for (int e = kInstructions; e < kEvents && ok; ++e) {
+            if ((decided && slot[e] < 0) || (leftOut >> e & 1)) continue;
+            c.fd[e] = OpenCounter(kConfig[e], (int)i, c.fd[kCycles]);
+            if (c.fd[e] < 0 && (decided || e == kInstructions)) { error = errno; ok = false; }
+        }
+        if (ok && !decided) {
+            members = 0;
+            for (int e = 0; e < kEvents; ++e) slot[e] = c.fd[e] >= 0 ? members++ : -1;
+            decided = true;
+        }
+        if (!ok) { for (int fd : c.fd) if (fd >= 0) close(fd); continue; }
+        cpus.push_back(c);
+    }
+    if (cpus.empty()) { std::fill(slot, slot + kEvents, -1); members = 0; }
+    lastMs = 0;
+    starved = 0;
+    return !cpus.empty();
+}
+
+void PerfEventSource::Close() {
+    for (Cpu& c : cpus) for (int fd : c.fd) if (fd >= 0) close(fd);
+    cpus.clear();
+}
+
+bool PerfEventSource::Read(uint64_t nowMs, PerfSample& out) {
+    if (cpus.empty()) {
+        if (nowMs >= retryMs) { retryMs = nowMs + 60'000; Open(); lastMs = nowMs; }
+        return false;
+    }
+    double sum[kEvents] = {};
+    uint64_t enabled = 0, running = 0;
+    size_t counted = 0, primed = 0;
+    uint64_t buf[3 + kEvents];
+    const ssize_t want = (ssize_t)((3 + members) * sizeof(uint64_t));
+    for (Cpu& c : cpus) {
+        if (read(c.fd[kCycles], buf, sizeof(buf)) != want) { c.primed = false; continue; }
+        const uint64_t* v = buf + 3;
+        primed += c.primed;
+        if (c.primed && buf[2] > c.running) {
+            const uint64_t dE = buf[1] - c.enabled, dR = buf[2] - c.running;
+            const double scale = (double)dE / (double)dR;
+            for (int e = 0; e < kEvents; ++e)
+                if (slot[e] >= 0) sum[e] += (double)(v[slot[e]] - c.value[e]) * scale;
+            enabled += dE; running += dR;
+            ++counted;
+        }
+        c.enabled = buf[1]; c.running = buf[2];
+        for (int e = 0; e < kEvents; ++e) if (slot[e] >= 0) c.value[e] = v[slot[e]];
+        c.primed = true;
+    }
+    // A group that never gets onto the PMU is too big for it (the watchdog or another tool holds
+    // counters): leave out the last optional member and open again.
+    if (counted) starved = -1;
+    else if (primed && starved >= 0 && ++starved >= 3) {
+        starved = -1;
+        for (int e = kEvents - 1; e > kInstructions; --e) {
+            if (slot[e] < 0) continue;
+            leftOut |= (uint8_t)(1 << e);
+            Open();
+            return false;
+        }
+    }
+    const uint64_t prevMs = lastMs;
+    lastMs = nowMs;
+    if (!counted || !prevMs || nowMs <= prevMs) return false;   // first read, or multiplexed out throughout
+    out = PerfSample{};
+    out.seconds = (double)(nowMs - prevMs) / 1000.0;
+    out.cycles = sum[kCycles];
+    out.instructions = sum[kInstructions];
+    if (slot[kMisses] >= 0) out.llcMisses = sum[kMisses];
+    if (slot[kStalls] >= 0) out.stallCycles = sum[kStalls];
+    out.running = enabled ? (double)running / (double)enabled : 0.0;
+    return true;
+}
+#endif
+
+// ---------- Classifier ----------
+void WorkloadClassifier::Reset() {
+    metrics = WorkloadMetrics{};
+    phase = pending = WorkloadPhase::Unknown;
+    pendingSinceMs = 0;
+}
+
+WorkloadPhase WorkloadClassifier::Candidate(const PerfSample& s, bool ok) {
+    metrics = WorkloadMetrics{};
+    if (!ok || s.seconds <= 0.0 || s.cycles <= 0.0 || s.instructions <= 0.0) return WorkloadPhase::Unknown;
+    metrics.ipc = s.instructions / s.cycles;
+    metrics.gCyclesPerSec = s.cycles / s.seconds / 1e9;
+    if (s.llcMisses >= 0.0) metrics.mpki = s.llcMisses * 1000.0 / s.instructions;
+    if (s.stallCycles >= 0.0) metrics.stallShare = std::min(1.0, s.stallCycles / s.cycles);
+    if (metrics.gCyclesPerSec < cfg.minGCyclesPerSec) return WorkloadPhase::Unknown;
+
+    // Inside a memory-bound phase the release thresholds apply (hysteresis).
+    const bool in = phase == WorkloadPhase::Memory;
+    bool mem = false;
+    if (metrics.mpki >= 0.0) mem = metrics.mpki >= (in ? cfg.memExitMpki : cfg.memEnterMpki);
+    else if (metrics.stallShare >= 0.0) mem = metrics.stallShare >= (in ? cfg.memExitStall : cfg.memEnterStall);
+    mem = mem && metrics.ipc <= (in ? cfg.computeMinIpc : cfg.memMaxIpc);
+    return mem ? WorkloadPhase::Memory : WorkloadPhase::Compute;
+}
+
+WorkloadPhase WorkloadClassifier::Update(uint64_t nowMs, const PerfSample& s, bool ok) {
+    const WorkloadPhase c = Candidate(s, ok);
+    if (c == phase) { pending = phase; return phase; }
+    if (c != pending) { pending = c; pendingSinceMs = nowMs; }
+    const uint32_t dwell = c == WorkloadPhase::Memory ? cfg.enterMs : phase == WorkloadPhase::Memory ? cfg.exitMs : 0;
+    if (nowMs - pendingSinceMs >= dwell) phase = c;
+    return phase;
+}
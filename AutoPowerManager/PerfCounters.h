@@ -0,0 +1,134 @@
+// PerfCounters.h
+// Workload classification from hardware performance counters. Load alone can't tell a core that is
+// computing from one that is waiting on DRAM: both read 100 % busy. Raising clocks speeds up the
+// first and does little for the second except burn power and the thermal headroom the next compute
+// phase needs. Instructions, cycles and last-level-cache misses (or backend stall cycles, where the
+// PMU has no usable miss event) tell them apart; the classifier turns them into a phase, and a
+// memory-bound phase caps max processor state and boost mode like the thermal cap does.
+//
+// Misses per thousand instructions are the primary signal because they don't depend on the clock:
+// capping a memory-bound phase raises its IPC and lowers its stall share (the memory latency costs
+// fewer cycles), which would read as "compute-bound again" and release the cap a tick later.
+
+#pragma once
+
+#include "Thermal.h"
+
+#include <cstdint>
+#include <vector>
+
+// Counts over the interval since the previous read, summed over CPUs and scaled up for the time
+// the kernel had the counters multiplexed out.
+struct PerfSample {
+    double seconds = 0.0;          // wall interval
+    double instructions = 0.0;
+    double cycles = 0.0;           // unhalted: idle cores add nothing
+    double llcMisses = -1.0;       // <0 not counted on this PMU
+    double stallCycles = -1.0;     // backend stall cycles; <0 not counted
+    double running = 1.0;          // share of the interval the counters were on the PMU
+};
+
+struct IPerfCounterSource {
+    virtual ~IPerfCounterSource() = default;
+    // False when nothing is counted: the first call, no PMU access, or every counter multiplexed out.
+    virtual bool Read(uint64_t nowMs, PerfSample& out) = 0;
+    virtual const char* Name() const = 0;
+};
+
+// Windows has no user-mode PMU interface: the counters need a kernel driver or an elevated ETW
+// session with PMC profiling, which the per-user tray app doesn't have. It runs without a source,
+// so the phase stays Unknown and the policy is unchanged there.
+
+#ifndef _WIN32
+// perf_event_open, system-wide: one counter group per CPU (cycles leading, then instructions,
+// cache-misses and stalled-cycles-backend, each only if the PMU has it), read as a group in one
+// read() per CPU. Groups aren't pinned, so the kernel multiplexes them with other perf users; each
+// CPU's counts are scaled by time_enabled / time_running. Needs CAP_PERFMON (or root) or
+// perf_event_paranoid <= 0. Without access the open is retried once a minute.
+class PerfEventSource : public IPerfCounterSource {
+public:
+    PerfEventSource() = default;
+    ~PerfEventSource() override { Close(); }
+    PerfEventSource(const PerfEventSource&) = delete;
+    PerfEventSource& operator=(const PerfEventSource&) = delete;
+
+    bool Read(uint64_t nowMs, PerfSample& out) override;
+    const char* Name() const override { return cpus.empty() ? "none" : "perf_event"; }
+
+    bool   Open();               // false: no CPU could be counted (errno of the last attempt in Error())
+    void   Close();
+    size_t Cpus() const { return cpus.size(); }
+    bool   HaveMisses() const { return slot[kMisses] >= 0; }
+    bool   HaveStalls() const { return slot[kStalls] >= 0; }
+    int    Error() const { return error; }
+
+    static constexpr int    kEvents = 4;
+    static constexpr size_t kMaxCpus = 1024;
+
+private:
+    enum { kCycles, kInstructions, kMisses, kStalls };
+    struct Cpu {
+        int      fd[kEvents] = { -1, -1, -1, -1 };
+        uint64_t enabled = 0, running = 0;
+        uint64_t value[kEvents] = {};
+        bool     primed = false;
+    };
+
+    std::vector<Cpu> cpus;
+    int      slot[kEvents] = { -1, -1, -1, -1 };   // event -> position in the group read; -1 absent
+    int      members = 0;
+    uint8_t  leftOut = 0;                          // optional events dropped because the group never fit
+    int      starved = 0;                          // reads since Open with nothing counted; -1 once counted
+    int      error = 0;
+    uint64_t lastMs = 0;
+    uint64_t retryMs = 0;
+};
+#endif
+
+enum class WorkloadPhase : uint8_t { Unknown, Compute, Memory };
+const char* WorkloadPhaseNameA(WorkloadPhase p);
+
+struct WorkloadClassifierConfig {
+    double   minGCyclesPerSec = 0.5;   // less busy than half a core at 1 GHz: Unknown
+    double   memEnterMpki = 10.0;      // LLC misses per 1000 instructions to enter Memory...
+    double   memExitMpki = 5.0;        // ...and to stay there
+    double   memEnterStall = 0.6;      // backend stall share of cycles, when no miss event is counted
+    double   memExitStall = 0.4;
+    double   memMaxIpc = 1.0;          // Memory only at or below this IPC...
+    double   computeMinIpc = 1.6;      // ...and Compute again above this (a capped clock raises IPC)
+    uint32_t enterMs = 3'000;          // looks memory-bound this long before the phase changes
+    uint32_t exitMs = 0;               // and not memory-bound this long before it changes back
+    ThermalCap cap = { 80, 0 };        // applied in a memory-bound phase: max state, boost off
+};
+
+struct WorkloadMetrics {
+    double ipc = 0.0;
+    double mpki = -1.0;                // <0 not counted
+    double stallShare = -1.0;          // <0 not counted
+    double gCyclesPerSec = 0.0;
+};
+
+// Once per tick with the source's sample. The phase moves into Memory only after enterMs of
+// memory-bound samples and out after exitMs of anything else; Unknown <-> Compute is immediate.
+class WorkloadClassifier {
+public:
+    void SetConfig(const WorkloadClassifierConfig& c) { cfg = c; }
+    const WorkloadClassifierConfig& Config() const { return cfg; }
+
+    // ok: the source's Read result (false: no counts this tick, treated as Unknown).
+    WorkloadPhase Update(uint64_t nowMs, const PerfSample& s, bool ok);
+    void Reset();
+
+    WorkloadPhase          Phase() const { return phase; }
+    bool                   MemoryBound() const { return phase == WorkloadPhase::Memory; }
+    const WorkloadMetrics& Metrics() const { return metrics; }
+
+private:
+    WorkloadPhase Candidate(const PerfSample& s, bool ok);
+
+    WorkloadClassifierConfig cfg;
+    WorkloadMetrics metrics;
+    WorkloadPhase   phase = WorkloadPhase::Unknown;
+    WorkloadPhase   pending = WorkloadPhase::Unknown;
+    uint64_t        pendingSinceMs = 0;
+};
@@ -0,0 +1,25 @@
+// PlatformTypes.h
+// Minimal Win32 type surface so the platform-neutral governor modules also build off-Windows.
+
+#pragma once
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cstdint>
+#include <cstring>
+
+typedef uint32_t DWORD;
+
+struct GUID {
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t  Data4[8];
+};
+
+inline bool IsEqualGUID(const GUID& a, const GUID& b) { return memcmp(&a, &b, sizeof(GUID)) == 0; }
+#endif
@@ -0,0 +1,156 @@
+// PowerWriter.cpp
+// Transactional power-scheme writer, the Win32 backend and the timing decorator.
+
+#include "PowerWriter.h"
+#include "ProfileLadder.h"
+
+#include <chrono>
+
+#ifdef _WIN32
+#include <powrprof.h>
+#pragma comment(lib, "PowrProf.lib")
+
+// ---------- Win32 backend ----------
+bool Win32PowerBackend::GetActiveScheme(GUID& scheme) {
+    GUID* active = nullptr;
+    if (PowerGetActiveScheme(nullptr, &active) != ERROR_SUCCESS || !active) return false;
+    scheme = *active;
+    LocalFree(active);
+    return true;
+}
+
+bool Win32PowerBackend::WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) {
+    DWORD rc = (src == PowerSource::AC)
+        ? PowerWriteACValueIndex(nullptr, &scheme, &subgroup, &setting, value)
+        : PowerWriteDCValueIndex(nullptr, &scheme, &subgroup, &setting, value);
+    return rc == ERROR_SUCCESS;
+}
+
+bool Win32PowerBackend::SetActiveScheme(const GUID& scheme) {
+    return PowerSetActiveScheme(nullptr, &scheme) == ERROR_SUCCESS;
+}
+#endif
+
+// ---------- Timing decorator ----------
+static uint64_t NowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TimedPowerBackend::TimedPowerBackend(IPowerBackend& inner) : inner(inner) { writes.reserve(16); }
+
+void TimedPowerBackend::SetName(const GUID& setting, const char* name) {
+    for (auto& n : names)
+        if (IsEqualGUID(n.setting, setting)) { n.name = name; return; }
+    names.push_back({ setting, name });
+    for (auto& w : writes)
+        if (IsEqualGUID(w.setting, setting)) w.name = name;
+}
+
+bool TimedPowerBackend::GetActiveScheme(GUID& scheme) {
+    uint64_t t0 = NowUs();
+    bool ok = inner.GetActiveScheme(scheme);
+    reads.Record(NowUs() - t0);
+    ++calls;
+    return ok;
+}
+
+bool TimedPowerBackend::WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) {
+    uint64_t t0 = NowUs();
+    bool ok = inner.WriteValueIndex(scheme, subgroup, setting, src, value);
+    uint64_t us = NowUs() - t0;
+    ++calls;
+
+    Series* s = nullptr;
+    for (auto& w : writes)
+        if (w.src == src && IsEqualGUID(w.setting, setting)) { s = &w; break; }
+    if (!s) {
+        const char* name = nullptr;
+        for (auto& n : names)
+            if (IsEqualGUID(n.setting, setting)) { name = n.name; break; }
+        writes.push_back({ setting, src, name, LatencyHistogram() });
+        s = &writes.back();
+    }
+    s->hist.Record(us);
+    return ok;
+}
+
+bool TimedPowerBackend::SetActiveScheme(const GUID& scheme) {
+    uint64_t t0 = NowUs();
+    bool ok = inner.SetActiveScheme(scheme);
+    commits.Record(NowUs() - t0);
+    ++calls;
+    return ok;
+}
+
+void TimedPowerBackend::Reset() {
+    for (auto& w : writes) w.hist.Reset();
+    reads.Reset();
+    commits.Reset();
+    calls = 0;
+}
+
+// ---------- Writer ----------
+PowerSettingsWriter::PowerSettingsWriter(IPowerBackend& backend) : backend(backend) {
+    // Processor subgroup settings x AC/DC; sized so steady-state transactions never reallocate.
+    cache.reserve(32); staged.reserve(32); dirty.reserve(32);
+}
+
+PowerSettingsWriter::Entry* PowerSettingsWriter::Find(std::vector<Entry>& v, const Entry& key) {
+    for (auto& e : v)
+        if (e.src == key.src && IsEqualGUID(e.setting, key.setting) && IsEqualGUID(e.subgroup, key.subgroup)) return &e;
+    return nullptr;
+}
+
+void PowerSettingsWriter::Begin() { staged.clear(); }
+
+void PowerSettingsWriter::Set(const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) {
+    Entry e{ subgroup, setting, src, value };
+    if (Entry* s = Find(staged, e)) s->value = value;   // last write in a transaction wins
+    else staged.push_back(e);
+}
+
+bool PowerSettingsWriter::Commit() {
+    dirty.clear();
+    for (auto& e : staged) {
+        const Entry* c = haveScheme ? Find(cache, e) : nullptr;
+        if (!c || c->value != e.value) dirty.push_back(e);
+    }
+    if (dirty.empty()) { staged.clear(); return false; }
+
+    GUID scheme{};
+    if (!backend.GetActiveScheme(scheme)) { staged.clear(); ++failures; return false; }
+    if (!haveScheme || !IsEqualGUID(scheme, cachedScheme)) {
+        // Different scheme than the cache describes: nothing in it can be trusted.
+        cache.clear(); dirty = staged;
+        cachedScheme = scheme; haveScheme = true;
+    }
+
+    for (auto& e : dirty) {
+        if (!backend.WriteValueIndex(scheme, e.subgroup, e.setting, e.src, e.value)) continue;
+        if (Entry* c = Find(cache, e)) c->value = e.value;
+        else cache.push_back(e);
+    }
+    bool ok = backend.SetActiveScheme(scheme); // single commit per transaction
+    if (!ok) { Invalidate(); ++failures; }
+    staged.clear();
+    return ok;
+}
+
+void PowerSettingsWriter::Invalidate() { cache.clear(); haveScheme = false; }
+
+// ---------- Ladder setpoints ----------
+void StageLadderSetpoint(PowerSettingsWriter& w, const LadderSetpoint& sp, bool hybrid) {
+    if (hybrid) {
+        w.SetACDC(SUB_PROCESSOR, SET_MIN_PROC_STATE, sp.eMinAC, sp.eMinDC);
+        w.SetACDC(SUB_PROCESSOR, SET_MAX_PROC_STATE, sp.eMaxAC, sp.eMaxDC);
+        w.SetACDC(SUB_PROCESSOR, SET_MIN_PROC_STATE1, sp.pMinAC, sp.pMinDC);
+        w.SetACDC(SUB_PROCESSOR, SET_MAX_PROC_STATE1, sp.pMaxAC, sp.pMaxDC);
+    }
+    else {
+        w.SetACDC(SUB_PROCESSOR, SET_MIN_PROC_STATE, sp.minAC, sp.minDC);
+        w.SetACDC(SUB_PROCESSOR, SET_MAX_PROC_STATE, sp.maxAC, sp.maxDC);
+    }
+    w.SetACDC(SUB_PROCESSOR, SET_BOOST_MODE, sp.boostAC, sp.boostDC); // 0:Off 1:Efficient 2:Aggressive 3:AggressiveAtGuarantee
+    w.SetACDC(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, sp.parkAC, sp.parkDC);
+}
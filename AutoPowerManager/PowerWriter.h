@@ -0,0 +1,125 @@
+// PowerWriter.h
+// Transactional power-scheme writer: diffs value indexes against the last write and commits once.
+
+#pragma once
+
+#include "PlatformTypes.h"
+#include "LatencyHistogram.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class PowerSource { AC, DC };
+
+// ---------- Processor settings the app writes ----------
+static const GUID SUB_PROCESSOR = { 0x54533251,0x82be,0x4824,{0x96,0xc1,0x47,0xb6,0x0b,0x74,0x0d,0x00} }; // GUID_PROCESSOR_SETTINGS_SUBGROUP
+static const GUID SET_MIN_PROC_STATE = { 0x893dee8e,0x2bef,0x41e0,{0x89,0xc6,0xb5,0x7f,0xc8,0x77,0x79,0x99} }; // GUID_PROCESSOR_THROTTLE_MINIMUM
+static const GUID SET_MAX_PROC_STATE = { 0xbc5038f7,0x23e0,0x4960,{0x96,0xda,0x33,0xab,0xaf,0x59,0x35,0xec} }; // GUID_PROCESSOR_THROTTLE_MAXIMUM
+static const GUID SET_MIN_PROC_STATE1 = { 0x893dee8e,0x2bef,0x41e0,{0x89,0xc6,0xb5,0x5d,0x09,0x29,0x96,0x4d} }; // GUID_PROCESSOR_THROTTLE_MINIMUM_1 (efficiency class 1)
+static const GUID SET_MAX_PROC_STATE1 = { 0xbc5038f7,0x23e0,0x4960,{0x96,0xda,0x33,0xab,0xaf,0x59,0x35,0xed} }; // GUID_PROCESSOR_THROTTLE_MAXIMUM_1 (efficiency class 1)
+static const GUID SET_BOOST_MODE = { 0xbe337238,0x0d82,0x4146,{0xa2,0x41,0x23,0x20,0x33,0x1f,0xf1,0xa6} }; // GUID_PROCESSOR_PERF_BOOST_MODE
+static const GUID SET_CORE_PARK_MIN_CORES = { 0x0cc5b647,0xc1df,0x4637,{0x89,0x2e,0x31,0x69,0x1b,0x1d,0x2d,0x5b} }; // % cores unparked min
+
+// ---------- Backend (raw power API surface) ----------
+struct IPowerBackend {
+    virtual ~IPowerBackend() = default;
+    virtual bool GetActiveScheme(GUID& scheme) = 0;
+    virtual bool WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) = 0;
+    virtual bool SetActiveScheme(const GUID& scheme) = 0;
+};
+
+#ifdef _WIN32
+// PowerGetActiveScheme / PowerWrite{AC,DC}ValueIndex / PowerSetActiveScheme.
+struct Win32PowerBackend : IPowerBackend {
+    bool GetActiveScheme(GUID& scheme) override;
+    bool WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) override;
+    bool SetActiveScheme(const GUID& scheme) override;
+};
+#endif
+
+// Records every call instead of touching the system; used by the Linux tools and simulator.
+struct CountingPowerBackend : IPowerBackend {
+    GUID  scheme{};
+    int   getActiveCalls = 0;
+    int   writeCalls = 0;
+    int   commitCalls = 0;
+
+    bool GetActiveScheme(GUID& s) override { ++getActiveCalls; s = scheme; return true; }
+    bool WriteValueIndex(const GUID&, const GUID&, const GUID&, PowerSource, DWORD) override { ++writeCalls; return true; }
+    bool SetActiveScheme(const GUID&) override { ++commitCalls; return true; }
+    void Reset() { getActiveCalls = writeCalls = commitCalls = 0; }
+};
+
+// Times every call into another backend (steady clock, microseconds): one histogram per
+// setting x AC/DC, plus the active-scheme read and the re-apply.
+class TimedPowerBackend : public IPowerBackend {
+public:
+    struct Series {
+        GUID             setting;
+        PowerSource      src;
+        const char*      name;     // SetName(), or null
+        LatencyHistogram hist;
+    };
+
+    explicit TimedPowerBackend(IPowerBackend& inner);
+
+    void SetName(const GUID& setting, const char* name);   // static string
+
+    bool GetActiveScheme(GUID& scheme) override;
+    bool WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) override;
+    bool SetActiveScheme(const GUID& scheme) override;
+
+    const std::vector<Series>& Writes() const { return writes; }
+    const LatencyHistogram&    SchemeReads() const { return reads; }
+    const LatencyHistogram&    Commits() const { return commits; }
+    uint64_t                   Calls() const { return calls; }
+    void Reset();
+
+private:
+    struct Name { GUID setting; const char* name; };
+
+    IPowerBackend&      inner;
+    std::vector<Series> writes;
+    std::vector<Name>   names;
+    LatencyHistogram    reads;
+    LatencyHistogram    commits;
+    uint64_t            calls = 0;
+};
+
+// ---------- Writer ----------
+// Usage: Begin(); Set...(); Commit();  Values equal to the last successful write for the
+// active scheme are skipped; a transaction with no effective change makes no API calls.
+class PowerSettingsWriter {
+public:
+    explicit PowerSettingsWriter(IPowerBackend& backend);
+
+    void Begin();
+    void Set(const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value);
+    void SetACDC(const GUID& subgroup, const GUID& setting, DWORD ac, DWORD dc) {
+        Set(subgroup, setting, PowerSource::AC, ac);
+        Set(subgroup, setting, PowerSource::DC, dc);
+    }
+    bool Commit();      // true if the active scheme was re-applied
+    uint64_t Failures() const { return failures; }   // commits the backend refused
+    void Invalidate();  // forget cached values (scheme switched or edited externally)
+
+private:
+    struct Entry { GUID subgroup; GUID setting; PowerSource src; DWORD value; };
+
+    Entry* Find(std::vector<Entry>& v, const Entry& key);
+
+    IPowerBackend&     backend;
+    std::vector<Entry> cache;   // last written values for cachedScheme
+    std::vector<Entry> staged;  // current transaction
+    std::vector<Entry> dirty;
+    GUID cachedScheme{};
+    bool haveScheme = false;
+    uint64_t failures = 0;
+};
+
+// ---------- Ladder setpoints ----------
+struct LadderSetpoint;
+
+// Stages one ladder setpoint (ProfileLadder.h) as the processor settings above. On hybrid CPUs the
+// base min/max settings cover efficiency class 0 and the "1" variants the faster cores.
+void StageLadderSetpoint(PowerSettingsWriter& w, const LadderSetpoint& sp, bool hybrid);
@@ -0,0 +1,152 @@
+// Predictor.cpp
+// Per-app, per-epoch-of-day tier transition counts and their persistence.
+
+#include "Predictor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+const uint32_t kMagic = 0x504D5041;   // "APMP"
+const uint32_t kVersion = 1;
+
+template <typename S> uint32_t Fnv1a(const S& s) {
+    uint32_t h = 2166136261u;
+    for (auto c : s) { h ^= (uint32_t)(std::make_unsigned_t<decltype(c)>)c; h *= 16777619u; }
+    return h;
+}
+
+int Bucket(int minuteOfDay) {
+    return (((minuteOfDay % 1440) + 1440) % 1440) / (int)TierPredictor::kEpochMinutes;
+}
+}
+
+TierPredictor::TierPredictor(const PredictorConfig& cfg) : cfg(cfg) { Clear(); }
+
+void TierPredictor::Clear() {
+    for (auto& s : slots) s = Slot{};
+    memset(counts, 0, sizeof(counts));
+    useClock = 0;
+    lastMs = 0;
+    prevTier = -1;
+    stats = Stats{};
+}
+
+uint32_t TierPredictor::AppKey(const std::wstring& name) { return Fnv1a(name); }
+uint32_t TierPredictor::AppKey(const std::string& name) { return Fnv1a(name); }
+
+int TierPredictor::FindSlot(uint32_t key) const {
+    for (size_t i = 0; i < kSlots; ++i)
+        if (slots[i].used && slots[i].key == key) return (int)i;
+    return -1;
+}
+
+int TierPredictor::AcquireSlot(uint32_t key) {
+    int i = FindSlot(key);
+    if (i < 0) {
+        i = 0;
+        for (size_t j = 0; j < kSlots; ++j) {
+            if (!slots[j].used) { i = (int)j; break; }
+            if (slots[j].lastUse < slots[i].lastUse) i = (int)j;
+        }
+        memset(counts[i], 0, sizeof(counts[i]));
+        slots[i].key = key;
+        slots[i].used = true;
+    }
+    slots[i].lastUse = ++useClock;
+    return i;
+}
+
+void TierPredictor::Count(int slot, int bucket, int from, int to) {
+    uint8_t* row = counts[slot][bucket][from];
+    if (row[to] == 255) for (size_t k = 0; k < kTiers; ++k) row[k] /= 2;
+    ++row[to];
+}
+
+double TierPredictor::Probability(uint32_t appKey, int minuteOfDay) const {
+    if (prevTier < 0) return -1.0;
+    int s = FindSlot(appKey);
+    if (s < 0) return -1.0;
+    const uint8_t* row = counts[s][Bucket(minuteOfDay)][prevTier];
+    uint32_t sum = (uint32_t)row[0] + row[1] + row[2];
+    if (!sum || sum < cfg.minSamples) return -1.0;
+    return row[(int)ActivityTier::Active] / (double)sum;
+}
+
+bool TierPredictor::PredictActive(uint32_t appKey, int minuteOfDay) const {
+    // Only rises are anticipated; holding an Active stretch is the sticky/residency timers' job.
+    if (prevTier == (int)ActivityTier::Active) return false;
+    return Probability(appKey, minuteOfDay) >= cfg.threshold;
+}
+
+void TierPredictor::Observe(uint64_t nowMs, int minuteOfDay, uint32_t appKey, ActivityTier organic, bool predicted, bool lifted) {
+    const int bucket = Bucket(minuteOfDay);
+    const int tier = (int)organic;
+    const uint64_t epochMs = kEpochMinutes * 60'000ull;
+
+    if (!lastMs || nowMs < lastMs) {
+        lastMs = nowMs; lastLifted = lifted;
+        epochApp = appKey; epochBucket = bucket;
+        maxTier = tier; epochPredicted = predicted; epochLiftedMs = 0;
+        prevTier = -1;
+        return;
+    }
+    const uint64_t gap = nowMs - lastMs;
+    if (lastLifted) epochLiftedMs += gap;
+    lastMs = nowMs;
+    lastLifted = lifted;
+
+    if (bucket == epochBucket && gap < epochMs) {
+        maxTier = std::max(maxTier, tier);
+        epochPredicted = epochPredicted || predicted;
+        return;
+    }
+
+    // Close the epoch: count (app, epoch of day, previous tier) -> this epoch's tier.
+    if (prevTier >= 0) {
+        const bool active = maxTier == (int)ActivityTier::Active;
+        if (prevTier != (int)ActivityTier::Active) ++stats.epochs;
+        if (epochPredicted) { ++stats.predicted; if (active) ++stats.hits; }
+        else if (active && prevTier != (int)ActivityTier::Active) ++stats.missed;
+        Count(AcquireSlot(epochApp), epochBucket, prevTier, maxTier);
+    }
+    stats.liftedMs += epochLiftedMs;
+    if (maxTier != (int)ActivityTier::Active) stats.wastedMs += epochLiftedMs;
+
+    // Skipped epochs (sleep, a long back-off) break the chain.
+    const bool next = bucket == (epochBucket + 1) % (int)kDayBuckets && gap < 2 * epochMs;
+    prevTier = next ? maxTier : -1;
+    epochApp = appKey; epochBucket = bucket;
+    maxTier = tier; epochPredicted = predicted; epochLiftedMs = 0;
+}
+
+// ---------- Persistence ----------
+bool TierPredictor::Save(FILE* f) const {
+    uint32_t hdr[6] = { kMagic, kVersion, (uint32_t)kSlots, (uint32_t)kDayBuckets, (uint32_t)kTiers, useClock };
+    if (fwrite(hdr, sizeof(hdr), 1, f) != 1) return false;
+    for (auto& s : slots) {
+        uint32_t rec[3] = { s.key, s.lastUse, s.used ? 1u : 0u };
+        if (fwrite(rec, sizeof(rec), 1, f) != 1) return false;
+    }
+    return fwrite(counts, sizeof(counts), 1, f) == 1;
+}
+
+bool TierPredictor::Load(FILE* f) {
+    uint32_t hdr[6];
+    if (fread(hdr, sizeof(hdr), 1, f) != 1) return false;
+    if (hdr[0] != kMagic || hdr[1] != kVersion || hdr[2] != kSlots || hdr[3] != kDayBuckets || hdr[4] != kTiers) return false;
+    Slot s[kSlots];
+    for (auto& x : s) {
+        uint32_t rec[3];
+        if (fread(rec, sizeof(rec), 1, f) != 1) return false;
+        x.key = rec[0]; x.lastUse = rec[1]; x.used = rec[2] != 0;
+    }
+    std::vector<uint8_t> c(sizeof(counts));
+    if (fread(c.data(), c.size(), 1, f) != 1) return false;
+    std::copy(std::begin(s), std::end(s), slots);
+    memcpy(counts, c.data(), sizeof(counts));
+    useClock = hdr[5];
+    return true;
+}
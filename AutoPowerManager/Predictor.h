@@ -0,0 +1,87 @@
+// Predictor.h
+// Learned pre-boost: a first-order Markov model over per-epoch ActivityTier, keyed by foreground
+// app and time of day. Regular spikes (the morning build, a scheduled solve) raise the tier at the
+// start of the epoch instead of a smoothed tick or two after the load arrives. Epochs are aligned to
+// the wall clock (2 minutes), so "09:00 every morning" always lands on the same epoch.
+//
+// Memory is fixed (~100 KB): kSlots app slots (LRU, a slot's counts are cleared on reuse) x 720
+// epochs of the day x 3 x 3 saturating 8-bit transition counts, halved on saturation so old
+// habits fade.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct PredictorConfig {
+    double   threshold = 0.6;      // P(epoch Active) needed to pre-boost
+    uint32_t minSamples = 4;       // observations of a state before it may predict
+};
+
+class TierPredictor {
+public:
+    static constexpr size_t kSlots = 16;
+    static constexpr size_t kEpochMinutes = 2;
+    static constexpr size_t kDayBuckets = 1440 / kEpochMinutes;
+    static constexpr size_t kTiers = 3;
+
+    struct Stats {
+        uint64_t epochs = 0;       // completed epochs following a non-Active one
+        uint64_t predicted = 0;    // ... during which a pre-boost was predicted
+        uint64_t hits = 0;         // ... and the epoch turned Active on its own
+        uint64_t missed = 0;       // organic Active epochs after a non-Active one, not predicted
+        uint64_t liftedMs = 0;     // time the prediction raised the tier
+        uint64_t wastedMs = 0;     // ... in epochs that never turned Active on their own
+    };
+
+    explicit TierPredictor(const PredictorConfig& cfg = PredictorConfig());
+
+    void SetConfig(const PredictorConfig& c) { cfg = c; }
+    const PredictorConfig& Config() const { return cfg; }
+
+    // Normalized app name -> key. Same value for the app's wide names and the tools' narrow ones.
+    static uint32_t AppKey(const std::wstring& name);
+    static uint32_t AppKey(const std::string& name);
+
+    // Should the current epoch be pre-boosted? Read-only; unknown apps never predict.
+    // minuteOfDay: local wall-clock minute, 0..1439.
+    bool PredictActive(uint32_t appKey, int minuteOfDay) const;
+    double Probability(uint32_t appKey, int minuteOfDay) const;   // -1 when not enough samples
+
+    // Once per tick with the tier the governor reached without the prediction's help.
+    // predicted: PredictActive() was true this tick; lifted: it changed the applied tier.
+    void Observe(uint64_t nowMs, int minuteOfDay, uint32_t appKey, ActivityTier organic, bool predicted, bool lifted);
+
+    const Stats& GetStats() const { return stats; }
+    void Clear();
+
+    bool Save(FILE* f) const;
+    bool Load(FILE* f);            // false (and unchanged) on a foreign or truncated file
+
+private:
+    struct Slot { uint32_t key = 0; uint32_t lastUse = 0; bool used = false; };
+
+    int  FindSlot(uint32_t key) const;
+    int  AcquireSlot(uint32_t key);
+    void Count(int slot, int bucket, int from, int to);
+
+    PredictorConfig cfg;
+    Slot            slots[kSlots];
+    uint8_t         counts[kSlots][kDayBuckets][kTiers][kTiers];
+    uint32_t        useClock = 0;
+
+    // Epoch in progress
+    uint64_t lastMs = 0;
+    uint32_t epochApp = 0;
+    int      epochBucket = 0;
+    int      prevTier = -1;        // max tier of the previous epoch; -1 unknown
+    int      maxTier = 0;
+    bool     epochPredicted = false;
+    uint64_t epochLiftedMs = 0;
+    bool     lastLifted = false;
+
+    Stats stats;
+};
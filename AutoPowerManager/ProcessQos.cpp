@@ -0,0 +1,293 @@
+// ProcessQos.cpp
+// Background-throttling policy and its Win32 (power throttling) / Linux (nice, affinity, cgroup)
+// controls.
+
+#include "ProcessQos.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// ---------- Win32 control ----------
+static HANDLE OpenSame(uint32_t pid, uint64_t created) {
+    HANDLE h = OpenProcess(PROCESS_SET_INFORMATION | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return nullptr;
+    FILETIME c, e, k, u;
+    if (!GetProcessTimes(h, &c, &e, &k, &u) || (((uint64_t)c.dwHighDateTime << 32) | c.dwLowDateTime) != created) {
+        CloseHandle(h);
+        return nullptr;
+    }
+    return h;
+}
+
+static bool SetThrottling(HANDLE h, ULONG control, ULONG state) {
+    PROCESS_POWER_THROTTLING_STATE st{};
+    st.Version = PROCESS_POWER_THROTTLING_CURRENT_VERSION;
+    st.ControlMask = control;
+    st.StateMask = state;
+    return SetProcessInformation(h, ProcessPowerThrottling, &st, sizeof(st)) != 0;
+}
+
+bool Win32ProcessQosControl::Set(uint32_t pid, uint64_t created, QosLevel level, QosSaved& saved) {
+    HANDLE h = OpenSame(pid, created);
+    if (!h) return false;
+    const ULONG speed = PROCESS_POWER_THROTTLING_EXECUTION_SPEED;
+    bool ok = SetThrottling(h, speed, level == QosLevel::Eco ? speed : 0);
+    if (ok && level == QosLevel::Eco) {
+        DWORD cls = GetPriorityClass(h);
+        if (opt.lowerPriority && cls == NORMAL_PRIORITY_CLASS && SetPriorityClass(h, BELOW_NORMAL_PRIORITY_CLASS))
+            saved.priority = (int32_t)cls;   // leave anything not at Normal alone
+        DWORD_PTR procMask = 0, sysMask = 0;
+        if (opt.ecoAffinity && GetProcessAffinityMask(h, &procMask, &sysMask)) {
+            DWORD_PTR eco = procMask & (DWORD_PTR)opt.ecoAffinity;
+            if (eco && eco != procMask && SetProcessAffinityMask(h, eco)) saved.affinity = procMask;
+        }
+    }
+    CloseHandle(h);
+    return ok;
+}
+
+bool Win32ProcessQosControl::Restore(uint32_t pid, uint64_t created, QosLevel, const QosSaved& saved) {
+    HANDLE h = OpenSame(pid, created);
+    if (!h) return false;
+    bool ok = SetThrottling(h, 0, 0);   // back to system-managed
+    if (saved.priority && GetPriorityClass(h) == BELOW_NORMAL_PRIORITY_CLASS)
+        ok = SetPriorityClass(h, (DWORD)saved.priority) && ok;
+    if (saved.affinity) ok = SetProcessAffinityMask(h, (DWORD_PTR)saved.affinity) && ok;
+    CloseHandle(h);
+    return ok;
+}
+#else
+// ---------- Linux control ----------
+static bool ReadSmall(const std::string& path, char* text, size_t n) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ssize_t k = read(fd, text, n - 1);
+    close(fd);
+    if (k < 0) return false;
+    text[k] = 0;
+    return true;
+}
+
+static bool WriteSmall(const std::string& path, const std::string& value) {
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0) return false;
+    bool ok = write(fd, value.data(), value.size()) == (ssize_t)value.size();
+    return (close(fd) == 0) && ok;
+}
+
+static const int kEcoNice = 10;
+
+LinuxProcessQosControl::LinuxProcessQosControl(const ProcessQosOptions& opt, const QosCgroup& group, std::string procRoot)
+    : opt(opt), group(group), procRoot(std::move(procRoot)) {}
+
+bool LinuxProcessQosControl::SameProcess(uint32_t pid, uint64_t created) const {
+    const std::string dir = procRoot + "/" + std::to_string(pid);
+    char text[1024];
+    if (!ReadSmall(dir + "/stat", text, sizeof(text))) return false;
+    const char* rp = strrchr(text, ')');
+    unsigned long long start = 0;
+    if (!rp || sscanf(rp + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+            &start) != 1 || start != created) return false;
+    char cmd[8];
+    return ReadSmall(dir + "/cmdline", cmd, sizeof(cmd)) && cmd[0];   // kernel threads have none
+}
+
+bool LinuxProcessQosControl::SetNice(uint32_t pid, int nice) const {
+    // nice is per thread on Linux: the PID's own call only covers its main thread.
+    bool ok = setpriority(PRIO_PROCESS, (id_t)pid, nice) == 0;
+    const std::string dir = procRoot + "/" + std::to_string(pid) + "/task";
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* de = readdir(d)) {
+            uint32_t tid = (uint32_t)strtoul(de->d_name, nullptr, 10);
+            if (tid && tid != pid) setpriority(PRIO_PROCESS, (id_t)tid, nice);
+        }
+        closedir(d);
+    }
+    return ok;
+}
+
+bool LinuxProcessQosControl::Set(uint32_t pid, uint64_t created, QosLevel level, QosSaved& saved) {
+    if (!SameProcess(pid, created)) return false;
+    if (level != QosLevel::Eco) return true;   // unprivileged, there is nothing above the default
+
+    bool any = false;
+    errno = 0;
+    const int nice = getpriority(PRIO_PROCESS, (id_t)pid);
+    rlimit rl{};
+    // Raising nice is always allowed; lowering it back needs CAP_SYS_NICE or RLIMIT_NICE headroom,
+    // so only renice what can be restored.
+    const bool canRestore = geteuid() == 0 || (getrlimit(RLIMIT_NICE, &rl) == 0 && 20 - (int)rl.rlim_cur <= nice);
+    if (opt.lowerPriority && errno == 0 && nice < kEcoNice && canRestore && SetNice(pid, kEcoNice)) {
+        saved.priority = nice;
+        any = true;
+    }
+
+    cpu_set_t cur;
+    CPU_ZERO(&cur);
+    if (opt.ecoAffinity && sched_getaffinity((pid_t)pid, sizeof(cur), &cur) == 0) {
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i) if (CPU_ISSET(i, &cur)) mask |= 1ull << i;
+        const uint64_t eco = mask & opt.ecoAffinity;
+        if (eco && eco != mask && CPU_COUNT(&cur) == __builtin_popcountll(mask)) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int i = 0; i < 64; ++i) if (eco & (1ull << i)) CPU_SET(i, &set);
+            if (sched_setaffinity((pid_t)pid, sizeof(set), &set) == 0) { saved.affinity = mask; any = true; }
+        }
+    }
+
+    if (!group.dir.empty()) {
+        if (!groupReady) {
+            mkdir(group.dir.c_str(), 0755);
+            WriteSmall(group.dir + "/cpu.weight", std::to_string(group.weight));
+            WriteSmall(group.dir + "/cpu.max", group.maxPct ? std::to_string(group.maxPct * 1000) + " 100000" : "max");
+            groupReady = true;
+        }
+        char text[512];
+        const std::string cg = procRoot + "/" + std::to_string(pid) + "/cgroup";
+        if (ReadSmall(cg, text, sizeof(text))) {
+            const char* line = strstr(text, "0::");   // cgroup v2 entry
+            std::string from = line ? std::string(line + 3, strcspn(line + 3, "\n")) : "";
+            if (!from.empty() && WriteSmall(group.dir + "/cgroup.procs", std::to_string(pid))) { saved.group = from; any = true; }
+        }
+    }
+    return any;
+}
+
+bool LinuxProcessQosControl::Restore(uint32_t pid, uint64_t created, QosLevel level, const QosSaved& saved) {
+    if (!SameProcess(pid, created)) return false;
+    if (level != QosLevel::Eco) return true;
+    bool ok = true;
+    if (!saved.group.empty()) {
+        // The group directory sits in the cgroup2 mount; the saved path is relative to that mount.
+        const std::string mount = group.dir.substr(0, group.dir.find_last_of('/'));
+        ok = WriteSmall(mount + saved.group + "/cgroup.procs", std::to_string(pid)) && ok;
+    }
+    if (saved.affinity) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < 64; ++i) if (saved.affinity & (1ull << i)) CPU_SET(i, &set);
+        ok = sched_setaffinity((pid_t)pid, sizeof(set), &set) == 0 && ok;
+    }
+    errno = 0;
+    if (getpriority(PRIO_PROCESS, (id_t)pid) == kEcoNice && errno == 0) ok = SetNice(pid, saved.priority) && ok;
+    return ok;
+}
+#endif
+
+// ---------- Engine ----------
+ProcessQosEngine::ProcessQosEngine(IProcessQosControl& ctl, const ProcessQosConfig& cfg) : ctl(ctl), cfg(cfg) {
+    tracks.reserve(256);
+}
+
+void ProcessQosEngine::Change(uint32_t pid, Track& t, QosLevel to) {
+    QosSaved s;
+    if (!ctl.Set(pid, t.created, to, s)) { t.failed = true; ++stats.failures; return; }
+    t.saved = std::move(s);
+    t.level = to;
+    t.quietSinceMs = 0;
+    ++stats.applied;
+    ++(to == QosLevel::Eco ? stats.eco : stats.high);
+}
+
+// The track's process is restored or gone: it no longer counts toward stats.eco / stats.high.
+void ProcessQosEngine::Uncount(const Track& t) {
+    if (t.level != QosLevel::Default) --(t.level == QosLevel::Eco ? stats.eco : stats.high);
+}
+
+void ProcessQosEngine::Release(uint32_t pid, Track& t) {
+    if (t.level == QosLevel::Default) return;
+    if (ctl.Restore(pid, t.created, t.level, t.saved)) ++stats.restored;
+    else ++stats.failures;   // most often it exited between scans
+    Uncount(t);
+    t.level = QosLevel::Default;
+    t.saved = QosSaved{};
+    t.busySinceMs = 0;
+}
+
+void ProcessQosEngine::Update(ProcessScanner& scanner, uint32_t fgPid, uint64_t nowMs) {
+    ++gen;
+    for (const ProcessScanner::Entry& e : scanner.Entries()) {
+        // Only processes that are busy, heavy, or already ours get a track, so thousands of idle
+        // processes cost one hash probe each.
+        auto it = tracks.find(e.pid);
+        if (it != tracks.end() && it->second.created != e.created) {   // PID reused: the old one is gone
+            Uncount(it->second);
+            tracks.erase(it);
+            it = tracks.end();
+        }
+        const bool heavy = e.heavy && cfg.boostHeavy;
+        const bool busy = e.corePct >= cfg.throttleCorePct;
+        if (it == tracks.end()) {
+            // A busy foreground process is never throttled; tracking it would only churn the
+            // table (and the heap) every scan.
+            if (!heavy && (!busy || e.pid == fgPid)) continue;
+            if (e.pid == selfPid || e.pid <= 4) continue;   // Idle / System / init
+            it = tracks.emplace(e.pid, Track()).first;
+            it->second.created = e.created;
+        }
+        Track& t = it->second;
+        t.seen = gen;
+        if (t.failed) continue;
+
+        if (heavy) {
+            if (t.level == QosLevel::Eco) Release(e.pid, t);
+            if (t.level == QosLevel::Default) Change(e.pid, t, QosLevel::High);
+        }
+        else if (t.level == QosLevel::High) {
+            Release(e.pid, t);   // no longer heavy: rules or power source changed
+        }
+        else if (t.level == QosLevel::Eco) {
+            if (e.pid == fgPid) Release(e.pid, t);
+            else if (e.corePct >= cfg.releaseCorePct) t.quietSinceMs = 0;
+            else if (!t.quietSinceMs) t.quietSinceMs = nowMs;
+            else if (nowMs - t.quietSinceMs >= cfg.releaseAfterMs) Release(e.pid, t);
+        }
+        else if (busy && e.pid != fgPid) {
+            if (!t.busySinceMs) t.busySinceMs = nowMs;
+            if (nowMs - t.busySinceMs >= cfg.throttleAfterMs && stats.eco < cfg.maxThrottled) Change(e.pid, t, QosLevel::Eco);
+        }
+        else {
+            t.busySinceMs = 0;
+        }
+        scanner.MarkThrottled(e.pid, t.level == QosLevel::Eco);
+    }
+
+    // Exited processes take their QoS with them; drop the tracks (and the failures, in case the
+    // PID comes back as something else).
+    for (auto it = tracks.begin(); it != tracks.end();) {
+        Track& t = it->second;
+        if (t.seen == gen && (t.failed || t.level != QosLevel::Default || t.busySinceMs)) { ++it; continue; }
+        Uncount(t);
+        it = tracks.erase(it);
+    }
+}
+
+void ProcessQosEngine::OnForeground(ProcessScanner& scanner, uint32_t fgPid) {
+    auto it = tracks.find(fgPid);
+    if (it == tracks.end() || it->second.level != QosLevel::Eco) return;
+    Release(fgPid, it->second);
+    scanner.MarkThrottled(fgPid, false);
+}
+
+void ProcessQosEngine::RestoreAll(ProcessScanner* scanner) {
+    for (auto& kv : tracks) {
+        Release(kv.first, kv.second);
+        if (scanner) scanner->MarkThrottled(kv.first, false);
+    }
+    tracks.clear();
+}
@@ -0,0 +1,130 @@
+// ProcessQos.h
+// Per-process QoS next to the system-wide profile: CPU-heavy background processes are moved to
+// EcoQoS (or nice / a weighted cgroup on Linux) so one indexer doesn't hold the whole machine in
+// Boost, and apps with a Boost rule (AppRules.h) are pinned to high QoS so dropping to Saver
+// doesn't starve them. The foreground process is never throttled; the OS already runs it at high QoS.
+//
+// Every process the engine changes is tracked by (PID, creation time) with what it replaced, and
+// is restored when it calms down, comes to the foreground, or on RestoreAll at shutdown.
+
+#pragma once
+
+#include "ProcessScanner.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class QosLevel : uint8_t { Default, High, Eco };
+
+// What a change replaced, so it can be put back.
+struct QosSaved {
+    int32_t     priority = 0;   // priority class (Win32) / nice (Linux)
+    uint64_t    affinity = 0;   // 0: not changed
+    std::string group;          // original cgroup (Linux), empty: not moved
+};
+
+struct IProcessQosControl {
+    virtual ~IProcessQosControl() = default;
+    // created is the ProcessScanner's creation time; a mismatch (PID reused) fails the call.
+    virtual bool Set(uint32_t pid, uint64_t created, QosLevel level, QosSaved& saved) = 0;
+    virtual bool Restore(uint32_t pid, uint64_t created, QosLevel level, const QosSaved& saved) = 0;
+};
+
+struct ProcessQosOptions {
+    bool     lowerPriority = true;    // Eco also lowers the priority class / nice
+    uint64_t ecoAffinity = 0;         // Eco also restricts to these logical processors; 0 leaves affinity
+};
+
+#ifdef _WIN32
+// SetProcessInformation(ProcessPowerThrottling): EcoQoS = EXECUTION_SPEED throttled, High = opted
+// out of throttling; Eco also sets BELOW_NORMAL_PRIORITY_CLASS. Restore hands throttling back to
+// the system and puts the priority class back if it is still ours.
+class Win32ProcessQosControl : public IProcessQosControl {
+public:
+    explicit Win32ProcessQosControl(const ProcessQosOptions& opt = ProcessQosOptions()) : opt(opt) {}
+    bool Set(uint32_t pid, uint64_t created, QosLevel level, QosSaved& saved) override;
+    bool Restore(uint32_t pid, uint64_t created, QosLevel level, const QosSaved& saved) override;
+private:
+    ProcessQosOptions opt;
+};
+#endif
+
+#ifndef _WIN32
+struct QosCgroup {
+    std::string dir;              // e.g. /sys/fs/cgroup/autopower-eco (must be writable); empty: none
+    uint32_t    weight = 20;      // cpu.weight (default 100)
+    uint32_t    maxPct = 0;       // cpu.max as % of one CPU; 0 = "max"
+};
+
+// nice (every thread) and sched_setaffinity; with a cgroup v2 directory, Eco also moves the process
+// into it, with cpu.weight / cpu.max written once. procRoot is injectable for fixture trees.
+class LinuxProcessQosControl : public IProcessQosControl {
+public:
+    explicit LinuxProcessQosControl(const ProcessQosOptions& opt = ProcessQosOptions(), const QosCgroup& group = QosCgroup(),
+        std::string procRoot = "/proc");
+    bool Set(uint32_t pid, uint64_t created, QosLevel level, QosSaved& saved) override;
+    bool Restore(uint32_t pid, uint64_t created, QosLevel level, const QosSaved& saved) override;
+private:
+    bool SameProcess(uint32_t pid, uint64_t created) const;
+    bool SetNice(uint32_t pid, int nice) const;
+
+    ProcessQosOptions opt;
+    QosCgroup         group;
+    std::string       procRoot;
+    bool              groupReady = false;
+};
+#endif
+
+struct ProcessQosConfig {
+    double   throttleCorePct = 25.0;   // background process over this share of a core ...
+    uint32_t throttleAfterMs = 10'000; // ... for this long -> Eco
+    double   releaseCorePct = 5.0;     // Eco process under this ...
+    uint32_t releaseAfterMs = 30'000;  // ... for this long -> restored
+    uint32_t maxThrottled = 64;
+    bool     boostHeavy = true;        // Boost-rule (heavy) processes -> High
+};
+
+class ProcessQosEngine {
+public:
+    struct Stats { uint64_t applied = 0, restored = 0, failures = 0; uint32_t eco = 0, high = 0; };
+
+    explicit ProcessQosEngine(IProcessQosControl& ctl, const ProcessQosConfig& cfg = ProcessQosConfig());
+
+    void SetConfig(const ProcessQosConfig& c) { cfg = c; }
+    void SetSelfPid(uint32_t pid) { selfPid = pid; }
+
+    // After each ProcessScanner::Scan. Marks throttled entries in the scanner so their load no
+    // longer counts as background-busy.
+    void Update(ProcessScanner& scanner, uint32_t fgPid, uint64_t nowMs);
+
+    // Foreground changed: a throttled process coming forward is restored at once.
+    void OnForeground(ProcessScanner& scanner, uint32_t fgPid);
+
+    void RestoreAll(ProcessScanner* scanner = nullptr);
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Track {
+        uint64_t created = 0;
+        uint64_t busySinceMs = 0;    // over throttleCorePct since
+        uint64_t quietSinceMs = 0;   // Eco and under releaseCorePct since
+        uint64_t seen = 0;           // update generation
+        QosLevel level = QosLevel::Default;
+        bool     failed = false;     // Set refused (protected process); don't retry
+        QosSaved saved;
+    };
+
+    void Change(uint32_t pid, Track& t, QosLevel to);
+    void Release(uint32_t pid, Track& t);
+    void Uncount(const Track& t);
+
+    IProcessQosControl&                 ctl;
+    ProcessQosConfig                    cfg;
+    std::unordered_map<uint32_t, Track> tracks;
+    uint32_t                            selfPid = 0;
+    uint64_t                            gen = 0;
+    Stats                               stats;
+};
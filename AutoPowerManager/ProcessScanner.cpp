@@ -0,0 +1,188 @@
+// ProcessScanner.cpp
+// Incremental per-process CPU accounting and its NT / procfs process-table sources.
+
+#include "ProcessScanner.h"
+#include "ForegroundTracker.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// ---------- Win32 source ----------
+namespace {
+typedef LONG(NTAPI* NtQuerySystemInformation_t)(ULONG, PVOID, ULONG, PULONG);
+const ULONG kSystemProcessInformation = 5;
+const LONG  kStatusInfoLengthMismatch = (LONG)0xC0000004;
+
+struct ProcessInfo {                // leading part of SYSTEM_PROCESS_INFORMATION
+    ULONG         NextEntryOffset;
+    ULONG         NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG         HardFaultCount;
+    ULONG         NumberOfThreadsHighWatermark;
+    ULONGLONG     CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;         // 100 ns
+    LARGE_INTEGER KernelTime;
+    struct { USHORT Length, MaximumLength; PWSTR Buffer; } ImageName;
+    LONG          BasePriority;
+    HANDLE        UniqueProcessId;
+};
+}
+
+NtProcessTableSource::NtProcessTableSource() {
+    if (HMODULE nt = GetModuleHandleW(L"ntdll.dll"))
+        query = reinterpret_cast<void*>(GetProcAddress(nt, "NtQuerySystemInformation"));
+    buf.resize(256 * 1024);
+}
+
+bool NtProcessTableSource::Scan(IProcessSink& sink) {
+    if (!query) return false;
+    auto fn = reinterpret_cast<NtQuerySystemInformation_t>(query);
+    for (;;) {
+        ULONG need = 0;
+        LONG st = fn(kSystemProcessInformation, buf.data(), (ULONG)buf.size(), &need);
+        if (st == kStatusInfoLengthMismatch) { buf.resize(std::max<size_t>(buf.size() * 2, need + 64 * 1024)); continue; }
+        if (st < 0) return false;
+        break;
+    }
+    for (size_t off = 0;;) {
+        auto* p = reinterpret_cast<const ProcessInfo*>(buf.data() + off);
+        uint64_t cpu100ns = (uint64_t)p->UserTime.QuadPart + (uint64_t)p->KernelTime.QuadPart;
+        sink.OnProcess((uint32_t)(uintptr_t)p->UniqueProcessId, (uint64_t)p->CreateTime.QuadPart, cpu100ns / 10,
+            p->ImageName.Buffer ? p->ImageName.Buffer : L"", p->ImageName.Length / sizeof(wchar_t));
+        if (!p->NextEntryOffset) break;
+        off += p->NextEntryOffset;
+    }
+    return true;
+}
+#else
+// ---------- procfs source ----------
+ProcfsProcessTableSource::ProcfsProcessTableSource(std::string root) : root(std::move(root)) {
+    long hz = sysconf(_SC_CLK_TCK);
+    usPerTick = 1e6 / (hz > 0 ? hz : 100);
+}
+
+bool ProcfsProcessTableSource::Scan(IProcessSink& sink) {
+    DIR* d = opendir(root.c_str());
+    if (!d) return false;
+    path.assign(root).append("/");
+    const size_t base = path.size();
+    char text[1024];
+    while (dirent* de = readdir(d)) {
+        if (de->d_name[0] < '0' || de->d_name[0] > '9') continue;
+        path.resize(base); path += de->d_name; path += "/stat";
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;                               // exited since readdir
+        ssize_t n = read(fd, text, sizeof(text) - 1);
+        close(fd);
+        if (n <= 0) continue;
+        text[n] = 0;
+
+        // "pid (comm) S ppid ..." -- comm may itself contain spaces or ')'.
+        const char* lp = strchr(text, '(');
+        const char* rp = strrchr(text, ')');
+        if (!lp || !rp || rp < lp) continue;
+        unsigned long utime = 0, stime = 0;
+        unsigned long long start = 0;
+        if (sscanf(rp + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %llu",
+                &utime, &stime, &start) != 3) continue;
+
+        wchar_t name[64];
+        size_t len = 0;
+        for (const char* c = lp + 1; c < rp && len < 63; ++c) name[len++] = (wchar_t)(unsigned char)*c;
+        name[len] = 0;
+        sink.OnProcess((uint32_t)strtoul(de->d_name, nullptr, 10), start, (uint64_t)((utime + stime) * usPerTick), name, len);
+    }
+    closedir(d);
+    return true;
+}
+#endif
+
+// ---------- Scanner ----------
+ProcessScanner::ProcessScanner(IProcessTableSource& src, const ProcessScannerConfig& cfg) : src(src), cfg(cfg) {
+    entries.reserve(512);
+    index.reserve(1024);
+}
+
+void ProcessScanner::SetRules(const AppRules& r) {
+    rules = r;
+    for (auto& e : entries) {
+        e.match = rules.Match(e.name, std::wstring());
+        e.heavy = e.match.Heavy(cfg.onAC);
+    }
+}
+
+const ProcessScanner::Entry* ProcessScanner::Find(uint32_t pid) const {
+    auto it = index.find(pid);
+    return it == index.end() ? nullptr : &entries[it->second];
+}
+
+void ProcessScanner::MarkThrottled(uint32_t pid, bool on) {
+    auto it = index.find(pid);
+    if (it != index.end()) entries[it->second].throttled = on;
+}
+
+void ProcessScanner::OnProcess(uint32_t pid, uint64_t created, uint64_t cpuUs, const wchar_t* name, size_t nameLen) {
+    if (pid == 0) return;   // NT idle process: its "CPU time" is idle time
+
+    auto it = index.find(pid);
+    if (it != index.end() && entries[it->second].created == created) {
+        Entry& e = entries[it->second];
+        uint64_t d = cpuUs >= e.cpuUs ? cpuUs - e.cpuUs : 0;
+        e.cpuUs = cpuUs;
+        e.seen = gen;
+        e.corePct = intervalUs > 0.0 ? 100.0 * (double)d / intervalUs : 0.0;
+        e.heavy = e.match.Heavy(cfg.onAC);
+
+        if (e.corePct > pending.topCorePct) { pending.topCorePct = e.corePct; pending.topPid = pid; }
+        if (e.heavy && e.corePct >= cfg.heavyMinCorePct) {
+            pending.heavyBusy = true;
+            if (e.corePct > pending.heavyCorePct) { pending.heavyCorePct = e.corePct; pending.heavyPid = pid; }
+        }
+        if (cfg.busyCorePct > 0.0 && e.corePct >= cfg.busyCorePct && !e.throttled) pending.busy = true;
+        return;
+    }
+
+    // New process (or a reused PID): resolve the name once; its share starts counting next scan.
+    Entry e;
+    e.pid = pid;
+    e.created = created;
+    e.cpuUs = cpuUs;
+    e.seen = gen;
+    e.name = NormalizeImageName(std::wstring(name, nameLen));
+    e.match = rules.Match(e.name, std::wstring());
+    e.heavy = e.match.Heavy(cfg.onAC);
+    if (it != index.end()) entries[it->second] = std::move(e);
+    else { index.emplace(pid, (uint32_t)entries.size()); entries.push_back(std::move(e)); }
+}
+
+bool ProcessScanner::Scan(uint64_t nowMs) {
+    ++gen;
+    intervalUs = lastScanMs && nowMs > lastScanMs ? (nowMs - lastScanMs) * 1000.0 : 0.0;
+    pending = BackgroundLoad{};
+    if (!src.Scan(*this)) return false;
+    lastScanMs = nowMs;
+
+    // Drop exited processes: swap-remove so the table stays dense.
+    for (size_t i = 0; i < entries.size();) {
+        if (entries[i].seen == gen) { ++i; continue; }
+        index.erase(entries[i].pid);
+        if (i + 1 != entries.size()) {
+            entries[i] = std::move(entries.back());
+            index[entries[i].pid] = (uint32_t)i;
+        }
+        entries.pop_back();
+    }
+    result = pending;
+    return true;
+}
@@ -0,0 +1,105 @@
+// ProcessScanner.h
+// Periodic whole-process CPU accounting so minimized/background solvers keep the machine out
+// of Saver. The table is updated incrementally by PID each scan; names are only resolved and
+// classified when a process is first seen.
+
+#pragma once
+
+#include "AppRules.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct IProcessSink {
+    virtual ~IProcessSink() = default;
+    // name is the image name (no path required) and is only valid during the call.
+    virtual void OnProcess(uint32_t pid, uint64_t created, uint64_t cpuUs, const wchar_t* name, size_t nameLen) = 0;
+};
+
+struct IProcessTableSource {
+    virtual ~IProcessTableSource() = default;
+    virtual bool Scan(IProcessSink& sink) = 0;
+};
+
+#ifdef _WIN32
+// One NtQuerySystemInformation(SystemProcessInformation) call per scan; no per-process handles.
+class NtProcessTableSource : public IProcessTableSource {
+public:
+    NtProcessTableSource();
+    bool Scan(IProcessSink& sink) override;
+private:
+    void* query = nullptr;    // NtQuerySystemInformation
+    std::vector<uint8_t> buf;
+};
+#endif
+
+#ifndef _WIN32
+// /proc/<pid>/stat (comm, utime, stime, starttime); root is injectable for fixture trees.
+class ProcfsProcessTableSource : public IProcessTableSource {
+public:
+    explicit ProcfsProcessTableSource(std::string root = "/proc");
+    bool Scan(IProcessSink& sink) override;
+private:
+    std::string root;
+    std::string path;        // reused across scans
+    double      usPerTick;
+};
+#endif
+
+struct ProcessScannerConfig {
+    double heavyMinCorePct = 10.0;   // heavy (Boost-rule) process using this much of a core -> hold Active
+    double busyCorePct = 80.0;       // any process using this much of a core -> hold Engaged
+    bool   onAC = true;              // picks the app rules that apply
+};
+
+struct BackgroundLoad {
+    bool     heavyBusy = false;      // a heavy app is computing
+    bool     busy = false;           // some process is over busyCorePct
+    uint32_t topPid = 0;
+    double   topCorePct = 0.0;       // 100 = one full logical processor
+    uint32_t heavyPid = 0;           // the busiest heavy process, when heavyBusy
+    double   heavyCorePct = 0.0;
+};
+
+class ProcessScanner : private IProcessSink {
+public:
+    struct Entry {
+        uint32_t     pid = 0;
+        uint64_t     created = 0;
+        uint64_t     cpuUs = 0;      // cumulative at the last scan
+        double       corePct = 0.0;  // over the last scan interval
+        uint64_t     seen = 0;       // scan generation
+        AppMatch     match;          // by name only: the table has no paths
+        bool         heavy = false;  // match, for the power source at the last scan
+        bool         throttled = false;   // moved to EcoQoS (ProcessQosEngine): not background-busy
+        std::wstring name;           // normalized
+    };
+
+    explicit ProcessScanner(IProcessTableSource& src, const ProcessScannerConfig& cfg = ProcessScannerConfig());
+
+    void SetConfig(const ProcessScannerConfig& c) { cfg = c; }
+    void SetRules(const AppRules& r);
+
+    // nowMs: monotonic clock. Returns false if the source failed (previous result is kept).
+    bool Scan(uint64_t nowMs);
+
+    const BackgroundLoad&     Result() const { return result; }
+    const std::vector<Entry>& Entries() const { return entries; }
+    const Entry*              Find(uint32_t pid) const;
+    void                      MarkThrottled(uint32_t pid, bool on);
+
+private:
+    void OnProcess(uint32_t pid, uint64_t created, uint64_t cpuUs, const wchar_t* name, size_t nameLen) override;
+
+    IProcessTableSource&                   src;
+    ProcessScannerConfig                   cfg;
+    AppRules                               rules;
+    std::vector<Entry>                     entries;
+    std::unordered_map<uint32_t, uint32_t> index;   // pid -> entries slot
+    uint64_t                               gen = 0;
+    uint64_t                               lastScanMs = 0;
+    double                                 intervalUs = 0.0;
+    BackgroundLoad                         result, pending;
+};
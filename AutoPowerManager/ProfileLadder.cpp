@@ -0,0 +1,136 @@
+// ProfileLadder.cpp
+// Ladder table, user level parsing and the slew-limited ladder controller.
+
+#include "ProfileLadder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
+
+// ---------- Levels ----------
+bool ParseProfileLevel(const std::wstring& line, ProfileLevel& out) {
+    ProfileLevel l{};
+    size_t comma = line.find(L',');
+    if (comma == std::wstring::npos) return false;
+    std::wstring name = line.substr(0, comma);
+    name.erase(name.begin(), std::find_if(name.begin(), name.end(), [](wchar_t c) {return !iswspace(c);}));
+    name.erase(std::find_if(name.rbegin(), name.rend(), [](wchar_t c) {return !iswspace(c);}).base(), name.end());
+    if (name.empty() || name.size() >= sizeof(l.name)) return false;
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (name[i] > 0x7E || name[i] < 0x20) return false;
+        l.name[i] = (char)name[i];
+    }
+
+    uint8_t* fields[] = { &l.rank, &l.minAC, &l.minDC, &l.maxAC, &l.maxDC, &l.boostAC, &l.boostDC, &l.parkAC, &l.parkDC,
+        &l.pMinAC, &l.pMinDC, &l.pMaxAC, &l.pMaxDC, &l.eMinAC, &l.eMinDC, &l.eMaxAC, &l.eMaxDC };
+    const size_t required = 9, total = sizeof(fields) / sizeof(fields[0]);
+    const wchar_t* p = line.c_str() + comma + 1;
+    size_t i = 0;
+    for (; i < total; ++i) {
+        wchar_t* end = nullptr;
+        long v = wcstol(p, &end, 10);
+        if (end == p) return false;
+        long hi = (fields[i] == &l.boostAC || fields[i] == &l.boostDC) ? 4 : 100;
+        *fields[i] = (uint8_t)std::min(hi, std::max(0L, v));
+        p = end;
+        while (*p == L' ' || *p == L'\t') ++p;
+        if (i + 1 == required && !*p) { ++i; break; }   // no hybrid fields
+        if (i + 1 < total) { if (*p != L',') return false; ++p; }
+    }
+    if (i != required && i != total) return false;
+    if (i == required) {
+        l.pMinAC = l.eMinAC = l.minAC; l.pMinDC = l.eMinDC = l.minDC;
+        l.pMaxAC = l.eMaxAC = l.maxAC; l.pMaxDC = l.eMaxDC = l.maxDC;
+    }
+    if (l.minAC > l.maxAC || l.minDC > l.maxDC) return false;
+    if (l.pMinAC > l.pMaxAC || l.pMinDC > l.pMaxDC || l.eMinAC > l.eMaxAC || l.eMinDC > l.eMaxDC) return false;
+    out = l;
+    return true;
+}
+
+ProfileLadder::ProfileLadder() { Reset(); }
+
+void ProfileLadder::Reset() {
+    levels.assign(std::begin(kDefaultLadder), std::end(kDefaultLadder));
+}
+
+void ProfileLadder::Merge(const ProfileLevel& l) {
+    auto same = std::find_if(levels.begin(), levels.end(), [&](const ProfileLevel& x) { return strcmp(x.name, l.name) == 0; });
+    if (same != levels.end()) *same = l;
+    else levels.push_back(l);
+    std::stable_sort(levels.begin(), levels.end(), [](const ProfileLevel& a, const ProfileLevel& b) { return a.rank > b.rank; });
+}
+
+size_t ProfileLadder::Anchor(ProcProfile p) const {
+    const char* want = ProfileNameA(p);
+    for (size_t i = 0; i < levels.size(); ++i)
+        if (strcmp(levels[i].name, want) == 0) return i;
+    return p == ProcProfile::Boost ? 0 : p == ProcProfile::Saver ? levels.size() - 1 : levels.size() / 2;
+}
+
+// ---------- Interpolation ----------
+bool LadderSetpoint::operator==(const LadderSetpoint& o) const {
+    return minAC == o.minAC && minDC == o.minDC && maxAC == o.maxAC && maxDC == o.maxDC &&
+        boostAC == o.boostAC && boostDC == o.boostDC && parkAC == o.parkAC && parkDC == o.parkDC &&
+        pMinAC == o.pMinAC && pMinDC == o.pMinDC && pMaxAC == o.pMaxAC && pMaxDC == o.pMaxDC &&
+        eMinAC == o.eMinAC && eMinDC == o.eMinDC && eMaxAC == o.eMaxAC && eMaxDC == o.eMaxDC;
+}
+
+static uint8_t Lerp(uint8_t a, uint8_t b, double f) { return (uint8_t)std::lround(a + (b - a) * f); }
+
+LadderSetpoint InterpolateLadder(const ProfileLadder& ladder, double pos) {
+    LadderSetpoint s;
+    if (!ladder.Size()) return s;
+    double top = (double)(ladder.Size() - 1);
+    pos = std::min(top, std::max(0.0, pos));
+    size_t i = (size_t)pos;
+    const ProfileLevel& a = ladder[i];
+    const ProfileLevel& b = ladder[std::min(i + 1, ladder.Size() - 1)];
+    double f = pos - (double)i;
+    s.minAC = Lerp(a.minAC, b.minAC, f);  s.minDC = Lerp(a.minDC, b.minDC, f);
+    s.maxAC = Lerp(a.maxAC, b.maxAC, f);  s.maxDC = Lerp(a.maxDC, b.maxDC, f);
+    s.parkAC = Lerp(a.parkAC, b.parkAC, f); s.parkDC = Lerp(a.parkDC, b.parkDC, f);
+    s.pMinAC = Lerp(a.pMinAC, b.pMinAC, f); s.pMinDC = Lerp(a.pMinDC, b.pMinDC, f);
+    s.pMaxAC = Lerp(a.pMaxAC, b.pMaxAC, f); s.pMaxDC = Lerp(a.pMaxDC, b.pMaxDC, f);
+    s.eMinAC = Lerp(a.eMinAC, b.eMinAC, f); s.eMinDC = Lerp(a.eMinDC, b.eMinDC, f);
+    s.eMaxAC = Lerp(a.eMaxAC, b.eMaxAC, f); s.eMaxDC = Lerp(a.eMaxDC, b.eMaxDC, f);
+    // Boost mode is an enumeration, not a scale: take the nearer level.
+    const ProfileLevel& n = f < 0.5 ? a : b;
+    s.boostAC = n.boostAC; s.boostDC = n.boostDC;
+    return s;
+}
+
+// ---------- Controller ----------
+LadderSetpoint LadderController::Update(const ProfileLadder& ladder, uint64_t nowMs, ProcProfile profile, double utilPct) {
+    const double top = ladder.Size() ? (double)(ladder.Size() - 1) : 0.0;
+    const double dt = lastMs && nowMs > lastMs ? (double)std::min<uint64_t>(nowMs - lastMs, 60'000) : 0.0;
+    lastMs = nowMs;
+
+    const double anchor = (double)ladder.Anchor(profile);
+    const bool raised = (int)profile < (int)lastProfile;
+    if (profile != lastProfile) bias = 0.0;
+    lastProfile = profile;
+
+    // Utilization loop, Balanced only; the deadband keeps it from chasing noise.
+    if (profile == ProcProfile::Balanced && dt > 0.0 && cfg.biasMsPerLevel) {
+        double step = dt / cfg.biasMsPerLevel, err = utilPct - cfg.targetUtilPct;
+        if (err > cfg.deadbandPct) bias -= step;
+        else if (err < -cfg.deadbandPct) bias += step;
+        bias = std::min(cfg.biasLevels, std::max(-cfg.biasLevels, bias));
+    }
+    const double goal = std::min(top, std::max(0.0, anchor + bias));
+
+    if (pos < 0.0) pos = goal;                                   // first update
+    else if (goal < pos) {
+        // A governor raise (input, heavy app) is applied at once; loop-driven raises are slewed.
+        pos = raised ? goal : std::max(goal, pos - dt / std::max(1u, cfg.upMsPerLevel));
+    }
+    else if (goal > pos) pos = std::min(goal, pos + dt / std::max(1u, cfg.downMsPerLevel));
+    pos = std::min(top, pos);
+    settled = std::fabs(pos - goal) < 1e-6;
+
+    const double steps = (double)std::max(1u, cfg.stepsPerLevel);
+    return InterpolateLadder(ladder, std::round(pos * steps) / steps);
+}
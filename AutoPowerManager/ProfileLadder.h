@@ -0,0 +1,101 @@
+// ProfileLadder.h
+// Processor profiles as data: an ordered ladder of levels (min/max processor state, boost mode,
+// core-parking minimum, per-class limits for hybrid CPUs) and a controller that moves continuously along it. The governor's
+// Boost/Balanced/Saver choice picks an anchor level; a utilization loop nudges around it and
+// downward moves are slew-limited, so a finished job walks down instead of falling off a cliff.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ProfileLevel {
+    char    name[16];
+    uint8_t rank;                 // 0..100, higher = faster; the ladder is ordered by it
+    uint8_t minAC, minDC;         // SET_MIN_PROC_STATE %
+    uint8_t maxAC, maxDC;         // SET_MAX_PROC_STATE %
+    uint8_t boostAC, boostDC;     // SET_BOOST_MODE (0:Off 1:Efficient 2:Aggressive 3:AggressiveAtGuarantee)
+    uint8_t parkAC, parkDC;       // SET_CORE_PARK_MIN_CORES %
+    // Hybrid CPUs only (see CpuTopology.h), in place of min/max above.
+    uint8_t pMinAC, pMinDC, pMaxAC, pMaxDC;   // performance cores: SET_MIN/MAX_PROC_STATE1 %
+    uint8_t eMinAC, eMinDC, eMaxAC, eMaxDC;   // efficiency cores: SET_MIN/MAX_PROC_STATE %
+};
+
+// Boost/Balanced/Saver keep their historical values; the two in between remove the cliffs.
+// On hybrid CPUs, E-cores get no raised floor (Boost needn't wake them) and take the deeper caps,
+// while P-cores stay quicker in the slow levels.
+constexpr ProfileLevel kDefaultLadder[] = {
+    //                rank  min     max     boost  park    P: min    max     E: min  max
+    { "Boost",       100, 80, 50, 100, 90, 3, 2, 100, 60,  80, 50, 100, 90,  5, 5, 100, 90 },
+    { "Performance",  75, 45, 30, 100, 85, 2, 2,  80, 50,  45, 30, 100, 85,  5, 5, 100, 80 },
+    { "Balanced",     50, 20, 10, 100, 80, 2, 1,  60, 40,  20, 10, 100, 85,  5, 5,  90, 70 },
+    { "Efficient",    25, 10,  5,  80, 65, 1, 1,  45, 35,  10,  5,  90, 75,  5, 5,  70, 55 },
+    { "Saver",         0,  5,  5,  60, 50, 1, 0,  30, 30,   5,  5,  80, 65,  5, 5,  50, 40 },
+};
+
+// "name,rank,minAC,minDC,maxAC,maxDC,boostAC,boostDC,parkAC,parkDC"
+// [",pMinAC,pMinDC,pMaxAC,pMaxDC,eMinAC,eMinDC,eMaxAC,eMaxDC"]; without the hybrid fields both
+// core classes use min/max.
+bool ParseProfileLevel(const std::wstring& line, ProfileLevel& out);
+
+class ProfileLadder {
+public:
+    ProfileLadder();   // kDefaultLadder
+
+    // Adds a level, or replaces the one with the same name; keeps the ladder ordered by rank.
+    void Merge(const ProfileLevel& l);
+    void Reset();
+
+    size_t              Size() const { return levels.size(); }
+    const ProfileLevel& operator[](size_t i) const { return levels[i]; }   // 0 = fastest
+    size_t              Anchor(ProcProfile p) const;                        // level for a governor profile
+
+private:
+    std::vector<ProfileLevel> levels;
+};
+
+struct LadderControllerConfig {
+    double   targetUtilPct = 60.0;     // utilization the loop steers toward
+    double   deadbandPct = 15.0;       // no bias change within target +/- this (hysteresis)
+    double   biasLevels = 1.0;         // how far the loop may move away from the anchor
+    uint32_t biasMsPerLevel = 5'000;   // loop speed
+    uint32_t downMsPerLevel = 4'000;   // slew limit when lowering performance
+    uint32_t upMsPerLevel = 250;       // slew limit for loop-driven raises (profile raises jump)
+    uint32_t stepsPerLevel = 4;        // output quantization, bounds the number of writes
+};
+
+// Interpolated settings for one position on the ladder.
+struct LadderSetpoint {
+    uint8_t minAC = 0, minDC = 0, maxAC = 0, maxDC = 0, boostAC = 0, boostDC = 0, parkAC = 0, parkDC = 0;
+    uint8_t pMinAC = 0, pMinDC = 0, pMaxAC = 0, pMaxDC = 0, eMinAC = 0, eMinDC = 0, eMaxAC = 0, eMaxDC = 0;
+    bool operator==(const LadderSetpoint& o) const;
+    bool operator!=(const LadderSetpoint& o) const { return !(*this == o); }
+};
+
+LadderSetpoint InterpolateLadder(const ProfileLadder& ladder, double pos);
+
+class LadderController {
+public:
+    explicit LadderController(const LadderControllerConfig& cfg = LadderControllerConfig()) : cfg(cfg) {}
+
+    void SetConfig(const LadderControllerConfig& c) { cfg = c; }
+    const LadderControllerConfig& Config() const { return cfg; }
+
+    // utilPct: smoothed utilization (the app uses max(aggregate, top-k)). The loop only biases Balanced;
+    // Boost and Saver are policy decisions (input hold, battery, lock) and stay on their anchors.
+    LadderSetpoint Update(const ProfileLadder& ladder, uint64_t nowMs, ProcProfile profile, double utilPct);
+
+    double Position() const { return pos; }          // 0 = fastest level
+    bool   Settled() const { return settled; }       // false while still slewing toward the goal
+
+private:
+    LadderControllerConfig cfg;
+    double      pos = -1.0;                          // <0: not initialized
+    double      bias = 0.0;                          // levels, + = slower
+    uint64_t    lastMs = 0;
+    ProcProfile lastProfile = ProcProfile::Balanced;
+    bool        settled = true;
+};
@@ -0,0 +1,248 @@
+// SignalFilter.cpp
+
+#include "SignalFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ---------- Sliding median ----------
+void SlidingMedian::Reset(uint32_t w) {
+    window = std::max<uint32_t>(1, std::min(kMaxWindow, w));
+    count = head = 0;
+    size[0] = size[1] = 0;
+    vals.assign(window, 0.0);
+    heaps[0].assign(window, 0);
+    heaps[1].assign(window, 0);
+    heapOf.assign(window, 0);
+    posOf.assign(window, 0);
+}
+
+void SlidingMedian::Place(int heap, uint32_t i, uint16_t slot) {
+    heaps[heap][i] = slot;
+    heapOf[slot] = (uint8_t)heap;
+    posOf[slot] = (uint16_t)i;
+}
+
+void SlidingMedian::SiftUp(int heap, uint32_t i) {
+    const uint16_t slot = heaps[heap][i];
+    while (i > 0) {
+        const uint32_t parent = (i - 1) / 2;
+        if (!Before(heap, slot, heaps[heap][parent])) break;
+        Place(heap, i, heaps[heap][parent]);
+        i = parent;
+    }
+    Place(heap, i, slot);
+}
+
+void SlidingMedian::SiftDown(int heap, uint32_t i) {
+    const uint16_t slot = heaps[heap][i];
+    const uint32_t n = size[heap];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && Before(heap, heaps[heap][child + 1], heaps[heap][child])) ++child;
+        if (!Before(heap, heaps[heap][child], slot)) break;
+        Place(heap, i, heaps[heap][child]);
+        i = child;
+    }
+    Place(heap, i, slot);
+}
+
+void SlidingMedian::Push(int heap, uint16_t slot) {
+    const uint32_t i = size[heap]++;
+    Place(heap, i, slot);
+    SiftUp(heap, i);
+}
+
+uint16_t SlidingMedian::Pop(int heap) {
+    const uint16_t top = heaps[heap][0];
+    const uint32_t last = --size[heap];
+    if (last) {
+        Place(heap, 0, heaps[heap][last]);
+        SiftDown(heap, 0);
+    }
+    return top;
+}
+
+double SlidingMedian::Update(double x) {
+    if (count < window) {
+        // Filling: insert, then keep the lower half the same size as the upper or one larger.
+        const uint16_t slot = (uint16_t)count++;
+        vals[slot] = x;
+        Push(size[0] && x > vals[heaps[0][0]] ? 1 : 0, slot);
+        if (size[0] > size[1] + 1) Push(1, Pop(0));
+        else if (size[1] > size[0]) Push(0, Pop(1));
+        return Value();
+    }
+
+    // Full: the oldest slot takes the new sample and is re-sifted where it is. If that breaks the
+    // halves' order, exchanging the two tops restores it (only one element moved).
+    const uint16_t slot = (uint16_t)head;
+    head = (head + 1) % window;
+    vals[slot] = x;
+    const int h = heapOf[slot];
+    SiftUp(h, posOf[slot]);
+    SiftDown(h, posOf[slot]);
+    if (size[1] && Less(heaps[1][0], heaps[0][0])) {
+        const uint16_t lo = heaps[0][0], hi = heaps[1][0];
+        Place(0, 0, hi);
+        Place(1, 0, lo);
+        SiftDown(0, 0);
+        SiftDown(1, 0);
+    }
+    return Value();
+}
+
+double SlidingMedian::Value() const {
+    if (!count) return 0.0;
+    const double lo = vals[heaps[0][0]];
+    return size[0] > size[1] ? lo : 0.5 * (lo + vals[heaps[1][0]]);
+}
+
+// ---------- Smoothers ----------
+double AsymmetricEwma::Update(double x, double dtMs) {
+    if (!primed) { primed = true; value = x; return value; }
+    dtMs = std::max(dtMs, 0.0);
+    if (dtMs != alphaDt) {
+        alphaDt = dtMs;
+        alphaRise = rise > 0.0 ? 1.0 - std::exp(-dtMs / rise) : 1.0;
+        alphaFall = fall > 0.0 ? 1.0 - std::exp(-dtMs / fall) : 1.0;
+    }
+    value += (x >= value ? alphaRise : alphaFall) * (x - value);
+    return value;
+}
+
+double ScalarKalman::Update(double z, double dtMs) {
+    if (!primed) { primed = true; x = z; p = r; k = 1.0; return x; }
+    p += q * std::max(dtMs, 0.0) / 1000.0;   // predict: the level may have drifted
+    k = p + r > 0.0 ? p / (p + r) : 1.0;
+    x += k * (z - x);
+    p *= 1.0 - k;
+    return x;
+}
+
+// ---------- Specs ----------
+bool FilterSpec::operator==(const FilterSpec& o) const {
+    return medianWindow == o.medianWindow && smoother == o.smoother && riseMs == o.riseMs && fallMs == o.fallMs
+        && kalmanQ == o.kalmanQ && kalmanR == o.kalmanR;
+}
+
+FilterSpec FilterSpec::MedianEwma(uint32_t window, double riseMs, double fallMs) {
+    FilterSpec s;
+    s.medianWindow = window;
+    s.smoother = SmootherKind::Ewma;
+    s.riseMs = riseMs;
+    s.fallMs = fallMs;
+    return s;
+}
+
+FilterSpec FilterSpec::LegacyCpu() {
+    const double tau = -1000.0 / std::log(0.80);   // 4481 ms: alpha 0.20 at 1 s ticks
+    return MedianEwma(5, tau, tau);
+}
+
+// "a" or "a/b" after "name:"; b defaults to a.
+static bool ParsePair(const char* p, const char* end, double& a, double& b) {
+    char* e = nullptr;
+    a = strtod(p, &e);
+    if (e == p || a < 0.0) return false;
+    b = a;
+    if (e < end && *e == '/') {
+        const char* q = e + 1;
+        b = strtod(q, &e);
+        if (e == q || b < 0.0) return false;
+    }
+    return e == end;
+}
+
+bool ParseFilterSpec(const char* text, FilterSpec& out) {
+    FilterSpec s;
+    const char* p = text;
+    while (*p == ' ' || *p == '\t') ++p;
+    if (!*p || !strcmp(p, "none")) { out = s; return true; }
+    while (*p) {
+        const char* end = p;
+        while (*end && *end != '+') ++end;
+        const char* stop = end;
+        while (stop > p && (stop[-1] == ' ' || stop[-1] == '\t' || stop[-1] == '\r' || stop[-1] == '\n')) --stop;
+        double a = 0, b = 0;
+        if (!strncmp(p, "median:", 7)) {
+            char* e = nullptr;
+            const long w = strtol(p + 7, &e, 10);
+            if (e != stop || w < 1 || w > (long)SlidingMedian::kMaxWindow) return false;
+            s.medianWindow = (uint32_t)w;
+        }
+        else if (!strncmp(p, "ewma:", 5) && ParsePair(p + 5, stop, a, b) && s.smoother == SmootherKind::None) {
+            s.smoother = SmootherKind::Ewma; s.riseMs = a; s.fallMs = b;
+        }
+        else if (!strncmp(p, "kalman:", 7) && ParsePair(p + 7, stop, a, b) && s.smoother == SmootherKind::None) {
+            s.smoother = SmootherKind::Kalman; s.kalmanQ = a; s.kalmanR = b;
+        }
+        else return false;
+        p = *end ? end + 1 : end;
+        while (*p == ' ' || *p == '\t') ++p;
+    }
+    out = s;
+    return true;
+}
+
+bool ParseFilterSpec(const wchar_t* text, FilterSpec& out) {
+    char narrow[128];
+    size_t n = 0;
+    for (; text[n]; ++n) {
+        if (n + 1 >= sizeof(narrow) || text[n] > 0x7f) return false;   // specs are ASCII
+        narrow[n] = (char)text[n];
+    }
+    narrow[n] = 0;
+    return ParseFilterSpec(narrow, out);
+}
+
+void FormatFilterSpec(const FilterSpec& s, char* out, size_t cap) {
+    if (!cap) return;
+    char* p = out;
+    size_t left = cap;
+    auto put = [&](int w) {
+        if (w < 0 || (size_t)w >= left) { p += left - 1; left = 1; }   // truncated
+        else { p += w; left -= (size_t)w; }
+    };
+    *p = 0;
+    const char* sep = "";
+    if (s.medianWindow > 1) { put(snprintf(p, left, "median:%u", (unsigned)s.medianWindow)); sep = "+"; }
+    if (s.smoother == SmootherKind::Ewma)
+        put(s.riseMs == s.fallMs ? snprintf(p, left, "%sewma:%g", sep, s.riseMs) : snprintf(p, left, "%sewma:%g/%g", sep, s.riseMs, s.fallMs));
+    else if (s.smoother == SmootherKind::Kalman)
+        put(snprintf(p, left, "%skalman:%g/%g", sep, s.kalmanQ, s.kalmanR));
+    if (p == out) snprintf(out, cap, "none");
+}
+
+// ---------- Chain ----------
+void SignalFilter::Configure(const FilterSpec& s) {
+    if (configured && s == spec) return;
+    configured = true;
+    spec = s;
+    median.Reset(spec.medianWindow > 1 ? spec.medianWindow : 1);
+    ewma.Configure(spec.riseMs, spec.fallMs);
+    kalman.Configure(spec.kalmanQ, spec.kalmanR);
+    Reset();
+}
+
+void SignalFilter::Reset() {
+    median.Reset(median.Window());
+    ewma.Reset();
+    kalman.Reset();
+    value = 0.0;
+}
+
+double SignalFilter::Update(double x, double dtMs) {
+    if (spec.medianWindow > 1) x = median.Update(x);
+    switch (spec.smoother) {
+    case SmootherKind::Ewma:   x = ewma.Update(x, dtMs); break;
+    case SmootherKind::Kalman: x = kalman.Update(x, dtMs); break;
+    case SmootherKind::None:   break;
+    }
+    value = x;
+    return value;
+}
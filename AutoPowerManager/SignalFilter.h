@@ -0,0 +1,138 @@
+// SignalFilter.h
+// Filters for the governor's input signals: a sliding median of any window (O(log N) per sample),
+// an EWMA with separate rise and fall time constants, a scalar Kalman filter and a hysteresis
+// comparator. A SignalFilter chains an optional median with one smoother, chosen per signal from a
+// short text spec, so the CPU, idle and battery inputs can each be tuned from configuration.
+//
+// Storage is sized when a spec is applied; updating never allocates.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Median of the last N samples, from two heaps of ring-buffer slots (lower half max-heap, upper
+// half min-heap). The outgoing sample's slot is overwritten and re-sifted in place, so each update
+// is O(log N). Until N samples have arrived, the median of those seen so far.
+class SlidingMedian {
+public:
+    static constexpr uint32_t kMaxWindow = 1024;
+
+    explicit SlidingMedian(uint32_t window = 5) { Reset(window); }
+    void     Reset(uint32_t window);
+    double   Update(double x);
+    double   Value() const;
+    uint32_t Window() const { return window; }
+    uint32_t Count() const { return count; }
+
+private:
+    bool Less(uint16_t a, uint16_t b) const { return vals[a] < vals[b]; }
+    void Place(int heap, uint32_t i, uint16_t slot);
+    void SiftUp(int heap, uint32_t i);
+    void SiftDown(int heap, uint32_t i);
+    void Push(int heap, uint16_t slot);
+    uint16_t Pop(int heap);
+    bool Before(int heap, uint16_t a, uint16_t b) const { return heap == 0 ? Less(b, a) : Less(a, b); }   // heap order
+
+    uint32_t              window = 0, count = 0, head = 0;
+    std::vector<double>   vals;        // by slot
+    std::vector<uint16_t> heaps[2];    // 0: lower half (max at top), 1: upper half (min at top)
+    uint32_t              size[2] = {};
+    std::vector<uint8_t>  heapOf;      // by slot
+    std::vector<uint16_t> posOf;       // by slot
+};
+
+// Exponential smoothing with time constants instead of a per-tick alpha, so irregular tick spacing
+// keeps the same response: alpha = 1 - exp(-dt / tau). A short rise constant with a long fall
+// constant reacts to load at once and lets go slowly. Starts at the first sample.
+class AsymmetricEwma {
+public:
+    void   Configure(double riseMs, double fallMs) { rise = riseMs; fall = fallMs; alphaDt = -1.0; }
+    double Update(double x, double dtMs);
+    double Value() const { return value; }
+    void   Reset() { primed = false; value = 0.0; }
+
+private:
+    double rise = 4'481.42, fall = 4'481.42;   // alpha 0.20 per second
+    double value = 0.0;
+    bool   primed = false;
+    double alphaDt = -1.0, alphaRise = 0.0, alphaFall = 0.0;   // ticks are mostly evenly spaced
+};
+
+// Scalar Kalman filter for a level that drifts as a random walk: q is the drift variance per second,
+// r the measurement variance (both in signal units squared). The gain settles where the two balance;
+// a large r relative to q smooths harder. Starts at the first sample.
+class ScalarKalman {
+public:
+    void   Configure(double q, double r) { this->q = q; this->r = r; }
+    double Update(double z, double dtMs);
+    double Value() const { return x; }
+    double Gain() const { return k; }
+    void   Reset() { primed = false; x = 0.0; p = 0.0; k = 0.0; }
+
+private:
+    double q = 4.0, r = 100.0;
+    double x = 0.0, p = 0.0, k = 0.0;
+    bool   primed = false;
+};
+
+// Schmitt trigger: turns on above `on`, off at or below `off` (off <= on). With off == on it is a
+// plain comparison.
+class Hysteresis {
+public:
+    bool Update(double v, double on, double off) {
+        if (v > on) state = true;
+        else if (v <= off) state = false;
+        return state;
+    }
+    bool State() const { return state; }
+    void Reset() { state = false; }
+
+private:
+    bool state = false;
+};
+
+enum class SmootherKind : uint8_t { None, Ewma, Kalman };
+
+// "median:5+ewma:4481.42" / "median:3+ewma:300/6000" (rise/fall ms) / "kalman:4/100" (q/r) / "none".
+struct FilterSpec {
+    uint32_t     medianWindow = 0;    // samples; 0 or 1: no median
+    SmootherKind smoother = SmootherKind::None;
+    double       riseMs = 0.0, fallMs = 0.0;
+    double       kalmanQ = 0.0, kalmanR = 0.0;
+
+    bool operator==(const FilterSpec& o) const;
+    bool operator!=(const FilterSpec& o) const { return !(*this == o); }
+
+    static FilterSpec Passthrough() { return FilterSpec(); }
+    static FilterSpec MedianEwma(uint32_t window, double riseMs, double fallMs);
+    static FilterSpec LegacyCpu();    // median of 5, then EWMA alpha 0.20 per second
+};
+
+// False (and out unchanged) on a malformed spec.
+bool ParseFilterSpec(const char* text, FilterSpec& out);
+bool ParseFilterSpec(const wchar_t* text, FilterSpec& out);
+// Canonical text for a spec; truncates to cap - 1 characters.
+void FormatFilterSpec(const FilterSpec& spec, char* out, size_t cap);
+
+class SignalFilter {
+public:
+    explicit SignalFilter(const FilterSpec& spec = FilterSpec()) { Configure(spec); }
+
+    // Restarts the filter only when the spec differs, so a config copied every tick costs nothing.
+    void Configure(const FilterSpec& spec);
+    const FilterSpec& Spec() const { return spec; }
+
+    double Update(double x, double dtMs);
+    double Value() const { return value; }
+    void   Reset();
+
+private:
+    FilterSpec     spec;
+    bool           configured = false;
+    SlidingMedian  median;
+    AsymmetricEwma ewma;
+    ScalarKalman   kalman;
+    double         value = 0.0;
+};
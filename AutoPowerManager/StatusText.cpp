@@ -0,0 +1,49 @@
+// StatusText.cpp
+
+#include "StatusText.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cwchar>
+
+const wchar_t* ProfileNameW(ProcProfile p) {
+    return p == ProcProfile::Boost ? L"Boost" : p == ProcProfile::Balanced ? L"Balanced" : L"Saver";
+}
+
+// Idle time coarser the longer it gets (whole minutes, then 5, then 15), so on an idle machine the
+// text, and the shell update each change costs, only changes every few minutes.
+static void FormatIdle(uint32_t idleSec, wchar_t* out, size_t cap) {
+    const unsigned min = idleSec / 60;
+    if (min < 1) swprintf(out, cap, L"<1 min");
+    else if (min < 10) swprintf(out, cap, L"%u min", min);
+    else if (min < 60) swprintf(out, cap, L"%u min", min / 5 * 5);
+    else swprintf(out, cap, L"%uh %02um", min / 60, min % 60 / 15 * 15);
+}
+
+void FormatTrayTip(const StatusFields& f, wchar_t* out, size_t cap) {
+    if (!cap) return;
+    wchar_t idle[16];
+    FormatIdle(f.idleSec, idle, sizeof(idle) / sizeof(idle[0]));
+    if (swprintf(out, cap, L"Auto Power Manager\nProfile: %ls \u2022 CPU~%d%% (core %d%%) \u2022 Idle %ls\nAC:%ls \u2022 Batt:%d%%",
+            ProfileNameW(f.profile), (int)f.cpuPct, (int)f.maxCorePct, idle,
+            f.onAC ? L"Online" : L"Battery", f.battPct) < 0)
+        out[cap - 1] = 0;   // truncated
+}
+
+void FormatStatusLine(const StatusFields& f, wchar_t* out, size_t cap) {
+    if (!cap) return;
+    wchar_t level[16];
+    size_t i = 0;
+    for (; f.level[i] && i + 1 < sizeof(level) / sizeof(level[0]); ++i) level[i] = (wchar_t)(unsigned char)f.level[i];
+    level[i] = 0;
+    wchar_t idle[16];
+    FormatIdle(f.idleSec, idle, sizeof(idle) / sizeof(idle[0]));
+    // %ls: wide on both the MSVC and the ISO printf families.
+    int n = swprintf(out, cap, L"Profile:%ls (%ls)  CPU~%d%% (core %d%%)  Idle:%ls  AC:%ls  Batt:%d%%  Tick:%ums  Switch p50/p99:%.1f/%.1fms  Temp:%dC cap:%d  Eco:%u",
+        ProfileNameW(f.profile), level, (int)f.cpuPct, (int)f.maxCorePct, idle,
+        f.onAC ? L"Online" : L"Battery", f.battPct, (unsigned)f.tickMs, f.switchP50Ms, f.switchP99Ms,
+        (int)std::lround(f.tempC), f.thermalLevel, (unsigned)f.eco);
+    if (n < 0) { out[cap - 1] = 0; return; }   // truncated
+    if (f.hybrid && (size_t)n < cap)
+        swprintf(out + n, cap - n, L"  P/E:%d/%d%%", (int)f.pCoresPct, (int)f.eCoresPct);
+}
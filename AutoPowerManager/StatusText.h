@@ -0,0 +1,36 @@
+// StatusText.h
+// The tray tooltip and the settings dialog's status line, formatted from plain fields so the
+// formatting builds (and is measured, Tools/GovBench) off-Windows too.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstddef>
+#include <cstdint>
+
+struct StatusFields {
+    ProcProfile profile = ProcProfile::Balanced;
+    const char* level = "";          // ladder level name
+    double      cpuPct = 0.0;        // smoothed
+    double      maxCorePct = 0.0;
+    uint32_t    idleSec = 0;         // shown in minutes, coarser past 10
+    bool        onAC = true;
+    int         battPct = 100;
+    uint32_t    tickMs = 0;
+    double      switchP50Ms = 0.0;
+    double      switchP99Ms = 0.0;
+    double      tempC = -1.0;
+    int         thermalLevel = 0;
+    uint32_t    eco = 0;             // processes in EcoQoS
+    bool        hybrid = false;
+    double      pCoresPct = 0.0;
+    double      eCoresPct = 0.0;
+};
+
+const wchar_t* ProfileNameW(ProcProfile p);
+
+// Both format in place (no allocation) and truncate to cap - 1 characters. The tray tip fits the
+// shell's 128-character szTip.
+void FormatTrayTip(const StatusFields& f, wchar_t* out, size_t cap);
+void FormatStatusLine(const StatusFields& f, wchar_t* out, size_t cap);
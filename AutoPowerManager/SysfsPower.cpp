@@ -0,0 +1,231 @@
+// SysfsPower.cpp
+// cpufreq / intel_pstate discovery and the batched, diffed sysfs writes.
+
+#include "SysfsPower.h"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static bool ReadLine(const std::string& path, std::string& out) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    char text[256];
+    ssize_t n = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (n < 0) return false;
+    text[n] = 0;
+    out.assign(text, strcspn(text, "\n"));
+    return true;
+}
+
+// First line, without the newline, into a caller's buffer.
+static bool ReadText(const char* path, char* text, size_t n) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    ssize_t r = read(fd, text, n - 1);
+    close(fd);
+    if (r < 0) return false;
+    text[r] = 0;
+    text[strcspn(text, "\n")] = 0;
+    return true;
+}
+
+static uint32_t ReadU32(const std::string& path) {
+    std::string s;
+    return ReadLine(path, s) ? (uint32_t)strtoul(s.c_str(), nullptr, 10) : 0;
+}
+
+static bool Exists(const std::string& path) { return access(path.c_str(), F_OK) == 0; }
+
+SysfsPowerBackend::SysfsPowerBackend(const SysfsPowerConfig& cfg) : cfg(cfg) {
+    for (auto& k : staged) k[0] = k[1] = -1;
+}
+
+void SysfsPowerBackend::Discover() {
+    discovered = true;
+    cpus.clear();
+    const std::string base = cfg.root + "/devices/system/cpu";
+    if (DIR* d = opendir(base.c_str())) {
+        while (dirent* de = readdir(d)) {
+            if (strncmp(de->d_name, "cpu", 3) || de->d_name[3] < '0' || de->d_name[3] > '9') continue;
+            Cpu c;
+            c.dir = base + "/" + de->d_name;
+            c.index = (uint32_t)strtoul(de->d_name + 3, nullptr, 10);
+            c.freq = Exists(c.dir + "/cpufreq/scaling_max_freq");
+            c.minKHz = ReadU32(c.dir + "/cpufreq/cpuinfo_min_freq");
+            c.maxKHz = ReadU32(c.dir + "/cpufreq/cpuinfo_max_freq");
+            c.epp = Exists(c.dir + "/cpufreq/energy_performance_preference");
+            c.online = c.index != 0 && Exists(c.dir + "/online");
+            cpus.push_back(c);
+        }
+        closedir(d);
+    }
+    std::sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) { return a.index < b.index; });
+
+    driver.clear(); eppAvailable.clear();
+    if (!cpus.empty()) {
+        ReadLine(cpus[0].dir + "/cpufreq/scaling_driver", driver);
+        ReadLine(cpus[0].dir + "/cpufreq/energy_performance_available_preferences", eppAvailable);
+    }
+    std::string status;
+    pstate = ReadLine(base + "/intel_pstate/status", status) && status == "active" ? base + "/intel_pstate" : "";
+    boostFile = Exists(base + "/cpufreq/boost") ? base + "/cpufreq/boost" : "";
+}
+
+// Calls f(path, len) for each /class/power_supply entry of the given type, with path holding the
+// entry's directory (len characters) and room to append an attribute. The daemon polls this every
+// tick, so it builds no strings.
+template <typename F> static void ForEachSupply(const std::string& root, const char* type, F f) {
+    char path[512];
+    const int base = snprintf(path, sizeof(path), "%s/class/power_supply", root.c_str());
+    if (base < 0 || (size_t)base >= sizeof(path) - 128) return;
+    DIR* d = opendir(path);
+    if (!d) return;
+    while (dirent* de = readdir(d)) {
+        if (de->d_name[0] == '.') continue;
+        const int len = base + snprintf(path + base, sizeof(path) - base, "/%s", de->d_name);
+        if ((size_t)len >= sizeof(path) - 32) continue;
+        char text[32];
+        snprintf(path + len, sizeof(path) - len, "/type");
+        if (!ReadText(path, text, sizeof(text)) || strcmp(text, type)) continue;
+        path[len] = 0;
+        f(path, (size_t)len);
+    }
+    closedir(d);
+}
+
+bool SysfsPowerBackend::DetectOnAC() {
+    bool sawMains = false, online = false;
+    ForEachSupply(cfg.root, "Mains", [&](char* path, size_t len) {
+        char text[32];
+        snprintf(path + len, 32, "/online");
+        sawMains = true;
+        online = online || (ReadText(path, text, sizeof(text)) && atoi(text) != 0);
+    });
+    if (sawMains) onAC = online;
+    return onAC;
+}
+
+int SysfsPowerBackend::DetectBatteryPct() const {
+    int pct = -1;
+    ForEachSupply(cfg.root, "Battery", [&](char* path, size_t len) {
+        char text[32];
+        snprintf(path + len, 32, "/capacity");
+        if (!ReadText(path, text, sizeof(text))) return;
+        const int c = atoi(text);
+        if (pct < 0 || c < pct) pct = c;
+    });
+    return pct;
+}
+
+bool SysfsPowerBackend::GetActiveScheme(GUID& scheme) {
+    scheme = GUID{ 0x73797366, 0x7366, 0x0001, { 0, 0, 0, 0, 0, 0, 0, 0 } };   // "sysfs": one implicit scheme
+    return true;
+}
+
+bool SysfsPowerBackend::WriteValueIndex(const GUID&, const GUID&, const GUID& setting, PowerSource src, DWORD value) {
+    int k = IsEqualGUID(setting, SET_MIN_PROC_STATE) ? MinState : IsEqualGUID(setting, SET_MAX_PROC_STATE) ? MaxState
+        : IsEqualGUID(setting, SET_BOOST_MODE) ? Boost : IsEqualGUID(setting, SET_CORE_PARK_MIN_CORES) ? Park
+        : IsEqualGUID(setting, SET_MIN_PROC_STATE1) ? MinState1 : IsEqualGUID(setting, SET_MAX_PROC_STATE1) ? MaxState1 : -1;
+    if (k < 0) return false;
+    staged[k][src == PowerSource::AC ? 0 : 1] = (int)std::min<DWORD>(value, 100);
+    return true;
+}
+
+bool SysfsPowerBackend::WriteIfChanged(const std::string& path, const std::string& value, bool& ok) {
+    auto it = written.find(path);
+    if (it != written.end() && it->second == value) return true;
+    int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+    bool done = fd >= 0 && write(fd, value.data(), value.size()) == (ssize_t)value.size();
+    if (fd >= 0) done = (close(fd) == 0) && done;
+    ++fileWrites;
+    if (!done) { ok = false; written.erase(path); return false; }
+    written[path] = value;
+    return true;
+}
+
+static const char* EppFor(int boost) {
+    static const char* const names[] = { "power", "balance_power", "balance_performance", "performance" };
+    return names[std::max(0, std::min(boost, 3))];
+}
+
+bool SysfsPowerBackend::SetActiveScheme(const GUID&) {
+    if (!discovered) Discover();
+    const int src = onAC ? 0 : 1;
+    const int minPct = staged[MinState][src], maxPct = staged[MaxState][src];
+    const int boost = staged[Boost][src], park = staged[Park][src];
+    // Hybrid with class-1 limits: every CPU gets its class's frequency window, intel_pstate included
+    // (its global perf_pct can't tell the classes apart).
+    const bool perClass = topo.Hybrid() && (staged[MinState1][src] >= 0 || staged[MaxState1][src] >= 0);
+    bool ok = true;
+
+    // Lowering: min before max; raising: max before min, so min <= max holds after every write.
+    auto lastPct = [&](const std::string& path) {
+        auto it = written.find(path);
+        return it == written.end() ? -1 : atoi(it->second.c_str());
+    };
+
+    if (!pstate.empty()) {
+        if (!perClass) {
+            const std::string minF = pstate + "/min_perf_pct", maxF = pstate + "/max_perf_pct";
+            const bool lowering = maxPct >= 0 && lastPct(maxF) > maxPct;
+            if (lowering && minPct >= 0) WriteIfChanged(minF, std::to_string(std::min(minPct, maxPct)), ok);
+            if (maxPct >= 0) WriteIfChanged(maxF, std::to_string(std::max(maxPct, 1)), ok);
+            if (!lowering && minPct >= 0) WriteIfChanged(minF, std::to_string(maxPct >= 0 ? std::min(minPct, maxPct) : minPct), ok);
+        }
+        if (boost >= 0) WriteIfChanged(pstate + "/no_turbo", boost == 0 ? "1" : "0", ok);
+    }
+    else if (boost >= 0 && !boostFile.empty()) {
+        WriteIfChanged(boostFile, boost == 0 ? "0" : "1", ok);
+    }
+
+    // Per CPU: all of one CPU's files together.
+    const size_t keep = park >= 0 ? std::max<size_t>(1, (cpus.size() * (size_t)park + 99) / 100) : cpus.size();
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        const Cpu& c = cpus[i];
+        if (cfg.parkOffline && c.online && park >= 0) {
+            if (i >= keep) { WriteIfChanged(c.dir + "/online", "0", ok); continue; }
+            const uint64_t before = fileWrites;
+            WriteIfChanged(c.dir + "/online", "1", ok);
+            if (fileWrites != before) {   // back online: its cpufreq policy may have been reset
+                for (auto it = written.begin(); it != written.end();)
+                    it = it->first.compare(0, c.dir.size() + 9, c.dir + "/cpufreq/") == 0 ? written.erase(it) : std::next(it);
+            }
+        }
+        if (!c.freq) continue;
+        if ((pstate.empty() || perClass) && c.maxKHz) {
+            const bool fast = perClass && topo.Performance(c.index);
+            const int lo = fast ? staged[MinState1][src] : minPct, hi = fast ? staged[MaxState1][src] : maxPct;
+            auto khz = [&](int pct) {
+                return std::to_string(std::max(c.minKHz, std::min(c.maxKHz, (uint32_t)((uint64_t)c.maxKHz * pct / 100))));
+            };
+            const std::string minF = c.dir + "/cpufreq/scaling_min_freq", maxF = c.dir + "/cpufreq/scaling_max_freq";
+            auto lastKHz = [&](const std::string& path) {
+                auto it = written.find(path);
+                return it == written.end() ? -1LL : atoll(it->second.c_str());
+            };
+            const bool lowering = hi >= 0 && lastKHz(maxF) > atoll(khz(hi).c_str());
+            const int effMin = hi >= 0 ? std::min(lo, hi) : lo;
+            if (lowering && lo >= 0) WriteIfChanged(minF, khz(effMin), ok);
+            if (hi >= 0) WriteIfChanged(maxF, khz(hi), ok);
+            if (!lowering && lo >= 0) WriteIfChanged(minF, khz(effMin), ok);
+        }
+        if (c.epp && boost >= 0) {
+            const char* epp = EppFor(boost);
+            if (eppAvailable.empty() || eppAvailable.find(epp) != std::string::npos)
+                WriteIfChanged(c.dir + "/cpufreq/energy_performance_preference", epp, ok);
+        }
+    }
+    return ok;
+}
+
+#endif
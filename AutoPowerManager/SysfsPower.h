@@ -0,0 +1,82 @@
+// SysfsPower.h
+// Linux actuation: an IPowerBackend that maps the processor settings PowerSettingsWriter writes
+// (min/max processor state, boost mode, core-parking minimum) onto cpufreq / intel_pstate sysfs
+// knobs, so the same governor, ladder and writer drive Linux workstations.
+//
+//   SET_MIN/MAX_PROC_STATE   intel_pstate/{min,max}_perf_pct when intel_pstate is active,
+//                            otherwise cpuN/cpufreq/scaling_{min,max}_freq (% of cpuinfo_max_freq)
+//   SET_BOOST_MODE           intel_pstate/no_turbo or cpufreq/boost (0 = off), and
+//                            energy_performance_preference per CPU (power .. performance)
+//   SET_CORE_PARK_MIN_CORES  cpuN/online for CPUs past the minimum, only with parkOffline
+//   SET_MIN/MAX_PROC_STATE1  on a hybrid topology: per-CPU scaling_{min,max}_freq of the faster
+//                            class, while SET_MIN/MAX_PROC_STATE then cover the efficiency class
+//
+// Like the Win32 power API, values are staged per AC/DC by WriteValueIndex and take effect in
+// SetActiveScheme, which writes one CPU's files at a time and skips files whose value is unchanged.
+
+#pragma once
+
+#ifndef _WIN32
+
+#include "PowerWriter.h"
+#include "CpuTopology.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SysfsPowerConfig {
+    std::string root = "/sys";        // injectable for fixture trees
+    bool        parkOffline = false;  // core parking by offlining CPUs (never cpu0); a hard cap, so opt-in
+};
+
+class SysfsPowerBackend : public IPowerBackend {
+public:
+    explicit SysfsPowerBackend(const SysfsPowerConfig& cfg = SysfsPowerConfig());
+
+    // Which value index is live, like the system's active power source. Default AC.
+    void SetOnAC(bool ac) { onAC = ac; }
+    bool DetectOnAC();                // power_supply "Mains" online; keeps the current choice if none
+    int  DetectBatteryPct() const;    // lowest power_supply "Battery" capacity; -1 without a battery
+    void SetTopology(const CpuTopology& t) { topo = t; }
+
+    bool GetActiveScheme(GUID& scheme) override;
+    bool WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, PowerSource src, DWORD value) override;
+    bool SetActiveScheme(const GUID& scheme) override;
+
+    const std::string& Driver() const { return driver; }   // scaling_driver of cpu0
+    size_t   Cpus() const { return cpus.size(); }
+    uint64_t FileWrites() const { return fileWrites; }
+    void     Rediscover() { discovered = false; written.clear(); }
+
+private:
+    enum Knob { MinState, MaxState, Boost, Park, MinState1, MaxState1, KnobCount };
+
+    struct Cpu {
+        std::string dir;              // .../cpuN
+        uint32_t    index = 0;
+        uint32_t    minKHz = 0;
+        uint32_t    maxKHz = 0;
+        bool        freq = false;     // has cpufreq/
+        bool        epp = false;
+        bool        online = false;   // has an online file (hot-pluggable)
+    };
+
+    void Discover();
+    bool WriteIfChanged(const std::string& path, const std::string& value, bool& ok);
+
+    SysfsPowerConfig cfg;
+    CpuTopology      topo;
+    bool             onAC = true;
+    bool             discovered = false;
+    std::string      driver;
+    std::string      pstate;           // .../intel_pstate when its status is "active"
+    std::string      boostFile;        // .../cpufreq/boost (acpi-cpufreq, amd-pstate passive)
+    std::string      eppAvailable;     // energy_performance_available_preferences of cpu0
+    std::vector<Cpu> cpus;
+    int              staged[KnobCount][2];   // [knob][AC, DC]; -1 unset
+    std::unordered_map<std::string, std::string> written;   // path -> last value written
+    uint64_t         fileWrites = 0;
+};
+
+#endif
@@ -0,0 +1,165 @@
+// Telemetry.cpp
+// Ring file mapping (Win32 / POSIX), record packing and the offline reader.
+
+#include "Telemetry.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------- Records ----------
+static uint16_t Centi(double pct) { return (uint16_t)std::lround(std::min(100.0, std::max(0.0, pct)) * 100.0); }
+
+TelemetryRecord MakeTelemetryRecord(const Governor& gov, const GovernorSignals& s, ProcProfile applied,
+                                    ProcProfile prevApplied, bool pinned, uint64_t wallMs, uint32_t nextTickMs) {
+    TelemetryRecord r{};
+    r.wallMs = wallMs;
+    r.monoMs = s.nowMs;
+    r.idleSec = s.idleSec;
+    r.cpuRaw = Centi(s.cpuPct);
+    r.cpuSmooth = Centi(gov.CpuEWMA());
+    r.coreRaw = Centi(s.cpuMaxCorePct);
+    r.coreSmooth = Centi(gov.MaxCoreEWMA());
+    r.nextTickMs = (uint16_t)std::min<uint32_t>(nextTickMs, 0xFFFF);
+    r.battPct = (int8_t)(s.battPct < 0 ? -1 : std::min(s.battPct, 100));
+    r.flags = (s.onAC ? TF_AC : 0) | (s.sessionLocked ? TF_Locked : 0) |
+        (s.display == DisplayState::Off ? TF_DisplayOff : 0) | (s.display == DisplayState::Dimmed ? TF_DisplayDimmed : 0) |
+        (s.fgHeavy ? TF_FgHeavy : 0) | (s.bgHeavy ? TF_BgHeavy : 0) | (s.bgBusy ? TF_BgBusy : 0) | (s.predictActive ? TF_Predicted : 0);
+    r.kind = (uint8_t)(applied != prevApplied ? TelemetryKind::Transition : TelemetryKind::Tick);
+    if (pinned) r.kind |= (uint8_t)(TK_Pinned | ((uint8_t)gov.Profile() << TK_GovernorShift));
+    r.tier = (uint8_t)gov.Tier();
+    r.profile = (uint8_t)applied;
+    r.prevProfile = (uint8_t)prevApplied;
+    r.tierReason = (uint8_t)gov.LastTierReason();
+    r.profileReason = (uint8_t)gov.LastProfileReason();
+    return r;
+}
+
+// ---------- Ring ----------
+static uint32_t RoundUpPow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 30)) p <<= 1;
+    return p;
+}
+
+static size_t RingBytes(uint32_t capacity) { return sizeof(TelemetryHeader) + (size_t)capacity * sizeof(TelemetryRecord); }
+
+bool TelemetryRing::Attach(uint8_t* base, uint32_t capacity, bool fresh) {
+    hdr = reinterpret_cast<TelemetryHeader*>(base);
+    recs = reinterpret_cast<TelemetryRecord*>(base + sizeof(TelemetryHeader));
+    if (fresh || hdr->magic != kTelemetryMagic || hdr->version != kTelemetryVersion ||
+        hdr->recordSize != sizeof(TelemetryRecord) || hdr->capacity != capacity) {
+        memset(base, 0, sizeof(TelemetryHeader));
+        hdr->magic = kTelemetryMagic;
+        hdr->version = kTelemetryVersion;
+        hdr->recordSize = sizeof(TelemetryRecord);
+        hdr->capacity = capacity;
+        hdr->next = 0;
+    }
+    mask = capacity - 1;
+    return true;
+}
+
+bool TelemetryRing::OpenInMemory(uint32_t capacity) {
+    Close();
+    capacity = RoundUpPow2(std::max(capacity, 2u));
+    heap.assign(RingBytes(capacity), 0);
+    return Attach(heap.data(), capacity, true);
+}
+
+#ifdef _WIN32
+bool TelemetryRing::Open(const wchar_t* path, uint32_t capacity) {
+    Close();
+    capacity = RoundUpPow2(std::max(capacity, 2u));
+    const size_t bytes = RingBytes(capacity);
+    HANDLE f = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size{};
+    GetFileSizeEx(f, &size);
+    const bool fresh = (uint64_t)size.QuadPart != bytes;
+    HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, nullptr);
+    void* view = m ? MapViewOfFile(m, FILE_MAP_WRITE, 0, 0, bytes) : nullptr;
+    if (!view) {
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    file = f; mapping = m; mappedBytes = bytes; mapped = true;
+    return Attach(static_cast<uint8_t*>(view), capacity, fresh);
+}
+
+void TelemetryRing::Close() {
+    if (mapped && hdr) {
+        FlushViewOfFile(hdr, 0);
+        UnmapViewOfFile(hdr);
+    }
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    file = mapping = nullptr;
+    hdr = nullptr; recs = nullptr; mapped = false; mappedBytes = 0;
+    heap.clear(); heap.shrink_to_fit();
+}
+#else
+bool TelemetryRing::Open(const char* path, uint32_t capacity) {
+    Close();
+    capacity = RoundUpPow2(std::max(capacity, 2u));
+    const size_t bytes = RingBytes(capacity);
+    int f = open(path, O_RDWR | O_CREAT, 0644);
+    if (f < 0) return false;
+    struct stat st{};
+    fstat(f, &st);
+    const bool fresh = (size_t)st.st_size != bytes;
+    if (fresh && ftruncate(f, (off_t)bytes) != 0) { close(f); return false; }
+    void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, f, 0);
+    if (view == MAP_FAILED) { close(f); return false; }
+    fd = f; mappedBytes = bytes; mapped = true;
+    return Attach(static_cast<uint8_t*>(view), capacity, fresh);
+}
+
+void TelemetryRing::Close() {
+    if (mapped && hdr) munmap(hdr, mappedBytes);
+    if (fd >= 0) close(fd);
+    fd = -1;
+    hdr = nullptr; recs = nullptr; mapped = false; mappedBytes = 0;
+    heap.clear(); heap.shrink_to_fit();
+}
+#endif
+
+void TelemetryRing::Snapshot(std::vector<TelemetryRecord>& out) const {
+    out.clear();
+    if (!hdr) return;
+    const uint64_t n = hdr->next;
+    const uint64_t count = std::min<uint64_t>(n, hdr->capacity);
+    out.reserve((size_t)count);
+    for (uint64_t i = n - count; i < n; ++i) out.push_back(recs[i & mask]);
+}
+
+// ---------- Reader ----------
+bool ReadTelemetryFile(const char* path, std::vector<TelemetryRecord>& out, std::string& err) {
+    out.clear();
+    FILE* f = fopen(path, "rb");
+    if (!f) { err = std::string("cannot open ") + path; return false; }
+    TelemetryHeader h{};
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != kTelemetryMagic) { err = std::string(path) + ": not a telemetry ring"; fclose(f); return false; }
+    if (h.version != kTelemetryVersion || h.recordSize != sizeof(TelemetryRecord) || !h.capacity || (h.capacity & (h.capacity - 1))) {
+        err = std::string(path) + ": unsupported telemetry version or layout"; fclose(f); return false;
+    }
+    std::vector<TelemetryRecord> slots(h.capacity);
+    if (fread(slots.data(), sizeof(TelemetryRecord), slots.size(), f) != slots.size()) {
+        err = std::string(path) + ": truncated"; fclose(f); return false;
+    }
+    fclose(f);
+    const uint64_t count = std::min<uint64_t>(h.next, h.capacity);
+    out.reserve((size_t)count);
+    for (uint64_t i = h.next - count; i < h.next; ++i) out.push_back(slots[i & (h.capacity - 1)]);
+    return true;
+}
@@ -0,0 +1,123 @@
+// Telemetry.h
+// Per-tick flight recorder: a fixed-size ring of compact binary records in a memory-mapped file,
+// so the last hours of governor inputs and decisions survive a crash and can be exported later
+// ("it felt sluggish at 14:02"). Appending is a 40-byte copy and a store; no locks, no allocation.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TelemetryKind : uint8_t { Tick = 0, Transition = 1 };   // Transition: applied profile changed this tick
+
+// The kind byte's high bits. TK_Pinned marks a tick whose profile was a pin (the daemon's "pin"),
+// with the governor's own choice in the TK_Governor bits; otherwise the two are the same.
+enum : uint8_t { TK_KindMask = 0x0F, TK_Governor = 0x30, TK_GovernorShift = 4, TK_Pinned = 0x80 };
+
+enum TelemetryFlag : uint8_t {
+    TF_AC = 1, TF_Locked = 2, TF_DisplayOff = 4, TF_DisplayDimmed = 8,
+    TF_FgHeavy = 16, TF_BgHeavy = 32, TF_BgBusy = 64, TF_Predicted = 128,
+};
+
+struct TelemetryRecord {
+    uint64_t wallMs;          // Unix epoch, UTC
+    uint64_t monoMs;          // governor clock
+    uint32_t idleSec;
+    uint16_t cpuRaw;          // 0.01 % units
+    uint16_t cpuSmooth;
+    uint16_t coreRaw;         // busiest core
+    uint16_t coreSmooth;
+    uint16_t nextTickMs;      // delay armed after this tick (saturating)
+    int8_t   battPct;         // -1 unknown
+    uint8_t  flags;           // TelemetryFlag
+    uint8_t  kind;            // TelemetryKind | TK_Pinned | governor's profile
+    uint8_t  tier;            // ActivityTier
+    uint8_t  profile;         // ProcProfile, as applied
+    uint8_t  prevProfile;     // applied on the tick before
+    uint8_t  tierReason;      // TierReason
+    uint8_t  profileReason;   // ProfileReason
+    uint8_t  thermalLevel;    // ThermalLimiter level, 0 = uncapped
+    uint8_t  tempC;           // 0 unknown
+};
+static_assert(sizeof(TelemetryRecord) == 40, "telemetry record layout is part of the file format");
+
+inline TelemetryKind RecordKind(const TelemetryRecord& r) { return (TelemetryKind)(r.kind & TK_KindMask); }
+inline bool          RecordPinned(const TelemetryRecord& r) { return (r.kind & TK_Pinned) != 0; }
+inline ProcProfile   RecordGovernorProfile(const TelemetryRecord& r) {
+    return RecordPinned(r) ? (ProcProfile)((r.kind & TK_Governor) >> TK_GovernorShift) : (ProcProfile)r.profile;
+}
+
+struct TelemetryHeader {
+    uint32_t magic;           // kTelemetryMagic
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity;        // power of two
+    uint32_t reserved0;
+    uint64_t next;            // records ever appended; slot = next & (capacity - 1)
+    uint8_t  reserved[40];
+};
+static_assert(sizeof(TelemetryHeader) == 64, "telemetry header layout is part of the file format");
+
+const uint32_t kTelemetryMagic = 0x544D5041;   // "APMT"
+const uint16_t kTelemetryVersion = 1;
+
+// Snapshot of one tick. applied is what was written (the pin, when pinned, else the governor's
+// profile); applied != prevApplied marks a transition.
+TelemetryRecord MakeTelemetryRecord(const Governor& gov, const GovernorSignals& s, ProcProfile applied,
+                                    ProcProfile prevApplied, bool pinned, uint64_t wallMs, uint32_t nextTickMs);
+
+class TelemetryRing {
+public:
+    TelemetryRing() = default;
+    ~TelemetryRing() { Close(); }
+    TelemetryRing(const TelemetryRing&) = delete;
+    TelemetryRing& operator=(const TelemetryRing&) = delete;
+
+    // Maps a ring file, continuing an existing one of the same geometry and starting over otherwise.
+    // capacity is rounded up to a power of two.
+#ifdef _WIN32
+    bool Open(const wchar_t* path, uint32_t capacity);
+#else
+    bool Open(const char* path, uint32_t capacity);
+#endif
+    bool OpenInMemory(uint32_t capacity);   // heap-backed: benchmarks, or when the file can't be mapped
+    void Close();
+
+    bool     IsOpen() const { return hdr != nullptr; }
+    uint32_t Capacity() const { return hdr ? hdr->capacity : 0; }
+    uint64_t Appended() const { return hdr ? hdr->next : 0; }
+
+    void Append(const TelemetryRecord& r) {
+        if (!hdr) return;
+        uint64_t n = hdr->next;
+        recs[n & mask] = r;
+        std::atomic_thread_fence(std::memory_order_release);   // record before the count
+        hdr->next = n + 1;
+    }
+
+    // Oldest first; at most Capacity() records.
+    void Snapshot(std::vector<TelemetryRecord>& out) const;
+
+private:
+    bool Attach(uint8_t* base, uint32_t capacity, bool fresh);
+
+    TelemetryHeader*     hdr = nullptr;
+    TelemetryRecord*     recs = nullptr;
+    uint64_t             mask = 0;
+    std::vector<uint8_t> heap;
+#ifdef _WIN32
+    void*                file = nullptr;      // HANDLE
+    void*                mapping = nullptr;   // HANDLE
+#else
+    int                  fd = -1;
+#endif
+    size_t               mappedBytes = 0;
+    bool                 mapped = false;
+};
+
+// Reads a ring file (plain I/O, no mapping) oldest first.
+bool ReadTelemetryFile(const char* path, std::vector<TelemetryRecord>& out, std::string& err);
@@ -0,0 +1,214 @@
+// Thermal.cpp
+// Thermal sensor sources (PDH / sysfs) and the step-down limiter.
+
+#include "Thermal.h"
+#include "PlatformTypes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <pdh.h>
+#pragma comment(lib, "pdh.lib")
+
+// ---------- Win32 source ----------
+PdhThermalSource::PdhThermalSource() {
+    PDH_HQUERY q = nullptr;
+    if (PdhOpenQueryW(nullptr, 0, &q) != ERROR_SUCCESS) return;
+    query = q;
+    PDH_HCOUNTER c = nullptr;
+    if (PdhAddEnglishCounterW(q, L"\\Thermal Zone Information(*)\\High Precision Temperature", 0, &c) == ERROR_SUCCESS) {
+        temp = c; tempTenthsK = true;
+    }
+    else if (PdhAddEnglishCounterW(q, L"\\Thermal Zone Information(*)\\Temperature", 0, &c) == ERROR_SUCCESS) {
+        temp = c;
+    }
+    if (PdhAddEnglishCounterW(q, L"\\Power Meter(*)\\Power", 0, &c) == ERROR_SUCCESS) power = c;
+    PdhCollectQueryData(q);
+}
+
+PdhThermalSource::~PdhThermalSource() {
+    if (query) PdhCloseQuery((PDH_HQUERY)query);
+}
+
+bool PdhThermalSource::ReadMax(void* counter, double& out) {
+    DWORD bytes = 0, count = 0;
+    PDH_STATUS st = PdhGetFormattedCounterArrayW((PDH_HCOUNTER)counter, PDH_FMT_DOUBLE, &bytes, &count, nullptr);
+    if (st != PDH_MORE_DATA) return false;
+    if (buf.size() < bytes) buf.resize(bytes);
+    auto items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buf.data());
+    if (PdhGetFormattedCounterArrayW((PDH_HCOUNTER)counter, PDH_FMT_DOUBLE, &bytes, &count, items) != ERROR_SUCCESS) return false;
+    bool any = false;
+    for (DWORD i = 0; i < count; ++i) {
+        if (items[i].FmtValue.CStatus != PDH_CSTATUS_VALID_DATA) continue;
+        out = any ? std::max(out, items[i].FmtValue.doubleValue) : items[i].FmtValue.doubleValue;
+        any = true;
+    }
+    return any;
+}
+
+bool PdhThermalSource::Sample(uint64_t, ThermalSample& out) {
+    out = ThermalSample{};
+    if (!query || PdhCollectQueryData((PDH_HQUERY)query) != ERROR_SUCCESS) return false;
+    double v;
+    if (temp && ReadMax(temp, v)) out.tempC = (tempTenthsK ? v / 10.0 : v) - 273.15;
+    if (power && ReadMax(power, v)) out.packageW = v / 1000.0;   // milliwatts
+    return out.tempC >= 0 || out.packageW >= 0;
+}
+#endif
+
+#ifndef _WIN32
+// ---------- sysfs source ----------
+static bool ReadText(const std::string& path, char* text, size_t n) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ssize_t k = read(fd, text, n - 1);
+    close(fd);
+    if (k <= 0) return false;
+    text[k] = 0;
+    return true;
+}
+
+static bool ReadU64(const std::string& path, uint64_t& v) {
+    char text[32];
+    if (!ReadText(path, text, sizeof(text))) return false;
+    char* end = nullptr;
+    v = strtoull(text, &end, 10);
+    return end != text;
+}
+
+static bool CpuZoneType(const char* type) {
+    return strstr(type, "x86_pkg_temp") || strstr(type, "cpu") || strstr(type, "CPU") || strstr(type, "soc") ||
+        strstr(type, "TCPU") || strstr(type, "coretemp") || strstr(type, "k10temp");
+}
+
+SysfsThermalSource::SysfsThermalSource(std::string root) : root(std::move(root)) {}
+
+void SysfsThermalSource::Discover() {
+    discovered = true;
+    zoneTemps.clear();
+    std::vector<std::string> all;
+    const std::string dir = root + "/class/thermal";
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* de = readdir(d)) {
+            if (strncmp(de->d_name, "thermal_zone", 12)) continue;
+            const std::string zone = dir + "/" + de->d_name;
+            char type[64];
+            if (!ReadText(zone + "/type", type, sizeof(type))) continue;
+            all.push_back(zone + "/temp");
+            if (CpuZoneType(type)) zoneTemps.push_back(zone + "/temp");
+        }
+        closedir(d);
+    }
+    if (zoneTemps.empty()) zoneTemps.swap(all);   // e.g. only acpitz: better than nothing
+
+    // Full paths once, so a sample builds no strings.
+    const std::string rapl = root + "/class/powercap/intel-rapl:0";
+    raplEnergy = rapl + "/energy_uj";
+    raplRange = rapl + "/max_energy_range_uj";
+    raplLimit = rapl + "/constraint_0_power_limit_uw";
+    uint64_t e;
+    if (!ReadU64(raplEnergy, e)) raplEnergy.clear();
+    lastEnergyMs = 0;
+}
+
+bool SysfsThermalSource::Sample(uint64_t nowMs, ThermalSample& out) {
+    out = ThermalSample{};
+    if (!discovered) Discover();
+
+    bool any = false;
+    for (auto& z : zoneTemps) {
+        uint64_t milliC;
+        if (!ReadU64(z, milliC) || milliC == 0 || milliC > 150'000) continue;   // unreadable or bogus
+        out.tempC = std::max(out.tempC, milliC / 1000.0);
+        any = true;
+    }
+
+    uint64_t e, range = 0, limitUw;
+    if (!raplEnergy.empty() && ReadU64(raplEnergy, e)) {
+        if (lastEnergyMs && nowMs > lastEnergyMs) {
+            uint64_t delta = e >= lastEnergyUj ? e - lastEnergyUj
+                : (ReadU64(raplRange, range) ? e + range - lastEnergyUj : 0);   // wrapped
+            out.packageW = (double)delta / (double)(nowMs - lastEnergyMs) / 1000.0;
+            any = true;
+        }
+        lastEnergyUj = e; lastEnergyMs = nowMs;
+        if (ReadU64(raplLimit, limitUw) && limitUw) out.packageLimitW = limitUw / 1e6;
+    }
+    if (!any && nowMs >= retryMs) {   // zones may appear later (driver load); rescan, once a minute at most
+        discovered = false;
+        retryMs = nowMs + 60'000;
+    }
+    return any;
+}
+#endif
+
+// ---------- Limiter ----------
+static const ThermalCap kCapLevels[ThermalLimiter::kLevels] = {
+    { 100, 3 }, { 100, 1 }, { 100, 0 }, { 95, 0 }, { 90, 0 }, { 85, 0 }, { 75, 0 },
+};
+
+void ThermalLimiter::Reset() {
+    level = 0; cap = kCapLevels[0];
+    lastStepMs = coolSinceMs = 0;
+    prevTempC = -1.0; prevMs = 0; slope = 0.0;
+}
+
+const ThermalCap& ThermalLimiter::Update(uint64_t nowMs, const ThermalSample& s) {
+    const bool haveTemp = s.tempC >= 0;
+    if (haveTemp && prevTempC >= 0 && nowMs > prevMs) {
+        double inst = (s.tempC - prevTempC) * 1000.0 / (double)(nowMs - prevMs);
+        slope = 0.3 * inst + 0.7 * slope;
+    }
+    if (haveTemp) { prevTempC = s.tempC; prevMs = nowMs; }
+    else { prevTempC = -1.0; slope = 0.0; }
+
+    bool hot = false, cool = true;
+    if (haveTemp) {
+        double projected = s.tempC + std::max(0.0, slope) * cfg.lookaheadSec;
+        hot = projected >= cfg.softC;
+        cool = s.tempC < cfg.softC - cfg.hysteresisC;
+    }
+    const double limitW = cfg.powerLimitW > 0 ? cfg.powerLimitW : s.packageLimitW;
+    if (s.packageW >= 0 && limitW > 0) {
+        hot = hot || s.packageW >= limitW * cfg.powerHeadroom;
+        cool = cool && s.packageW < limitW * (cfg.powerHeadroom - 0.1);
+    }
+
+    if (hot) {
+        coolSinceMs = 0;
+        if (level < kLevels - 1 && (!lastStepMs || nowMs - lastStepMs >= cfg.stepDownMs)) { ++level; lastStepMs = nowMs; }
+    }
+    else if (cool) {
+        if (!coolSinceMs) coolSinceMs = nowMs;
+        if (level > 0 && nowMs - coolSinceMs >= cfg.stepUpMs) { --level; lastStepMs = coolSinceMs = nowMs; }
+    }
+    else coolSinceMs = 0;   // inside the hysteresis band: hold
+
+    cap = kCapLevels[level];
+    return cap;
+}
+
+LadderSetpoint ApplyThermalCap(const LadderSetpoint& sp, const ThermalCap& cap) {
+    LadderSetpoint r = sp;
+    r.maxAC = std::min(r.maxAC, cap.maxProcPct);
+    r.maxDC = std::min(r.maxDC, cap.maxProcPct);
+    r.minAC = std::min(r.minAC, r.maxAC);
+    r.minDC = std::min(r.minDC, r.maxDC);
+    uint8_t* pairs[][2] = { { &r.pMinAC, &r.pMaxAC }, { &r.pMinDC, &r.pMaxDC }, { &r.eMinAC, &r.eMaxAC }, { &r.eMinDC, &r.eMaxDC } };
+    for (auto& mm : pairs) {
+        *mm[1] = std::min(*mm[1], cap.maxProcPct);
+        *mm[0] = std::min(*mm[0], *mm[1]);
+    }
+    r.boostAC = std::min(r.boostAC, cap.boostMode);
+    r.boostDC = std::min(r.boostDC, cap.boostMode);
+    return r;
+}
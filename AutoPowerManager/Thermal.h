@@ -0,0 +1,112 @@
+// Thermal.h
+// Thermal / package-power headroom and the Boost cap derived from it. Boosting on load alone drives
+// thin laptops into the firmware's thermal limit, where clocks oscillate; stepping the max processor
+// state and boost mode down a little before that sustains more throughput than being throttled.
+
+#pragma once
+
+#include "ProfileLadder.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ThermalSample {
+    double tempC = -1.0;           // hottest CPU-related zone; <0 unknown
+    double packageW = -1.0;        // mean package power since the previous sample; <0 unknown
+    double packageLimitW = -1.0;   // firmware long-term limit (RAPL PL1) when exposed; <0 unknown
+};
+
+struct IThermalSource {
+    virtual ~IThermalSource() = default;
+    virtual bool Sample(uint64_t nowMs, ThermalSample& out) = 0;   // false: nothing readable
+};
+
+#ifdef _WIN32
+// ACPI thermal zones through the "Thermal Zone Information" performance counters (readable without
+// admin, unlike WMI's MSAcpi_ThermalZoneTemperature), and "Power Meter" where the platform has one.
+class PdhThermalSource : public IThermalSource {
+public:
+    PdhThermalSource();
+    ~PdhThermalSource() override;
+    bool Sample(uint64_t nowMs, ThermalSample& out) override;
+private:
+    bool ReadMax(void* counter, double& out);
+
+    void* query = nullptr;          // PDH_HQUERY
+    void* temp = nullptr;           // PDH_HCOUNTER
+    void* power = nullptr;          // ...
+    bool  tempTenthsK = false;      // High Precision Temperature (0.1 K) vs Temperature (K)
+    std::vector<uint8_t> buf;
+};
+#endif
+
+#ifndef _WIN32
+// /sys/class/thermal/thermal_zone*/{type,temp} (CPU/package zones when present, else all) and the
+// RAPL package-0 counters under /sys/class/powercap (energy_uj is root-only on current kernels; power
+// then stays unknown). root is injectable for fixture trees.
+class SysfsThermalSource : public IThermalSource {
+public:
+    explicit SysfsThermalSource(std::string root = "/sys");
+    bool Sample(uint64_t nowMs, ThermalSample& out) override;
+private:
+    void Discover();
+
+    std::string              root;
+    std::vector<std::string> zoneTemps;      // .../thermal_zoneN/temp
+    std::string              raplEnergy;     // .../intel-rapl:0/energy_uj, empty if absent
+    std::string              raplRange;      // .../max_energy_range_uj
+    std::string              raplLimit;      // .../constraint_0_power_limit_uw
+    bool                     discovered = false;
+    uint64_t                 retryMs = 0;    // nothing readable: rescan no sooner than this
+    uint64_t                 lastEnergyUj = 0;
+    uint64_t                 lastEnergyMs = 0;
+};
+#endif
+
+struct ThermalCapConfig {
+    double   softC = 85.0;           // step down when the projected temperature reaches this
+    double   hysteresisC = 6.0;      // release only below softC - hysteresisC
+    double   lookaheadSec = 4.0;     // project the temperature trend this far ahead
+    double   powerLimitW = 0.0;      // 0: the firmware limit, when exposed
+    double   powerHeadroom = 0.95;   // step down above this fraction of the power limit
+    uint32_t stepDownMs = 2000;      // at most one level down per interval
+    uint32_t stepUpMs = 10000;       // stay cool this long before releasing a level
+};
+
+// Upper bounds for the applied setpoint. boostMode uses the ladder's 0 (Off) .. 3 ordering.
+struct ThermalCap {
+    uint8_t maxProcPct = 100;
+    uint8_t boostMode = 3;
+};
+
+class ThermalLimiter {
+public:
+    static constexpr int kLevels = 7;   // 0 = uncapped
+
+    explicit ThermalLimiter(const ThermalCapConfig& cfg = ThermalCapConfig()) : cfg(cfg) {}
+
+    void SetConfig(const ThermalCapConfig& c) { cfg = c; }
+    const ThermalCapConfig& Config() const { return cfg; }
+
+    // Once per tick. With no readable sensor the cap is released a level at a time, so a sensor
+    // that disappears can't pin it.
+    const ThermalCap& Update(uint64_t nowMs, const ThermalSample& s);
+    void Reset();
+
+    int               Level() const { return level; }
+    const ThermalCap& Cap() const { return cap; }
+    double            TrendCPerSec() const { return slope; }
+
+private:
+    ThermalCapConfig cfg;
+    ThermalCap       cap;
+    int              level = 0;
+    uint64_t         lastStepMs = 0;
+    uint64_t         coolSinceMs = 0;
+    double           prevTempC = -1.0;
+    uint64_t         prevMs = 0;
+    double           slope = 0.0;      // C/s, smoothed
+};
+
+LadderSetpoint ApplyThermalCap(const LadderSetpoint& sp, const ThermalCap& cap);
@@ -0,0 +1,51 @@
+// TickScheduler.cpp
+// Adaptive tick interval policy.
+
+#include "TickScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+TickObservation ObserveTick(const Governor& gov, const GovernorSignals& s) {
+    TickObservation o;
+    o.nowMs = s.nowMs;
+    o.profile = gov.Profile();
+    o.tier = gov.Tier();
+    o.inputRecent = s.idleSec < gov.Config().inputIdleSec;
+    o.screenOff = s.sessionLocked || s.display == DisplayState::Off;
+    o.cpuRaw = std::max(s.cpuPct, s.cpuMaxCorePct);
+    o.cpuSmoothed = std::max(gov.CpuEWMA(), gov.MaxCoreEWMA());
+    o.nextDeadlineMs = gov.NextDeadlineMs(s.nowMs);
+    return o;
+}
+
+uint32_t TickScheduler::OnTick(const TickObservation& o) {
+    ++wakeups;
+    const uint64_t now = o.nowMs;
+
+    // Input or a load step only matters while not already Active; Boost has nothing left to react to.
+    bool rising = o.tier != ActivityTier::Active && (o.inputRecent || o.cpuRaw - o.cpuSmoothed > cfg.cpuJumpPct);
+    bool transition = first || o.profile != lastProfile || o.tier != lastTier || rising;
+    first = false; lastProfile = o.profile; lastTier = o.tier;
+    if (transition) fastUntil = now + cfg.fastHoldMs;
+
+    if (now < fastUntil) delay = cfg.fastMs;
+    else if (o.tier == ActivityTier::Active) delay = cfg.baseMs;
+    else {
+        uint32_t cap = o.tier == ActivityTier::Engaged ? cfg.engagedMaxMs : o.screenOff ? cfg.screenOffMaxMs : cfg.idleMaxMs;
+        delay = std::min(cap, std::max(cfg.baseMs, delay * 2));
+    }
+
+    if (o.actuating) delay = std::min(delay, cfg.baseMs);
+
+    // Don't sleep through a residency/boost-hold deadline.
+    if (o.nextDeadlineMs > now)
+        delay = (uint32_t)std::min<uint64_t>(delay, std::max<uint64_t>(cfg.fastMs, o.nextDeadlineMs - now));
+    return delay;
+}
+
+uint32_t TickScheduler::Kick(uint64_t nowMs) {
+    fastUntil = nowMs + cfg.fastHoldMs;
+    delay = cfg.fastMs;
+    return delay;
+}
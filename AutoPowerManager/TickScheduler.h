@@ -0,0 +1,59 @@
+// TickScheduler.h
+// Adaptive governor tick interval: fast around transitions and input, exponential back-off
+// during stable residency, so the governor itself stops waking an idle package.
+
+#pragma once
+
+#include "Governor.h"
+
+#include <cstdint>
+
+struct TickSchedulerConfig {
+    uint32_t fastMs = 200;          // around transitions and just after input
+    uint32_t baseMs = 1000;         // Active tier
+    uint32_t engagedMaxMs = 2000;   // back-off ceiling while Engaged
+    uint32_t idleMaxMs = 8000;      // back-off ceiling during Idle residency
+    uint32_t screenOffMaxMs = 30000;// ... with the display off or the session locked
+    uint32_t fastHoldMs = 3000;     // stay fast this long after a trigger
+    double   cpuJumpPct = 20.0;     // raw above smoothed by this much counts as a load step
+};
+
+// What the scheduler needs to know about the tick that just ran.
+struct TickObservation {
+    uint64_t     nowMs = 0;
+    ProcProfile  profile = ProcProfile::Balanced;
+    ActivityTier tier = ActivityTier::Engaged;
+    bool         inputRecent = false;
+    bool         screenOff = false;     // display off or session locked
+    double       cpuRaw = 0.0;
+    double       cpuSmoothed = 0.0;
+    uint64_t     nextDeadlineMs = 0;    // earliest governor timer; 0 = none
+    bool         actuating = false;     // an actuator is still slewing; keep ticking at baseMs at most
+};
+
+TickObservation ObserveTick(const Governor& gov, const GovernorSignals& s);
+
+class TickScheduler {
+public:
+    explicit TickScheduler(const TickSchedulerConfig& cfg = TickSchedulerConfig()) : cfg(cfg), delay(cfg.baseMs) {}
+
+    void SetConfig(const TickSchedulerConfig& c) { cfg = c; }
+    const TickSchedulerConfig& Config() const { return cfg; }
+
+    // Called once per executed tick; returns the delay until the next one.
+    uint32_t OnTick(const TickObservation& o);
+    // External trigger (power/session change, input): go fast; returns the delay to arm.
+    uint32_t Kick(uint64_t nowMs);
+
+    uint32_t Delay() const { return delay; }
+    uint64_t Wakeups() const { return wakeups; }
+
+private:
+    TickSchedulerConfig cfg;
+    uint32_t     delay;
+    uint64_t     fastUntil = 0;
+    uint64_t     wakeups = 0;
+    bool         first = true;
+    ProcProfile  lastProfile = ProcProfile::Balanced;
+    ActivityTier lastTier = ActivityTier::Engaged;
+};
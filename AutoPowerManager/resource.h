@@ -16,6 +16,8 @@
 #define IDM_TRAY_OPEN           40001
 #define IDM_TRAY_APPLY          40002
 #define IDM_TRAY_EXIT           40003
+#define IDM_TRAY_LATENCY        40004
+#define IDM_TRAY_ENERGY         40005
 
 #define IDC_GOV_CONFIRM          1011
 #define IDC_GOV_COOLDOWN         1012
@@ -24,6 +26,8 @@
 
 #define IDC_SL_BATTPCT        3001
 #define IDC_TX_BATTPCT        3002
+#define IDC_ED_RUNTIME        3003
+#define IDC_TX_RUNTIME        3004
 
 #define IDC_SL_STICKY         3010
 #define IDC_TX_STICKY         3011
@@ -0,0 +1,140 @@
+// ActuatorStress.cpp
+// Message-thread latency with power actuation inline vs. on the latest-wins actuator thread,
+// against a mock backend whose calls are slow (as on some OEM images).
+//
+// A simulated message loop handles an event every --period ms (slider drags, notifications);
+// every --tick-every'th event is a governor tick that changes the processor setpoint. Latency is
+// measured from an event's due time to the end of its handling, so time spent blocked in the
+// power API shows up as queueing delay for everything behind it.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -pthread -o actuator_stress Tools/ActuatorStress/ActuatorStress.cpp
+//       AutoPowerManager/PowerWriter.cpp AutoPowerManager/LatencyHistogram.cpp
+//
+// Usage:
+//   actuator_stress [--events N] [--period MS] [--tick-every K] [--write-ms MS] [--commit-ms MS]
+
+#include "../../AutoPowerManager/Actuator.h"
+#include "../../AutoPowerManager/PowerWriter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static const GUID kSubgroup = { 0x54533251, 0x82be, 0x4824, { 0x96,0xc1,0x47,0xb6,0x0b,0x74,0x0d,0x00 } };
+static const GUID kMaxProc = { 0xbc5038f7, 0x23e0, 0x4960, { 0x96,0xda,0x33,0xab,0xaf,0x59,0x35,0xec } };
+
+// Sleeps in every call; remembers the last value written so the final state can be checked.
+struct SlowPowerBackend : IPowerBackend {
+    uint32_t writeMs = 20;
+    uint32_t commitMs = 150;
+    std::atomic<DWORD> lastValue{ 0 };
+
+    bool GetActiveScheme(GUID& s) override { s = GUID{}; return true; }
+    bool WriteValueIndex(const GUID&, const GUID&, const GUID&, PowerSource, DWORD v) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(writeMs));
+        lastValue = v;
+        return true;
+    }
+    bool SetActiveScheme(const GUID&) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(commitMs));
+        return true;
+    }
+};
+
+struct Options {
+    uint32_t events = 400;
+    uint32_t periodMs = 10;
+    uint32_t tickEvery = 10;
+    uint32_t writeMs = 20;
+    uint32_t commitMs = 150;
+};
+
+struct Result {
+    LatencyHistogram ui;
+    DWORD            lastPosted = 0;
+    DWORD            lastApplied = 0;
+    uint64_t         applied = 0;
+    uint64_t         superseded = 0;
+    double           seconds = 0;
+};
+
+static void Transaction(PowerSettingsWriter& w, DWORD v) {
+    w.Begin();
+    w.SetACDC(kSubgroup, kMaxProc, v, v);
+    w.Commit();
+}
+
+static Result Run(const Options& o, bool threaded) {
+    SlowPowerBackend slow;
+    slow.writeMs = o.writeMs; slow.commitMs = o.commitMs;
+    TimedPowerBackend timed(slow);
+    PowerSettingsWriter writer(timed);
+    LatestWinsWorker<DWORD> actuator([&](const DWORD& v) { Transaction(writer, v); });
+    if (threaded) actuator.Start();
+
+    Result r;
+    const Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < o.events; ++i) {
+        const Clock::time_point due = start + std::chrono::milliseconds((uint64_t)i * o.periodMs);
+        std::this_thread::sleep_until(due);   // no-op when the loop is already behind
+        if (i % o.tickEvery == 0) {
+            r.lastPosted = 50 + (i / o.tickEvery) % 51;   // a new setpoint every tick
+            if (threaded) actuator.Post(r.lastPosted);
+            else Transaction(writer, r.lastPosted);
+        }
+        r.ui.Record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - due).count());
+    }
+    if (threaded) {
+        while (actuator.Busy()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        actuator.Stop();
+        r.applied = actuator.GetStats().applied;
+        r.superseded = actuator.GetStats().superseded;
+    }
+    else r.applied = o.events / o.tickEvery + (o.events % o.tickEvery ? 1 : 0);
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    r.lastApplied = slow.lastValue;
+    return r;
+}
+
+static void Report(const char* label, const Result& r) {
+    char line[160];
+    r.ui.Summary(line, sizeof(line));
+    printf("%-9s UI latency %s\n", label, line);
+    printf("%-9s transactions %llu applied, %llu superseded; last posted %u, applied %u%s; %.1f s\n", "",
+        (unsigned long long)r.applied, (unsigned long long)r.superseded, (unsigned)r.lastPosted, (unsigned)r.lastApplied,
+        r.lastPosted == r.lastApplied ? "" : "  << MISMATCH", r.seconds);
+}
+
+static int Usage() {
+    fprintf(stderr, "usage: actuator_stress [--events N] [--period MS] [--tick-every K] [--write-ms MS] [--commit-ms MS]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) return Usage();
+        uint32_t v = (uint32_t)std::max(0, atoi(argv[++i]));
+        if      (!strcmp(a, "--events"))     o.events = std::max(1u, v);
+        else if (!strcmp(a, "--period"))     o.periodMs = std::max(1u, v);
+        else if (!strcmp(a, "--tick-every")) o.tickEvery = std::max(1u, v);
+        else if (!strcmp(a, "--write-ms"))   o.writeMs = v;
+        else if (!strcmp(a, "--commit-ms"))  o.commitMs = v;
+        else return Usage();
+    }
+    printf("%u events every %u ms, a setpoint change every %u; backend: %u ms/write (x2), %u ms/commit\n\n",
+        o.events, o.periodMs, o.tickEvery, o.writeMs, o.commitMs);
+
+    Result inl = Run(o, false);
+    Report("inline", inl);
+    Result thr = Run(o, true);
+    Report("actuator", thr);
+    return inl.lastPosted == inl.lastApplied && thr.lastPosted == thr.lastApplied ? 0 : 1;
+}
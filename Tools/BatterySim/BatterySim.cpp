@@ -0,0 +1,235 @@
+// BatterySim.cpp
+// Drives the governor and the battery runtime governor (BatteryRuntime.h) through a simulated
+// discharge: a battery of a given capacity, a repeating workload whose power depends on the profile
+// applied, and a fuel gauge that turns the remaining energy into whole percent along a synthetic
+// discharge curve. Each curve is run twice, with the plain battThreshold cutoff and with the runtime
+// target, and reports how long the battery lasted, whether the target was met and how the time
+// split across profiles.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o battery_sim Tools/BatterySim/BatterySim.cpp AutoPowerManager/BatteryRuntime.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp
+//
+// Usage:
+//   battery_sim [--target SPEC] [--start HH:MM] [--capacity WH] [--workload office|build|light]
+//               [--curve linear|knee|jumpy|all] [--reserve PCT] [--threshold PCT] [--trace] [--check]
+//
+// Curves: linear (the gauge reads the energy left), knee (a voltage-based gauge: reads high at
+// first, then falls fast near the end), jumpy (linear, with a 4% drop and a 2% rise where the gauge
+// recalibrates). --check exits 1 when the runtime target is missed on any curve, or when the ceiling
+// held the profile down for more than 15 minutes and still left more than 15% above the reserve at
+// the target (throttled for nothing).
+
+#include "../../AutoPowerManager/BatteryRuntime.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// A workload phase: what the governor sees, and the system power at Balanced.
+struct Phase {
+    const char* name;
+    uint32_t    minutes;
+    double      cpuPct;
+    bool        input;      // typing / clicking: idle stays under a second
+    double      watts;
+};
+
+static const Phase kOffice[] = {
+    { "typing", 25, 18.0, true,  9.0 },
+    { "build",  10, 85.0, false, 26.0 },
+    { "call",   20, 30.0, false, 12.0 },
+    { "reading", 15, 4.0, false, 6.0 },
+};
+static const Phase kBuild[] = {
+    { "typing", 10, 18.0, true,  9.0 },
+    { "build",  20, 90.0, false, 28.0 },
+};
+static const Phase kLight[] = {
+    { "typing", 20, 12.0, true,  7.0 },
+    { "reading", 40, 3.0, false, 5.0 },
+};
+
+// Power relative to Balanced for the same work.
+static double ProfileFactor(ProcProfile p) { return p == ProcProfile::Boost ? 1.45 : p == ProcProfile::Saver ? 0.7 : 1.0; }
+
+enum class Curve { Linear, Knee, Jumpy };
+static const char* CurveName(Curve c) { return c == Curve::Linear ? "linear" : c == Curve::Knee ? "knee" : "jumpy"; }
+
+// Reported whole percent for the fraction of energy left.
+static int Gauge(Curve c, double frac) {
+    frac = std::min(1.0, std::max(0.0, frac));
+    double pct = 100.0 * frac;
+    if (c == Curve::Knee) pct = 100.0 * (1.0 - std::pow(1.0 - frac, 1.35));
+    else if (c == Curve::Jumpy) {
+        if (frac < 0.6) pct -= 4.0;                        // recalibrates down at 60%
+        if (frac < 0.3) pct += 2.0;                        // and back up a little at 30%
+    }
+    return (int)std::max(0.0, std::floor(pct));
+}
+
+struct Options {
+    RuntimeTarget target;
+    int      startMinute = 9 * 60;
+    double   capacityWh = 50.0;
+    const Phase* phases = kOffice;
+    size_t   phaseCount = sizeof(kOffice) / sizeof(kOffice[0]);
+    int      reservePct = 5;
+    int      thresholdPct = 25;
+    bool     trace = false;
+};
+
+struct Result {
+    double hoursToEmpty = 0.0;      // until the gauge read 0
+    int    pctAtTarget = -1;        // gauge at the target time; -1: empty before it
+    double hoursIn[3] = {};         // per profile, until empty
+    double cappedHours = 0.0;       // before the target, time the ceiling held the profile down
+    double meanAbsErrH = -1.0;      // the estimator's hours-left vs when the reserve was really reached
+};
+
+static Result Run(const Options& o, Curve curve, bool withTarget) {
+    GovernorConfig gc;
+    gc.battThreshold = o.thresholdPct;
+    Governor gov(gc);
+    RuntimeGovernor rt;
+    RuntimeGovernorConfig rc;
+    if (withTarget) rc.target = o.target;
+    rc.reservePct = o.reservePct;
+    rt.SetConfig(rc);
+
+    uint64_t targetMs = 0;
+    if (o.target.kind == RuntimeTarget::Duration) targetMs = o.target.minutes * 60'000ull;
+    else if (o.target.kind == RuntimeTarget::Until) targetMs = (uint64_t)((o.target.minutes + 1440 - (uint32_t)o.startMinute) % 1440) * 60'000ull;
+
+    Result r;
+    double energyWh = o.capacityWh;
+    ProcProfile applied = ProcProfile::Balanced;
+    uint64_t cycleMs = 0;
+    for (size_t i = 0; i < o.phaseCount; ++i) cycleMs += o.phases[i].minutes * 60'000ull;
+    struct Prediction { uint64_t atMs; double reserveAtMs; };
+    std::vector<Prediction> predictions;
+    uint64_t reserveMs = 0;
+
+    const uint64_t t0 = 1'000;                        // the clocks are never 0
+    for (uint64_t t = 0; t < 48 * 3'600'000ull; t += 1000) {
+        // Phase of the repeating workload.
+        uint64_t inCycle = t % cycleMs;
+        size_t ph = 0;
+        while (inCycle >= o.phases[ph].minutes * 60'000ull) inCycle -= o.phases[ph++].minutes * 60'000ull;
+        const Phase& p = o.phases[ph];
+
+        const int pct = Gauge(curve, energyWh / o.capacityWh);
+        if (!reserveMs && pct <= o.reservePct) reserveMs = t;
+        if (targetMs && t == targetMs) r.pctAtTarget = pct;
+        if (pct <= 0 || energyWh <= 0.0) break;
+
+        GovernorSignals s;
+        s.nowMs = t0 + t;
+        s.cpuPct = s.cpuMaxCorePct = s.cpuTopKPct = p.cpuPct;
+        s.idleSec = p.input ? 0 : 120 + (uint32_t)(inCycle / 1000);
+        s.onAC = false;
+        s.battPct = pct;
+        const int minute = (int)((o.startMinute + t / 60'000) % 1440);
+        rt.Update(s.nowMs, false, pct, applied, gov.Wanted(), minute);
+        rt.ApplyTo(s);
+        applied = gov.Tick(s);
+        if (applied != gov.Wanted() && t < targetMs) r.cappedHours += 1.0 / 3600.0;
+
+        energyWh -= p.watts * ProfileFactor(applied) / 3600.0;
+        r.hoursIn[(int)applied] += 1.0 / 3600.0;
+
+        double left;
+        if (t % 600'000 == 0 && rt.Active() && rt.HoursLeft(left)) predictions.push_back({ t, t + left * 3.6e6 });
+        if (o.trace && t % 600'000 == 0) {
+            printf("  %5.2f h  %3d%%  %-8s %-8s ceiling %-8s", t / 3.6e6, pct, p.name, ProfileNameA(applied),
+                   rt.Active() ? ProfileNameA(rt.Ceiling()) : "-");
+            if (rt.Active() && rt.HoursLeft(left)) printf("  %.1f h left at the ceiling, %.1f h to go", left, rt.HoursToTarget());
+            printf("\n");
+        }
+        r.hoursToEmpty = (t + 1000) / 3.6e6;
+    }
+    if (reserveMs && !predictions.empty()) {
+        double sum = 0.0;
+        for (const Prediction& pr : predictions) sum += std::fabs(pr.reserveAtMs - (double)reserveMs) / 3.6e6;
+        r.meanAbsErrH = sum / predictions.size();
+    }
+    return r;
+}
+
+static int Usage() {
+    fprintf(stderr, "usage: battery_sim [--target SPEC] [--start HH:MM] [--capacity WH] [--workload office|build|light]\n"
+                    "                   [--curve linear|knee|jumpy|all] [--reserve PCT] [--threshold PCT] [--trace] [--check]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    ParseRuntimeTarget("4h", o.target);
+    std::vector<Curve> curves = { Curve::Linear, Curve::Knee, Curve::Jumpy };
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto take = [&]() { if (!v) { fprintf(stderr, "%s needs a value\n", a); exit(Usage()); } ++i; return v; };
+        if (!strcmp(a, "--target")) {
+            if (!ParseRuntimeTarget(take(), o.target) || o.target.kind == RuntimeTarget::Off) { fprintf(stderr, "bad --target\n"); return Usage(); }
+        }
+        else if (!strcmp(a, "--start")) {
+            RuntimeTarget t;
+            if (!ParseRuntimeTarget((std::string("until ") + take()).c_str(), t)) return Usage();
+            o.startMinute = (int)t.minutes;
+        }
+        else if (!strcmp(a, "--capacity"))  o.capacityWh = std::max(1.0, atof(take()));
+        else if (!strcmp(a, "--reserve"))   o.reservePct = std::min(50, std::max(0, atoi(take())));
+        else if (!strcmp(a, "--threshold")) o.thresholdPct = std::min(100, std::max(0, atoi(take())));
+        else if (!strcmp(a, "--workload")) {
+            const char* w = take();
+            if (!strcmp(w, "office"))     { o.phases = kOffice; o.phaseCount = sizeof(kOffice) / sizeof(kOffice[0]); }
+            else if (!strcmp(w, "build")) { o.phases = kBuild; o.phaseCount = sizeof(kBuild) / sizeof(kBuild[0]); }
+            else if (!strcmp(w, "light")) { o.phases = kLight; o.phaseCount = sizeof(kLight) / sizeof(kLight[0]); }
+            else return Usage();
+        }
+        else if (!strcmp(a, "--curve")) {
+            const char* c = take();
+            if (!strcmp(c, "all"))         curves = { Curve::Linear, Curve::Knee, Curve::Jumpy };
+            else if (!strcmp(c, "linear")) curves = { Curve::Linear };
+            else if (!strcmp(c, "knee"))   curves = { Curve::Knee };
+            else if (!strcmp(c, "jumpy"))  curves = { Curve::Jumpy };
+            else return Usage();
+        }
+        else if (!strcmp(a, "--trace")) o.trace = true;
+        else if (!strcmp(a, "--check")) check = true;
+        else return Usage();
+    }
+
+    char target[32];
+    FormatRuntimeTarget(o.target, target, sizeof(target));
+    printf("%.0f Wh, target %s from %02d:%02d, reserve %d%%, threshold %d%%\n\n", o.capacityWh, target,
+           o.startMinute / 60, o.startMinute % 60, o.reservePct, o.thresholdPct);
+    printf("%-7s %-10s %8s %10s %8s %8s %8s %8s %10s\n", "curve", "policy", "runtime", "at target", "boost", "balanced", "saver",
+           "capped", "est. err");
+    bool ok = true;
+    for (Curve c : curves) {
+        for (int withTarget = 0; withTarget < 2; ++withTarget) {
+            if (o.trace) printf("%s, %s:\n", CurveName(c), withTarget ? "target" : "threshold");
+            const Result r = Run(o, c, withTarget != 0);
+            char atTarget[16], err[16];
+            if (r.pctAtTarget < 0) snprintf(atTarget, sizeof(atTarget), "empty");
+            else snprintf(atTarget, sizeof(atTarget), "%d%%", r.pctAtTarget);
+            if (r.meanAbsErrH < 0) snprintf(err, sizeof(err), "-");
+            else snprintf(err, sizeof(err), "%.2f h", r.meanAbsErrH);
+            printf("%-7s %-10s %6.2f h %10s %6.2f h %6.2f h %6.2f h %6.2f h %10s\n", CurveName(c), withTarget ? "target" : "threshold",
+                   r.hoursToEmpty, atTarget, r.hoursIn[0], r.hoursIn[1], r.hoursIn[2], r.cappedHours, err);
+            const bool wasted = r.pctAtTarget > o.reservePct + 15 && r.cappedHours > 0.25;
+            if (check && withTarget && (r.pctAtTarget < 0 || wasted)) {
+                printf("  target %s: %s\n", r.pctAtTarget < 0 ? "missed" : "met, but throttled with battery to spare", target);
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
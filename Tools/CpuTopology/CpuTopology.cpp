@@ -0,0 +1,85 @@
+// CpuTopology.cpp
+// Prints the efficiency classes the app would detect for a sysfs tree (the live /sys, or a captured
+// fixture under Tools/CpuTopology/fixtures), optionally with one per-class utilization sample.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o cpu_topology Tools/CpuTopology/CpuTopology.cpp
+//       AutoPowerManager/CpuTopology.cpp AutoPowerManager/CpuSampler.cpp
+//
+// Usage:
+//   cpu_topology [sysfs-root] [--expect CLASS:LIST ...] [--sample MS]
+//
+// --expect checks that class CLASS holds exactly the CPUs in LIST ("1:0-11"); the exit status is 1
+// on a mismatch, so captured trees double as regression fixtures.
+
+#include "../../AutoPowerManager/CpuSampler.h"
+#include "../../AutoPowerManager/CpuTopology.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string FormatList(const std::vector<uint32_t>& ids) {
+    std::string s;
+    for (size_t i = 0; i < ids.size();) {
+        size_t j = i;
+        while (j + 1 < ids.size() && ids[j + 1] == ids[j] + 1) ++j;
+        if (!s.empty()) s += ',';
+        s += std::to_string(ids[i]);
+        if (j > i) { s += '-'; s += std::to_string(ids[j]); }
+        i = j + 1;
+    }
+    return s;
+}
+
+static std::vector<uint32_t> Members(const CpuTopology& t, int c) {
+    std::vector<uint32_t> ids;
+    for (uint32_t id = 0; id < t.classOf.size(); ++id) if (t.classOf[id] == c) ids.push_back(id);
+    return ids;
+}
+
+int main(int argc, char** argv) {
+    std::string root = "/sys";
+    std::vector<std::string> expects;
+    int sampleMs = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--expect") && i + 1 < argc) expects.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "--sample") && i + 1 < argc) sampleMs = atoi(argv[++i]);
+        else if (argv[i][0] != '-') root = argv[i];
+        else { fprintf(stderr, "usage: cpu_topology [sysfs-root] [--expect CLASS:LIST ...] [--sample MS]\n"); return 2; }
+    }
+
+    CpuTopology t;
+    if (!ReadSysfsCpuTopology(root, t)) { fprintf(stderr, "%s: no devices/system/cpu/present\n", root.c_str()); return 1; }
+    printf("source:  %s\nclasses: %d (%s)\n", t.source, t.classes, t.Hybrid() ? "hybrid" : "homogeneous");
+    for (int c = 0; c < t.classes; ++c)
+        printf("class %d: %u cpus  %s\n", c, t.count[c], FormatList(Members(t, c)).c_str());
+
+    int bad = 0;
+    for (const std::string& e : expects) {
+        std::vector<uint32_t> want;
+        const size_t colon = e.find(':');
+        if (colon == std::string::npos || !ParseCpuList(e.c_str() + colon + 1, want)) { fprintf(stderr, "bad --expect %s\n", e.c_str()); return 2; }
+        const int c = atoi(e.c_str());
+        if (Members(t, c) != want) { printf("MISMATCH class %d: want %s\n", c, FormatList(want).c_str()); ++bad; }
+    }
+
+    if (sampleMs > 0) {
+        ProcStatCoreTimesSource src;
+        PerCoreCpuSampler sampler(src);
+        sampler.SetTopology(t);
+        CpuLoad load;
+        sampler.Sample(load);
+        std::this_thread::sleep_for(std::chrono::milliseconds(sampleMs));
+        if (sampler.Sample(load)) {
+            printf("load:    %.1f%% (max core %.1f%%)\n", load.aggregate, load.maxCore);
+            for (int c = 0; c < load.classes; ++c)
+                printf("class %d: %.1f%% (max core %.1f%%)\n", c, load.classAggregate[c], load.classMaxCore[c]);
+        }
+    }
+    return bad ? 1 : 0;
+}
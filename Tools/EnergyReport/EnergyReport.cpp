@@ -0,0 +1,248 @@
+// EnergyReport.cpp
+// Prints a saved energy ledger (the tray's energy.bin, or the daemon's --energy file), samples the
+// live RAPL counters, or checks the meter and the ledger: --verify runs the RAPL reader against a
+// fake powercap tree (two packages, a subdomain, a counter wrap, a reset, a vanished file) and the
+// ledger against hand-computed totals, including a save/load round trip.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o energy_report Tools/EnergyReport/EnergyReport.cpp AutoPowerManager/Energy.cpp
+//       AutoPowerManager/ProcessScanner.cpp AutoPowerManager/AppRules.cpp AutoPowerManager/ForegroundTracker.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp
+//
+// Usage:
+//   energy_report FILE
+//   energy_report --verify
+//   energy_report --live SECONDS [--sysfs ROOT]
+
+#include "../../AutoPowerManager/Energy.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int g_failures = 0;
+
+static void Check(bool ok, const char* what) {
+    printf("%-4s %s\n", ok ? "ok" : "FAIL", what);
+    if (!ok) ++g_failures;
+}
+
+static bool Near(double a, double b) { return std::fabs(a - b) < 1e-9 * std::max(1.0, std::fabs(b)); }
+
+#ifndef _WIN32
+// ---------- Fake powercap tree ----------
+struct FakePowercap {
+    std::string root, dir;
+
+    FakePowercap() {
+        char tmpl[] = "/tmp/powercap.XXXXXX";
+        root = mkdtemp(tmpl) ? tmpl : "/tmp/powercap.fixture";
+        mkdir((root + "/class").c_str(), 0755);
+        dir = root + "/class/powercap";
+        mkdir(dir.c_str(), 0755);
+    }
+    ~FakePowercap() { std::string cmd = "rm -rf '" + root + "'"; if (system(cmd.c_str())) {} }
+
+    void Domain(const char* name, uint64_t energyUj, uint64_t rangeUj) {
+        mkdir((dir + "/" + name).c_str(), 0755);
+        Set(name, energyUj);
+        if (rangeUj) Write(dir + "/" + name + "/max_energy_range_uj", rangeUj);
+    }
+    void Set(const char* name, uint64_t energyUj) { Write(dir + "/" + name + "/energy_uj", energyUj); }
+    void Remove(const char* name) { unlink((dir + "/" + name + "/energy_uj").c_str()); }
+
+    static void Write(const std::string& path, uint64_t v) {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) { perror(path.c_str()); exit(2); }
+        fprintf(f, "%llu\n", (unsigned long long)v);
+        fclose(f);
+    }
+};
+
+static void VerifyRapl() {
+    const uint64_t kRange = 262'143'328'850ull;   // a typical package max_energy_range_uj
+    FakePowercap t;
+    t.Domain("intel-rapl:0", 5'000'000, kRange);
+    t.Domain("intel-rapl:0:0", 1'000, kRange);     // core subdomain: inside package 0
+    t.Domain("intel-rapl:1", 7'000'000, kRange);
+    t.Domain("intel-rapl-mmio:0", 9'000, kRange);  // the same package again through MMIO
+    RaplEnergySource src(t.root);
+    double j = -1.0;
+
+    Check(!src.Read(1000, j), "first reading only primes the counters");
+    Check(src.Domains() == 2, "two package domains found, subdomain and MMIO skipped");
+
+    t.Set("intel-rapl:0", 6'000'000);
+    t.Set("intel-rapl:1", 7'500'000);
+    t.Set("intel-rapl:0:0", 900'000'000);
+    Check(src.Read(2000, j) && Near(j, 1.5), "packages summed: 1.0 J + 0.5 J");
+
+    t.Set("intel-rapl:0", kRange - 100'000);
+    t.Set("intel-rapl:1", 7'500'000);
+    Check(src.Read(3000, j) && Near(j, (kRange - 100'000 - 6'000'000) / 1e6), "large step below the range");
+
+    t.Set("intel-rapl:0", 400'000);               // wrapped: 100 000 to the top, then 400 000
+    t.Set("intel-rapl:1", 7'750'000);
+    Check(src.Read(4000, j) && Near(j, 0.75), "wraparound unwrapped with max_energy_range_uj");
+
+    t.Set("intel-rapl:0", 400'000);
+    t.Set("intel-rapl:1", 7'750'000);
+    Check(src.Read(5000, j) && Near(j, 0.0), "no change: zero joules, still metered");
+
+    t.Remove("intel-rapl:1");
+    Check(!src.Read(6000, j), "vanished counter: interval dropped");
+    t.Set("intel-rapl:1", 8'000'000);
+    Check(!src.Read(7000, j) && src.Domains() == 2, "rediscovered, primes again");
+    t.Set("intel-rapl:0", 600'000);
+    t.Set("intel-rapl:1", 8'100'000);
+    Check(src.Read(8000, j) && Near(j, 0.3), "metering resumes after rediscovery");
+
+    // Without max_energy_range_uj a backwards step can't be told from a reset.
+    FakePowercap u;
+    u.Domain("intel-rapl:0", 10'000'000, 0);
+    RaplEnergySource noRange(u.root);
+    noRange.Read(1000, j);
+    u.Set("intel-rapl:0", 2'000'000);
+    Check(!noRange.Read(2000, j), "backwards without a range: interval dropped, not guessed");
+    u.Set("intel-rapl:0", 2'500'000);
+    Check(noRange.Read(3000, j) && Near(j, 0.5), "next interval metered again");
+
+    FakePowercap empty;
+    RaplEnergySource none(empty.root);
+    Check(!none.Read(1000, j) && !none.Read(2000, j) && none.Domains() == 0, "no powercap: never metered");
+}
+#endif
+
+// ---------- Ledger ----------
+static void VerifyLedger() {
+    EnergyLedger l;
+    l.Charge(0, 99.0, true, 50.0);                              // nothing attributed yet: ignored
+    l.Attribute(ProcProfile::Boost, L"matlab");
+    l.Charge(60'000, 1800.0, true, 85.0);                       // 30 W for a minute at high load
+    l.Attribute(ProcProfile::Saver, L"");
+    l.Charge(120'000, 240.0, true, 3.0);                        // 4 W idle
+    l.Attribute(ProcProfile::Balanced, L"teams");
+    l.Charge(180'000, 0.0, false, 20.0);                        // unmetered minute
+    l.Attribute(ProcProfile::Boost, L"matlab");
+    l.Charge(240'000, 1200.0, true, 5.0);                       // Boost at low load: 20 W
+
+    Check(l.Band(ProcProfile::Boost, 3).mJ == 1'800'000 && l.Band(ProcProfile::Boost, 3).ms == 60'000, "Boost, high-load band");
+    Check(l.Band(ProcProfile::Boost, 0).mJ == 1'200'000, "Boost, idle band");
+    Check(l.Profile(ProcProfile::Saver).mJ == 240'000 && l.UnmeteredMs(ProcProfile::Balanced) == 60'000, "Saver metered, Balanced unmetered");
+    Check(Near(l.MeteredWh(), 3240.0 / 3600.0), "total Wh");
+    double boostWh = 0.0;
+    // Band 0 holds Boost (20 W, 1 min) and Saver (1 min): 2 min * 20 W; band 3: 1 min * 30 W.
+    Check(l.AlwaysBoostWh(boostWh) && Near(boostWh, (20.0 * 120 + 30.0 * 60) / 3600.0), "always-Boost estimate by band");
+    Check(l.Apps() == 3 && !wcscmp(l.AppAt(0).name, L"matlab") && l.AppAt(0).Total().mJ == 3'000'000, "per-app totals");
+
+    // More apps than slots: the cheapest fold into "other", and no energy is lost.
+    EnergyLedger m;
+    uint64_t now = 0, charged = 0;
+    for (int i = 0; i < 100; ++i) {
+        m.Attribute(ProcProfile::Balanced, L"app" + std::to_wstring(i));
+        now += 1000;
+        m.Charge(now, 1.0 + i, true, 40.0);
+        charged += (uint64_t)(1000.0 * (1.0 + i));
+    }
+    uint64_t apps = 0;
+    for (size_t i = 0; i < m.Apps(); ++i) apps += m.AppAt(i).Total().mJ;
+    Check(m.Apps() == EnergyLedger::kApps + 1 && !wcscmp(m.AppAt(m.Apps() - 1).name, L"(other)"), "app table full: \"other\" used");
+    Check(apps == charged && m.Profile(ProcProfile::Balanced).mJ == charged, "energy conserved across eviction");
+
+    // Save / load round trip, and a truncated file left alone.
+    FILE* f = tmpfile();
+    Check(f && m.Save(f), "save");
+    long size = f ? ftell(f) : 0;
+    EnergyLedger back;
+    if (f) rewind(f);
+    Check(f && back.Load(f) && back.MeteredWh() == m.MeteredWh() && back.Apps() == m.Apps(), "load restores the totals");
+    if (f) {
+        FILE* g = tmpfile();
+        rewind(f);
+        std::vector<char> bytes((size_t)size);
+        if (fread(bytes.data(), 1, bytes.size(), f) != bytes.size()) bytes.clear();
+        fwrite(bytes.data(), 1, bytes.size() / 2, g);
+        rewind(g);
+        Check(!l.Load(g) && Near(l.MeteredWh(), 3240.0 / 3600.0), "truncated file rejected, ledger unchanged");
+        fclose(g);
+        fclose(f);
+    }
+    printf("ledger file: %ld bytes\n", size);
+}
+
+static int Usage() {
+    fprintf(stderr, "usage: energy_report FILE\n"
+                    "       energy_report --verify\n"
+                    "       energy_report --live SECONDS [--sysfs ROOT]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* file = nullptr;
+    const char* sysfs = "/sys";
+    bool verify = false;
+    int live = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--verify"))            verify = true;
+        else if (!strcmp(a, "--live") && v)    { live = std::max(1, atoi(v)); ++i; }
+        else if (!strcmp(a, "--sysfs") && v)   { sysfs = v; ++i; }
+        else if (a[0] == '-')                  return Usage();
+        else                                   file = a;
+    }
+    if (!verify && !live && !file) return Usage();
+
+    if (verify) {
+#ifndef _WIN32
+        VerifyRapl();
+#endif
+        VerifyLedger();
+        printf("%s\n", g_failures ? "FAILED" : "all checks passed");
+        if (g_failures) return 1;
+    }
+
+    if (file) {
+        FILE* f = fopen(file, "rb");
+        if (!f) { fprintf(stderr, "cannot open %s\n", file); return 1; }
+        EnergyLedger l;
+        const bool ok = l.Load(f);
+        fclose(f);
+        if (!ok) { fprintf(stderr, "%s: not an energy ledger\n", file); return 1; }
+        printf("%s", FormatEnergyReport(l, file).c_str());
+    }
+
+    if (live) {
+#ifndef _WIN32
+        RaplEnergySource src(sysfs);
+        const auto t0 = std::chrono::steady_clock::now();
+        auto ms = [&t0]() { return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count() + 1; };
+        uint64_t last = ms();
+        double j = 0.0;
+        src.Read(last, j);
+        if (!src.Domains()) { fprintf(stderr, "%s: no readable RAPL package counters (root only?)\n", sysfs); return 1; }
+        for (int s = 0; s < live; ++s) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            const uint64_t now = ms();
+            if (src.Read(now, j)) printf("%6.1f s  %8.2f W\n", now / 1000.0, j * 1000.0 / (double)(now - last));
+            else printf("%6.1f s  (not metered)\n", now / 1000.0);
+            last = now;
+        }
+#else
+        (void)sysfs;
+        fprintf(stderr, "--live reads RAPL: Linux only\n");
+        return 2;
+#endif
+    }
+    return 0;
+}
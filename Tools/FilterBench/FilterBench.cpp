@@ -0,0 +1,206 @@
+// FilterBench.cpp
+// Scores input-filter specs (SignalFilter.h) on synthetic CPU traces: how long a real load step
+// takes to trip the Active threshold and to release it, how often short spikes on an idle machine
+// trip it anyway, and the cost of one update. --verify checks the sliding median against a sort.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o filter_bench Tools/FilterBench/FilterBench.cpp AutoPowerManager/SignalFilter.cpp
+//
+// Usage:
+//   filter_bench [--spec SPEC ...] [--threshold PCT] [--hyst PCT] [--tick MS] [--hours H] [--seed N]
+//                [--max-latency-ms MS] [--max-false N] [--verify]
+//
+// The gates apply to every spec scored: the exit status is 1 when a step takes longer than
+// --max-latency-ms to trip, spikes trip more than --max-false times per hour, or a step never trips.
+
+#include "../../AutoPowerManager/SignalFilter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Deterministic noise, so runs are comparable across machines.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state(seed * 6'364'136'223'846'793'005ull + 1) {}
+    uint32_t Next() { state = state * 6'364'136'223'846'793'005ull + 1'442'695'040'888'963'407ull; return (uint32_t)(state >> 33); }
+    double   Uniform() { return Next() / 2'147'483'648.0; }   // [0, 1)
+    double   Gauss() {                                          // Box-Muller, one of the pair
+        const double u = std::max(Uniform(), 1e-12), v = Uniform();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283'185'307 * v);
+    }
+
+private:
+    uint64_t state;
+};
+
+static double Clamp(double v) { return std::min(100.0, std::max(0.0, v)); }
+
+struct Options {
+    double   thresholdPct = 40.0;    // GovernorConfig::activeCpuPct
+    double   hystPct = 0.0;
+    uint32_t tickMs = 1000;
+    double   hours = 4.0;
+    uint64_t seed = 1;
+};
+
+struct Score {
+    std::vector<double> riseMs, fallMs;   // per step; a step that never trips counts its full length
+    uint32_t missed = 0;                  // steps that never tripped
+    double   falsePerHour = 0.0;
+    double   nsPerUpdate = 0.0;
+};
+
+// Noisy 10% idle, then a 70% load held for two minutes, then idle again for two minutes; repeated.
+// Latency is measured from the step to the comparator changing state.
+static void ScoreSteps(const FilterSpec& spec, const Options& o, Score& sc) {
+    SignalFilter f(spec);
+    Hysteresis h;
+    Rng rng(o.seed);
+    const uint32_t phaseTicks = std::max<uint32_t>(1, 120'000 / o.tickMs);
+    const uint32_t steps = std::max<uint32_t>(1, (uint32_t)(o.hours * 3'600'000.0 / o.tickMs / (2 * phaseTicks)));
+    for (uint32_t i = 0; i < phaseTicks; ++i) h.Update(f.Update(Clamp(10.0 + 4.0 * rng.Gauss()), o.tickMs), o.thresholdPct, o.thresholdPct - o.hystPct);
+    for (uint32_t step = 0; step < steps; ++step) {
+        for (int high = 1; high >= 0; --high) {
+            const double level = high ? 70.0 : 10.0;
+            double latency = -1.0;
+            for (uint32_t i = 0; i < phaseTicks; ++i) {
+                const bool on = h.Update(f.Update(Clamp(level + 4.0 * rng.Gauss()), o.tickMs), o.thresholdPct, o.thresholdPct - o.hystPct);
+                if (latency < 0.0 && on == (high != 0)) latency = (double)(i + 1) * o.tickMs;
+            }
+            if (latency < 0.0) { latency = (double)phaseTicks * o.tickMs; if (high) ++sc.missed; }
+            (high ? sc.riseMs : sc.fallMs).push_back(latency);
+        }
+    }
+}
+
+// A 12% idle machine with one- and two-tick spikes to 85-100% (an indexer, a browser tab waking).
+// Every off->on transition is a false trigger.
+static void ScoreSpikes(const FilterSpec& spec, const Options& o, Score& sc) {
+    SignalFilter f(spec);
+    Hysteresis h;
+    Rng rng(o.seed + 1);
+    const uint64_t ticks = std::max<uint64_t>(1, (uint64_t)(o.hours * 3'600'000.0 / o.tickMs));
+    const double spikeChance = 0.03 * o.tickMs / 1000.0;   // about two spikes a minute
+    uint32_t burst = 0, triggers = 0;
+    bool was = false;
+    for (uint64_t i = 0; i < ticks; ++i) {
+        if (!burst && rng.Uniform() < spikeChance) burst = 1 + rng.Next() % 2;
+        const double x = burst ? 85.0 + 15.0 * rng.Uniform() : Clamp(12.0 + 5.0 * rng.Gauss());
+        if (burst) --burst;
+        const bool on = h.Update(f.Update(x, o.tickMs), o.thresholdPct, o.thresholdPct - o.hystPct);
+        if (on && !was) ++triggers;
+        was = on;
+    }
+    sc.falsePerHour = triggers / o.hours;
+}
+
+static void ScoreCost(const FilterSpec& spec, Score& sc) {
+    SignalFilter f(spec);
+    Rng rng(7);
+    std::vector<double> xs(4096);
+    for (double& x : xs) x = 100.0 * rng.Uniform();
+    const uint32_t n = 2'000'000;
+    double sink = 0.0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; ++i) sink += f.Update(xs[i & 4095], 1000.0);
+    const auto t1 = std::chrono::steady_clock::now();
+    sc.nsPerUpdate = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    if (sink == -1.0) printf("\n");   // keep the loop
+}
+
+static double Percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p / 100.0 * (v.size() - 1) + 0.5))];
+}
+
+// SlidingMedian against a sorted copy of the window, for random windows and data with ties.
+static bool VerifyMedian(uint64_t seed) {
+    Rng rng(seed);
+    uint64_t checks = 0;
+    for (uint32_t trial = 0; trial < 200; ++trial) {
+        const uint32_t window = trial < 64 ? trial + 1 : trial % 16 == 0 ? SlidingMedian::kMaxWindow : 1 + rng.Next() % 256;
+        const uint32_t len = window * 3 + rng.Next() % 200;
+        const bool ties = trial % 3 == 0;
+        SlidingMedian m(window);
+        std::vector<double> hist, win;
+        for (uint32_t i = 0; i < len; ++i) {
+            const double x = ties ? (double)(rng.Next() % 8) : 100.0 * rng.Uniform();
+            hist.push_back(x);
+            const double got = m.Update(x);
+            win.assign(hist.end() - std::min<size_t>(hist.size(), window), hist.end());
+            std::sort(win.begin(), win.end());
+            const size_t k = win.size();
+            const double want = k % 2 ? win[k / 2] : 0.5 * (win[k / 2 - 1] + win[k / 2]);
+            ++checks;
+            if (got != want) {
+                printf("median mismatch: window %u, sample %u: got %g, want %g\n", window, i, got, want);
+                return false;
+            }
+        }
+    }
+    printf("sliding median: %llu checks against a sort, all equal\n", (unsigned long long)checks);
+    return true;
+}
+
+static int Usage() {
+    fprintf(stderr,
+        "usage: filter_bench [--spec SPEC ...] [--threshold PCT] [--hyst PCT] [--tick MS] [--hours H] [--seed N]\n"
+        "                    [--max-latency-ms MS] [--max-false N] [--verify]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    std::vector<std::string> specs;
+    double maxLatencyMs = 0.0, maxFalse = -1.0;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto take = [&]() { if (!v) { fprintf(stderr, "%s needs a value\n", a); exit(Usage()); } ++i; return v; };
+        if      (!strcmp(a, "--spec"))           specs.push_back(take());
+        else if (!strcmp(a, "--threshold"))      o.thresholdPct = atof(take());
+        else if (!strcmp(a, "--hyst"))           o.hystPct = std::max(0.0, atof(take()));
+        else if (!strcmp(a, "--tick"))           o.tickMs = (uint32_t)std::max(10, atoi(take()));
+        else if (!strcmp(a, "--hours"))          o.hours = std::max(0.1, atof(take()));
+        else if (!strcmp(a, "--seed"))           o.seed = strtoull(take(), nullptr, 10);
+        else if (!strcmp(a, "--max-latency-ms")) maxLatencyMs = atof(take());
+        else if (!strcmp(a, "--max-false"))      maxFalse = atof(take());
+        else if (!strcmp(a, "--verify"))         verify = true;
+        else                                     return Usage();
+    }
+
+    bool ok = true;
+    if (verify) ok = VerifyMedian(o.seed);
+
+    if (specs.empty()) {
+        char legacy[64];
+        FormatFilterSpec(FilterSpec::LegacyCpu(), legacy, sizeof(legacy));
+        specs = { "none", legacy, "ewma:4481", "median:3+ewma:800/4481", "median:5+ewma:1000/4481", "median:9",
+                  "kalman:20/100", "median:5+kalman:20/100" };
+    }
+
+    printf("threshold %.0f%%, hysteresis %.0f%%, %u ms ticks, %.1f h per trace\n\n", o.thresholdPct, o.hystPct, o.tickMs, o.hours);
+    printf("%-26s %9s %9s %9s %9s %8s %9s\n", "spec", "rise p50", "rise max", "fall p50", "fall max", "false/h", "ns/upd");
+    for (const std::string& text : specs) {
+        FilterSpec spec;
+        if (!ParseFilterSpec(text.c_str(), spec)) { fprintf(stderr, "bad filter spec: %s\n", text.c_str()); return 2; }
+        Score sc;
+        ScoreSteps(spec, o, sc);
+        ScoreSpikes(spec, o, sc);
+        ScoreCost(spec, sc);
+        const double riseMax = Percentile(sc.riseMs, 100.0);
+        printf("%-26s %7.0fms %7.0fms %7.0fms %7.0fms %8.1f %9.1f%s\n", text.c_str(), Percentile(sc.riseMs, 50.0), riseMax,
+               Percentile(sc.fallMs, 50.0), Percentile(sc.fallMs, 100.0), sc.falsePerHour, sc.nsPerUpdate,
+               sc.missed ? "  (missed steps)" : "");
+        if (sc.missed || (maxLatencyMs > 0.0 && riseMax > maxLatencyMs) || (maxFalse >= 0.0 && sc.falsePerHour > maxFalse)) ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,502 @@
+// GovBench.cpp
+// Tick-path microbenchmarks and the governor's own overhead over a simulated hour, with every OS
+// call mocked: synthetic per-core counters, process table, thermal zone, energy meter, PMU counters and
+// foreground events, a power backend that only counts, and a virtual clock driven by the tick scheduler's delays.
+// Global operator new is counted, so each figure comes with its heap allocations.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o gov_bench Tools/GovBench/GovBench.cpp AutoPowerManager/GovernorLoop.cpp
+//       AutoPowerManager/StatusText.cpp AutoPowerManager/Governor.cpp AutoPowerManager/CpuSampler.cpp
+//       AutoPowerManager/CpuTopology.cpp AutoPowerManager/ProcessScanner.cpp AutoPowerManager/ProcessQos.cpp
+//       AutoPowerManager/ForegroundTracker.cpp AutoPowerManager/ProfileLadder.cpp AutoPowerManager/Thermal.cpp
+//       AutoPowerManager/TickScheduler.cpp AutoPowerManager/Telemetry.cpp AutoPowerManager/PowerWriter.cpp
+//       AutoPowerManager/LatencyHistogram.cpp AutoPowerManager/SignalFilter.cpp AutoPowerManager/AppRules.cpp
+//       AutoPowerManager/Energy.cpp AutoPowerManager/BatteryRuntime.cpp AutoPowerManager/PerfCounters.cpp
+//       AutoPowerManager/Predictor.cpp
+//
+// Usage:
+//   gov_bench [--cores N] [--procs N] [--hours H] [--iters N] [--procfs]
+//             [--max-allocs-per-tick X] [--max-cpu-ms-per-hour X] [--max-wakeups-per-hour X]
+// It exits 1 if a steady-state tick allocates or changes the status text more than once per ten
+// ticks, or when the simulated run exceeds a --max-* budget (a CI regression gate).
+
+#include "../../AutoPowerManager/GovernorLoop.h"
+#include "../../AutoPowerManager/ForegroundTracker.h"
+#include "../../AutoPowerManager/StatusText.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ---------- Allocation counting ----------
+static uint64_t g_allocs = 0;
+
+void* operator new(size_t n) {
+    ++g_allocs;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double ThreadCpuMs() {
+#ifdef _WIN32
+    FILETIME c, e, k, u;
+    if (!GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u)) return 0.0;
+    auto ticks = [](const FILETIME& f) { return ((uint64_t)f.dwHighDateTime << 32) | f.dwLowDateTime; };
+    return (ticks(k) + ticks(u)) / 10'000.0;
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+// ---------- Workload model ----------
+// A deterministic working hour in one-minute phases: idle, typing, video, a parallel build.
+enum class Phase { Idle, Typing, Video, Build };
+static const char* const kPhaseNames[] = { "idle", "typing", "video", "build" };
+static int g_holdPhase = -1;   // >= 0: that phase throughout (steady-state runs)
+
+static Phase PhaseAt(uint64_t nowMs) {
+    if (g_holdPhase >= 0) return (Phase)g_holdPhase;
+    uint32_t m = (uint32_t)(nowMs / 60'000);
+    uint32_t h = m * 2654435761u;
+    switch ((h >> 24) % 8) {
+    case 0: case 1: case 2: return Phase::Idle;
+    case 3: case 4:         return Phase::Typing;
+    case 5: case 6:         return Phase::Video;
+    default:                return Phase::Build;
+    }
+}
+
+// Busy share of core i (0..1) during a phase.
+static double CoreBusy(Phase p, size_t i, size_t cores) {
+    switch (p) {
+    case Phase::Idle:   return i == 0 ? 0.03 : 0.01;
+    case Phase::Typing: return i == 0 ? 0.25 : 0.03;
+    case Phase::Video:  return i < 2 ? 0.35 : 0.05;
+    case Phase::Build:  return i < cores - 1 ? 0.95 : 0.40;
+    }
+    return 0.0;
+}
+
+struct SyntheticCores : ICoreTimesSource {
+    const uint64_t* now;
+    size_t          cores;
+    uint64_t        lastMs = 0;
+    std::vector<double> busy, total;   // in ms
+
+    SyntheticCores(const uint64_t* now, size_t cores) : now(now), cores(cores), busy(cores), total(cores) {}
+
+    bool Read(CoreTimes& out) override {
+        const uint64_t dt = *now - lastMs;
+        lastMs = *now;
+        const Phase p = PhaseAt(*now);
+        out.busy.resize(cores); out.total.resize(cores); out.ids.resize(cores);
+        for (size_t i = 0; i < cores; ++i) {
+            busy[i] += dt * CoreBusy(p, i, cores);
+            total[i] += (double)dt;
+            out.busy[i] = (uint64_t)busy[i]; out.total[i] = (uint64_t)total[i]; out.ids[i] = (uint32_t)i;
+        }
+        return true;
+    }
+};
+
+// N processes with stable PIDs; during a build a handful of compilers burn whole cores.
+struct SyntheticTable : IProcessTableSource {
+    struct Proc { uint32_t pid; uint64_t cpuUs; const wchar_t* name; };
+    const uint64_t*   now;
+    uint64_t          lastMs = 0;
+    std::vector<Proc> procs;
+
+    SyntheticTable(const uint64_t* now, uint32_t n) : now(now) {
+        for (uint32_t i = 0; i < n; ++i)
+            procs.push_back({ 100 + i, 0, i < 4 ? L"cl.exe" : i == 4 ? L"vlc.exe" : L"svchost.exe" });
+    }
+
+    bool Scan(IProcessSink& sink) override {
+        const uint64_t dt = *now - lastMs;
+        lastMs = *now;
+        const Phase p = PhaseAt(*now);
+        for (size_t i = 0; i < procs.size(); ++i) {
+            Proc& pr = procs[i];
+            const double share = i < 4 ? (p == Phase::Build ? 0.95 : 0.0) : i == 4 ? (p == Phase::Video ? 0.35 : 0.0) : 0.001;
+            pr.cpuUs += (uint64_t)(dt * 1000 * share);
+            sink.OnProcess(pr.pid, pr.pid, pr.cpuUs, pr.name, wcslen(pr.name));
+        }
+        return true;
+    }
+};
+
+// Temperature follows the phase with a 20 s lag; package power tracks it.
+struct SyntheticThermal : IThermalSource {
+    double   tempC = 45.0;
+    uint64_t lastMs = 0;
+
+    bool Sample(uint64_t nowMs, ThermalSample& out) override {
+        const Phase p = PhaseAt(nowMs);
+        const double target = p == Phase::Build ? 92.0 : p == Phase::Video ? 60.0 : 48.0;
+        const double a = 1.0 - std::exp(-(double)(nowMs - lastMs) / 20'000.0);
+        lastMs = nowMs;
+        tempC += (target - tempC) * a;
+        out.tempC = tempC;
+        out.packageW = 5.0 + (tempC - 45.0) * 0.8;
+        out.packageLimitW = 28.0;
+        return true;
+    }
+};
+
+// Package energy from the phase's load and the profile applied: Boost costs more at the same load.
+struct SyntheticEnergy : IEnergySource {
+    const GovernorLoop* loop = nullptr;
+    uint64_t            lastMs = 0;
+
+    bool Read(uint64_t nowMs, double& joules) override {
+        const Phase p = PhaseAt(nowMs);
+        const double loadW = p == Phase::Build ? 30.0 : p == Phase::Video ? 9.0 : p == Phase::Typing ? 6.0 : 3.0;
+        const ProcProfile a = loop ? loop->Applied() : ProcProfile::Balanced;
+        const double w = loadW * (a == ProcProfile::Boost ? 1.3 : a == ProcProfile::Saver ? 0.8 : 1.0);
+        const bool primed = lastMs != 0;
+        joules = w * (double)(nowMs - lastMs) / 1000.0;
+        lastMs = nowMs;
+        return primed;
+    }
+    const char* Name() const override { return "synthetic"; }
+};
+
+// PMU counts for the phase: a build computes (IPC 1.8, 2 misses per 1000 instructions), video
+// decoding streams frames through memory (IPC 0.6, 18 MPKI). Typing keeps the build boosted;
+// the video phase has no input, so its memory-bound ticks are capped.
+struct SyntheticPerf : IPerfCounterSource {
+    uint64_t lastMs = 0;
+
+    bool Read(uint64_t nowMs, PerfSample& out) override {
+        const bool primed = lastMs != 0 && nowMs > lastMs;
+        out = PerfSample{};
+        out.seconds = (double)(nowMs - lastMs) / 1000.0;
+        lastMs = nowMs;
+        const Phase p = PhaseAt(nowMs);
+        const bool stream = p == Phase::Video;
+        const double cores = p == Phase::Build ? 14.0 : p == Phase::Video ? 1.0 : 0.3;
+        out.cycles = cores * 3e9 * out.seconds;
+        out.instructions = out.cycles * (stream ? 0.6 : 1.8);
+        out.llcMisses = out.instructions * (stream ? 0.018 : 0.002);
+        return primed;
+    }
+    const char* Name() const override { return "synthetic"; }
+};
+
+struct NullQosControl : IProcessQosControl {
+    uint64_t sets = 0, restores = 0;
+    bool Set(uint32_t, uint64_t, QosLevel, QosSaved&) override { ++sets; return true; }
+    bool Restore(uint32_t, uint64_t, QosLevel, const QosSaved&) override { ++restores; return true; }
+};
+
+struct FakeInspector : IProcessInspector {
+    bool CreationTime(uint32_t pid, uint64_t& t) override { t = pid * 1000ull; return true; }
+    bool ImagePath(uint32_t pid, std::wstring& path) override {
+        static const wchar_t* const names[] = { L"C:\\Windows\\explorer.exe", L"C:\\Code\\devenv.exe",
+            L"C:\\Apps\\MATLAB\\bin\\MATLAB.exe", L"C:\\Apps\\vlc.exe" };
+        path = names[pid % 4];
+        return true;
+    }
+};
+
+// Inputs the tray would sample itself: idle time from the phase, AC, foreground from the phase.
+static GovernorLoopInputs InputsAt(uint64_t nowMs, uint64_t& lastInputMs) {
+    const Phase p = PhaseAt(nowMs);
+    if (p == Phase::Typing || p == Phase::Build) lastInputMs = nowMs - nowMs % 3'000;
+    GovernorLoopInputs in;
+    in.idleSec = (uint32_t)((nowMs - lastInputMs) / 1000);
+    in.onAC = (nowMs / 1'800'000) % 2 == 0;       // unplugged every other half hour
+    in.battPct = 80;
+    in.fgPid = p == Phase::Video ? 104 : 200;
+    return in;
+}
+
+// ---------- Microbenchmarks ----------
+struct Result { double nsPerOp; double allocsPerOp; };
+
+template <typename F> static Result Measure(uint32_t iters, F op) {
+    for (uint32_t i = 0; i < std::min<uint32_t>(iters, 100); ++i) op(i);   // warm caches and buffers
+    const uint64_t a0 = g_allocs;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < iters; ++i) op(i);
+    auto t1 = Clock::now();
+    return { std::chrono::duration<double, std::nano>(t1 - t0).count() / iters, (double)(g_allocs - a0) / iters };
+}
+
+static void Print(const char* name, const Result& r) {
+    printf("  %-22s %10.1f ns/op  %6.2f allocs/op\n", name, r.nsPerOp, r.allocsPerOp);
+}
+
+static void Micro(size_t cores, uint32_t procs, uint32_t iters, bool procfs) {
+    printf("microbenchmarks (%zu cores, %u processes, %u iterations)\n", cores, procs, iters);
+    uint64_t now = 0;
+
+    {
+        SyntheticCores src(&now, cores);
+        PerCoreCpuSampler sampler(src);
+        CpuLoad l;
+        Print("cpu-sample", Measure(iters, [&](uint32_t) { now += 1000; sampler.Sample(l); }));
+    }
+#ifndef _WIN32
+    if (procfs) {
+        ProcStatCoreTimesSource src;
+        PerCoreCpuSampler sampler(src);
+        CpuLoad l;
+        Print("cpu-sample /proc/stat", Measure(std::min<uint32_t>(iters, 10'000), [&](uint32_t) { sampler.Sample(l); }));
+    }
+#else
+    (void)procfs;
+#endif
+    {
+        // Input filters (median + EWMA) and tier/profile decision, over a varying signal.
+        Governor gov;
+        GovernorSignals s;
+        Print("governor-tick", Measure(iters, [&](uint32_t i) {
+            s.nowMs += 1000;
+            s.cpuPct = (i * 37) % 100; s.cpuMaxCorePct = (i * 53) % 100; s.cpuTopKPct = (i * 41) % 100;
+            s.idleSec = (i / 30) % 2 ? i % 600 : 0;
+            gov.Tick(s);
+        }));
+    }
+    {
+        FakeInspector insp;
+        ForegroundTracker fg(insp);
+        AppRules rules;
+        rules.Parse(L"matlab");
+        fg.SetRules(rules);
+        Governor gov;
+        GovernorSignals s;
+        Print("foreground+tick", Measure(iters, [&](uint32_t i) {
+            if (i % 16 == 0) fg.OnForegroundChanged(100 + (i / 16) % 8);   // cache hits after warm-up
+            s.nowMs += 1000;
+            SetForegroundRule(s, fg.ForegroundRule(true));
+            gov.Tick(s);
+        }));
+    }
+    {
+        StatusFields f;
+        f.level = "Balanced"; f.hybrid = true; f.tempC = 71.4;
+        wchar_t tip[128], line[320];
+        Print("status-tip", Measure(iters, [&](uint32_t i) {
+            f.cpuPct = i % 100; f.idleSec = i;
+            FormatTrayTip(f, tip, sizeof(tip) / sizeof(tip[0]));
+        }));
+        Print("status-line", Measure(iters, [&](uint32_t i) {
+            f.cpuPct = i % 100; f.idleSec = i;
+            FormatStatusLine(f, line, sizeof(line) / sizeof(line[0]));
+        }));
+    }
+    {
+        SyntheticCores src(&now, cores);
+        SyntheticTable table(&now, procs);
+        SyntheticThermal thermal;
+        NullQosControl qosCtl;
+        CountingPowerBackend power;
+        GovernorLoop loop(src, table, qosCtl, thermal, power);
+        uint64_t lastInput = 0;
+        Print("loop-tick", Measure(iters, [&](uint32_t) {
+            now += 1000;
+            loop.Tick(now, InputsAt(now, lastInput), now);
+        }));
+    }
+}
+
+// ---------- Simulated hours ----------
+// The tray's refresh after each tick: format in place, send only changed text.
+struct StatusView {
+    wchar_t  tip[128] = {}, line[320] = {};
+    uint64_t updates = 0;
+
+    void Refresh(const GovernorLoop& loop, const GovernorLoopInputs& in, uint32_t delay) {
+        StatusFields f;
+        f.profile = loop.Applied();
+        f.level = loop.Ladder().Size() ? loop.Ladder()[0].name : "";
+        f.cpuPct = loop.Gov().CpuEWMA(); f.maxCorePct = loop.Gov().MaxCoreEWMA();
+        f.idleSec = in.idleSec; f.onAC = in.onAC; f.battPct = in.battPct;
+        f.tickMs = delay; f.tempC = loop.ThermalReading().tempC; f.thermalLevel = loop.Thermal().Level();
+        f.eco = loop.Qos().GetStats().eco;
+        wchar_t t[128], l[320];
+        FormatTrayTip(f, t, sizeof(t) / sizeof(t[0]));
+        FormatStatusLine(f, l, sizeof(l) / sizeof(l[0]));
+        if (wcscmp(t, tip)) { wcscpy(tip, t); ++updates; }
+        if (wcscmp(l, line)) { wcscpy(line, l); ++updates; }
+    }
+};
+
+struct Rig {
+    uint64_t             now = 0, lastInput = 0;
+    SyntheticCores       src;
+    SyntheticTable       table;
+    SyntheticThermal     thermal;
+    SyntheticEnergy      energy;
+    SyntheticPerf        perf;
+    NullQosControl       qosCtl;
+    CountingPowerBackend power;
+    GovernorLoop         loop;
+    StatusView           view;
+    uint32_t             delay = 1000;
+
+    Rig(size_t cores, uint32_t procs) : src(&now, cores), table(&now, procs), loop(src, table, qosCtl, thermal, power) {
+        GovernorLoopConfig cfg;
+        cfg.processQos = true;
+        loop.SetConfig(cfg);
+        AppRules rules;
+        rules.Parse(L"matlab");
+        loop.SetAppRules(rules);
+        energy.loop = &loop;
+        loop.SetEnergySource(&energy);
+        loop.SetPerfSource(&perf);
+    }
+
+    // One tick plus the status refresh; adds the allocations of each.
+    void Step(uint64_t& tickAllocs, uint64_t& refreshAllocs) {
+        now += delay;
+        const GovernorLoopInputs in = InputsAt(now, lastInput);
+        const uint64_t a0 = g_allocs;
+        delay = loop.Tick(now, in, now);
+        const uint64_t a1 = g_allocs;
+        view.Refresh(loop, in, delay);
+        tickAllocs += a1 - a0;
+        refreshAllocs += g_allocs - a1;
+    }
+};
+
+struct RunReport {
+    double   hours = 0, cpuMs = 0, tickAllocs = 0, refreshAllocs = 0, energyWh = 0, alwaysBoostWh = -1;
+    uint64_t ticks = 0, wakeups = 0, writes = 0, commits = 0, transitions = 0, statusUpdates = 0, memoryCapped = 0;
+};
+
+static RunReport Simulate(size_t cores, uint32_t procs, double hours) {
+    Rig rig(cores, procs);
+    const uint64_t endMs = (uint64_t)(hours * 3'600'000.0);
+    const uint64_t warmupMs = 60'000;    // first scans fill the tables
+    uint64_t ticks = 0, tickAllocs = 0, refreshAllocs = 0, memoryCapped = 0;
+    double cpuMs = 0.0;
+    while (rig.now < endMs) {
+        uint64_t t = 0, r = 0;
+        const double c0 = ThreadCpuMs();
+        rig.Step(t, r);
+        cpuMs += ThreadCpuMs() - c0;
+        if (rig.now < warmupMs) continue;
+        ++ticks;
+        memoryCapped += rig.loop.Gov().MemoryCapped();
+        tickAllocs += t;
+        refreshAllocs += r;
+    }
+
+    RunReport r;
+    r.hours = hours;
+    r.cpuMs = cpuMs;
+    r.ticks = ticks;
+    r.tickAllocs = ticks ? (double)tickAllocs / ticks : 0.0;
+    r.refreshAllocs = ticks ? (double)refreshAllocs / ticks : 0.0;
+    r.wakeups = rig.loop.Scheduler().Wakeups();
+    r.writes = (uint64_t)rig.power.writeCalls;
+    r.commits = rig.loop.GetStats().commits;
+    r.transitions = rig.loop.GetStats().transitions;
+    r.statusUpdates = rig.view.updates;
+    r.memoryCapped = memoryCapped;
+    r.energyWh = rig.loop.Energy().MeteredWh();
+    if (!rig.loop.Energy().AlwaysBoostWh(r.alwaysBoostWh)) r.alwaysBoostWh = -1;
+    return r;
+}
+
+// Each phase held for ten minutes to settle, then ten more measured: a steady-state tick (no
+// process churn, no new foreground app) must not touch the heap, and may only rarely change the
+// status text (each change is a Shell_NotifyIcon call in the tray).
+static const double kMaxSteadyUpdatesPerTick = 0.1;
+
+static bool SteadyState(size_t cores, uint32_t procs) {
+    bool ok = true;
+    printf("steady state (allocations over 10 min after 10 min settling)\n");
+    for (int p = 0; p < 4; ++p) {
+        g_holdPhase = p;
+        Rig rig(cores, procs);
+        uint64_t t = 0, r = 0, ticks = 0;
+        while (rig.now < 600'000) rig.Step(t, r);
+        t = r = 0;
+        rig.view.updates = 0;
+        for (; rig.now < 1'200'000; ++ticks) rig.Step(t, r);
+        printf("  %-8s %6llu ticks  tick %llu  status refresh %llu  status updates %llu\n", kPhaseNames[p],
+            (unsigned long long)ticks, (unsigned long long)t, (unsigned long long)r, (unsigned long long)rig.view.updates);
+        if (t || r) { fprintf(stderr, "steady-state %s ticks allocated\n", kPhaseNames[p]); ok = false; }
+        if (rig.view.updates > ticks * kMaxSteadyUpdatesPerTick) {
+            fprintf(stderr, "steady-state %s sent %.2f status updates per tick > %.2f\n", kPhaseNames[p],
+                (double)rig.view.updates / ticks, kMaxSteadyUpdatesPerTick);
+            ok = false;
+        }
+    }
+    g_holdPhase = -1;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    size_t cores = 16;
+    uint32_t procs = 300, iters = 200'000;
+    double hours = 1.0;
+    bool procfs = false;
+    double maxAllocs = -1, maxCpuMs = -1, maxWakeups = -1;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--cores") && v)                     { cores = (size_t)std::max(1, std::min(1024, atoi(v))); ++i; }
+        else if (!strcmp(a, "--procs") && v)                { procs = (uint32_t)std::max(8, atoi(v)); ++i; }
+        else if (!strcmp(a, "--hours") && v)                { hours = std::max(0.01, atof(v)); ++i; }
+        else if (!strcmp(a, "--iters") && v)                { iters = (uint32_t)std::max(1000, atoi(v)); ++i; }
+        else if (!strcmp(a, "--procfs"))                    procfs = true;
+        else if (!strcmp(a, "--max-allocs-per-tick") && v)  { maxAllocs = atof(v); ++i; }
+        else if (!strcmp(a, "--max-cpu-ms-per-hour") && v)  { maxCpuMs = atof(v); ++i; }
+        else if (!strcmp(a, "--max-wakeups-per-hour") && v) { maxWakeups = atof(v); ++i; }
+        else {
+            fprintf(stderr, "usage: gov_bench [--cores N] [--procs N] [--hours H] [--iters N] [--procfs]\n"
+                            "                 [--max-allocs-per-tick X] [--max-cpu-ms-per-hour X] [--max-wakeups-per-hour X]\n");
+            return 2;
+        }
+    }
+
+    Micro(cores, procs, iters, procfs);
+    const bool steady = SteadyState(cores, procs);
+
+    const RunReport r = Simulate(cores, procs, hours);
+    const double cpuPerHour = r.cpuMs / r.hours, wakeupsPerHour = r.wakeups / r.hours;
+    const double allocsPerTick = r.tickAllocs + r.refreshAllocs;
+    printf("simulated %.2f h (%zu cores, %u processes)\n", r.hours, cores, procs);
+    printf("  governor CPU           %10.1f ms/h\n", cpuPerHour);
+    printf("  wake-ups               %10.0f /h\n", wakeupsPerHour);
+    printf("  allocations            %10.2f /tick (tick %.2f, status refresh %.2f)\n", allocsPerTick, r.tickAllocs, r.refreshAllocs);
+    printf("  power writes           %10.0f /h (%.0f commits)\n", r.writes / r.hours, r.commits / r.hours);
+    printf("  transitions            %10.0f /h\n", r.transitions / r.hours);
+    printf("  status updates sent    %10.0f /h\n", r.statusUpdates / r.hours);
+    printf("  memory-bound cap       %10.1f %% of ticks\n", r.ticks ? 100.0 * r.memoryCapped / r.ticks : 0.0);
+    if (r.alwaysBoostWh > 0)
+        printf("  energy (synthetic)     %10.1f Wh/h (always-Boost estimate %.1f, %.0f%% saved)\n", r.energyWh / r.hours,
+            r.alwaysBoostWh / r.hours, 100.0 * (r.alwaysBoostWh - r.energyWh) / r.alwaysBoostWh);
+
+    int rc = 0;
+    if (!steady) rc = 1;
+    if (maxAllocs >= 0 && allocsPerTick > maxAllocs)   { fprintf(stderr, "over budget: %.2f allocations per tick > %.2f\n", allocsPerTick, maxAllocs); rc = 1; }
+    if (maxCpuMs >= 0 && cpuPerHour > maxCpuMs)         { fprintf(stderr, "over budget: %.1f CPU ms per hour > %.1f\n", cpuPerHour, maxCpuMs); rc = 1; }
+    if (maxWakeups >= 0 && wakeupsPerHour > maxWakeups) { fprintf(stderr, "over budget: %.0f wake-ups per hour > %.0f\n", wakeupsPerHour, maxWakeups); rc = 1; }
+    return rc;
+}
@@ -0,0 +1,224 @@
+// InputBench.cpp
+// Input-to-actuation latency of the governor, polled against input-triggered (InputBoost.h). A
+// virtual clock runs the governor and the tick scheduler through idle gaps long enough for Saver
+// and the scheduler's back-off, each followed by a burst of input: typing, a click, a scroll, a
+// drag, or a nudge of the mouse that the gate should ignore. Polled, the governor sees input only
+// through the idle-seconds counter at its next tick; triggered, the gate ticks it on the event.
+// Latency runs from a burst's first event to the end of the power write that applies Boost.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o input_bench Tools/InputBench/InputBench.cpp AutoPowerManager/InputBoost.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/TickScheduler.cpp AutoPowerManager/SignalFilter.cpp
+//       AutoPowerManager/LatencyHistogram.cpp
+//
+// Usage:
+//   input_bench [--hours H] [--seed N] [--actuate-ms MS] [--debounce-ms MS] [--max-p99-ms MS] [--check]
+//   input_bench --live SECONDS [--dev DIR]
+//
+// --check exits 1 when the triggered p99 is over --max-p99-ms (default 50), when an input-triggered
+// tick boosts on a nudge, or when input ticks more than twice per burst (a drag flooding the
+// actuator). A nudge still resets the idle counter, so the next timer tick may boost on it anyway,
+// as it does without the gate. --live reads evdev (root or the input group) and prints each event's
+// delivery delay and what the gate did with it.
+
+#include "../../AutoPowerManager/InputBoost.h"
+#include "../../AutoPowerManager/LatencyHistogram.h"
+#include "../../AutoPowerManager/TickScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+enum class Burst { Typing, Click, Scroll, Drag, Nudge };
+static const char* BurstName(Burst b) {
+    return b == Burst::Typing ? "typing" : b == Burst::Click ? "click" : b == Burst::Scroll ? "scroll" : b == Burst::Drag ? "drag" : "nudge";
+}
+
+struct InputEvent { uint64_t ms; InputKind kind; uint32_t burst; };
+struct BurstInfo  { uint64_t startMs; Burst kind; };
+
+// Idle gaps of 20 s to 5 min, each followed by one burst.
+static void MakeScript(double hours, unsigned seed, std::vector<InputEvent>& events, std::vector<BurstInfo>& bursts) {
+    std::mt19937 rng(seed);
+    auto uni = [&rng](double a, double b) { return std::uniform_real_distribution<double>(a, b)(rng); };
+    const uint64_t endMs = (uint64_t)(hours * 3.6e6);
+    uint64_t t = 60'000;
+    while (t < endMs) {
+        t += (uint64_t)uni(20'000, 300'000);
+        const Burst kind = (Burst)std::uniform_int_distribution<int>(0, 4)(rng);
+        const uint32_t id = (uint32_t)bursts.size();
+        bursts.push_back({ t, kind });
+        uint64_t at = t;
+        switch (kind) {
+        case Burst::Typing: {
+            const uint64_t end = t + (uint64_t)uni(3'000, 10'000);
+            for (; at < end; at += (uint64_t)uni(70, 230)) events.push_back({ at, InputKind::Key, id });
+            break;
+        }
+        case Burst::Click:  events.push_back({ at, InputKind::Button, id }); break;
+        case Burst::Scroll:
+            for (int i = 0; i < 12; ++i, at += 40) events.push_back({ at, InputKind::Wheel, id });
+            break;
+        case Burst::Drag: {
+            events.push_back({ at, InputKind::Button, id });
+            const uint64_t end = t + (uint64_t)uni(1'000, 3'000);
+            for (at += 8; at < end; at += 8) events.push_back({ at, InputKind::Motion, id });
+            break;
+        }
+        case Burst::Nudge:
+            for (int i = 0; i < 2; ++i, at += 8) events.push_back({ at, InputKind::Motion, id });
+            break;
+        }
+        t = at;
+    }
+}
+
+struct ModeResult {
+    LatencyHistogram latency;             // microseconds, per burst that needed Boost
+    uint32_t missed = 0;                  // a click or scroll the polled idle counter never saw
+    uint32_t nudgeBoosts = 0;             // nudges an input-triggered tick boosted
+    uint64_t ticks = 0, inputTicks = 0;
+};
+
+static ModeResult Run(const std::vector<InputEvent>& events, const std::vector<BurstInfo>& bursts, double hours,
+                      bool triggered, uint32_t actuateMs, const InputBoostConfig& ic) {
+    ModeResult r;
+    Governor gov;
+    TickScheduler sched;
+    InputBoostGate gate;
+    gate.SetConfig(ic);
+    const uint64_t endMs = (uint64_t)(hours * 3.6e6);
+    const uint64_t t0 = 1'000;                       // the clocks are never 0
+    uint64_t nextTick = 0, lastInput = 0;
+    ProcProfile applied = ProcProfile::Balanced;
+    size_t next = 0;
+    int pending = -1;                                // burst waiting for Boost
+
+    auto tick = [&](uint64_t t, bool fromInput) {
+        GovernorSignals s;
+        s.nowMs = t0 + t;
+        s.cpuPct = s.cpuMaxCorePct = s.cpuTopKPct = 4.0;
+        s.idleSec = lastInput ? (uint32_t)((t - lastInput) / 1000) : UINT32_MAX;
+        const ProcProfile p = gov.Tick(s);
+        ++r.ticks;
+        if (fromInput) ++r.inputTicks;
+        if (p == ProcProfile::Boost && applied != ProcProfile::Boost && pending >= 0) {
+            if (bursts[pending].kind == Burst::Nudge) r.nudgeBoosts += fromInput;
+            else r.latency.Record((t - bursts[pending].startMs + actuateMs) * 1000);
+            pending = -1;
+        }
+        applied = p;
+        nextTick = t + sched.OnTick(ObserveTick(gov, s));
+    };
+
+    for (uint64_t t = 0; t < endMs; ++t) {
+        while (next < events.size() && events[next].ms == t) {
+            const InputEvent& e = events[next++];
+            if (e.burst != (uint32_t)pending && t == bursts[e.burst].startMs) {
+                if (pending >= 0 && bursts[pending].kind != Burst::Nudge) ++r.missed;   // never boosted
+                pending = applied == ProcProfile::Boost ? -1 : (int)e.burst;
+            }
+            lastInput = t;
+            if (triggered && gate.OnInput(t0 + t, e.kind, gov.Tier() == ActivityTier::Active)) tick(t, true);
+        }
+        if (t >= nextTick) tick(t, false);
+    }
+    if (pending >= 0 && bursts[pending].kind != Burst::Nudge) ++r.missed;
+    return r;
+}
+
+static int Live(int seconds, const char* dir) {
+#ifndef _WIN32
+    EvdevInputSource src(dir);
+    if (!src.Open()) { fprintf(stderr, "%s: no readable keyboard or pointer (root or the input group)\n", dir); return 1; }
+    printf("%zu device(s), %s timestamps\n", src.Devices(), src.KernelStamps() ? "kernel" : "read-time");
+    InputBoostGate gate;
+    LatencyHistogram delivery;
+    std::vector<EvdevInputSource::Event> events;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        events.clear();
+        if (!src.Wait(250, events) && !src.Devices()) break;
+        const uint64_t nowUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        for (const EvdevInputSource::Event& e : events) {
+            const uint64_t delay = nowUs > e.us ? nowUs - e.us : 0;
+            delivery.Record(delay);
+            const bool trig = gate.OnInput(e.us / 1000, e.kind, false);
+            if (e.kind != InputKind::Motion || trig)
+                printf("%-7s %7.2f ms%s\n", e.kind == InputKind::Key ? "key" : e.kind == InputKind::Button ? "button"
+                       : e.kind == InputKind::Wheel ? "wheel" : "motion", delay / 1000.0, trig ? "  -> tick" : "");
+        }
+    }
+    char line[160];
+    delivery.Summary(line, sizeof(line));
+    const InputBoostGate::Stats& st = gate.GetStats();
+    printf("delivery (event timestamp to read): %s\n%llu events, %llu ticks, %llu debounced\n", line,
+           (unsigned long long)st.events, (unsigned long long)st.triggers, (unsigned long long)st.debounced);
+    return 0;
+#else
+    (void)seconds; (void)dir;
+    fprintf(stderr, "--live reads evdev: Linux only\n");
+    return 2;
+#endif
+}
+
+static int Usage() {
+    fprintf(stderr, "usage: input_bench [--hours H] [--seed N] [--actuate-ms MS] [--debounce-ms MS] [--max-p99-ms MS] [--check]\n"
+                    "       input_bench --live SECONDS [--dev DIR]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    double hours = 8.0, maxP99Ms = 50.0;
+    unsigned seed = 1;
+    uint32_t actuateMs = 3;
+    InputBoostConfig ic;
+    bool check = false;
+    int live = 0;
+    const char* dev = "/dev/input";
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--check"))                    check = true;
+        else if (!strcmp(a, "--hours") && v)          { hours = std::max(0.1, atof(v)); ++i; }
+        else if (!strcmp(a, "--seed") && v)           { seed = (unsigned)atoi(v); ++i; }
+        else if (!strcmp(a, "--actuate-ms") && v)     { actuateMs = (uint32_t)std::max(0, atoi(v)); ++i; }
+        else if (!strcmp(a, "--debounce-ms") && v)    { ic.debounceMs = (uint32_t)std::max(0, atoi(v)); ++i; }
+        else if (!strcmp(a, "--max-p99-ms") && v)     { maxP99Ms = atof(v); ++i; }
+        else if (!strcmp(a, "--live") && v)           { live = std::max(1, atoi(v)); ++i; }
+        else if (!strcmp(a, "--dev") && v)            { dev = v; ++i; }
+        else return Usage();
+    }
+    if (live) return Live(live, dev);
+
+    std::vector<InputEvent> events;
+    std::vector<BurstInfo> bursts;
+    MakeScript(hours, seed, events, bursts);
+    uint32_t perKind[5] = {};
+    for (const BurstInfo& b : bursts) ++perKind[(int)b.kind];
+    printf("%.1f h, %zu bursts (", hours, bursts.size());
+    for (int k = 0; k < 5; ++k) printf("%s%u %s", k ? ", " : "", perKind[k], BurstName((Burst)k));
+    printf("), %zu events, actuation %u ms, debounce %u ms\n\n", events.size(), actuateMs, ic.debounceMs);
+
+    printf("%-10s %6s %9s %9s %9s %9s %7s %7s %9s %9s\n", "mode", "n", "p50", "p90", "p99", "max", "missed",
+           "nudges", "ticks/h", "input/h");
+    bool ok = true;
+    for (int triggered = 0; triggered < 2; ++triggered) {
+        const ModeResult r = Run(events, bursts, hours, triggered != 0, actuateMs, ic);
+        const LatencyHistogram& h = r.latency;
+        printf("%-10s %6llu %6.0f ms %6.0f ms %6.0f ms %6.0f ms %7u %7u %9.0f %9.0f\n", triggered ? "triggered" : "polled",
+               (unsigned long long)h.Count(), h.Percentile(0.50) / 1000.0, h.Percentile(0.90) / 1000.0,
+               h.Percentile(0.99) / 1000.0, h.Max() / 1000.0, r.missed, r.nudgeBoosts, r.ticks / hours, r.inputTicks / hours);
+        if (check && triggered) {
+            if (h.Percentile(0.99) / 1000.0 > maxP99Ms) { printf("  p99 over %.0f ms\n", maxP99Ms); ok = false; }
+            if (r.nudgeBoosts) { printf("  a nudge boosted\n"); ok = false; }
+            if (r.inputTicks > 2 * bursts.size()) { printf("  input ticked more than twice per burst\n"); ok = false; }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// QosBench.cpp
+// Cost of a background scan plus the per-process QoS pass, over synthetic process tables of a few
+// thousand entries (or the live /proc), with a control that records changes instead of making them.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o qos_bench Tools/QosBench/QosBench.cpp AutoPowerManager/ProcessQos.cpp
+//       AutoPowerManager/ProcessScanner.cpp AutoPowerManager/ForegroundTracker.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   qos_bench [--procs N[,N...]] [--busy PCT] [--scans N] [--procfs]
+
+#include "../../AutoPowerManager/ProcessQos.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// N processes with stable PIDs; busyPct of them burn 60% of a core, a few are heavy apps, and a
+// slice of the table exits and is replaced (new PID) every scan.
+struct SyntheticTable : IProcessTableSource {
+    struct Proc { uint32_t pid; uint64_t cpuUs; bool busy; const wchar_t* name; };
+    std::vector<Proc> procs;
+    uint32_t nextPid = 100;
+    uint64_t scanMs = 5000;
+    uint32_t churn = 0;
+
+    SyntheticTable(uint32_t n, uint32_t busyPct) {
+        for (uint32_t i = 0; i < n; ++i)
+            procs.push_back({ nextPid++, 0, i % 100 < busyPct, i % 500 == 0 ? L"matlab.exe" : L"svchost.exe" });
+        churn = std::max<uint32_t>(1, n / 200);
+    }
+
+    bool Scan(IProcessSink& sink) override {
+        for (uint32_t i = 0; i < churn; ++i) {
+            Proc& p = procs[(nextPid * 7919u) % procs.size()];
+            p.pid = nextPid++; p.cpuUs = 0;
+        }
+        for (Proc& p : procs) {
+            p.cpuUs += p.busy ? scanMs * 600 : scanMs * 2;
+            sink.OnProcess(p.pid, p.pid, p.cpuUs, p.name, wcslen(p.name));
+        }
+        return true;
+    }
+};
+
+struct RecordingControl : IProcessQosControl {
+    uint64_t sets = 0, restores = 0;
+    bool Set(uint32_t, uint64_t, QosLevel, QosSaved&) override { ++sets; return true; }
+    bool Restore(uint32_t, uint64_t, QosLevel, const QosSaved&) override { ++restores; return true; }
+};
+
+static void Run(const char* label, IProcessTableSource& src, uint32_t scans, uint64_t scanMs) {
+    RecordingControl ctl;
+    ProcessScanner scanner(src);
+    AppRules rules;
+    rules.Parse(L"matlab");
+    scanner.SetRules(rules);
+    ProcessQosEngine qos(ctl);
+
+    std::vector<double> scanUs, qosUs;
+    for (uint32_t i = 0; i < scans; ++i) {
+        const uint64_t now = (i + 1) * scanMs;
+        auto t0 = Clock::now();
+        scanner.Scan(now);
+        auto t1 = Clock::now();
+        qos.Update(scanner, 0, now);
+        auto t2 = Clock::now();
+        if (i < 2) continue;   // first scans fill the table
+        scanUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        qosUs.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+    }
+    auto median = [](std::vector<double> v) { std::sort(v.begin(), v.end()); return v.empty() ? 0.0 : v[v.size() / 2]; };
+    auto worst = [](const std::vector<double>& v) { return v.empty() ? 0.0 : *std::max_element(v.begin(), v.end()); };
+    const ProcessQosEngine::Stats& st = qos.GetStats();
+    printf("%-14s %7zu procs  scan %8.1f us (max %8.1f)  qos %7.1f us (max %7.1f)  eco %u high %u  sets %llu restores %llu\n",
+        label, scanner.Entries().size(), median(scanUs), worst(scanUs), median(qosUs), worst(qosUs), st.eco, st.high,
+        (unsigned long long)ctl.sets, (unsigned long long)ctl.restores);
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> sizes = { 500, 2000, 5000, 20000 };
+    uint32_t busyPct = 2, scans = 50;
+    bool procfs = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--procs") && v) {
+            sizes.clear();
+            for (const char* p = v; *p;) { sizes.push_back((uint32_t)std::max(1L, strtol(p, nullptr, 10))); p = strchr(p, ','); if (!p) break; ++p; }
+            ++i;
+        }
+        else if (!strcmp(a, "--busy") && v)  { busyPct = (uint32_t)std::min(100, std::max(0, atoi(v))); ++i; }
+        else if (!strcmp(a, "--scans") && v) { scans = (uint32_t)std::max(3, atoi(v)); ++i; }
+        else if (!strcmp(a, "--procfs"))     procfs = true;
+        else { fprintf(stderr, "usage: qos_bench [--procs N[,N...]] [--busy PCT] [--scans N] [--procfs]\n"); return 2; }
+    }
+
+    for (uint32_t n : sizes) {
+        SyntheticTable t(n, busyPct);
+        char label[32];
+        snprintf(label, sizeof(label), "synthetic/%u", n);
+        Run(label, t, scans, t.scanMs);
+    }
+#ifndef _WIN32
+    if (procfs) {
+        ProcfsProcessTableSource live;
+        Run("procfs", live, std::min<uint32_t>(scans, 10), 5000);
+    }
+#else
+    (void)procfs;
+#endif
+    return 0;
+}
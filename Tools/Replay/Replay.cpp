@@ -0,0 +1,115 @@
+// Replay.cpp
+// Trace-driven governor replay and its metrics.
+
+#include "Replay.h"
+
+#include <algorithm>
+
+uint32_t ReplayMetrics::LatencyPercentile(double q) const {
+    if (boostLatencyMs.empty()) return 0;
+    std::vector<uint32_t> v(boostLatencyMs);
+    size_t k = (size_t)(q * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static bool IsDemand(const TraceRow& r, const DemandSpec& d) {
+    if (r.locked || r.display != (uint8_t)DisplayState::On) return false;
+    return r.idleSec < d.inputIdleSec || r.cpuPct >= d.cpuPct || r.topKPct >= d.topKPct || r.fgHeavy || r.bgHeavy;
+}
+
+// Power/session state changes wake the app immediately (KickGovernorTick).
+static bool StateChanged(const TraceRow& a, const TraceRow& b) {
+    return a.onAC != b.onAC || a.display != b.display || a.locked != b.locked;
+}
+
+ReplayMetrics ReplayTrace(const Trace& trace, const GovernorConfig& cfg, const ReplayOptions& opt) {
+    ReplayMetrics m;
+    const auto& rows = trace.rows;
+    if (rows.empty()) return m;
+
+    Governor gov(cfg);
+    TickScheduler sched(opt.sched);
+    ProcProfile applied = ProcProfile::Balanced;
+    bool     pendingInput = false;     // input seen, Boost not reached yet
+    uint64_t inputAtMs = 0;
+
+    std::vector<uint32_t> appKeys;
+    const TierPredictor::Stats predStart = opt.predictor ? opt.predictor->GetStats() : TierPredictor::Stats{};
+    if (opt.predictor)
+        for (auto& a : trace.apps) appKeys.push_back(TierPredictor::AppKey(a));
+
+    // Input onset: idle dropped below the input threshold. Idle is whole seconds, so date the
+    // input at the middle of its second, but never before the previous sample saw no input.
+    auto seeRow = [&](size_t i) {
+        const TraceRow& r = rows[i];
+        if (IsDemand(r, opt.demand) && (i == 0 || !IsDemand(rows[i - 1], opt.demand))) ++m.demandOnsets;
+        if (r.idleSec >= cfg.inputIdleSec || (i > 0 && rows[i - 1].idleSec < cfg.inputIdleSec)) return;
+        uint64_t at = r.tMs - std::min<uint64_t>(r.tMs, r.idleSec * 1000ull + 500);
+        if (i > 0) at = std::max(at, rows[i - 1].tMs);
+        if (applied == ProcProfile::Boost) ++m.inputsWhileBoosted;
+        else if (!pendingInput) { pendingInput = true; inputAtMs = at; }
+    };
+
+    const uint64_t endMs = rows.back().tMs;
+    size_t   row = 0;
+    uint64_t t = rows.front().tMs;
+    seeRow(0);
+
+    for (;;) {
+        while (row + 1 < rows.size() && rows[row + 1].tMs <= t) seeRow(++row);
+        const TraceRow& r = rows[row];
+
+        GovernorSignals sig = trace.Signals(r);
+        sig.nowMs = t;
+        sig.idleSec = r.idleSec + (uint32_t)((t - r.tMs) / 1000);
+        int minute = (int)((opt.startMinute + t / 60'000) % 1440);
+        if (opt.predictor) sig.predictActive = sig.onAC && opt.predictor->PredictActive(appKeys[r.app], minute);
+        ProcProfile p = gov.Tick(sig);
+        ++m.ticks;
+        if (opt.predictor)
+            opt.predictor->Observe(t, minute, appKeys[r.app], gov.OrganicTier(), sig.predictActive,
+                sig.predictActive && gov.OrganicTier() != ActivityTier::Active);
+
+        if (p != applied) { ++m.switches; applied = p; }
+        if (pendingInput && p == ProcProfile::Boost) {
+            m.boostLatencyMs.push_back((uint32_t)(t - inputAtMs));
+            pendingInput = false;
+        }
+
+        uint64_t next;
+        if (opt.mode == TickMode::EveryRow) next = row + 1 < rows.size() ? rows[row + 1].tMs : endMs + 1;
+        else if (opt.mode == TickMode::Fixed) next = t + std::max<uint32_t>(1, opt.fixedMs);
+        else {
+            next = t + sched.OnTick(ObserveTick(gov, sig));
+            for (size_t k = row + 1; k < rows.size() && rows[k].tMs < next; ++k)
+                if (StateChanged(rows[k - 1], rows[k])) { next = rows[k].tMs + sched.Kick(rows[k].tMs); break; }
+        }
+        next = std::max(next, t + 1);
+
+        m.msInProfile[(int)applied] += std::min(next, endMs) - std::min(t, endMs);
+        // Demand and energy row by row: an adaptive interval can span many rows.
+        for (size_t k = row; k < rows.size() && rows[k].tMs < std::min(next, endMs); ++k) {
+            const uint64_t a = std::max(t, rows[k].tMs), b = std::min(next, k + 1 < rows.size() ? rows[k + 1].tMs : endMs);
+            if (b <= a) continue;
+            const TraceRow& rk = rows[k];
+            m.energyMs += (b - a) * opt.profileFactor[(int)applied] * (opt.idleShare + (1.0 - opt.idleShare) * rk.cpuPct / 100.0);
+            if (!IsDemand(rk, opt.demand)) continue;
+            m.demandMs += b - a;
+            if (applied != ProcProfile::Boost) m.demandWaitMs += b - a;
+        }
+        if (next > endMs) break;
+        t = next;
+    }
+    m.durationMs = trace.DurationMs();
+    if (opt.predictor) {
+        const TierPredictor::Stats& e = opt.predictor->GetStats();
+        m.prediction.epochs = e.epochs - predStart.epochs;
+        m.prediction.predicted = e.predicted - predStart.predicted;
+        m.prediction.hits = e.hits - predStart.hits;
+        m.prediction.missed = e.missed - predStart.missed;
+        m.prediction.liftedMs = e.liftedMs - predStart.liftedMs;
+        m.prediction.wastedMs = e.wastedMs - predStart.wastedMs;
+    }
+    return m;
+}
@@ -0,0 +1,62 @@
+// Replay.h
+// Runs the Governor over a Trace as fast as possible and scores the result.
+
+#pragma once
+
+#include "Trace.h"
+#include "../../AutoPowerManager/TickScheduler.h"
+#include "../../AutoPowerManager/Predictor.h"
+
+#include <cstdint>
+#include <vector>
+
+// When the simulated governor wakes up.
+enum class TickMode {
+    EveryRow,   // one tick per trace row (the recording's own cadence)
+    Fixed,      // every fixedMs, sampling the latest row
+    Adaptive,   // TickScheduler, kicked by power/session changes like the app
+};
+
+// Fixed demand thresholds, the same for every config replayed, so configs can be compared on how
+// long demand waited for Boost. The defaults are GovernorConfig's.
+struct DemandSpec {
+    uint32_t inputIdleSec = 2;             // input this recent
+    double   cpuPct = 40.0;                // or raw aggregate load at or above this
+    double   topKPct = 75.0;               // or raw top-k load at or above this (a heavy app always counts)
+};
+
+struct ReplayOptions {
+    TickMode            mode = TickMode::EveryRow;
+    uint32_t            fixedMs = 1000;
+    TickSchedulerConfig sched;
+    TierPredictor*      predictor = nullptr;   // learns online and pre-boosts (on AC) when set
+    int                 startMinute = 8 * 60;  // wall-clock minute of day at the trace's t = 0
+    DemandSpec          demand;                // unlocked, display on, and one of these
+    // Energy proxy: power relative to Balanced at the same load (the battery estimator's priors),
+    // with idleShare of full-load power drawn at 0% CPU.
+    double              profileFactor[3] = { 1.35, 1.0, 0.75 };
+    double              idleShare = 0.3;
+};
+
+struct ReplayMetrics {
+    uint64_t ticks = 0;                    // governor wake-ups
+    uint64_t durationMs = 0;
+    uint64_t switches = 0;                 // profile changes
+    uint64_t msInProfile[3] = { 0,0,0 };   // indexed by ProcProfile
+    std::vector<uint32_t> boostLatencyMs;  // input onset -> Boost, for onsets outside Boost
+    uint64_t inputsWhileBoosted = 0;
+    TierPredictor::Stats prediction;       // this replay only, when a predictor was given
+    uint64_t demandOnsets = 0;             // rows where demand starts (the same for every config)
+    uint64_t demandMs = 0;
+    uint64_t demandWaitMs = 0;             // demand time spent outside Boost
+    double   energyMs = 0.0;               // relative power x ms
+
+    double SwitchesPerHour() const { return durationMs ? switches * 3600'000.0 / durationMs : 0.0; }
+    double WakeupsPerHour() const { return durationMs ? ticks * 3600'000.0 / durationMs : 0.0; }
+    double ProfileShare(ProcProfile p) const { return durationMs ? msInProfile[(int)p] / (double)durationMs : 0.0; }
+    double DemandWaitSec() const { return demandOnsets ? demandWaitMs / 1000.0 / demandOnsets : 0.0; }   // per onset
+    double RelativePower() const { return durationMs ? energyMs / durationMs : 0.0; }   // 1.0: Balanced at full load
+    uint32_t LatencyPercentile(double q) const;   // 0..1; sorts a copy
+};
+
+ReplayMetrics ReplayTrace(const Trace& trace, const GovernorConfig& cfg, const ReplayOptions& opt = ReplayOptions());
@@ -0,0 +1,236 @@
+// Trace.cpp
+// CSV trace load/save, app-rule resolution and a deterministic synthetic workload.
+
+#include "Trace.h"
+#include "../../AutoPowerManager/AppRules.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+GovernorSignals Trace::Signals(const TraceRow& r) const {
+    GovernorSignals s;
+    s.nowMs = r.tMs;
+    s.cpuPct = r.cpuPct;
+    s.cpuMaxCorePct = r.maxCorePct;
+    s.cpuTopKPct = r.topKPct;
+    s.idleSec = r.idleSec;
+    s.onAC = r.onAC != 0;
+    s.battPct = r.battPct;
+    s.display = (DisplayState)r.display;
+    s.sessionLocked = r.locked != 0;
+    s.fgHeavy = r.fgHeavy != 0;
+    s.fgPinned = r.fgPinned != 0;
+    s.fgProfile = (ProcProfile)r.fgProfile;
+    s.bgHeavy = r.bgHeavy != 0;
+    s.bgBusy = r.bgBusy != 0;
+    return s;
+}
+
+std::string NormalizeExeName(const std::string& pathOrName) {
+    size_t p = pathOrName.find_last_of("\\/");
+    std::string s = (p == std::string::npos) ? pathOrName : pathOrName.substr(p + 1);
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (s.size() > 4 && s.compare(s.size() - 4, 4, ".exe") == 0) s.resize(s.size() - 4);
+    return s;
+}
+
+// ---------- Load / save ----------
+static uint16_t InternApp(Trace& t, std::unordered_map<std::string, uint16_t>& index, const std::string& name) {
+    auto it = index.find(name);
+    if (it != index.end()) return it->second;
+    uint16_t id = (uint16_t)t.apps.size();
+    t.apps.push_back(name);
+    index.emplace(name, id);
+    return id;
+}
+
+namespace {
+enum Col { C_T, C_CPU, C_IDLE, C_AC, C_BATT, C_DISP, C_LOCK, C_MAXCORE, C_TOPK, C_BGHEAVY, C_BGBUSY, C_EXE, C_COUNT };
+const char* kColNames[C_COUNT] = { "t_ms", "cpu_pct", "idle_s", "ac", "batt_pct", "display", "locked", "max_core_pct", "topk_pct", "bg_heavy", "bg_busy", "fg_exe" };
+
+// Header "a,b,c" -> column ids (-1 for unknown columns, which are skipped).
+std::vector<int> ParseHeader(const char* p) {
+    std::vector<int> cols;
+    std::string name;
+    for (;; ++p) {
+        if (*p == ',' || *p == 0 || *p == '\n' || *p == '\r') {
+            while (!name.empty() && name.back() == ' ') name.pop_back();
+            int id = -1;
+            for (int c = 0; c < C_COUNT; ++c) if (name == kColNames[c]) id = c;
+            cols.push_back(id);
+            name.clear();
+            if (*p != ',') break;
+        }
+        else if (*p != ' ' || !name.empty()) name += *p;
+    }
+    return cols;
+}
+}
+
+bool LoadTrace(const char* path, Trace& out, std::string& err) {
+    FILE* f = fopen(path, "r");
+    if (!f) { err = std::string("cannot open ") + path; return false; }
+    out = Trace();
+    std::unordered_map<std::string, uint16_t> index;
+    InternApp(out, index, "");
+
+    std::vector<int> cols = { C_T, C_CPU, C_IDLE, C_AC, C_BATT, C_DISP, C_LOCK, C_EXE };
+    char line[1024];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        char* p = line;
+        while (*p == ' ' || *p == '\t' || *p == '#') ++p;
+        if (*p == '\n' || *p == '\r' || *p == 0) continue;
+        if (!isdigit((unsigned char)*p)) {          // header or comment
+            if (!strncmp(p, "t_ms", 4)) cols = ParseHeader(p);
+            continue;
+        }
+
+        double v[C_COUNT] = { 0, 0, 0, 1, 100, 1, 0, -1, -1, 0, 0, 0 };
+        std::string exe;
+        size_t got = 0;
+        for (size_t c = 0; c < cols.size() && *p; ++c) {
+            if (cols[c] == C_EXE) { exe = p; break; }
+            char* end = p;
+            double x = strtod(p, &end);
+            if (end == p) break;
+            if (cols[c] >= 0) v[cols[c]] = x;
+            ++got;
+            p = end;
+            if (*p == ',') ++p; else break;
+        }
+        if (got < 3) {
+            err = std::string(path) + ":" + std::to_string(lineNo) + ": malformed row";
+            fclose(f); return false;
+        }
+        while (!exe.empty() && (exe.back() == '\n' || exe.back() == '\r' || exe.back() == ' ')) exe.pop_back();
+
+        TraceRow r{};
+        r.tMs = (uint64_t)v[C_T];
+        r.cpuPct = (float)std::min(100.0, std::max(0.0, v[C_CPU]));
+        r.maxCorePct = v[C_MAXCORE] < 0 ? r.cpuPct : (float)std::min(100.0, v[C_MAXCORE]);
+        r.topKPct = v[C_TOPK] < 0 ? r.cpuPct : (float)std::min(100.0, v[C_TOPK]);
+        r.idleSec = (uint32_t)v[C_IDLE];
+        r.battPct = (int16_t)v[C_BATT];
+        r.app = InternApp(out, index, NormalizeExeName(exe));
+        r.onAC = v[C_AC] != 0 ? 1 : 0;
+        r.display = (uint8_t)std::min(2.0, std::max(0.0, v[C_DISP]));
+        r.locked = v[C_LOCK] != 0 ? 1 : 0;
+        r.bgHeavy = v[C_BGHEAVY] != 0 ? 1 : 0;
+        r.bgBusy = v[C_BGBUSY] != 0 ? 1 : 0;
+        if (!out.rows.empty() && r.tMs < out.rows.back().tMs) {
+            err = std::string(path) + ":" + std::to_string(lineNo) + ": timestamps go backwards";
+            fclose(f); return false;
+        }
+        out.rows.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+bool SaveTrace(const char* path, const Trace& t) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# t_ms,cpu_pct,idle_s,ac,batt_pct,display,locked,max_core_pct,topk_pct,bg_heavy,bg_busy,fg_exe\n");
+    for (auto& r : t.rows)
+        fprintf(f, "%llu,%.1f,%u,%d,%d,%d,%d,%.1f,%.1f,%d,%d,%s\n", (unsigned long long)r.tMs, r.cpuPct, r.idleSec,
+            r.onAC, r.battPct, r.display, r.locked, r.maxCorePct, r.topKPct, r.bgHeavy, r.bgBusy, t.apps[r.app].c_str());
+    return fclose(f) == 0;
+}
+
+void ResolveAppRules(Trace& t, const AppRules& rules) {
+    std::vector<AppMatch> match(t.apps.size());
+    for (size_t i = 0; i < t.apps.size(); ++i)
+        if (!t.apps[i].empty()) match[i] = rules.Match(std::wstring(t.apps[i].begin(), t.apps[i].end()), std::wstring());
+    for (auto& r : t.rows) {
+        GovernorSignals s;
+        SetForegroundRule(s, rules.Rule(match[r.app], r.onAC != 0));
+        r.fgHeavy = s.fgHeavy;
+        r.fgPinned = s.fgPinned;
+        r.fgProfile = (uint8_t)s.fgProfile;
+    }
+}
+
+// ---------- Synthetic workload ----------
+namespace {
+struct Rng {
+    uint32_t s;
+    uint32_t Next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    double   Unit() { return (Next() & 0xFFFFFF) / double(0x1000000); }
+    double   Range(double lo, double hi) { return lo + (hi - lo) * Unit(); }
+};
+
+enum class Phase { Typing, Reading, Build, Solver, Away };
+}
+
+Trace SynthesizeTrace(double hours, uint32_t seed, uint32_t periodMs) {
+    Trace t;
+    t.apps = { "", "code", "chrome", "matlab", "msbuild" };
+    Rng rng{ seed ? seed : 0x9E3779B9u };
+
+    const uint64_t endMs = (uint64_t)(hours * 3600'000.0);
+    uint64_t lastInputMs = 0, phaseEndMs = 0;
+    Phase phase = Phase::Typing;
+    double batt = 100.0;
+    bool onAC = true;
+    t.rows.reserve((size_t)(endMs / periodMs) + 1);
+
+    for (uint64_t now = 0; now <= endMs; now += periodMs) {
+        if (now >= phaseEndMs) {
+            double r = rng.Unit();
+            phase = r < 0.35 ? Phase::Typing : r < 0.60 ? Phase::Reading : r < 0.75 ? Phase::Build : r < 0.85 ? Phase::Solver : Phase::Away;
+            double minutes = phase == Phase::Away ? rng.Range(5, 45) : phase == Phase::Solver ? rng.Range(5, 30) : rng.Range(1, 12);
+            phaseEndMs = now + (uint64_t)(minutes * 60'000.0);
+        }
+        // Unplugged for the third and fourth hour of every eight.
+        double hourOfShift = std::fmod(now / 3600'000.0, 8.0);
+        onAC = !(hourOfShift >= 2.0 && hourOfShift < 4.0);
+        batt = onAC ? std::min(100.0, batt + periodMs * (40.0 / 3600'000.0)) : std::max(0.0, batt - periodMs * (18.0 / 3600'000.0));
+
+        // Lunch break four hours into every day (12:00 if the trace starts at 08:00); a scheduled
+        // background job runs from 12:06 to 12:18 -- the regular spike the predictor should learn.
+        double hourOfDay = std::fmod(now / 3600'000.0, 24.0);
+        bool lunch = hourOfDay >= 4.0 && hourOfDay < 4.75;
+        bool scheduled = hourOfDay >= 4.1 && hourOfDay < 4.3;
+
+        double cpu = 2.0; uint16_t app = 1;
+        if (lunch) { phase = Phase::Away; phaseEndMs = std::max(phaseEndMs, now + periodMs); }
+        switch (phase) {
+        case Phase::Typing:  cpu = rng.Range(4, 25);  app = 1; if (rng.Unit() < 0.6) lastInputMs = now; break;
+        case Phase::Reading: cpu = rng.Range(2, 12);  app = 2; if (rng.Unit() < 0.05) lastInputMs = now; break;
+        case Phase::Build:   cpu = rng.Range(55, 100); app = 4; if (rng.Unit() < 0.02) lastInputMs = now; break;
+        case Phase::Solver:  cpu = rng.Range(70, 100); app = rng.Unit() < 0.7 ? 3 : 2; if (rng.Unit() < 0.03) lastInputMs = now; break;
+        case Phase::Away:    cpu = rng.Range(0, 4);   app = 2; break;
+        }
+        if (rng.Unit() < 0.01) cpu = std::min(100.0, cpu + rng.Range(30, 70)); // background spike
+        if (scheduled) cpu = std::max(cpu, rng.Range(60, 100));
+
+        // 16 logical processors: builds spread out, solver phases are often one pinned thread.
+        double maxCore = std::min(100.0, cpu * rng.Range(1.0, 2.5)), topK = maxCore * rng.Range(0.7, 1.0);
+        if (phase == Phase::Solver && app == 3) { maxCore = rng.Range(95, 100); topK = rng.Range(55, 75); cpu = maxCore / 16 + rng.Range(1, 4); }
+
+        uint32_t idle = (uint32_t)((now - lastInputMs) / 1000);
+        TraceRow r{};
+        r.tMs = now;
+        r.cpuPct = (float)cpu;
+        r.maxCorePct = (float)maxCore;
+        r.topKPct = (float)topK;
+        r.idleSec = idle;
+        r.battPct = (int16_t)batt;
+        r.app = app;
+        r.onAC = onAC ? 1 : 0;
+        r.display = idle > 600 ? 0 : 1;
+        r.locked = idle > 900 ? 1 : 0;
+        // The process scanner sees solves whether or not they own the foreground; builds trip the busy share.
+        r.bgHeavy = phase == Phase::Solver ? 1 : 0;
+        r.bgBusy = phase == Phase::Build || scheduled ? 1 : 0;
+        t.rows.push_back(r);
+    }
+    return t;
+}
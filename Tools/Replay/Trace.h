@@ -0,0 +1,59 @@
+// Trace.h
+// Recorded activity traces for offline governor replay.
+//
+// CSV, one row per sample, '#' starts a comment. A header row (optionally '#'-prefixed) names
+// the columns; without one the default order below is assumed. fg_exe, if present, is last.
+//   t_ms,cpu_pct,idle_s,ac,batt_pct,display,locked,max_core_pct,topk_pct,bg_heavy,bg_busy,fg_exe
+//   t_ms     monotonic milliseconds        display  0=Off 1=On 2=Dimmed
+//   ac       1=AC 0=battery                locked   1=session locked
+//   max_core_pct / topk_pct   per-core load (default: cpu_pct)
+//   bg_heavy / bg_busy        process-scanner verdicts as recorded (default 0)
+//   fg_exe   foreground image name or path (may be empty)
+
+#pragma once
+
+#include "../../AutoPowerManager/Governor.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class AppRules;
+
+struct TraceRow {
+    uint64_t tMs;
+    float    cpuPct;
+    float    maxCorePct;
+    float    topKPct;
+    uint32_t idleSec;
+    int16_t  battPct;
+    uint16_t app;          // index into Trace::apps
+    uint8_t  onAC;
+    uint8_t  display;
+    uint8_t  locked;
+    uint8_t  fgHeavy;      // resolved against the app rules at load time, for the row's power source
+    uint8_t  fgPinned;     // a Balanced/Saver rule: fgProfile
+    uint8_t  fgProfile;
+    uint8_t  bgHeavy;      // recorded, not re-resolved
+    uint8_t  bgBusy;
+};
+
+struct Trace {
+    std::vector<TraceRow>    rows;
+    std::vector<std::string> apps;   // interned, normalized exe names
+
+    uint64_t DurationMs() const { return rows.size() < 2 ? 0 : rows.back().tMs - rows.front().tMs; }
+    GovernorSignals Signals(const TraceRow& r) const;
+};
+
+// "C:\\Tools\\MATLAB.exe" -> "matlab"
+std::string NormalizeExeName(const std::string& pathOrName);
+
+bool LoadTrace(const char* path, Trace& out, std::string& err);
+bool SaveTrace(const char* path, const Trace& t);
+
+// Recompute the foreground rule fields of every row. Apps are matched by name: traces keep no paths.
+void ResolveAppRules(Trace& t, const AppRules& rules);
+
+// Deterministic synthetic workday (typing bursts, solver runs, idle gaps, lunch lock) at periodMs.
+Trace SynthesizeTrace(double hours, uint32_t seed, uint32_t periodMs = 1000);
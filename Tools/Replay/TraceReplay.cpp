@@ -0,0 +1,160 @@
+// TraceReplay.cpp
+// Command-line governor replayer: runs recorded (or synthetic) traces through the Governor
+// with no OS dependencies and reports switching rate, profile residency and boost latency.
+// With --predict, the pre-boost predictor learns online and is scored (hit rate, wasted boost).
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o trace_replay Tools/Replay/*.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp AutoPowerManager/TickScheduler.cpp
+//       AutoPowerManager/Predictor.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   trace_replay <trace.csv | --synth HOURS> [--heavy a,b,c | --rules FILE] [--sticky S]
+//                [--resbal S] [--ressaver S] [--batt PCT] [--active PCT] [--engaged PCT] [--repeat N]
+//                [--tick row|fixed:MS|adaptive] [--synth-period MS] [--save-synth FILE]
+//                [--predict] [--model FILE] [--start-hour H]
+//                [--cpu-filter SPEC] [--idle-filter SPEC] [--batt-filter SPEC] [--cpu-hyst PCT]
+
+#include "Replay.h"
+#include "../../AutoPowerManager/AppRules.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// "a,b,c" -> one Boost rule per name, as the old heavy list.
+static std::wstring SplitList(const char* s) {
+    std::wstring out;
+    for (const char* p = s; *p; ++p) out += *p == ',' ? L'\n' : (wchar_t)(unsigned char)*p;
+    return out;
+}
+
+static bool ReadRules(const char* path, std::wstring& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    out.clear();
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;)
+        for (size_t i = 0; i < n; ++i) out += (wchar_t)(unsigned char)buf[i];   // rules are ASCII
+    fclose(f);
+    return true;
+}
+
+static int Usage() {
+    fprintf(stderr,
+        "usage: trace_replay <trace.csv | --synth HOURS> [--heavy a,b,c | --rules FILE] [--sticky S]\n"
+        "                    [--resbal S] [--ressaver S] [--batt PCT] [--active PCT] [--engaged PCT] [--repeat N]\n"
+        "                    [--tick row|fixed:MS|adaptive] [--synth-period MS] [--save-synth FILE]\n"
+        "                    [--predict] [--model FILE] [--start-hour H]\n"
+        "                    [--cpu-filter SPEC] [--idle-filter SPEC] [--batt-filter SPEC] [--cpu-hyst PCT]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    GovernorConfig cfg;
+    std::wstring ruleText = L"comsol\nmatlab\nvivado\nansys";   // the tray's default rules
+    const char* tracePath = nullptr;
+    const char* savePath = nullptr;
+    double synthHours = 0;
+    uint32_t synthPeriodMs = 1000;
+    int repeat = 1;
+    ReplayOptions opt;
+    bool predict = false;
+    const char* modelPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto take = [&]() { if (!v) { fprintf(stderr, "%s needs a value\n", a); exit(Usage()); } ++i; return v; };
+        if      (!strcmp(a, "--synth"))      synthHours = atof(take());
+        else if (!strcmp(a, "--heavy"))      ruleText = SplitList(take());
+        else if (!strcmp(a, "--rules")) {
+            const char* path = take();
+            if (!ReadRules(path, ruleText)) { fprintf(stderr, "cannot read %s\n", path); return 1; }
+        }
+        else if (!strcmp(a, "--sticky"))     cfg.stickyBoostMs = (uint32_t)(atof(take()) * 1000);
+        else if (!strcmp(a, "--resbal"))     cfg.residencyBalancedMs = (uint32_t)(atof(take()) * 1000);
+        else if (!strcmp(a, "--ressaver"))   cfg.residencySaverMs = (uint32_t)(atof(take()) * 1000);
+        else if (!strcmp(a, "--batt"))       cfg.battThreshold = atoi(take());
+        else if (!strcmp(a, "--active"))     cfg.activeCpuPct = atof(take());
+        else if (!strcmp(a, "--engaged"))    cfg.engagedCpuPct = atof(take());
+        else if (!strcmp(a, "--repeat"))     repeat = std::max(1, atoi(take()));
+        else if (!strcmp(a, "--synth-period")) synthPeriodMs = (uint32_t)std::max(10, atoi(take()));
+        else if (!strcmp(a, "--tick")) {
+            const char* m = take();
+            if (!strcmp(m, "row")) opt.mode = TickMode::EveryRow;
+            else if (!strcmp(m, "adaptive")) opt.mode = TickMode::Adaptive;
+            else if (!strncmp(m, "fixed:", 6)) { opt.mode = TickMode::Fixed; opt.fixedMs = (uint32_t)std::max(1, atoi(m + 6)); }
+            else return Usage();
+        }
+        else if (!strcmp(a, "--save-synth")) savePath = take();
+        else if (!strcmp(a, "--predict"))    predict = true;
+        else if (!strcmp(a, "--model"))      { modelPath = take(); predict = true; }
+        else if (!strcmp(a, "--start-hour")) opt.startMinute = (int)(atof(take()) * 60) % 1440;
+        else if (!strcmp(a, "--cpu-hyst"))   cfg.cpuHysteresisPct = atof(take());
+        else if (!strcmp(a, "--cpu-filter") || !strcmp(a, "--idle-filter") || !strcmp(a, "--batt-filter")) {
+            FilterSpec& spec = a[2] == 'c' ? cfg.cpuFilter : a[2] == 'i' ? cfg.idleFilter : cfg.battFilter;
+            const char* text = take();
+            if (!ParseFilterSpec(text, spec)) { fprintf(stderr, "bad filter spec: %s\n", text); return Usage(); }
+        }
+        else if (a[0] == '-')                return Usage();
+        else                                 tracePath = a;
+    }
+    if (!tracePath && synthHours <= 0) return Usage();
+
+    Trace trace;
+    if (tracePath) {
+        std::string err;
+        if (!LoadTrace(tracePath, trace, err)) { fprintf(stderr, "%s\n", err.c_str()); return 1; }
+    }
+    else {
+        trace = SynthesizeTrace(synthHours, 1, synthPeriodMs);
+        if (savePath && !SaveTrace(savePath, trace)) { fprintf(stderr, "cannot write %s\n", savePath); return 1; }
+    }
+    AppRules rules;
+    if (int bad = rules.Parse(ruleText)) fprintf(stderr, "%d malformed app rule line(s) skipped\n", bad);
+    ResolveAppRules(trace, rules);
+    if (trace.rows.empty()) { fprintf(stderr, "empty trace\n"); return 1; }
+
+    // --model: warm-start from (and save back to) a model file, as the app does across runs.
+    TierPredictor predictor;
+    if (predict) {
+        opt.predictor = &predictor;
+        if (modelPath) if (FILE* f = fopen(modelPath, "rb")) {
+            if (!predictor.Load(f)) fprintf(stderr, "%s: not a predictor model, starting empty\n", modelPath);
+            fclose(f);
+        }
+    }
+
+    ReplayMetrics m;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) m = ReplayTrace(trace, cfg, opt);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printf("trace            %s (%zu rows, %.2f h)\n", tracePath ? tracePath : "synthetic", trace.rows.size(), m.durationMs / 3600'000.0);
+    printf("wake-ups/hour    %.0f\n", m.WakeupsPerHour());
+    printf("switches/hour    %.1f (%llu total)\n", m.SwitchesPerHour(), (unsigned long long)m.switches);
+    for (ProcProfile p : { ProcProfile::Boost, ProcProfile::Balanced, ProcProfile::Saver })
+        printf("time %-11s %5.1f%%\n", ProfileNameA(p), 100.0 * m.ProfileShare(p));
+    printf("demand wait      %.2f s per onset (%llu onsets, %.1f%% of %.1f min unboosted)\n", m.DemandWaitSec(),
+        (unsigned long long)m.demandOnsets, m.demandMs ? 100.0 * m.demandWaitMs / m.demandMs : 0.0, m.demandMs / 60'000.0);
+    printf("relative power   %.3f (1.0: Balanced at full load)\n", m.RelativePower());
+    printf("boost latency    n=%zu p50=%ums p95=%ums max=%ums (%llu inputs already boosted)\n", m.boostLatencyMs.size(),
+        m.LatencyPercentile(0.50), m.LatencyPercentile(0.95), m.LatencyPercentile(1.0), (unsigned long long)m.inputsWhileBoosted);
+    if (predict) {
+        const TierPredictor::Stats& ps = m.prediction;
+        printf("prediction       %llu epochs, %llu pre-boosted: %.1f%% hit, %llu spikes missed\n", (unsigned long long)ps.epochs,
+            (unsigned long long)ps.predicted, ps.predicted ? 100.0 * ps.hits / ps.predicted : 0.0, (unsigned long long)ps.missed);
+        printf("pre-boost time   %.1f min lifted, %.1f min wasted\n", ps.liftedMs / 60'000.0, ps.wastedMs / 60'000.0);
+        if (modelPath) {
+            FILE* f = fopen(modelPath, "wb");
+            if (!f || !predictor.Save(f)) fprintf(stderr, "cannot write %s\n", modelPath);
+            if (f) fclose(f);
+        }
+    }
+    printf("replay speed     %.2f Mticks/s\n", secs > 0 ? (double)m.ticks * repeat / secs / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,189 @@
+// RuleBench.cpp
+// Checks and times the per-app rule matcher (AppRules.h). --expect cases check which rule a process
+// gets; the benchmark times one lookup against rule sets of growing size, next to the linear
+// name loop the matcher replaced.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o rule_bench Tools/RuleBench/RuleBench.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   rule_bench [--rules FILE] [--expect NAME[:PATH]=PROFILE|none ...] [--dc] [--sizes N[,N...]]
+//              [--lookups N] [--max-growth X]
+//
+// PROFILE is boost, balanced or saver. The exit status is 1 when an --expect case gets another
+// result, or when a lookup against the largest rule set costs more than --max-growth times one
+// against a single rule.
+
+#include "../../AutoPowerManager/AppRules.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::wstring Widen(const std::string& s) { return std::wstring(s.begin(), s.end()); }   // ASCII
+
+static bool ReadFile(const char* path, std::wstring& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    out.clear();
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) out += Widen(std::string(buf, n));
+    fclose(f);
+    return true;
+}
+
+static const char* ProfileOf(const AppRule* r) {
+    if (!r) return "none";
+    switch (r->profile) {
+    case ProcProfile::Boost:    return "boost";
+    case ProcProfile::Balanced: return "balanced";
+    case ProcProfile::Saver:    return "saver";
+    }
+    return "?";
+}
+
+// "name[:path]=profile". The path may hold ':' (a drive letter), so split at the first one only.
+static bool RunExpect(const AppRules& rules, const std::string& c, bool onAC) {
+    const size_t eq = c.rfind('=');
+    if (eq == std::string::npos) { fprintf(stderr, "bad --expect: %s\n", c.c_str()); return false; }
+    const std::string proc = c.substr(0, eq), want = c.substr(eq + 1);
+    const size_t colon = proc.find(':');
+    const std::string name = proc.substr(0, colon), path = colon == std::string::npos ? "" : proc.substr(colon + 1);
+    const AppMatch m = rules.Match(Widen(name), Widen(path));
+    const AppRule* r = rules.Rule(m, onAC);
+    const char* got = ProfileOf(r);
+    const bool ok = want == got;
+    printf("%-4s %-40s %-9s", ok ? "ok" : "FAIL", proc.c_str(), got);
+    if (r) printf(" rule %d: %ls", m.Rule(onAC), r->pattern.c_str());
+    if (!ok) printf("  (want %s)", want.c_str());
+    printf("\n");
+    return ok;
+}
+
+// n rules: half plain names, a quarter name globs, a quarter folder rules; queried by a mix of hits on
+// each kind and misses.
+static void Synthesize(size_t n, std::wstring& text, std::vector<std::wstring>& names) {
+    text.clear();
+    names.clear();
+    for (size_t i = 0; i < n; ++i) {
+        const std::wstring id = std::to_wstring(i);
+        switch (i % 4) {
+        case 0: case 1: text += L"app" + id + L"\n"; break;
+        case 2:         text += L"tool" + id + L"* balanced max=70\n"; break;
+        case 3:         text += L"c:\\vendor" + id + L"\\ saver ac\n"; break;
+        }
+    }
+    for (size_t i = 0; i < 64; ++i) {
+        const std::wstring id = std::to_wstring(i * 7919 % std::max<size_t>(n, 1));
+        switch (i % 4) {
+        case 0: names.push_back(L"app" + id); break;
+        case 1: names.push_back(L"tool" + id + L"_x64"); break;
+        case 2: names.push_back(L"c:\\vendor" + id + L"\\bin\\main.exe"); break;
+        case 3: names.push_back(L"notepad" + id); break;
+        }
+    }
+}
+
+struct Timing { double ruleNs; double linearNs; size_t dfaStates; };
+
+static Timing TimeLookups(size_t n, uint32_t lookups) {
+    std::wstring text;
+    std::vector<std::wstring> queries;
+    Synthesize(n, text, queries);
+    AppRules rules;
+    rules.Parse(text);
+    std::vector<std::wstring> linear;                 // the old heavy list: exact names only
+    for (size_t i = 0; i < rules.Size(); ++i) linear.push_back(rules[i].pattern);
+
+    uint64_t sink = 0;
+    for (const std::wstring& q : queries) sink += rules.Match(q, q).Rule(true) + 1;   // warm the DFA
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        const std::wstring& q = queries[i & 63];
+        const bool path = q.find(L'\\') != std::wstring::npos;
+        sink += rules.Match(path ? std::wstring() : q, path ? q : std::wstring()).Rule(true) + 1;
+    }
+    auto t1 = Clock::now();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        const std::wstring& q = queries[i & 63];
+        for (const std::wstring& l : linear) if (q == l) { ++sink; break; }
+    }
+    auto t2 = Clock::now();
+    if (sink == 1) printf("\n");                       // keep the loops
+    Timing t;
+    t.ruleNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / lookups;
+    t.linearNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / lookups;
+    t.dfaStates = rules.NameGlobs().DfaStates() + rules.PathGlobs().DfaStates();
+    return t;
+}
+
+static int Usage() {
+    fprintf(stderr,
+        "usage: rule_bench [--rules FILE] [--expect NAME[:PATH]=PROFILE|none ...] [--dc] [--sizes N[,N...]]\n"
+        "                  [--lookups N] [--max-growth X]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* rulesPath = nullptr;
+    std::vector<std::string> expects;
+    std::vector<size_t> sizes = { 1, 10, 100, 1000 };
+    uint32_t lookups = 1'000'000;
+    double maxGrowth = 0.0;
+    bool onAC = true;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto take = [&]() { if (!v) { fprintf(stderr, "%s needs a value\n", a); exit(Usage()); } ++i; return v; };
+        if      (!strcmp(a, "--rules"))      rulesPath = take();
+        else if (!strcmp(a, "--expect"))     expects.push_back(take());
+        else if (!strcmp(a, "--dc"))         onAC = false;
+        else if (!strcmp(a, "--lookups"))    lookups = (uint32_t)std::max(64, atoi(take()));
+        else if (!strcmp(a, "--max-growth")) maxGrowth = atof(take());
+        else if (!strcmp(a, "--sizes")) {
+            sizes.clear();
+            for (const char* p = take(); *p;) {
+                char* e = nullptr;
+                const long n = strtol(p, &e, 10);
+                if (e == p || n < 1) return Usage();
+                sizes.push_back((size_t)n);
+                p = *e == ',' ? e + 1 : e;
+            }
+        }
+        else return Usage();
+    }
+
+    bool ok = true;
+    if (rulesPath || !expects.empty()) {
+        std::wstring text = L"comsol\nmatlab\nvivado\nansys";   // the tray's default rules
+        if (rulesPath && !ReadFile(rulesPath, text)) { fprintf(stderr, "cannot read %s\n", rulesPath); return 1; }
+        AppRules rules;
+        const int bad = rules.Parse(text);
+        printf("%zu rules, %d malformed line(s) skipped, %zu name globs, %zu path globs (%s)\n", rules.Size(), bad,
+               rules.NameGlobs().Patterns(), rules.PathGlobs().Patterns(), onAC ? "AC" : "DC");
+        if (bad) ok = false;
+        for (const std::string& c : expects) ok = RunExpect(rules, c, onAC) && ok;
+        if (expects.empty()) return ok ? 0 : 1;
+        printf("\n");
+    }
+
+    printf("%8s %12s %12s %10s\n", "rules", "match ns", "linear ns", "dfa states");
+    double first = 0.0, last = 0.0;
+    for (size_t n : sizes) {
+        const Timing t = TimeLookups(n, lookups);
+        printf("%8zu %12.1f %12.1f %10zu\n", n, t.ruleNs, t.linearNs, t.dfaStates);
+        if (first == 0.0) first = t.ruleNs;
+        last = t.ruleNs;
+    }
+    if (maxGrowth > 0.0 && first > 0.0 && last > maxGrowth * first) {
+        printf("lookup cost grew %.1fx (limit %.1fx)\n", last / first, maxGrowth);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
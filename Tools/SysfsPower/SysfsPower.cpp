@@ -0,0 +1,204 @@
+// SysfsPower.cpp
+// Runs one ladder level through PowerSettingsWriter and the sysfs backend against a copy of a fake
+// /sys tree (Tools/SysfsPower/fixtures), prints every file the transaction wrote, then repeats the
+// transaction to show what a retry writes. The fixture itself is never modified.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o sysfs_power Tools/SysfsPower/SysfsPower.cpp AutoPowerManager/SysfsPower.cpp
+//       AutoPowerManager/PowerWriter.cpp AutoPowerManager/LatencyHistogram.cpp AutoPowerManager/CpuTopology.cpp
+//
+// Usage:
+//   sysfs_power FIXTURE [--level NAME] [--dc] [--park-offline] [--read-only FILE ...]
+//               [--expect FILE=VALUE ...] [--expect-failure]
+//
+// FILE is relative to FIXTURE; NAME is a default ladder level (Boost .. Saver; default Balanced).
+// --read-only makes FILE refuse writes, as a read-only sysfs attribute does. With any --expect the
+// written files must be exactly those given, with those values; --expect-failure expects the commit
+// to fail. Either way the retry must write nothing after a good commit, and only the refused files
+// after a failed one. The exit status is 1 on a mismatch.
+
+#include "../../AutoPowerManager/CpuTopology.h"
+#include "../../AutoPowerManager/PowerWriter.h"
+#include "../../AutoPowerManager/ProfileLadder.h"
+#include "../../AutoPowerManager/SysfsPower.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool CopyFile(const std::string& from, const std::string& to) {
+    FILE* in = fopen(from.c_str(), "rb");
+    if (!in) return false;
+    FILE* out = fopen(to.c_str(), "wb");
+    bool ok = out != nullptr;
+    char buf[4096];
+    size_t n;
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0) ok = fwrite(buf, 1, n, out) == n;
+    fclose(in);
+    if (out) ok = fclose(out) == 0 && ok;
+    return ok;
+}
+
+// Copies the tree with every file's modification time at the epoch, so any later mtime is a write.
+static bool CopyTree(const std::string& from, const std::string& to) {
+    DIR* d = opendir(from.c_str());
+    if (!d) return false;
+    bool ok = true;
+    while (dirent* de = readdir(d)) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+        const std::string src = from + "/" + de->d_name, dst = to + "/" + de->d_name;
+        struct stat st;
+        if (lstat(src.c_str(), &st) != 0) { ok = false; continue; }
+        if (S_ISDIR(st.st_mode)) ok = mkdir(dst.c_str(), 0755) == 0 && CopyTree(src, dst) && ok;
+        else if (S_ISREG(st.st_mode)) {
+            const struct timespec epoch[2] = { { 0, 0 }, { 0, 0 } };
+            ok = CopyFile(src, dst) && utimensat(AT_FDCWD, dst.c_str(), epoch, 0) == 0 && ok;
+        }
+    }
+    closedir(d);
+    return ok;
+}
+
+static void RemoveTree(const std::string& dir) {
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* de = readdir(d)) {
+            if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+            const std::string p = dir + "/" + de->d_name;
+            struct stat st;
+            if (lstat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) RemoveTree(p);
+            else unlink(p.c_str());
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
+// Regular files modified since the copy, relative to root, with their first line.
+static void Written(const std::string& root, const std::string& rel, std::map<std::string, std::string>& out) {
+    DIR* d = opendir((rel.empty() ? root : root + "/" + rel).c_str());
+    if (!d) return;
+    while (dirent* de = readdir(d)) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
+        const std::string r = rel.empty() ? de->d_name : rel + "/" + de->d_name;
+        const std::string p = root + "/" + r;
+        struct stat st;
+        if (lstat(p.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) { Written(root, r, out); continue; }
+        if (!S_ISREG(st.st_mode) || (st.st_mtim.tv_sec == 0 && st.st_mtim.tv_nsec == 0)) continue;
+        char line[256] = "";
+        if (FILE* f = fopen(p.c_str(), "r")) {
+            if (!fgets(line, sizeof(line), f)) line[0] = 0;
+            fclose(f);
+        }
+        line[strcspn(line, "\n")] = 0;
+        out[r] = line;
+    }
+    closedir(d);
+}
+
+// Root ignores mode bits, so for root the file becomes a link to /dev/full, where every write fails.
+static bool MakeReadOnly(const std::string& path) {
+    if (geteuid() != 0) return chmod(path.c_str(), 0444) == 0;
+    return unlink(path.c_str()) == 0 && symlink("/dev/full", path.c_str()) == 0;
+}
+
+static LadderSetpoint FromLevel(const ProfileLevel& l) {
+    LadderSetpoint sp;
+    sp.minAC = l.minAC; sp.minDC = l.minDC; sp.maxAC = l.maxAC; sp.maxDC = l.maxDC;
+    sp.boostAC = l.boostAC; sp.boostDC = l.boostDC; sp.parkAC = l.parkAC; sp.parkDC = l.parkDC;
+    sp.pMinAC = l.pMinAC; sp.pMinDC = l.pMinDC; sp.pMaxAC = l.pMaxAC; sp.pMaxDC = l.pMaxDC;
+    sp.eMinAC = l.eMinAC; sp.eMinDC = l.eMinDC; sp.eMaxAC = l.eMaxAC; sp.eMaxDC = l.eMaxDC;
+    return sp;
+}
+
+int main(int argc, char** argv) {
+    std::string fixture, levelName = "Balanced";
+    bool dc = false, parkOffline = false, expectFailure = false;
+    std::vector<std::string> readOnly;
+    std::map<std::string, std::string> expects;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--level") && i + 1 < argc) levelName = argv[++i];
+        else if (!strcmp(argv[i], "--dc")) dc = true;
+        else if (!strcmp(argv[i], "--park-offline")) parkOffline = true;
+        else if (!strcmp(argv[i], "--read-only") && i + 1 < argc) readOnly.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "--expect") && i + 1 < argc) {
+            const char* eq = strchr(argv[++i], '=');
+            if (!eq) { fprintf(stderr, "bad --expect %s\n", argv[i]); return 2; }
+            expects[std::string(argv[i], (size_t)(eq - argv[i]))] = eq + 1;
+        }
+        else if (!strcmp(argv[i], "--expect-failure")) expectFailure = true;
+        else if (argv[i][0] != '-' && fixture.empty()) fixture = argv[i];
+        else {
+            fprintf(stderr, "usage: sysfs_power FIXTURE [--level NAME] [--dc] [--park-offline] [--read-only FILE ...]\n"
+                            "                   [--expect FILE=VALUE ...] [--expect-failure]\n");
+            return 2;
+        }
+    }
+    if (fixture.empty()) { fprintf(stderr, "sysfs_power: no fixture\n"); return 2; }
+    const ProfileLevel* level = nullptr;
+    for (const ProfileLevel& l : kDefaultLadder) if (!strcasecmp(l.name, levelName.c_str())) level = &l;
+    if (!level) { fprintf(stderr, "sysfs_power: no level %s\n", levelName.c_str()); return 2; }
+
+    char tmp[] = "/tmp/sysfs_power.XXXXXX";
+    if (!mkdtemp(tmp)) { perror("mkdtemp"); return 1; }
+    const std::string root = tmp;
+    if (!CopyTree(fixture, root)) { fprintf(stderr, "%s: can't copy the tree\n", fixture.c_str()); RemoveTree(root); return 1; }
+    for (const std::string& f : readOnly)
+        if (!MakeReadOnly(root + "/" + f)) { fprintf(stderr, "%s: can't make it read-only\n", f.c_str()); RemoveTree(root); return 1; }
+
+    SysfsPowerConfig cfg;
+    cfg.root = root;
+    cfg.parkOffline = parkOffline;
+    SysfsPowerBackend be(cfg);
+    be.SetOnAC(!dc);
+    CpuTopology topo;
+    const bool hybrid = ReadSysfsCpuTopology(root, topo) && topo.Hybrid();
+    if (hybrid) be.SetTopology(topo);
+    PowerSettingsWriter w(be);
+    const LadderSetpoint sp = FromLevel(*level);
+
+    w.Begin();
+    StageLadderSetpoint(w, sp, hybrid);
+    w.Commit();
+    const bool failed = w.Failures() != 0;
+    std::map<std::string, std::string> written;
+    Written(root, "", written);
+
+    // The same setpoint again: the writer re-stages after a failure, the backend skips what stuck.
+    const uint64_t before = be.FileWrites();
+    w.Begin();
+    StageLadderSetpoint(w, sp, hybrid);
+    w.Commit();
+    const uint64_t retried = be.FileWrites() - before;
+
+    printf("driver:  %s, %zu cpus%s\n", be.Driver().empty() ? "none" : be.Driver().c_str(), be.Cpus(), hybrid ? ", hybrid" : "");
+    printf("level:   %s (%s)\n", level->name, dc ? "DC" : "AC");
+    printf("commit:  %s, %zu files written\n", failed ? "failed" : "ok", written.size());
+    for (const auto& kv : written) printf("  %s = %s\n", kv.first.c_str(), kv.second.c_str());
+    printf("retry:   %llu file writes\n", (unsigned long long)retried);
+
+    int bad = 0;
+    if (failed != expectFailure) { printf("MISMATCH commit %s\n", failed ? "failed" : "succeeded"); ++bad; }
+    if (!expects.empty()) {
+        for (const auto& kv : expects) {
+            auto it = written.find(kv.first);
+            if (it == written.end()) { printf("MISMATCH %s not written, want %s\n", kv.first.c_str(), kv.second.c_str()); ++bad; }
+            else if (it->second != kv.second) { printf("MISMATCH %s = %s, want %s\n", kv.first.c_str(), it->second.c_str(), kv.second.c_str()); ++bad; }
+        }
+        for (const auto& kv : written)
+            if (!expects.count(kv.first)) { printf("MISMATCH %s written, not expected\n", kv.first.c_str()); ++bad; }
+    }
+    const uint64_t wantRetried = failed ? readOnly.size() : 0;
+    if (retried != wantRetried) { printf("MISMATCH retry wrote %llu files, want %llu\n", (unsigned long long)retried, (unsigned long long)wantRetried); ++bad; }
+
+    RemoveTree(root);
+    return bad ? 1 : 0;
+}
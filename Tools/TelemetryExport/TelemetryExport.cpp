@@ -0,0 +1,167 @@
+// TelemetryExport.cpp
+// Dumps the app's telemetry ring (telemetry.bin) as CSV, JSON lines, or a replay trace, and
+// benchmarks the per-tick append path.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o telemetry_export Tools/TelemetryExport/TelemetryExport.cpp
+//       AutoPowerManager/Telemetry.cpp AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp
+//
+// Usage:
+//   telemetry_export <telemetry.bin> [--csv | --json | --trace] [--last N] [--transitions]
+//   telemetry_export --bench [N]
+//
+// --trace writes the Tools/Replay CSV format (fg_exe and topk_pct are not recorded), so a
+// "sluggish at 14:02" report can be replayed against a retuned governor.
+
+#include "../../AutoPowerManager/Telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+enum class Format { Csv, Json, Trace };
+
+static int Usage() {
+    fprintf(stderr,
+        "usage: telemetry_export <telemetry.bin> [--csv | --json | --trace] [--last N] [--transitions]\n"
+        "       telemetry_export --bench [N]\n");
+    return 2;
+}
+
+static void FormatWall(uint64_t wallMs, char* buf, size_t n) {
+    time_t t = (time_t)(wallMs / 1000);
+    struct tm lt{};
+#ifdef _WIN32
+    localtime_s(&lt, &t);
+#else
+    localtime_r(&t, &lt);
+#endif
+    size_t k = strftime(buf, n, "%Y-%m-%d %H:%M:%S", &lt);
+    snprintf(buf + k, n - k, ".%03u", (unsigned)(wallMs % 1000));
+}
+
+static void Export(const std::vector<TelemetryRecord>& recs, Format fmt) {
+    char wall[40];
+    if (fmt == Format::Csv)
+        printf("wall,t_ms,kind,cpu_pct,cpu_ewma,max_core_pct,max_core_ewma,idle_s,ac,batt_pct,display,locked,"
+               "fg_heavy,bg_heavy,bg_busy,predicted,tier,tier_reason,profile,profile_reason,prev_profile,pinned,"
+               "governor_profile,next_tick_ms,temp_c,thermal_level\n");
+    if (fmt == Format::Trace)
+        printf("# t_ms,cpu_pct,idle_s,ac,batt_pct,display,locked,max_core_pct,bg_heavy,bg_busy\n");
+
+    for (const TelemetryRecord& r : recs) {
+        const int display = (r.flags & TF_DisplayOff) ? 0 : (r.flags & TF_DisplayDimmed) ? 2 : 1;
+        const int ac = (r.flags & TF_AC) ? 1 : 0;
+        const int locked = (r.flags & TF_Locked) ? 1 : 0;
+        const int bgHeavy = (r.flags & TF_BgHeavy) ? 1 : 0;
+        const int bgBusy = (r.flags & TF_BgBusy) ? 1 : 0;
+        if (fmt == Format::Trace) {
+            printf("%llu,%.2f,%u,%d,%d,%d,%d,%.2f,%d,%d\n", (unsigned long long)r.monoMs, r.cpuRaw / 100.0, r.idleSec,
+                ac, r.battPct, display, locked, r.coreRaw / 100.0, bgHeavy, bgBusy);
+            continue;
+        }
+        FormatWall(r.wallMs, wall, sizeof(wall));
+        const char* kind = RecordKind(r) == TelemetryKind::Transition ? "transition" : "tick";
+        const char* tier = TierNameA((ActivityTier)r.tier);
+        const char* tierWhy = TierReasonNameA((TierReason)r.tierReason);
+        const char* prof = ProfileNameA((ProcProfile)r.profile);
+        const char* profWhy = ProfileReasonNameA((ProfileReason)r.profileReason);
+        const char* prev = ProfileNameA((ProcProfile)r.prevProfile);
+        const bool pinned = RecordPinned(r);
+        const char* govProf = ProfileNameA(RecordGovernorProfile(r));
+        if (fmt == Format::Csv) {
+            printf("%s,%llu,%s,%.2f,%.2f,%.2f,%.2f,%u,%d,%d,%d,%d,%d,%d,%d,%d,%s,%s,%s,%s,%s,%d,%s,%u,%u,%u\n",
+                wall, (unsigned long long)r.monoMs, kind, r.cpuRaw / 100.0, r.cpuSmooth / 100.0, r.coreRaw / 100.0,
+                r.coreSmooth / 100.0, r.idleSec, ac, r.battPct, display, locked, (r.flags & TF_FgHeavy) ? 1 : 0,
+                bgHeavy, bgBusy, (r.flags & TF_Predicted) ? 1 : 0, tier, tierWhy, prof, profWhy, prev, pinned ? 1 : 0,
+                govProf, r.nextTickMs, r.tempC, r.thermalLevel);
+        } else {
+            printf("{\"wall\":\"%s\",\"t_ms\":%llu,\"kind\":\"%s\",\"cpu_pct\":%.2f,\"cpu_ewma\":%.2f,"
+                   "\"max_core_pct\":%.2f,\"max_core_ewma\":%.2f,\"idle_s\":%u,\"ac\":%s,\"batt_pct\":%d,"
+                   "\"display\":%d,\"locked\":%s,\"fg_heavy\":%s,\"bg_heavy\":%s,\"bg_busy\":%s,\"predicted\":%s,"
+                   "\"tier\":\"%s\",\"tier_reason\":\"%s\",\"profile\":\"%s\",\"profile_reason\":\"%s\","
+                   "\"prev_profile\":\"%s\",\"pinned\":%s,\"governor_profile\":\"%s\",\"next_tick_ms\":%u,\"temp_c\":%u,\"thermal_level\":%u}\n",
+                wall, (unsigned long long)r.monoMs, kind, r.cpuRaw / 100.0, r.cpuSmooth / 100.0, r.coreRaw / 100.0,
+                r.coreSmooth / 100.0, r.idleSec, ac ? "true" : "false", r.battPct, display, locked ? "true" : "false",
+                (r.flags & TF_FgHeavy) ? "true" : "false", bgHeavy ? "true" : "false", bgBusy ? "true" : "false",
+                (r.flags & TF_Predicted) ? "true" : "false", tier, tierWhy, prof, profWhy, prev,
+                pinned ? "true" : "false", govProf, r.nextTickMs, r.tempC, r.thermalLevel);
+        }
+    }
+}
+
+// Times what the app does per tick: pack a record from the governor, append it to a mapped ring.
+static int Bench(uint32_t n) {
+    std::string path = "telemetry_bench.bin";
+    TelemetryRing ring;
+#ifdef _WIN32
+    std::wstring wpath(path.begin(), path.end());
+    if (!ring.Open(wpath.c_str(), 65536)) { fprintf(stderr, "cannot map %s\n", path.c_str()); return 1; }
+#else
+    if (!ring.Open(path.c_str(), 65536)) { fprintf(stderr, "cannot map %s\n", path.c_str()); return 1; }
+#endif
+    Governor gov;
+    GovernorSignals s;
+    std::vector<TelemetryRecord> pre(1024);
+    for (size_t i = 0; i < pre.size(); ++i) {
+        s.nowMs = i * 1000; s.cpuPct = (double)(i * 37 % 100); s.cpuMaxCorePct = s.cpuPct; s.idleSec = (uint32_t)(i % 60);
+        gov.Tick(s);
+        pre[i] = MakeTelemetryRecord(gov, s, gov.Profile(), ProcProfile::Balanced, false, 1'700'000'000'000ull + i * 1000, 1000);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < n; ++i) ring.Append(pre[i & 1023]);
+    auto t1 = Clock::now();
+    for (uint32_t i = 0; i < n; ++i) {
+        s.nowMs = (uint64_t)i * 1000;
+        ring.Append(MakeTelemetryRecord(gov, s, gov.Profile(), ProcProfile::Balanced, false, 1'700'000'000'000ull + i, 1000));
+    }
+    auto t2 = Clock::now();
+
+    const double appendNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    const double packNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+    printf("records:        %u x %zu B, ring %u (%.1f MB mapped)\n", n, sizeof(TelemetryRecord), ring.Capacity(),
+        (sizeof(TelemetryHeader) + (double)ring.Capacity() * sizeof(TelemetryRecord)) / 1e6);
+    printf("append:         %.1f ns/record\n", appendNs);
+    printf("pack + append:  %.1f ns/record\n", packNs);
+    ring.Close();
+    remove(path.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    Format fmt = Format::Csv;
+    size_t last = 0;
+    bool transitionsOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if      (!strcmp(a, "--bench"))       return Bench(v && *v != '-' ? (uint32_t)std::max(1, atoi(v)) : 10'000'000u);
+        else if (!strcmp(a, "--csv"))         fmt = Format::Csv;
+        else if (!strcmp(a, "--json"))        fmt = Format::Json;
+        else if (!strcmp(a, "--trace"))       fmt = Format::Trace;
+        else if (!strcmp(a, "--transitions")) transitionsOnly = true;
+        else if (!strcmp(a, "--last"))        { if (!v) return Usage(); last = (size_t)std::max(0, atoi(v)); ++i; }
+        else if (a[0] == '-')                 return Usage();
+        else                                  path = a;
+    }
+    if (!path) return Usage();
+
+    std::vector<TelemetryRecord> recs;
+    std::string err;
+    if (!ReadTelemetryFile(path, recs, err)) { fprintf(stderr, "%s\n", err.c_str()); return 1; }
+    if (transitionsOnly && fmt != Format::Trace)
+        recs.erase(std::remove_if(recs.begin(), recs.end(),
+            [](const TelemetryRecord& r) { return RecordKind(r) != TelemetryKind::Transition; }), recs.end());
+    if (last && recs.size() > last) recs.erase(recs.begin(), recs.end() - last);
+    Export(recs, fmt);
+    return 0;
+}
@@ -0,0 +1,45 @@
+// AppRulesTest.cpp
+// AppRules::Parse comment handling: a '#' at the start of a line or after a blank starts a comment,
+// one inside a word or inside a quoted pattern does not, and an unterminated quote is malformed.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o app_rules_test Tools/Tests/AppRulesTest.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   app_rules_test             (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/AppRules.h"
+#include "Check.h"
+
+#include <string>
+
+static std::wstring Pattern(const AppRules& rules, size_t i) {
+    return i < rules.Size() ? rules[i].pattern : L"";
+}
+
+int main() {
+    AppRules rules;
+    CHECK_EQ(rules.Parse(L"# whole-line comment\n"
+                         L"\"C:\\My #Tools\\\" boost ac   # quoted '#' is part of the path\n"
+                         L"matlab # trailing comment\n"
+                         L"foo#bar  # '#' inside a word is not a comment\n"
+                         L"teams balanced max=70#not a comment either\n"), 1);
+    CHECK_EQ(rules.Size(), 3);
+    CHECK(Pattern(rules, 0) == L"c:\\my #tools\\*");
+    CHECK(rules.Size() && rules[0].when == kRuleOnAC);
+    CHECK(Pattern(rules, 1) == L"matlab");
+    CHECK(Pattern(rules, 2) == L"foo#bar");
+
+    // The quoted folder matches what is below it, on AC only.
+    const AppMatch m = rules.Match(L"build", L"C:\\My #Tools\\bin\\build.exe");
+    CHECK(m.Heavy(true));
+    CHECK(!m.Heavy(false));
+    CHECK_EQ(rules.Match(L"build", L"C:\\My\\bin\\build.exe").Rule(true), -1);
+
+    // An unterminated quote is malformed, a '#' after it included.
+    CHECK_EQ(rules.Parse(L"\"C:\\Games # boost\nnotepad"), 1);
+    CHECK_EQ(rules.Size(), 1);
+    CHECK(Pattern(rules, 0) == L"notepad");
+
+    return CheckSummary();
+}
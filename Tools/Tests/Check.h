@@ -0,0 +1,23 @@
+// Check.h
+// The checks every test under Tools/Tests uses: a failing check prints its file and line and the
+// test goes on, and main returns CheckSummary() so the exit status is 1 if any check failed.
+
+#pragma once
+
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); ++failures; } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    const long long a_ = (long long)(actual), e_ = (long long)(expected); \
+    if (a_ != e_) { printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); ++failures; } \
+} while (0)
+
+static int CheckSummary() {
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+// ForegroundTrackerTest.cpp
+// ForegroundTracker with a fake process inspector and a fake event source (direct
+// OnForegroundChanged calls): cache hits make no image lookups, a reused PID with a new creation
+// time is looked up again, new rules reclassify cached entries without lookups, and the least
+// recently used entry is the one evicted.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o foreground_tracker_test Tools/Tests/ForegroundTrackerTest.cpp
+//       AutoPowerManager/ForegroundTracker.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   foreground_tracker_test    (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/ForegroundTracker.h"
+#include "Check.h"
+
+#include <map>
+
+// A process table the test edits; counts the lookups the tracker makes.
+struct FakeInspector : IProcessInspector {
+    struct Proc { uint64_t created; std::wstring path; };
+    std::map<uint32_t, Proc> procs;
+    int timeCalls = 0, pathCalls = 0;
+
+    bool CreationTime(uint32_t pid, uint64_t& t) override {
+        ++timeCalls;
+        auto it = procs.find(pid);
+        if (it == procs.end()) return false;
+        t = it->second.created;
+        return true;
+    }
+    bool ImagePath(uint32_t pid, std::wstring& path) override {
+        ++pathCalls;
+        auto it = procs.find(pid);
+        if (it == procs.end()) return false;
+        path = it->second.path;
+        return true;
+    }
+};
+
+static bool Heavy(const ForegroundTracker& t) {
+    const AppRule* r = t.ForegroundRule(true);
+    return r && r->Heavy();
+}
+
+int main() {
+    FakeInspector os;
+    os.procs[100] = { 1, L"C:\\Program Files\\MATLAB\\bin\\MATLAB.exe" };
+    os.procs[200] = { 2, L"C:\\Windows\\notepad.exe" };
+    AppRules rules;
+    rules.Parse(L"matlab\nnotepad balanced max=70");
+    ForegroundTracker t(os, 3);
+    t.SetRules(rules);
+
+    // First sight: one creation-time and one image lookup, classified from the rules.
+    t.OnForegroundChanged(100);
+    CHECK(t.ForegroundName() == L"matlab");
+    CHECK(Heavy(t));
+    CHECK_EQ(os.pathCalls, 1);
+    t.OnForegroundChanged(200);
+    CHECK(!Heavy(t));
+    CHECK(t.ForegroundRule(true) && t.ForegroundRule(true)->maxProcPct == 70);
+
+    // Back to a cached process: creation time only (PID-reuse guard), no image lookup.
+    t.OnForegroundChanged(100);
+    CHECK(Heavy(t));
+    CHECK_EQ(os.pathCalls, 2);
+    CHECK_EQ(t.GetStats().hits, 1);
+    CHECK_EQ(os.timeCalls, 3);
+
+    // PID reuse: 100 exits and an unrelated process gets its PID with a later creation time.
+    os.procs[100] = { 3, L"C:\\Windows\\explorer.exe" };
+    t.OnForegroundChanged(100);
+    CHECK(t.ForegroundName() == L"explorer");
+    CHECK(t.ForegroundRule(true) == nullptr);
+    CHECK_EQ(os.pathCalls, 3);
+    CHECK_EQ(t.GetStats().misses, 3);
+
+    // New rules reclassify what is cached, foreground included, without any lookup.
+    const int timeBefore = os.timeCalls, pathBefore = os.pathCalls;
+    rules.Parse(L"explorer boost\nnotepad");
+    t.SetRules(rules);
+    CHECK(Heavy(t));
+    CHECK_EQ(os.timeCalls, timeBefore);
+    CHECK_EQ(os.pathCalls, pathBefore);
+    t.OnForegroundChanged(200);
+    CHECK(Heavy(t));
+    CHECK_EQ(os.pathCalls, pathBefore);
+
+    // Capacity 3, full. The least recently used entry goes first: the dead MATLAB, then explorer
+    // (100), so the next focus on 100 is a miss again while notepad (200) stays a hit.
+    os.procs[300] = { 4, L"/usr/bin/Vivado" };
+    os.procs[400] = { 5, L"C:\\Tools\\ansys.exe" };
+    t.OnForegroundChanged(300);
+    CHECK(t.ForegroundName() == L"vivado");
+    CHECK_EQ(os.pathCalls, pathBefore + 1);
+    t.OnForegroundChanged(200);
+    t.OnForegroundChanged(400);
+    t.OnForegroundChanged(200);
+    CHECK_EQ(os.pathCalls, pathBefore + 2);
+    t.OnForegroundChanged(100);
+    CHECK_EQ(os.pathCalls, pathBefore + 3);
+    CHECK(Heavy(t));
+
+    // A process that is gone (or protected) clears the foreground instead of keeping the last one.
+    t.OnForegroundChanged(999);
+    CHECK_EQ(t.ForegroundPid(), 0);
+    CHECK(t.ForegroundRule(true) == nullptr);
+    CHECK_EQ(t.GetStats().lookupFailures, 1);
+    t.OnForegroundChanged(0);
+    CHECK(t.ForegroundName().empty());
+
+    return CheckSummary();
+}
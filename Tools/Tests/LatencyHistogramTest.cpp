@@ -0,0 +1,124 @@
+// LatencyHistogramTest.cpp
+// LatencyHistogram on known distributions: bucket edges and widths, the clamped top bucket, exact
+// percentiles (each the top of the bucket holding the target sample, clamped to min/max), merge and
+// the summary line.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o latency_histogram_test Tools/Tests/LatencyHistogramTest.cpp
+//       AutoPowerManager/LatencyHistogram.cpp
+//
+// Usage:
+//   latency_histogram_test     (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/LatencyHistogram.h"
+#include "Check.h"
+
+#include <cstring>
+#include <initializer_list>
+
+using H = LatencyHistogram;
+
+static void Buckets() {
+    // Below 2^kSubBits every value has its own bucket.
+    for (uint64_t v = 0; v < 32; ++v) {
+        CHECK_EQ(H::IndexOf(v), v);
+        CHECK_EQ(H::LowestEquivalent(v), v);
+        CHECK_EQ(H::HighestEquivalent(v), v);
+    }
+    // Then 16 buckets per power of two, each twice as wide as in the one before.
+    CHECK_EQ(H::IndexOf(32), 32);
+    CHECK_EQ(H::IndexOf(33), 32);
+    CHECK_EQ(H::IndexOf(34), 33);
+    CHECK_EQ(H::IndexOf(63), 47);
+    CHECK_EQ(H::IndexOf(64), 48);
+    CHECK_EQ(H::LowestEquivalent(48), 64);
+    CHECK_EQ(H::HighestEquivalent(48), 67);
+    CHECK_EQ(H::IndexOf(1'000'000), 270);          // 2^19 <= v < 2^20: width 2^15
+    CHECK_EQ(H::LowestEquivalent(270), 983'040);
+    CHECK_EQ(H::HighestEquivalent(270), 1'015'807);
+
+    // Buckets tile the range with no gap or overlap, and none is wider than 1/16 of its low edge.
+    for (size_t i = 0; i + 1 < H::kCounts; ++i) {
+        CHECK_EQ(H::HighestEquivalent(i) + 1, H::LowestEquivalent(i + 1));
+        CHECK_EQ(H::IndexOf(H::LowestEquivalent(i)), i);
+        CHECK_EQ(H::IndexOf(H::HighestEquivalent(i)), i);
+        if (i >= 32) CHECK(H::HighestEquivalent(i) - H::LowestEquivalent(i) + 1 <= H::LowestEquivalent(i) / 16);
+    }
+
+    // Overflow: everything from MaxTrackable() up shares the last bucket.
+    CHECK_EQ(H::MaxTrackable(), (1ull << 36) - 1);
+    CHECK_EQ(H::IndexOf(H::MaxTrackable()), H::kCounts - 1);
+    CHECK_EQ(H::IndexOf(H::MaxTrackable() + 1), H::kCounts - 1);
+    CHECK_EQ(H::IndexOf(UINT64_MAX), H::kCounts - 1);
+    CHECK_EQ(H::HighestEquivalent(H::kCounts - 1), H::MaxTrackable());
+}
+
+static void Percentiles() {
+    H empty;
+    CHECK_EQ(empty.Count(), 0);
+    CHECK_EQ(empty.Min(), 0);
+    CHECK_EQ(empty.Percentile(0.99), 0);
+
+    // Small values are exact.
+    H small;
+    for (uint64_t v : { 7, 7, 7, 3, 20 }) small.Record(v);
+    CHECK_EQ(small.Percentile(0.0), 3);
+    CHECK_EQ(small.Percentile(0.5), 7);
+    CHECK_EQ(small.Percentile(1.0), 20);
+
+    // 1..1000 us once each: the p-th sample is p*10, reported as the top of its bucket.
+    H uniform;
+    for (uint64_t v = 1; v <= 1000; ++v) uniform.Record(v);
+    CHECK_EQ(uniform.Count(), 1000);
+    CHECK_EQ(uniform.Min(), 1);
+    CHECK_EQ(uniform.Max(), 1000);
+    CHECK(uniform.Mean() == 500.5);
+    CHECK_EQ(uniform.Percentile(0.50), 511);      // 500 is in [496, 511]
+    CHECK_EQ(uniform.Percentile(0.90), 927);      // 900 in [896, 927]
+    CHECK_EQ(uniform.Percentile(0.95), 959);      // 950 in [928, 959]
+    CHECK_EQ(uniform.Percentile(0.99), 991);      // 990 in [960, 991]
+    CHECK_EQ(uniform.Percentile(1.0), 1000);      // 1000 in [992, 1023], clamped to the max
+
+    // Bimodal: 90 fast writes and 10 stalls.
+    H bimodal;
+    for (int i = 0; i < 90; ++i) bimodal.Record(100);
+    for (int i = 0; i < 10; ++i) bimodal.Record(10'000);
+    CHECK_EQ(bimodal.Percentile(0.50), 103);      // [100, 103]
+    CHECK_EQ(bimodal.Percentile(0.90), 103);
+    CHECK_EQ(bimodal.Percentile(0.95), 10'000);   // [9728, 10239], clamped to the max
+    CHECK_EQ(bimodal.Percentile(0.99), 10'000);
+
+    // Overflow: the top bucket reports MaxTrackable(), while Max() stays exact.
+    H over;
+    over.Record(10);
+    over.Record(1'000'000'000'000ull);
+    CHECK_EQ(over.Max(), 1'000'000'000'000ull);
+    CHECK_EQ(over.Percentile(0.50), 10);
+    CHECK_EQ(over.Percentile(0.99), H::MaxTrackable());
+
+    // Merging the halves gives the same histogram as recording everything in one.
+    H lo, hi;
+    for (uint64_t v = 1; v <= 500; ++v) lo.Record(v);
+    for (uint64_t v = 501; v <= 1000; ++v) hi.Record(v);
+    lo.Merge(hi);
+    CHECK_EQ(lo.Count(), 1000);
+    CHECK_EQ(lo.Min(), 1);
+    CHECK_EQ(lo.Max(), 1000);
+    for (double q : { 0.5, 0.9, 0.95, 0.99, 1.0 }) CHECK_EQ(lo.Percentile(q), uniform.Percentile(q));
+
+    char line[96];
+    uniform.Summary(line, sizeof(line));
+    CHECK(!strcmp(line, "n=1000 p50=511us p90=927us p99=991us max=1.0ms"));
+    bimodal.Summary(line, sizeof(line));
+    CHECK(!strcmp(line, "n=100 p50=103us p90=103us p99=10ms max=10ms"));
+
+    uniform.Reset();
+    CHECK_EQ(uniform.Count(), 0);
+    CHECK_EQ(uniform.Max(), 0);
+}
+
+int main() {
+    Buckets();
+    Percentiles();
+    return CheckSummary();
+}
@@ -0,0 +1,115 @@
+// PowerWriterTest.cpp
+// PowerSettingsWriter against the counting backend: a Boost -> Saver switch is one transaction with
+// one scheme commit, unchanged values make no calls, and a scheme change or a refused commit
+// invalidates the cache. The timing wrapper's counts start over on Reset.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o power_writer_test Tools/Tests/PowerWriterTest.cpp AutoPowerManager/PowerWriter.cpp
+//       AutoPowerManager/LatencyHistogram.cpp
+//
+// Usage:
+//   power_writer_test          (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/PowerWriter.h"
+#include "../../AutoPowerManager/ProfileLadder.h"
+#include "Check.h"
+
+// Refuses the re-apply on demand.
+struct RefusingPowerBackend : CountingPowerBackend {
+    bool refuse = false;
+    bool SetActiveScheme(const GUID& s) override { CountingPowerBackend::SetActiveScheme(s); return !refuse; }
+};
+
+// The default ladder's Boost and Saver levels, as the app's anchors write them.
+static LadderSetpoint FromLevel(const ProfileLevel& l) {
+    LadderSetpoint sp;
+    sp.minAC = l.minAC; sp.minDC = l.minDC; sp.maxAC = l.maxAC; sp.maxDC = l.maxDC;
+    sp.boostAC = l.boostAC; sp.boostDC = l.boostDC; sp.parkAC = l.parkAC; sp.parkDC = l.parkDC;
+    return sp;
+}
+
+static void Stage(PowerSettingsWriter& w, const LadderSetpoint& sp) {
+    w.Begin();
+    StageLadderSetpoint(w, sp, false);
+}
+
+int main() {
+    const LadderSetpoint boost = FromLevel(kDefaultLadder[0]), saver = FromLevel(kDefaultLadder[4]);
+    RefusingPowerBackend be;
+    be.scheme = GUID{ 0x381b4222, 0xf694, 0x41f0, { 0x96,0x85,0xff,0x5b,0xb2,0x60,0xdf,0x2e } };
+    PowerSettingsWriter w(be);
+
+    // First transaction: nothing cached, all 4 settings x AC/DC written, one commit.
+    Stage(w, boost);
+    CHECK_EQ(w.Commit(), true);
+    CHECK_EQ(be.getActiveCalls, 1);
+    CHECK_EQ(be.writeCalls, 8);
+    CHECK_EQ(be.commitCalls, 1);
+
+    // Boost -> Saver: every default value differs, still a single commit.
+    be.Reset();
+    Stage(w, saver);
+    CHECK_EQ(w.Commit(), true);
+    CHECK_EQ(be.getActiveCalls, 1);
+    CHECK_EQ(be.writeCalls, 8);
+    CHECK_EQ(be.commitCalls, 1);
+
+    // Saver again: no API calls at all.
+    be.Reset();
+    Stage(w, saver);
+    CHECK_EQ(w.Commit(), false);
+    CHECK_EQ(be.getActiveCalls + be.writeCalls + be.commitCalls, 0);
+
+    // One value changed, and the last Set in a transaction wins: one write.
+    be.Reset();
+    Stage(w, saver);
+    w.Set(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, PowerSource::DC, 10);
+    w.Set(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, PowerSource::DC, 20);
+    CHECK_EQ(w.Commit(), true);
+    CHECK_EQ(be.writeCalls, 1);
+    CHECK_EQ(be.commitCalls, 1);
+
+    // Another scheme became active: the cache describes the old one, so everything is rewritten.
+    be.Reset();
+    be.scheme.Data1 ^= 1;
+    Stage(w, boost);
+    w.Set(SUB_PROCESSOR, SET_CORE_PARK_MIN_CORES, PowerSource::DC, 20);
+    CHECK_EQ(w.Commit(), true);
+    CHECK_EQ(be.writeCalls, 8);
+    CHECK_EQ(be.commitCalls, 1);
+
+    // A refused commit counts as a failure and drops the cache: the same values go out again.
+    be.Reset();
+    be.refuse = true;
+    Stage(w, saver);
+    CHECK_EQ(w.Commit(), false);
+    CHECK_EQ(w.Failures(), 1);
+    be.refuse = false;
+    be.Reset();
+    Stage(w, saver);
+    CHECK_EQ(w.Commit(), true);
+    CHECK_EQ(be.writeCalls, 8);
+    CHECK_EQ(w.Failures(), 1);
+
+    // An empty diff is not a failure.
+    Stage(w, saver);
+    CHECK_EQ(w.Commit(), false);
+    CHECK_EQ(w.Failures(), 1);
+
+    // The timing wrapper: a Boost transaction is 10 calls, and Reset starts the count over.
+    CountingPowerBackend inner;
+    TimedPowerBackend timed(inner);
+    PowerSettingsWriter tw(timed);
+    Stage(tw, boost);
+    CHECK_EQ(tw.Commit(), true);
+    CHECK_EQ(timed.Calls(), 10);
+    CHECK_EQ(timed.Commits().Count(), 1);
+    timed.Reset();
+    CHECK_EQ(timed.Calls(), 0);
+    CHECK_EQ(timed.Commits().Count(), 0);
+    Stage(tw, saver);
+    CHECK_EQ(tw.Commit(), true);
+    CHECK_EQ(timed.Calls(), 10);
+
+    return CheckSummary();
+}
@@ -0,0 +1,84 @@
+// ProcessQosTest.cpp
+// ProcessQosEngine against a scripted process table and a recording control: a busy background
+// process is throttled after throttleAfterMs, and when its PID comes back as a different process
+// (new creation time) the Eco count drops, so the maxThrottled budget is not used up by the dead one.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o process_qos_test Tools/Tests/ProcessQosTest.cpp AutoPowerManager/ProcessQos.cpp
+//       AutoPowerManager/ProcessScanner.cpp AutoPowerManager/ForegroundTracker.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   process_qos_test           (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/ProcessQos.h"
+#include "Check.h"
+
+#include <cwchar>
+#include <map>
+
+// The processes the next scan reports; each burns cpuPct of a core between scans.
+struct ScriptedTable : IProcessTableSource {
+    struct Proc { uint64_t created; double cpuPct; uint64_t cpuUs; const wchar_t* name; };
+    std::map<uint32_t, Proc> procs;
+    uint64_t scanMs = 5000;
+
+    bool Scan(IProcessSink& sink) override {
+        for (auto& kv : procs) {
+            Proc& p = kv.second;
+            p.cpuUs += (uint64_t)(p.cpuPct * 10.0 * (double)scanMs);
+            sink.OnProcess(kv.first, p.created, p.cpuUs, p.name, wcslen(p.name));
+        }
+        return true;
+    }
+};
+
+struct RecordingControl : IProcessQosControl {
+    std::map<uint32_t, QosLevel> level;
+    int sets = 0, restores = 0;
+    bool Set(uint32_t pid, uint64_t, QosLevel l, QosSaved&) override { ++sets; level[pid] = l; return true; }
+    bool Restore(uint32_t pid, uint64_t, QosLevel, const QosSaved&) override { ++restores; level.erase(pid); return true; }
+};
+
+int main() {
+    ScriptedTable table;
+    RecordingControl ctl;
+    ProcessScanner scanner(table);
+    ProcessQosConfig cfg;
+    cfg.maxThrottled = 1;
+    ProcessQosEngine qos(ctl, cfg);
+    uint64_t now = 0;
+    auto scan = [&] { now += table.scanMs; scanner.Scan(now); qos.Update(scanner, 0, now); };
+
+    // An indexer at 60% of a core: throttled once it has been busy for throttleAfterMs.
+    table.procs[500] = { 1, 60.0, 0, L"indexer.exe" };
+    for (int i = 0; i < 4; ++i) scan();
+    CHECK_EQ(qos.GetStats().eco, 1);
+    CHECK(ctl.level.count(500) && ctl.level[500] == QosLevel::Eco);
+
+    // It exits and PID 500 comes back as an idle process with a new creation time: the old track
+    // goes, and with it the Eco count. Nothing is restored, since the process is gone.
+    table.procs[500] = { 2, 0.0, 0, L"notepad.exe" };
+    scan();
+    CHECK_EQ(qos.GetStats().eco, 0);
+    CHECK_EQ(qos.GetStats().high, 0);
+    CHECK_EQ(ctl.restores, 0);
+
+    // The budget of one is free again for the next busy process.
+    table.procs[600] = { 3, 60.0, 0, L"compiler.exe" };
+    for (int i = 0; i < 4; ++i) scan();
+    CHECK_EQ(qos.GetStats().eco, 1);
+    CHECK(ctl.level.count(600) && ctl.level[600] == QosLevel::Eco);
+
+    // A reused PID that is busy again starts over: not throttled until it has been busy long enough.
+    table.procs[600] = { 4, 60.0, 0, L"compiler.exe" };
+    scan();
+    CHECK_EQ(qos.GetStats().eco, 0);
+    const int setsBefore = ctl.sets;
+    for (int i = 0; i < 4; ++i) scan();
+    CHECK_EQ(qos.GetStats().eco, 1);
+    CHECK_EQ(ctl.sets, setsBefore + 1);
+
+    qos.RestoreAll(&scanner);
+    CHECK_EQ(qos.GetStats().eco, 0);
+    return CheckSummary();
+}
@@ -0,0 +1,222 @@
+// ThermalTest.cpp
+// SysfsThermalSource against a fake /sys tree built in a temporary directory: CPU zones are preferred
+// over acpitz (acpitz alone is the fallback), 0 and >150 C readings are dropped, package power comes
+// from energy_uj deltas, unwrapped with max_energy_range_uj, and is unknown without energy_uj. Then
+// ThermalLimiter's step-down and step-up timing, the temperature projection and the hysteresis hold.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o thermal_test Tools/Tests/ThermalTest.cpp AutoPowerManager/Thermal.cpp
+//
+// Usage:
+//   thermal_test               (exit status 1 if any check fails)
+
+#include "../../AutoPowerManager/Thermal.h"
+#include "Check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool Near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+// ---------- Fake sysfs tree ----------
+struct FakeSysfs {
+    std::string root;
+
+    FakeSysfs() {
+        char tmpl[] = "/tmp/thermal.XXXXXX";
+        root = mkdtemp(tmpl) ? tmpl : "/tmp/thermal.fixture";
+        mkdir((root + "/class").c_str(), 0755);
+        mkdir((root + "/class/thermal").c_str(), 0755);
+        mkdir((root + "/class/powercap").c_str(), 0755);
+    }
+    ~FakeSysfs() { std::string cmd = "rm -rf '" + root + "'"; if (system(cmd.c_str())) {} }
+
+    void Zone(int n, const char* type, uint64_t milliC) {
+        const std::string zone = root + "/class/thermal/thermal_zone" + std::to_string(n);
+        mkdir(zone.c_str(), 0755);
+        Write(zone + "/type", type);
+        Temp(n, milliC);
+    }
+    void Temp(int n, uint64_t milliC) {
+        Write(root + "/class/thermal/thermal_zone" + std::to_string(n) + "/temp", std::to_string(milliC));
+    }
+    void Rapl(uint64_t energyUj, uint64_t rangeUj, uint64_t limitUw) {
+        mkdir((root + "/class/powercap/intel-rapl:0").c_str(), 0755);
+        Energy(energyUj);
+        Write(Rapl() + "/max_energy_range_uj", std::to_string(rangeUj));
+        Write(Rapl() + "/constraint_0_power_limit_uw", std::to_string(limitUw));
+    }
+    void Energy(uint64_t energyUj) { Write(Rapl() + "/energy_uj", std::to_string(energyUj)); }
+    void RemoveEnergy() { unlink((Rapl() + "/energy_uj").c_str()); }
+    std::string Rapl() const { return root + "/class/powercap/intel-rapl:0"; }
+
+    static void Write(const std::string& path, const std::string& v) {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) { perror(path.c_str()); exit(2); }
+        fprintf(f, "%s\n", v.c_str());
+        fclose(f);
+    }
+};
+
+static void Zones() {
+    // acpitz is hotter, but the package zone is the CPU's own: it wins.
+    FakeSysfs t;
+    t.Zone(0, "acpitz", 95'000);
+    t.Zone(1, "x86_pkg_temp", 61'500);
+    SysfsThermalSource src(t.root);
+    ThermalSample s;
+    CHECK(src.Sample(1000, s));
+    CHECK(Near(s.tempC, 61.5));
+    CHECK(s.packageW < 0);
+
+    // Bogus CPU readings (0, above 150 C) are skipped; the hottest sane one counts.
+    t.Zone(2, "TCPU", 0);
+    t.Zone(3, "coretemp", 200'000);
+    t.Zone(4, "cpu-thermal", 70'000);
+    SysfsThermalSource src2(t.root);
+    CHECK(src2.Sample(1000, s));
+    CHECK(Near(s.tempC, 70.0));
+
+    // Every CPU zone bogus: no temperature, and acpitz is not consulted while CPU zones exist.
+    t.Temp(1, 0); t.Temp(4, 151'000);
+    CHECK(!src2.Sample(2000, s));
+    CHECK(s.tempC < 0);
+
+    // Only acpitz: it is the fallback.
+    FakeSysfs a;
+    a.Zone(0, "acpitz", 48'000);
+    SysfsThermalSource src3(a.root);
+    CHECK(src3.Sample(1000, s));
+    CHECK(Near(s.tempC, 48.0));
+
+    // No zones and no RAPL: nothing readable.
+    FakeSysfs none;
+    SysfsThermalSource src4(none.root);
+    CHECK(!src4.Sample(1000, s));
+}
+
+static void PackagePower() {
+    const uint64_t kRange = 10'000'000;
+    FakeSysfs t;
+    t.Zone(0, "x86_pkg_temp", 50'000);
+    t.Rapl(1'000'000, kRange, 15'000'000);
+    SysfsThermalSource src(t.root);
+    ThermalSample s;
+
+    // The first sample only sets the baseline; the limit is read at once.
+    CHECK(src.Sample(1000, s));
+    CHECK(s.packageW < 0);
+    CHECK(Near(s.packageLimitW, 15.0));
+
+    t.Energy(3'000'000);                  // 2 J in 1 s
+    src.Sample(2000, s);
+    CHECK(Near(s.packageW, 2.0));
+    t.Energy(9'500'000);                  // 6.5 J in 1 s
+    src.Sample(3000, s);
+    CHECK(Near(s.packageW, 6.5));
+    t.Energy(500'000);                    // wrapped: 0.5 J to the top of the range, 0.5 J after
+    src.Sample(4000, s);
+    CHECK(Near(s.packageW, 1.0));
+
+    // energy_uj gone (e.g. made root-only): power is unknown, the temperature still reads.
+    t.RemoveEnergy();
+    CHECK(src.Sample(5000, s));
+    CHECK(s.packageW < 0);
+    CHECK(s.packageLimitW < 0);
+    CHECK(Near(s.tempC, 50.0));
+
+    // A tree without energy_uj at all.
+    FakeSysfs n;
+    n.Zone(0, "x86_pkg_temp", 50'000);
+    n.Rapl(0, kRange, 15'000'000);
+    n.RemoveEnergy();
+    SysfsThermalSource src2(n.root);
+    src2.Sample(1000, s);
+    src2.Sample(2000, s);
+    CHECK(s.packageW < 0);
+    CHECK(s.packageLimitW < 0);
+}
+
+static ThermalSample Temp(double c) {
+    ThermalSample s;
+    s.tempC = c;
+    return s;
+}
+
+static void Limiter() {
+    // Defaults: soft limit 85 C, release below 79 C, one step down per 2 s, one step up per 10 s cool.
+    ThermalLimiter lim;
+    uint64_t t = 0;
+
+    // Steady at 90 C: a level at once, then one more every 2 s, never faster.
+    lim.Update(t += 1000, Temp(90));
+    CHECK_EQ(lim.Level(), 1);
+    CHECK_EQ(lim.Cap().boostMode, 1);
+    lim.Update(t += 1000, Temp(90));
+    CHECK_EQ(lim.Level(), 1);
+    lim.Update(t += 1000, Temp(90));
+    CHECK_EQ(lim.Level(), 2);
+    CHECK_EQ(lim.Cap().boostMode, 0);
+    CHECK_EQ(lim.Cap().maxProcPct, 100);
+
+    // 82 C is inside the hysteresis band (79..85): the level holds however long it stays there.
+    for (int i = 0; i < 30; ++i) lim.Update(t += 1000, Temp(82));
+    CHECK_EQ(lim.Level(), 2);
+
+    // Below 79 C: one level back after 10 s cool, the next after 10 s more.
+    const uint64_t cool = t += 1000;
+    lim.Update(cool, Temp(70));
+    while (t < cool + 9000) lim.Update(t += 1000, Temp(70));
+    CHECK_EQ(lim.Level(), 2);
+    lim.Update(t += 1000, Temp(70));
+    CHECK_EQ(lim.Level(), 1);
+    while (t < cool + 19'000) lim.Update(t += 1000, Temp(70));
+    CHECK_EQ(lim.Level(), 1);
+    lim.Update(t += 1000, Temp(70));
+    CHECK_EQ(lim.Level(), 0);
+
+    // Hot again: the step down waits 2 s from the last step up. Then a dip into the band restarts
+    // the cool period.
+    lim.Update(t += 1000, Temp(90));
+    CHECK_EQ(lim.Level(), 0);
+    lim.Update(t += 1000, Temp(90));
+    CHECK_EQ(lim.Level(), 1);
+    for (int i = 0; i < 5; ++i) lim.Update(t += 1000, Temp(77));
+    lim.Update(t += 1000, Temp(80));      // in the band, and rising too slowly to project past 85
+    for (int i = 0; i < 10; ++i) lim.Update(t += 1000, Temp(77));   // cool from the first
+    CHECK_EQ(lim.Level(), 1);
+    lim.Update(t += 1000, Temp(77));
+    CHECK_EQ(lim.Level(), 0);
+
+    // Rising 2 C/s: the projection 4 s ahead trips the limit at 82 C, before it is reached.
+    lim.Reset();
+    t = 0;
+    for (double c : { 76.0, 78.0, 80.0 }) lim.Update(t += 1000, Temp(c));
+    CHECK_EQ(lim.Level(), 0);
+    lim.Update(t += 1000, Temp(82));
+    CHECK_EQ(lim.Level(), 1);
+
+    // Package power at 95% of the limit steps down on its own; the sensor vanishing releases it.
+    lim.Reset();
+    t = 0;
+    ThermalSample p = Temp(60);
+    p.packageW = 14.5; p.packageLimitW = 15.0;
+    lim.Update(t += 1000, p);
+    CHECK_EQ(lim.Level(), 1);
+    for (int i = 0; i < 10; ++i) lim.Update(t += 1000, ThermalSample());
+    CHECK_EQ(lim.Level(), 1);
+    lim.Update(t += 1000, ThermalSample());
+    CHECK_EQ(lim.Level(), 0);
+}
+
+int main() {
+    Zones();
+    PackagePower();
+    Limiter();
+    return CheckSummary();
+}
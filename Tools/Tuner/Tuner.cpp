@@ -0,0 +1,329 @@
+// Tuner.cpp
+// Offline auto-tuner for the governor's timing and threshold knobs: sticky boost, the Balanced and
+// Saver residencies, the battery threshold and the Active/Engaged CPU thresholds. Every candidate in
+// the grid is replayed headless (Replay.h) over the given traces, spread across all cores with a
+// work-stealing pool, and scored on three costs to minimise:
+//   wait    seconds per demand onset spent outside Boost (input, a heavy app, or raw load over the
+//           demand thresholds, which stay fixed while the config's own thresholds move)
+//   power   relative power, from the time in each profile and the load (ReplayOptions)
+//   switch  profile switches per hour
+// The report is the Pareto front of those, where the built-in presets sit against it, and three
+// generated presets picked off the front by weight.
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -pthread -o tuner Tools/Tuner/Tuner.cpp Tools/Replay/Replay.cpp Tools/Replay/Trace.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp AutoPowerManager/TickScheduler.cpp
+//       AutoPowerManager/Predictor.cpp AutoPowerManager/AppRules.cpp
+//
+// Usage:
+//   tuner <trace.csv ... | --synth HOURS> [--rules FILE] [--threads N] [--tick row|fixed:MS|adaptive]
+//         [--sticky LO:HI:STEP] [--resbal LO:HI:STEP] [--ressaver LO:HI:STEP] (seconds)
+//         [--batt LO:HI:STEP] [--active LO:HI:STEP] [--engaged LO:HI:STEP] (percent)
+//         [--front N] [--preset fast|recommended|eco] [--preset-out FILE] [--check]
+//
+// --preset-out writes the chosen generated preset as daemon config lines (AutoPowerManager.conf).
+// --check also runs the sweep on one thread and exits 1 when the results differ, when a front point
+// is dominated, or when a generated preset is not on the front.
+
+#include "WorkStealingPool.h"
+#include "../Replay/Replay.h"
+#include "../../AutoPowerManager/AppRules.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Candidate {
+    uint32_t stickyMs, resBalMs, resSaverMs;
+    int      batt;
+    double   activePct, engagedPct;
+};
+
+struct Score {
+    double wait = 0.0;      // s per demand onset
+    double power = 0.0;     // relative
+    double switches = 0.0;  // per hour
+    double boostShare = 0.0;
+
+    bool operator==(const Score& o) const { return wait == o.wait && power == o.power && switches == o.switches; }
+};
+
+struct Range { double lo, hi, step; };
+
+static bool ParseRange(const char* s, Range& r) {
+    if (sscanf(s, "%lf:%lf:%lf", &r.lo, &r.hi, &r.step) == 3) return r.step > 0 && r.hi >= r.lo;
+    if (sscanf(s, "%lf", &r.lo) != 1) return false;
+    r.hi = r.lo; r.step = 1;
+    return true;
+}
+
+static std::vector<double> Values(const Range& r) {
+    std::vector<double> v;
+    for (double x = r.lo; x <= r.hi + r.step * 1e-6; x += r.step) v.push_back(x);
+    return v;
+}
+
+static GovernorConfig Apply(GovernorConfig cfg, const Candidate& c) {
+    cfg.stickyBoostMs = c.stickyMs;
+    cfg.residencyBalancedMs = c.resBalMs;
+    cfg.residencySaverMs = c.resSaverMs;
+    cfg.battThreshold = c.batt;
+    cfg.activeCpuPct = c.activePct;
+    cfg.engagedCpuPct = c.engagedPct;
+    return cfg;
+}
+
+// Summed over the traces, then normalised, so a long trace weighs more than a short one.
+static Score Evaluate(const std::vector<Trace>& traces, const GovernorConfig& base, const Candidate& c, const ReplayOptions& opt) {
+    const GovernorConfig cfg = Apply(base, c);
+    uint64_t onsets = 0, waitMs = 0, durMs = 0, switches = 0, boostMs = 0;
+    double energy = 0.0;
+    for (const Trace& t : traces) {
+        const ReplayMetrics m = ReplayTrace(t, cfg, opt);
+        onsets += m.demandOnsets;
+        waitMs += m.demandWaitMs;
+        durMs += m.durationMs;
+        switches += m.switches;
+        boostMs += m.msInProfile[(int)ProcProfile::Boost];
+        energy += m.energyMs;
+    }
+    Score s;
+    s.wait = onsets ? waitMs / 1000.0 / onsets : 0.0;
+    s.power = durMs ? energy / durMs : 0.0;
+    s.switches = durMs ? switches * 3600'000.0 / durMs : 0.0;
+    s.boostShare = durMs ? (double)boostMs / durMs : 0.0;
+    return s;
+}
+
+static bool Dominates(const Score& a, const Score& b) {
+    return a.wait <= b.wait && a.power <= b.power && a.switches <= b.switches &&
+           (a.wait < b.wait || a.power < b.power || a.switches < b.switches);
+}
+
+// Grid steps from the default config, summed over the knobs. A knob the traces never exercise
+// (battThreshold on a trace that stays above it) leaves candidates tied; the nearest default wins.
+static double Distance(const Candidate& c, const GovernorConfig& d, const Range* r) {
+    const double v[6] = { c.stickyMs / 1000.0, c.resBalMs / 1000.0, c.resSaverMs / 1000.0, (double)c.batt, c.activePct, c.engagedPct };
+    const double def[6] = { d.stickyBoostMs / 1000.0, d.residencyBalancedMs / 1000.0, d.residencySaverMs / 1000.0,
+                            (double)d.battThreshold, d.activeCpuPct, d.engagedCpuPct };
+    double sum = 0.0;
+    for (int k = 0; k < 6; ++k) sum += std::fabs(v[k] - def[k]) / r[k].step;
+    return sum;
+}
+
+// Indices of the non-dominated scores, by power. Of tied candidates only the nearest default stays.
+static std::vector<size_t> ParetoFront(const std::vector<Score>& s, const std::vector<double>& dist) {
+    std::vector<size_t> front;
+    for (size_t i = 0; i < s.size(); ++i) {
+        bool keep = true;
+        for (size_t j = 0; j < s.size() && keep; ++j)
+            if (j != i && (Dominates(s[j], s[i]) || (s[j] == s[i] && (dist[j] < dist[i] || (dist[j] == dist[i] && j < i)))))
+                keep = false;
+        if (keep) front.push_back(i);
+    }
+    std::sort(front.begin(), front.end(), [&](size_t a, size_t b) { return s[a].power < s[b].power; });
+    return front;
+}
+
+struct PresetWeights { const char* name; double wait, power, switches; };
+static const PresetWeights kPresets[] = {
+    { "fast",        0.70, 0.20, 0.10 },
+    { "recommended", 0.40, 0.40, 0.20 },
+    { "eco",         0.15, 0.70, 0.15 },
+};
+
+// The front point with the smallest weighted sum of costs, each scaled to 0..1 over the front.
+static size_t PickPreset(const std::vector<Score>& s, const std::vector<size_t>& front, const PresetWeights& w) {
+    double lo[3] = { 1e300, 1e300, 1e300 }, hi[3] = { -1e300, -1e300, -1e300 };
+    for (size_t i : front) {
+        const double v[3] = { s[i].wait, s[i].power, s[i].switches };
+        for (int k = 0; k < 3; ++k) { lo[k] = std::min(lo[k], v[k]); hi[k] = std::max(hi[k], v[k]); }
+    }
+    auto norm = [&](int k, double v) { return hi[k] > lo[k] ? (v - lo[k]) / (hi[k] - lo[k]) : 0.0; };
+    size_t best = front[0];
+    double bestCost = 1e300;
+    for (size_t i : front) {
+        const double cost = w.wait * norm(0, s[i].wait) + w.power * norm(1, s[i].power) + w.switches * norm(2, s[i].switches);
+        if (cost < bestCost) { bestCost = cost; best = i; }
+    }
+    return best;
+}
+
+static void PrintRow(const char* label, const Candidate& c, const Score& s) {
+    printf("%-13s %6u %6u %8u %4d%% %5.0f%% %6.0f%% %6.3f s %7.4f %6.1f %6.1f%%\n", label, c.stickyMs / 1000,
+           c.resBalMs / 1000, c.resSaverMs / 1000, c.batt, c.activePct, c.engagedPct, s.wait, s.power, s.switches,
+           100.0 * s.boostShare);
+}
+
+static bool WriteConfig(const char* path, const char* name, const Candidate& c) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# Generated by tuner (%s)\n", name);
+    fprintf(f, "BattThreshold = %d\nStickyBoostMs = %u\nResidencyBalancedMs = %u\nResidencySaverMs = %u\n",
+            c.batt, c.stickyMs, c.resBalMs, c.resSaverMs);
+    fprintf(f, "ActiveCpuPct = %.0f\nEngagedCpuPct = %.0f\n", c.activePct, c.engagedPct);
+    return fclose(f) == 0;
+}
+
+static bool ReadRules(const char* path, std::wstring& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    out.clear();
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;)
+        for (size_t i = 0; i < n; ++i) out += (wchar_t)(unsigned char)buf[i];   // rules are ASCII
+    fclose(f);
+    return true;
+}
+
+static int Usage() {
+    fprintf(stderr,
+        "usage: tuner <trace.csv ... | --synth HOURS> [--rules FILE] [--threads N] [--tick row|fixed:MS|adaptive]\n"
+        "             [--sticky LO:HI:STEP] [--resbal LO:HI:STEP] [--ressaver LO:HI:STEP]\n"
+        "             [--batt LO:HI:STEP] [--active LO:HI:STEP] [--engaged LO:HI:STEP]\n"
+        "             [--front N] [--preset fast|recommended|eco] [--preset-out FILE] [--check]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    std::wstring ruleText = L"comsol\nmatlab\nvivado\nansys";   // the tray's default rules
+    std::vector<const char*> paths;
+    double synthHours = 0;
+    unsigned threads = 0;
+    size_t frontRows = 20;
+    const char* presetName = "recommended";
+    const char* presetOut = nullptr;
+    bool check = false;
+    ReplayOptions opt;
+    opt.mode = TickMode::Adaptive;   // as the app ticks
+    Range sticky{ 15, 90, 15 }, resBal{ 30, 120, 30 }, resSaver{ 60, 240, 60 };
+    Range batt{ 15, 35, 10 }, active{ 30, 60, 10 }, engaged{ 10, 25, 5 };
+
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto take = [&]() { if (!v) { fprintf(stderr, "%s needs a value\n", a); exit(Usage()); } ++i; return v; };
+        auto range = [&](Range& r) { const char* s = take(); if (!ParseRange(s, r)) { fprintf(stderr, "bad range: %s\n", s); exit(Usage()); } };
+        if      (!strcmp(a, "--synth"))      synthHours = atof(take());
+        else if (!strcmp(a, "--rules")) {
+            const char* path = take();
+            if (!ReadRules(path, ruleText)) { fprintf(stderr, "cannot read %s\n", path); return 1; }
+        }
+        else if (!strcmp(a, "--threads"))    threads = (unsigned)std::max(1, atoi(take()));
+        else if (!strcmp(a, "--tick")) {
+            const char* m = take();
+            if (!strcmp(m, "row")) opt.mode = TickMode::EveryRow;
+            else if (!strcmp(m, "adaptive")) opt.mode = TickMode::Adaptive;
+            else if (!strncmp(m, "fixed:", 6)) { opt.mode = TickMode::Fixed; opt.fixedMs = (uint32_t)std::max(1, atoi(m + 6)); }
+            else return Usage();
+        }
+        else if (!strcmp(a, "--sticky"))     range(sticky);
+        else if (!strcmp(a, "--resbal"))     range(resBal);
+        else if (!strcmp(a, "--ressaver"))   range(resSaver);
+        else if (!strcmp(a, "--batt"))       range(batt);
+        else if (!strcmp(a, "--active"))     range(active);
+        else if (!strcmp(a, "--engaged"))    range(engaged);
+        else if (!strcmp(a, "--front"))      frontRows = (size_t)std::max(1, atoi(take()));
+        else if (!strcmp(a, "--preset"))     presetName = take();
+        else if (!strcmp(a, "--preset-out")) presetOut = take();
+        else if (!strcmp(a, "--check"))      check = true;
+        else if (a[0] == '-')                return Usage();
+        else                                 paths.push_back(a);
+    }
+    if (paths.empty() && synthHours <= 0) return Usage();
+    const PresetWeights* chosen = nullptr;
+    for (const PresetWeights& w : kPresets) if (!strcmp(w.name, presetName)) chosen = &w;
+    if (!chosen) { fprintf(stderr, "unknown preset: %s\n", presetName); return Usage(); }
+
+    AppRules rules;
+    if (int bad = rules.Parse(ruleText)) fprintf(stderr, "%d malformed app rule line(s) skipped\n", bad);
+    std::vector<Trace> traces;
+    for (const char* p : paths) {
+        Trace t;
+        std::string err;
+        if (!LoadTrace(p, t, err)) { fprintf(stderr, "%s\n", err.c_str()); return 1; }
+        traces.push_back(std::move(t));
+    }
+    if (synthHours > 0) traces.push_back(SynthesizeTrace(synthHours, 1));
+    double hours = 0;
+    for (Trace& t : traces) {
+        ResolveAppRules(t, rules);
+        if (t.rows.empty()) { fprintf(stderr, "empty trace\n"); return 1; }
+        hours += t.DurationMs() / 3600'000.0;
+    }
+
+    // Engaged at or above Active is not a valid config (the tray's sliders keep them apart too).
+    std::vector<Candidate> grid;
+    for (double st : Values(sticky)) for (double rb : Values(resBal)) for (double rs : Values(resSaver))
+    for (double b : Values(batt)) for (double ac : Values(active)) for (double en : Values(engaged))
+        if (en < ac) grid.push_back({ (uint32_t)(st * 1000), (uint32_t)(rb * 1000), (uint32_t)(rs * 1000), (int)b, ac, en });
+    if (grid.empty()) { fprintf(stderr, "empty grid\n"); return 1; }
+
+    const GovernorConfig base;
+    const Range steps[6] = { sticky, resBal, resSaver, batt, active, engaged };
+    std::vector<double> dist(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) dist[i] = Distance(grid[i], base, steps);
+    std::vector<Score> scores(grid.size());
+    WorkStealingPool pool(threads);
+    auto t0 = std::chrono::steady_clock::now();
+    const WorkStealingPool::Stats ps = pool.Run(grid.size(), [&](size_t i, unsigned) { scores[i] = Evaluate(traces, base, grid[i], opt); });
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("%zu trace(s), %.1f h; %zu candidates on %u threads in %.2f s (%.0f/s, %llu stolen)\n", traces.size(), hours,
+           grid.size(), pool.Threads(), secs, secs > 0 ? grid.size() / secs : 0.0, (unsigned long long)ps.steals);
+
+    bool ok = true;
+    if (check) {
+        std::vector<Score> serial(grid.size());
+        auto t1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < grid.size(); ++i) serial[i] = Evaluate(traces, base, grid[i], opt);
+        const double serialSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+        printf("serial %.2f s: %.2fx on %u threads\n", serialSecs, secs > 0 ? serialSecs / secs : 0.0, pool.Threads());
+        if (serial != scores) { printf("  parallel results differ from serial\n"); ok = false; }
+    }
+
+    const std::vector<size_t> front = ParetoFront(scores, dist);
+    printf("\nPareto front: %zu of %zu (wait, power and switches all minimised; by power)\n", front.size(), grid.size());
+    printf("%-13s %6s %6s %8s %5s %6s %7s %8s %7s %6s %7s\n", "", "sticky", "resbal", "ressaver", "batt", "active",
+           "engaged", "wait", "power", "sw/h", "Boost");
+    for (size_t k = 0; k < front.size() && k < frontRows; ++k) PrintRow("", grid[front[k]], scores[front[k]]);
+    if (front.size() > frontRows) printf("... %zu more (--front N)\n", front.size() - frontRows);
+
+    // The tray's presets (ApplyPreset), which keep the default thresholds.
+    printf("\nbuilt-in presets\n");
+    const struct { const char* name; Candidate c; } builtin[] = {
+        { "Recommended", { 45'000, 60'000, 90'000, 25, 40, 15 } },
+        { "Fast",        { 60'000, 45'000, 75'000, 15, 40, 15 } },
+        { "Eco",         { 30'000, 90'000, 120'000, 35, 40, 15 } },
+    };
+    for (const auto& b : builtin) {
+        const Score s = Evaluate(traces, base, b.c, opt);
+        size_t by = 0;
+        for (size_t i : front) by += Dominates(scores[i], s);
+        PrintRow(b.name, b.c, s);
+        printf("%-13s dominated by %zu front point(s)\n", "", by);
+    }
+
+    printf("\ngenerated presets\n");
+    for (const PresetWeights& w : kPresets) {
+        const size_t i = PickPreset(scores, front, w);
+        PrintRow(w.name, grid[i], scores[i]);
+        const Candidate& c = grid[i];
+        printf("%-13s ApplyPreset: batt %d, sticky %u, resbal %u, ressaver %u; ActiveCpuPct %.0f, EngagedCpuPct %.0f\n", "",
+               c.batt, c.stickyMs / 1000, c.resBalMs / 1000, c.resSaverMs / 1000, c.activePct, c.engagedPct);
+        if (check && std::find(front.begin(), front.end(), i) == front.end()) { printf("  %s is not on the front\n", w.name); ok = false; }
+        if (presetOut && &w == chosen) {
+            if (!WriteConfig(presetOut, w.name, c)) { fprintf(stderr, "cannot write %s\n", presetOut); return 1; }
+            printf("%-13s written to %s\n", "", presetOut);
+        }
+    }
+
+    if (check)
+        for (size_t a : front) for (size_t b : front)
+            if (Dominates(scores[a], scores[b])) { printf("  front point %zu dominated by %zu\n", b, a); ok = false; }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// WorkStealingPool.h
+// Fixed set of independent jobs, indexed 0..n-1, run on a pool of worker threads. Each worker owns
+// a deque seeded with a contiguous block of indices and takes from its back; a worker whose deque
+// runs dry steals from the front of another's, so a block of slow jobs (long traces, configs that
+// tick often) gets spread out instead of leaving the other workers idle at the end. Jobs don't
+// spawn jobs, so a worker that finds every deque empty is done.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    struct Stats { uint64_t jobs = 0, steals = 0; };
+
+    // threads 0: one per hardware thread.
+    explicit WorkStealingPool(unsigned threads = 0)
+        : count(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    unsigned Threads() const { return count; }
+
+    // Runs job(i, worker) once for every i in [0, n) and returns when all have finished.
+    Stats Run(size_t n, const std::function<void(size_t, unsigned)>& job) {
+        std::vector<std::unique_ptr<Queue>> queues;
+        for (unsigned w = 0; w < count; ++w) {
+            queues.emplace_back(new Queue);
+            for (size_t i = n * w / count; i < n * (w + 1) / count; ++i) queues.back()->jobs.push_back(i);
+        }
+        std::atomic<uint64_t> steals{ 0 };
+        auto work = [&](unsigned self) {
+            uint32_t seed = 0x9E3779B9u * (self + 1);
+            for (;;) {
+                size_t i;
+                if (Pop(*queues[self], i)) { job(i, self); continue; }
+                bool stole = false;
+                // Start at a random victim so idle workers don't all pile onto the same one.
+                const unsigned first = (seed = seed * 1664525u + 1013904223u) >> 8;
+                for (unsigned k = 0; k < count && !stole; ++k) {
+                    const unsigned v = (first + k) % count;
+                    if (v != self && Steal(*queues[v], i)) stole = true;
+                }
+                if (!stole) return;
+                steals.fetch_add(1, std::memory_order_relaxed);
+                job(i, self);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned w = 1; w < count; ++w) threads.emplace_back(work, w);
+        work(0);
+        for (std::thread& t : threads) t.join();
+        return Stats{ n, steals.load() };
+    }
+
+private:
+    struct Queue {
+        std::mutex         lock;
+        std::deque<size_t> jobs;
+    };
+
+    static bool Pop(Queue& q, size_t& out) {
+        std::lock_guard<std::mutex> g(q.lock);
+        if (q.jobs.empty()) return false;
+        out = q.jobs.back();
+        q.jobs.pop_back();
+        return true;
+    }
+
+    static bool Steal(Queue& q, size_t& out) {
+        std::lock_guard<std::mutex> g(q.lock);
+        if (q.jobs.empty()) return false;
+        out = q.jobs.front();
+        q.jobs.pop_front();
+        return true;
+    }
+
+    unsigned count;
+};
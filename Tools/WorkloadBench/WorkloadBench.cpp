@@ -0,0 +1,262 @@
+// WorkloadBench.cpp
+// Compute- versus memory-bound classification (PerfCounters.h) on a simulated FEM batch: jobs that
+// alternate assembly (compute-bound) and sparse solves (memory-bound), with mixed cache-resident
+// stretches and idle gaps between jobs. Throughput and power follow the clock: a phase spends a
+// fixed share of its time waiting on memory, which the clock doesn't shorten, and power rises
+// steeply with the clock. The counters are generated from the same model, so capping a solve
+// raises its IPC and lowers its stall share exactly as on hardware; misses per instruction don't move.
+//
+// Each script is run three times: load alone (no counters), the classifier on LLC misses, and the
+// classifier on backend stalls only (PMUs without a usable miss event).
+//
+// Build (Linux):
+//   g++ -std=c++17 -O2 -o workload_bench Tools/WorkloadBench/WorkloadBench.cpp AutoPowerManager/PerfCounters.cpp
+//       AutoPowerManager/Governor.cpp AutoPowerManager/SignalFilter.cpp AutoPowerManager/ProfileLadder.cpp
+//       AutoPowerManager/Thermal.cpp
+//
+// Usage:
+//   workload_bench [--hours H] [--seed N] [--cores N] [--cap-pct P] [--check]
+//   workload_bench --live SECONDS [--load compute|memory]
+//
+// --check exits 1 when a classifier caps less than 85% of the solve time, caps more than 3% of the
+// assembly time, loses more than 5% of the work done by load alone, or doesn't save at least 15% of
+// the energy per unit of work. --live reads the real counters (root or CAP_PERFMON) once a second
+// and prints the phase, the metrics, the share of time the group was on the PMU and what a read
+// cost; --load runs a compute loop or a pointer chase over 256 MB on one thread meanwhile.
+
+#include "../../AutoPowerManager/PerfCounters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+enum class Kind { Idle, Assembly, Solve, Mixed };
+static const char* const kKindNames[] = { "idle", "assembly", "solve", "mixed" };
+
+// A stretch of the script. memShare: share of the time at full clock spent waiting on memory.
+struct Segment { Kind kind; uint32_t seconds; double busyCores, ipc, mpki, memShare; };
+
+static void MakeScript(double hours, unsigned seed, int cores, std::vector<Segment>& out) {
+    std::mt19937 rng(seed);
+    auto uni = [&rng](double a, double b) { return std::uniform_real_distribution<double>(a, b)(rng); };
+    const double total = hours * 3600.0;
+    double t = 0;
+    auto add = [&](Kind k, double lo, double hi) {
+        Segment s;
+        s.kind = k;
+        s.seconds = (uint32_t)uni(lo, hi);
+        s.busyCores = k == Kind::Idle ? 0.05 : cores * uni(0.85, 1.0);
+        switch (k) {
+        case Kind::Idle:     s.ipc = 0.8; s.mpki = 3.0;  s.memShare = 0.3;  break;
+        case Kind::Assembly: s.ipc = 2.1; s.mpki = 1.5;  s.memShare = 0.08; break;
+        case Kind::Solve:    s.ipc = 0.5; s.mpki = 24.0; s.memShare = 0.88; break;
+        case Kind::Mixed:    s.ipc = 1.2; s.mpki = 7.0;  s.memShare = 0.4;  break;
+        }
+        out.push_back(s);
+        t += s.seconds;
+    };
+    while (t < total) {
+        const int steps = std::uniform_int_distribution<int>(3, 8)(rng);   // one job: time steps
+        for (int i = 0; i < steps && t < total; ++i) {
+            add(Kind::Assembly, 10, 60);
+            if (uni(0, 1) < 0.3) add(Kind::Mixed, 10, 40);
+            add(Kind::Solve, 20, 180);
+        }
+        add(Kind::Idle, 30, 300);
+    }
+}
+
+// Relative clock: Boost 1.0, Balanced 0.85, Saver 0.6; the cap's max state, without turbo above it.
+static double ProfileClock(ProcProfile p) {
+    return p == ProcProfile::Boost ? 1.0 : p == ProcProfile::Balanced ? 0.85 : 0.6;
+}
+static double CappedClock(double clock, const ThermalCap& cap) {
+    return std::min(clock, cap.maxProcPct / 100.0 * (cap.boostMode ? 1.0 : 0.85));
+}
+static double Rate(double memShare, double clock) { return 1.0 / ((1.0 - memShare) / clock + memShare); }
+
+enum class Policy { LoadOnly, Misses, Stalls };
+static const char* const kPolicyNames[] = { "load only", "LLC misses", "stalls only" };
+
+struct RunResult {
+    double work = 0.0, wh = 0.0;
+    double kindSec[4] = {}, cappedSec[4] = {}, kindWork[4] = {};
+    uint32_t capChanges = 0;
+};
+
+static RunResult Run(const std::vector<Segment>& script, Policy policy, int cores, uint32_t capPct, unsigned seed) {
+    RunResult r;
+    std::mt19937 rng(seed * 7919u + (unsigned)policy);
+    std::normal_distribution<double> noise(0.0, 0.12);
+    Governor gov;
+    WorkloadClassifier wc;
+    WorkloadClassifierConfig c = wc.Config();
+    c.cap.maxProcPct = (uint8_t)capPct;
+    wc.SetConfig(c);
+    uint64_t now = 1'000;
+    double clock = ProfileClock(ProcProfile::Balanced);
+    bool capped = false;
+    for (const Segment& seg : script) {
+        for (uint32_t s = 0; s < seg.seconds; ++s) {
+            // The second that just ran at the clock chosen on the last tick.
+            const double rate = Rate(seg.memShare, clock);
+            const double w = seg.busyCores * rate;
+            r.work += w;
+            r.kindWork[(int)seg.kind] += w;
+            r.kindSec[(int)seg.kind] += 1.0;
+            if (capped) r.cappedSec[(int)seg.kind] += 1.0;
+            r.wh += (3.0 + seg.busyCores * (1.0 + 6.0 * std::pow(clock, 2.6))) / 3600.0;
+            now += 1'000;
+
+            GovernorSignals sig;
+            sig.nowMs = now;
+            sig.cpuPct = std::min(100.0, 100.0 * seg.busyCores / cores);
+            sig.cpuMaxCorePct = sig.cpuTopKPct = seg.kind == Kind::Idle ? 5.0 : 100.0;
+            sig.idleSec = UINT32_MAX;
+            if (policy != Policy::LoadOnly) {
+                PerfSample ps;
+                ps.seconds = 1.0;
+                ps.cycles = seg.busyCores * clock * 3e9;
+                ps.instructions = seg.ipc * std::exp(noise(rng)) * 3e9 * seg.busyCores * rate;
+                if (policy == Policy::Misses) ps.llcMisses = ps.instructions * seg.mpki * std::exp(noise(rng)) / 1000.0;
+                const double stall = seg.memShare / ((1.0 - seg.memShare) / clock + seg.memShare);
+                ps.stallCycles = ps.cycles * std::min(1.0, stall * std::exp(noise(rng)));
+                sig.memoryBound = wc.Update(now, ps, true) == WorkloadPhase::Memory;
+            }
+            const ProcProfile p = gov.Tick(sig);
+            const bool cap = gov.MemoryCapped();
+            r.capChanges += cap != capped;
+            capped = cap;
+            clock = capped ? CappedClock(ProfileClock(p), wc.Config().cap) : ProfileClock(p);
+        }
+    }
+    return r;
+}
+
+// ---------- Live ----------
+static std::atomic<bool> g_stop{ false };
+
+static void ComputeLoad() {
+    double x = 1.0;
+    while (!g_stop.load(std::memory_order_relaxed))
+        for (int i = 0; i < 1'000'000; ++i) x = x * 1.0000001 + 0.5;
+    if (x == 0.0) printf("\n");
+}
+
+static void MemoryLoad() {
+    const size_t n = (256u << 20) / sizeof(uint32_t);
+    std::vector<uint32_t> next(n);
+    for (size_t i = 0; i < n; ++i) next[i] = (uint32_t)i;
+    std::mt19937 rng(1);
+    for (size_t i = n - 1; i > 0; --i) std::swap(next[i], next[std::uniform_int_distribution<size_t>(0, i - 1)(rng)]);   // one cycle
+    uint32_t p = 0;
+    while (!g_stop.load(std::memory_order_relaxed))
+        for (int i = 0; i < 100'000; ++i) p = next[p];
+    if (p == UINT32_MAX) printf("\n");
+}
+
+static int Live(int seconds, const char* load) {
+#ifndef _WIN32
+    PerfEventSource src;
+    if (!src.Open()) {
+        const int e = src.Error();
+        fprintf(stderr, "perf_event_open: %s%s\n", strerror(e), e == EACCES || e == EPERM ? " (root, CAP_PERFMON or perf_event_paranoid <= 0)"
+                : e == ENOENT ? " (no hardware PMU: a VM without PMU passthrough?)" : "");
+        return 1;
+    }
+    printf("%zu cpu(s), %s\n", src.Cpus(), src.HaveMisses() ? "LLC misses" : src.HaveStalls() ? "backend stalls" : "no memory event");
+    std::thread worker;
+    if (load) worker = std::thread(strcmp(load, "memory") ? ComputeLoad : MemoryLoad);
+    WorkloadClassifier wc;
+    double readUs = 0.0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s <= seconds; ++s) {
+        std::this_thread::sleep_until(t0 + std::chrono::seconds(s));
+        const uint64_t nowMs = 1'000 + (uint64_t)s * 1'000;
+        PerfSample ps;
+        const auto r0 = std::chrono::steady_clock::now();
+        const bool ok = src.Read(nowMs, ps);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - r0).count();
+        if (s) readUs += us;
+        const WorkloadPhase ph = wc.Update(nowMs, ps, ok);
+        if (!ok) continue;
+        const WorkloadMetrics& m = wc.Metrics();
+        printf("%3ds  %-8s ipc %5.2f  mpki %6.2f  stalls %5.2f  Gcycles/s %6.2f  on PMU %3.0f%%  read %6.1f us\n", s,
+               WorkloadPhaseNameA(ph), m.ipc, m.mpki, m.stallShare, m.gCyclesPerSec, 100.0 * ps.running, us);
+    }
+    g_stop = true;
+    if (worker.joinable()) worker.join();
+    printf("mean read %.1f us (%zu cpu(s))\n", seconds ? readUs / seconds : 0.0, src.Cpus());
+    return 0;
+#else
+    (void)seconds; (void)load;
+    fprintf(stderr, "--live reads perf_event: Linux only\n");
+    return 2;
+#endif
+}
+
+static int Usage() {
+    fprintf(stderr, "usage: workload_bench [--hours H] [--seed N] [--cores N] [--cap-pct P] [--check]\n"
+                    "       workload_bench --live SECONDS [--load compute|memory]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    double hours = 8.0;
+    unsigned seed = 1;
+    int cores = 16;
+    uint32_t capPct = 80;
+    bool check = false;
+    int live = 0;
+    const char* load = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--check"))                 check = true;
+        else if (!strcmp(a, "--hours") && v)       { hours = std::max(0.1, atof(v)); ++i; }
+        else if (!strcmp(a, "--seed") && v)        { seed = (unsigned)atoi(v); ++i; }
+        else if (!strcmp(a, "--cores") && v)       { cores = std::max(1, std::min(1024, atoi(v))); ++i; }
+        else if (!strcmp(a, "--cap-pct") && v)     { capPct = (uint32_t)std::max(50, std::min(100, atoi(v))); ++i; }
+        else if (!strcmp(a, "--live") && v)        { live = std::max(1, atoi(v)); ++i; }
+        else if (!strcmp(a, "--load") && v && (!strcmp(v, "compute") || !strcmp(v, "memory"))) { load = v; ++i; }
+        else return Usage();
+    }
+    if (live) return Live(live, load);
+
+    std::vector<Segment> script;
+    MakeScript(hours, seed, cores, script);
+    RunResult res[3];
+    for (int p = 0; p < 3; ++p) res[p] = Run(script, (Policy)p, cores, capPct, seed);
+    printf("%.1f h, %d cores, %zu segments (", hours, cores, script.size());
+    for (int k = 0; k < 4; ++k) printf("%s%s %.0f min", k ? ", " : "", kKindNames[k], res[0].kindSec[k] / 60.0);
+    printf("), cap %u%% without boost\n\n", capPct);
+
+    const RunResult& base = res[0];
+    printf("%-12s %8s %8s %8s %8s %9s %9s %9s %8s\n", "policy", "work", "solve", "assembly", "Wh", "Wh/kunit",
+           "capped:S", "capped:A", "caps/h");
+    bool ok = true;
+    for (int p = 0; p < 3; ++p) {
+        const RunResult& r = res[p];
+        const double cover = r.kindSec[2] ? r.cappedSec[2] / r.kindSec[2] : 0.0;
+        const double wrong = r.kindSec[1] ? r.cappedSec[1] / r.kindSec[1] : 0.0;
+        const double perWork = r.wh / r.work * 1000.0, basePerWork = base.wh / base.work * 1000.0;
+        printf("%-12s %7.1f%% %7.1f%% %7.1f%% %8.0f %9.3f %8.1f%% %8.1f%% %8.1f\n", kPolicyNames[p], 100.0 * r.work / base.work,
+               100.0 * r.kindWork[2] / base.kindWork[2], 100.0 * r.kindWork[1] / base.kindWork[1], r.wh, perWork,
+               100.0 * cover, 100.0 * wrong, r.capChanges / hours);
+        if (check && p) {
+            if (cover < 0.85)                        { printf("  capped under 85%% of the solve time\n"); ok = false; }
+            if (wrong > 0.03)                        { printf("  capped over 3%% of the assembly time\n"); ok = false; }
+            if (r.work < 0.95 * base.work)           { printf("  lost over 5%% of the work\n"); ok = false; }
+            if (perWork > 0.85 * basePerWork)        { printf("  saved under 15%% energy per unit of work\n"); ok = false; }
+        }
+    }
+    return ok ? 0 : 1;
+}